@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2014-2019,  Regents of the University of California,
+ *                           Arizona Board of Regents,
+ *                           Colorado State University,
+ *                           University Pierre & Marie Curie, Sorbonne University,
+ *                           Washington University in St. Louis,
+ *                           Beijing Institute of Technology,
+ *                           The University of Memphis.
+ *
+ * This file is part of NFD (Named Data Networking Forwarding Daemon).
+ * See AUTHORS.md for complete list of NFD authors and contributors.
+ *
+ * NFD is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NFD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NFD, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory-pool.hpp"
+
+namespace nfd {
+
+static size_t
+roundUpBlockSize(size_t size)
+{
+  return (std::max<size_t>(size, 1) + MemoryPool::BLOCK_ALIGNMENT - 1) &
+         ~(MemoryPool::BLOCK_ALIGNMENT - 1);
+}
+
+MemoryPool::MemoryPool() = default;
+
+MemoryPool::~MemoryPool()
+{
+  for (void* slab : m_slabs) {
+    ::operator delete(slab);
+  }
+}
+
+void*
+MemoryPool::allocate(size_t size)
+{
+  size_t blockSize = roundUpBlockSize(size);
+  if (blockSize > MAX_BLOCK_SIZE) {
+    void* p = ::operator new(blockSize);
+    m_bytesInUse += blockSize;
+    m_bytesReserved += blockSize;
+    ++m_nBlocksInUse;
+    return p;
+  }
+
+  SizeClass& sizeClass = m_sizeClasses[blockSize / BLOCK_ALIGNMENT - 1];
+  void* p = nullptr;
+  if (sizeClass.freeList != nullptr) {
+    p = sizeClass.freeList;
+    sizeClass.freeList = sizeClass.freeList->next;
+  }
+  else {
+    if (sizeClass.slabNext == sizeClass.slabEnd) {
+      this->allocateSlab(sizeClass, blockSize);
+    }
+    p = sizeClass.slabNext;
+    sizeClass.slabNext += blockSize;
+  }
+
+  m_bytesInUse += blockSize;
+  ++m_nBlocksInUse;
+  return p;
+}
+
+void
+MemoryPool::deallocate(void* p, size_t size) noexcept
+{
+  if (p == nullptr) {
+    return;
+  }
+
+  size_t blockSize = roundUpBlockSize(size);
+  BOOST_ASSERT(m_bytesInUse >= blockSize);
+  m_bytesInUse -= blockSize;
+  --m_nBlocksInUse;
+
+  if (blockSize > MAX_BLOCK_SIZE) {
+    ::operator delete(p);
+    m_bytesReserved -= blockSize;
+    return;
+  }
+
+  SizeClass& sizeClass = m_sizeClasses[blockSize / BLOCK_ALIGNMENT - 1];
+  auto block = static_cast<FreeBlock*>(p);
+  block->next = sizeClass.freeList;
+  sizeClass.freeList = block;
+}
+
+void
+MemoryPool::allocateSlab(SizeClass& sizeClass, size_t blockSize)
+{
+  size_t nBlocks = std::max<size_t>(1, std::min(sizeClass.nextSlabBlocks, MAX_SLAB_BYTES / blockSize));
+  size_t slabSize = nBlocks * blockSize;
+
+  // allocate the slot first, so that a failure leaves no unreachable slab
+  m_slabs.push_back(nullptr);
+  m_slabs.back() = ::operator new(slabSize);
+  m_bytesReserved += slabSize;
+
+  sizeClass.slabNext = static_cast<char*>(m_slabs.back());
+  sizeClass.slabEnd = sizeClass.slabNext + slabSize;
+  sizeClass.nextSlabBlocks = nBlocks * 2;
+}
+
+} // namespace nfd
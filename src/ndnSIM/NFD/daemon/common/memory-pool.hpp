@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2014-2019,  Regents of the University of California,
+ *                           Arizona Board of Regents,
+ *                           Colorado State University,
+ *                           University Pierre & Marie Curie, Sorbonne University,
+ *                           Washington University in St. Louis,
+ *                           Beijing Institute of Technology,
+ *                           The University of Memphis.
+ *
+ * This file is part of NFD (Named Data Networking Forwarding Daemon).
+ * See AUTHORS.md for complete list of NFD authors and contributors.
+ *
+ * NFD is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NFD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NFD, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NFD_DAEMON_COMMON_MEMORY_POOL_HPP
+#define NFD_DAEMON_COMMON_MEMORY_POOL_HPP
+
+#include "core/common.hpp"
+
+#include <array>
+
+namespace nfd {
+
+/** \brief a pool of small fixed-size memory blocks
+ *
+ *  Requested sizes are rounded up to a multiple of BLOCK_ALIGNMENT, and each rounded size has
+ *  its own size class. A size class carves blocks out of slabs, whose number of blocks doubles
+ *  from MIN_SLAB_BLOCKS up to MAX_SLAB_BYTES, so that a table with few entries stays small.
+ *  Freed blocks are kept in a free list of their size class and reused by later allocations.
+ *  Slabs are never returned to the heap individually; they are all released when the pool is
+ *  destroyed. Sizes above MAX_BLOCK_SIZE are passed on to the global heap.
+ *
+ *  A table owns its pool through a shared_ptr, and PoolAllocator holds another, so that the
+ *  pool outlives entries that are still referenced after the table itself is gone.
+ */
+class MemoryPool : noncopyable
+{
+public:
+  static constexpr size_t BLOCK_ALIGNMENT = 16;
+  static constexpr size_t MAX_BLOCK_SIZE = 1024;
+  static constexpr size_t MIN_SLAB_BLOCKS = 4;
+  static constexpr size_t MAX_SLAB_BYTES = 64 * 1024;
+
+  MemoryPool();
+
+  ~MemoryPool();
+
+  /** \brief allocates a block of at least \p size bytes, aligned to BLOCK_ALIGNMENT
+   */
+  void*
+  allocate(size_t size);
+
+  /** \brief returns a block to the pool
+   *  \param p a block obtained from allocate() of this pool
+   *  \param size the size passed to allocate()
+   */
+  void
+  deallocate(void* p, size_t size) noexcept;
+
+  /** \return bytes of blocks currently allocated, after rounding
+   */
+  size_t
+  getBytesInUse() const noexcept
+  {
+    return m_bytesInUse;
+  }
+
+  /** \return bytes of memory obtained from the heap, including free blocks
+   */
+  size_t
+  getBytesReserved() const noexcept
+  {
+    return m_bytesReserved;
+  }
+
+  /** \return number of blocks currently allocated
+   */
+  size_t
+  getNBlocksInUse() const noexcept
+  {
+    return m_nBlocksInUse;
+  }
+
+private:
+  struct FreeBlock
+  {
+    FreeBlock* next;
+  };
+
+  struct SizeClass
+  {
+    FreeBlock* freeList = nullptr;
+    char* slabNext = nullptr; ///< first never allocated block of the newest slab
+    char* slabEnd = nullptr;
+    size_t nextSlabBlocks = MIN_SLAB_BLOCKS;
+  };
+
+  static constexpr size_t N_SIZE_CLASSES = MAX_BLOCK_SIZE / BLOCK_ALIGNMENT;
+
+  void
+  allocateSlab(SizeClass& sizeClass, size_t blockSize);
+
+private:
+  std::array<SizeClass, N_SIZE_CLASSES> m_sizeClasses;
+  std::vector<void*> m_slabs;
+  size_t m_bytesInUse = 0;
+  size_t m_bytesReserved = 0;
+  size_t m_nBlocksInUse = 0;
+};
+
+/** \brief a standard allocator drawing from a MemoryPool
+ *
+ *  Node-based containers and allocate_shared allocate one node at a time, which fits the
+ *  size classes of MemoryPool; larger arrays, such as hashtable buckets, go to the heap.
+ */
+template<typename T>
+class PoolAllocator
+{
+public:
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = PoolAllocator<U>;
+  };
+
+  explicit
+  PoolAllocator(shared_ptr<MemoryPool> pool) noexcept
+    : m_pool(std::move(pool))
+  {
+    BOOST_ASSERT(m_pool != nullptr);
+  }
+
+  template<typename U>
+  PoolAllocator(const PoolAllocator<U>& other) noexcept
+    : m_pool(other.getPool())
+  {
+  }
+
+  T*
+  allocate(size_t n)
+  {
+    return static_cast<T*>(m_pool->allocate(n * sizeof(T)));
+  }
+
+  void
+  deallocate(T* p, size_t n) noexcept
+  {
+    m_pool->deallocate(p, n * sizeof(T));
+  }
+
+  const shared_ptr<MemoryPool>&
+  getPool() const noexcept
+  {
+    return m_pool;
+  }
+
+private:
+  shared_ptr<MemoryPool> m_pool;
+};
+
+template<typename T, typename U>
+bool
+operator==(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs) noexcept
+{
+  return lhs.getPool() == rhs.getPool();
+}
+
+template<typename T, typename U>
+bool
+operator!=(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs) noexcept
+{
+  return lhs.getPool() != rhs.getPool();
+}
+
+} // namespace nfd
+
+#endif // NFD_DAEMON_COMMON_MEMORY_POOL_HPP
@@ -50,9 +50,10 @@ getDefaultStrategyName()
   return fw::BestRouteStrategy::getStrategyName();
 }
 
-Forwarder::Forwarder(FaceTable& faceTable)
+Forwarder::Forwarder(FaceTable& faceTable, const name_tree::HashtableOptions& nameTreeOptions)
   : m_faceTable(faceTable)
   , m_unsolicitedDataPolicy(make_unique<fw::DefaultUnsolicitedDataPolicy>())
+  , m_nameTree(nameTreeOptions)
   , m_fib(m_nameTree)
   , m_pit(m_nameTree)
   , m_measurements(m_nameTree)
@@ -53,8 +53,12 @@ class Strategy;
 class Forwarder
 {
 public:
+  /** \param faceTable
+   *  \param nameTreeOptions options of the NameTree hashtable shared by FIB, PIT, Measurements and StrategyChoice
+   */
   explicit
-  Forwarder(FaceTable& faceTable);
+  Forwarder(FaceTable& faceTable,
+            const name_tree::HashtableOptions& nameTreeOptions = name_tree::HashtableOptions(1024));
 
   NFD_VIRTUAL_WITH_TESTS
   ~Forwarder();
@@ -27,6 +27,7 @@
 #define NFD_DAEMON_TABLE_CS_ENTRY_HPP
 
 #include "core/common.hpp"
+#include "common/memory-pool.hpp"
 
 namespace nfd {
 namespace cs {
@@ -112,8 +113,9 @@ operator<(const Entry& lhs, const Entry& rhs);
 /** \brief an ordered container of ContentStore entries
  *
  *  This container uses std::less<> comparator to enable lookup with queryName.
+ *  Its nodes are allocated from the MemoryPool of the ContentStore.
  */
-using Table = std::set<Entry, std::less<>>;
+using Table = std::set<Entry, std::less<>, PoolAllocator<Entry>>;
 
 inline bool
 operator<(Table::const_iterator lhs, Table::const_iterator rhs)
@@ -121,6 +123,20 @@ operator<(Table::const_iterator lhs, Table::const_iterator rhs)
   return *lhs < *rhs;
 }
 
+/** \brief hashes a Table iterator by the address of its entry
+ *
+ *  Unlike operator<, this does not compare names, so that containers of iterators keyed by it
+ *  are accessed in constant time regardless of name length and table size.
+ */
+struct TableIteratorHash
+{
+  size_t
+  operator()(Table::const_iterator it) const noexcept
+  {
+    return std::hash<const Entry*>()(&*it);
+  }
+};
+
 } // namespace cs
 } // namespace nfd
 
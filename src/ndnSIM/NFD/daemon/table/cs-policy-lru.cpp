@@ -35,6 +35,8 @@ NFD_REGISTER_CS_POLICY(LruPolicy);
 
 LruPolicy::LruPolicy()
   : Policy(POLICY_NAME)
+  , m_pool(make_shared<MemoryPool>())
+  , m_queue(Queue::ctor_args_list(), Queue::allocator_type(m_pool))
 {
 }
 
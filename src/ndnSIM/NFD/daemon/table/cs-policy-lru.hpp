@@ -30,7 +30,7 @@
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 
 namespace nfd {
 namespace cs {
@@ -40,8 +40,10 @@ using Queue = boost::multi_index_container<
                 Policy::EntryRef,
                 boost::multi_index::indexed_by<
                   boost::multi_index::sequenced<>,
-                  boost::multi_index::ordered_unique<boost::multi_index::identity<Policy::EntryRef>>
-                >
+                  boost::multi_index::hashed_unique<boost::multi_index::identity<Policy::EntryRef>,
+                                                    TableIteratorHash>
+                >,
+                PoolAllocator<Policy::EntryRef>
               >;
 
 /** \brief Least-Recently-Used (LRU) replacement policy
@@ -51,6 +53,12 @@ class LruPolicy final : public Policy
 public:
   LruPolicy();
 
+  const MemoryPool*
+  getMemoryPool() const final
+  {
+    return m_pool.get();
+  }
+
 public:
   static const std::string POLICY_NAME;
 
@@ -77,6 +85,7 @@ private:
   insertToQueue(EntryRef i, bool isNewEntry);
 
 private:
+  shared_ptr<MemoryPool> m_pool;
   Queue m_queue;
 };
 
@@ -29,6 +29,7 @@
 #include "cs-policy.hpp"
 
 #include <list>
+#include <unordered_map>
 
 namespace nfd {
 namespace cs {
@@ -114,7 +115,7 @@ private:
 
 private:
   Queue m_queues[QUEUE_MAX];
-  std::map<EntryRef, EntryInfo*> m_entryInfoMap;
+  std::unordered_map<EntryRef, EntryInfo*, TableIteratorHash> m_entryInfoMap;
 };
 
 } // namespace priority_fifo
@@ -104,6 +104,15 @@ public:
   void
   setLimit(size_t nMaxEntries);
 
+  /** \return the pool from which the policy allocates its own bookkeeping,
+   *          or nullptr if it uses the global heap
+   */
+  virtual const MemoryPool*
+  getMemoryPool() const
+  {
+    return nullptr;
+  }
+
 public:
   /** \brief a reference to an CS entry
    *  \note operator< of EntryRef compares the Data name enclosed in the Entry.
@@ -42,6 +42,9 @@ makeDefaultPolicy()
 }
 
 Cs::Cs(size_t nMaxPackets)
+  : m_pool(make_shared<MemoryPool>())
+  , m_table(Table::allocator_type(m_pool))
+  , m_nameIndex(NameIndex::allocator_type(m_pool))
 {
   setPolicyImpl(makeDefaultPolicy());
   m_policy->setLimit(nMaxPackets);
@@ -66,7 +69,7 @@ Cs::insert(const Data& data, bool isUnsolicited)
 
   const_iterator it;
   bool isNewEntry = false;
-  std::tie(it, isNewEntry) = m_table.emplace(data.shared_from_this(), isUnsolicited);
+  std::tie(it, isNewEntry) = this->insertEntry(data, isUnsolicited);
   Entry& entry = const_cast<Entry&>(*it);
 
   entry.updateFreshUntil();
@@ -84,6 +87,66 @@ Cs::insert(const Data& data, bool isUnsolicited)
   }
 }
 
+std::pair<Cs::const_iterator, bool>
+Cs::insertEntry(const Data& data, bool isUnsolicited)
+{
+  const Name& name = data.getName();
+  auto indexIt = m_nameIndex.find(&name);
+  if (indexIt == m_nameIndex.end()) {
+    // first Data with this name, the Table cannot contain an equal entry
+    auto it = m_table.emplace(data.shared_from_this(), isUnsolicited).first;
+    m_nameIndex.emplace(&it->getName(), it);
+    return {it, true};
+  }
+
+  // entries with this name are adjacent in the Table, ordered by implicit digest
+  const name::Component& digest = data.getFullName()[-1];
+  auto it = indexIt->second;
+  for (; it != m_table.end() && it->getName() == name; ++it) {
+    int cmp = it->getFullName()[-1].compare(digest);
+    if (cmp == 0) {
+      return {it, false};
+    }
+    if (cmp > 0) {
+      break;
+    }
+  }
+
+  bool isFirst = it == indexIt->second;
+  auto newIt = m_table.emplace_hint(it, data.shared_from_this(), isUnsolicited);
+  if (isFirst) {
+    this->replaceInNameIndex(indexIt, newIt);
+  }
+  return {newIt, true};
+}
+
+void
+Cs::replaceInNameIndex(NameIndex::iterator indexIt, const_iterator it)
+{
+  // the key must point to the name of the new first entry, the old one may be erased;
+  // extract() and insert() of the node are avoided, because libstdc++ then leaks a copy of
+  // the stateful PoolAllocator left in the emptied node handle
+  m_nameIndex.erase(indexIt);
+  m_nameIndex.emplace(&it->getName(), it);
+}
+
+Cs::const_iterator
+Cs::eraseEntry(const_iterator it)
+{
+  auto indexIt = m_nameIndex.find(&it->getName());
+  BOOST_ASSERT(indexIt != m_nameIndex.end());
+  if (indexIt->second == it) {
+    auto next = std::next(it);
+    if (next != m_table.end() && next->getName() == it->getName()) {
+      this->replaceInNameIndex(indexIt, next);
+    }
+    else {
+      m_nameIndex.erase(indexIt);
+    }
+  }
+  return m_table.erase(it);
+}
+
 std::pair<Cs::const_iterator, Cs::const_iterator>
 Cs::findPrefixRange(const Name& prefix) const
 {
@@ -104,7 +167,7 @@ Cs::eraseImpl(const Name& prefix, size_t limit)
   size_t nErased = 0;
   while (i != last && nErased < limit) {
     m_policy->beforeErase(i);
-    i = m_table.erase(i);
+    i = this->eraseEntry(i);
     ++nErased;
   }
   return nErased;
@@ -118,11 +181,20 @@ Cs::findImpl(const Interest& interest) const
   }
 
   const Name& prefix = interest.getName();
-  auto range = findPrefixRange(prefix);
-  auto match = std::find_if(range.first, range.second,
-                            [&interest] (const auto& entry) { return entry.canSatisfy(interest); });
+  const_iterator match;
+  if (interest.getCanBePrefix()) {
+    auto range = findPrefixRange(prefix);
+    match = std::find_if(range.first, range.second,
+                         [&interest] (const auto& entry) { return entry.canSatisfy(interest); });
+    if (match == range.second) {
+      match = m_table.end();
+    }
+  }
+  else {
+    match = this->findExactMatch(interest);
+  }
 
-  if (match == range.second) {
+  if (match == m_table.end()) {
     NFD_LOG_DEBUG("find " << prefix << " no-match");
     return m_table.end();
   }
@@ -131,6 +203,37 @@ Cs::findImpl(const Interest& interest) const
   return match;
 }
 
+Cs::const_iterator
+Cs::findInNameIndex(const Name& name, const Interest& interest) const
+{
+  auto indexIt = m_nameIndex.find(&name);
+  if (indexIt == m_nameIndex.end()) {
+    return m_table.end();
+  }
+
+  for (auto it = indexIt->second; it != m_table.end() && it->getName() == name; ++it) {
+    if (it->canSatisfy(interest)) {
+      return it;
+    }
+  }
+  return m_table.end();
+}
+
+Cs::const_iterator
+Cs::findExactMatch(const Interest& interest) const
+{
+  // Without CanBePrefix, only Data named exactly as the Interest, or whose full name is
+  // the Interest name, can satisfy it. In Table order, the latter precedes the former.
+  const Name& name = interest.getName();
+  if (!name.empty() && name[-1].isImplicitSha256Digest()) {
+    auto match = this->findInNameIndex(name.getPrefix(-1), interest);
+    if (match != m_table.end()) {
+      return match;
+    }
+  }
+  return this->findInNameIndex(name, interest);
+}
+
 void
 Cs::dump()
 {
@@ -155,7 +258,7 @@ Cs::setPolicyImpl(unique_ptr<Policy> policy)
 {
   NFD_LOG_DEBUG("set-policy " << policy->getName());
   m_policy = std::move(policy);
-  m_beforeEvictConnection = m_policy->beforeEvict.connect([this] (auto it) { m_table.erase(it); });
+  m_beforeEvictConnection = m_policy->beforeEvict.connect([this] (auto it) { this->eraseEntry(it); });
 
   m_policy->setCs(this);
   BOOST_ASSERT(m_policy->getCs() == this);
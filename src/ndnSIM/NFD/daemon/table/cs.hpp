@@ -28,9 +28,42 @@
 
 #include "cs-policy.hpp"
 
+#include <unordered_map>
+
 namespace nfd {
 namespace cs {
 
+/** \brief hashes a Name through a pointer
+ *  \note This is not noexcept, so that std::unordered_map caches hash values and does not
+ *        recompute them from the Names when rehashing.
+ */
+struct NamePtrHash
+{
+  size_t
+  operator()(const Name* name) const
+  {
+    return std::hash<Name>()(*name);
+  }
+};
+
+struct NamePtrEqual
+{
+  bool
+  operator()(const Name* lhs, const Name* rhs) const
+  {
+    return *lhs == *rhs;
+  }
+};
+
+/** \brief a hash index of Table entries by Data name
+ *
+ *  For every distinct Data name in the Table, it maps the name to an iterator to the first entry
+ *  with that name; the key points to the name of that entry. Entries with the same name are
+ *  adjacent in the Table.
+ */
+using NameIndex = std::unordered_map<const Name*, Table::const_iterator, NamePtrHash, NamePtrEqual,
+                                     PoolAllocator<std::pair<const Name* const, Table::const_iterator>>>;
+
 /** \brief implements the Content Store
  *
  *  This Content Store implementation consists of a Table and a replacement policy.
@@ -39,6 +72,10 @@ namespace cs {
  *  Data packets are wrapped in Entry objects. Each Entry contains the Data packet itself,
  *  and a few additional attributes such as when the Data becomes non-fresh.
  *
+ *  In addition, a NameIndex hashes the Data names of Table entries. Lookups of Interests
+ *  without CanBePrefix, and refreshes of already stored Data, go through the NameIndex in
+ *  constant time; only prefix lookups, prefix erasure, and new names search the Table.
+ *
  *  The replacement policy is implemented in a subclass of \c Policy.
  */
 class Cs : noncopyable
@@ -96,6 +133,15 @@ public:
     return m_table.size();
   }
 
+  /** \return the pool from which Table and NameIndex nodes are allocated
+   *  \sa Policy::getMemoryPool
+   */
+  const MemoryPool&
+  getMemoryPool() const
+  {
+    return *m_pool;
+  }
+
 public: // configuration
   /** \brief get capacity (in number of packets)
    */
@@ -173,9 +219,36 @@ public: // enumeration
   }
 
 private:
+  /** \brief inserts an entry into the Table and the NameIndex, unless it already exists
+   *  \return iterator to the new or existing entry, and whether it is new
+   */
+  std::pair<const_iterator, bool>
+  insertEntry(const Data& data, bool isUnsolicited);
+
+  /** \brief makes \p it the first entry of its name in the NameIndex
+   */
+  void
+  replaceInNameIndex(NameIndex::iterator indexIt, const_iterator it);
+
+  /** \brief erases an entry from the NameIndex and the Table
+   *  \return iterator to the entry following it
+   */
+  const_iterator
+  eraseEntry(const_iterator it);
+
   std::pair<const_iterator, const_iterator>
   findPrefixRange(const Name& prefix) const;
 
+  /** \brief finds the first entry named \p name satisfying \p interest
+   */
+  const_iterator
+  findInNameIndex(const Name& name, const Interest& interest) const;
+
+  /** \brief finds the first entry satisfying \p interest, which does not have CanBePrefix
+   */
+  const_iterator
+  findExactMatch(const Interest& interest) const;
+
   size_t
   eraseImpl(const Name& prefix, size_t limit);
 
@@ -190,7 +263,9 @@ NFD_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   dump();
 
 private:
+  shared_ptr<MemoryPool> m_pool;
   Table m_table;
+  NameIndex m_nameIndex;
   unique_ptr<Policy> m_policy;
   signal::ScopedConnection m_beforeEvictConnection;
 
@@ -0,0 +1,308 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2014-2021,  Regents of the University of California,
+ *                           Arizona Board of Regents,
+ *                           Colorado State University,
+ *                           University Pierre & Marie Curie, Sorbonne University,
+ *                           Washington University in St. Louis,
+ *                           Beijing Institute of Technology,
+ *                           The University of Memphis.
+ *
+ * This file is part of NFD (Named Data Networking Forwarding Daemon).
+ * See AUTHORS.md for complete list of NFD authors and contributors.
+ *
+ * NFD is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NFD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NFD, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dead-nonce-filter.hpp"
+#include "common/logger.hpp"
+
+#include <deque>
+
+namespace nfd {
+
+NFD_LOG_INIT(DeadNonceFilter);
+
+const size_t DeadNonceFilter::N_GENERATIONS;
+const size_t DeadNonceFilter::SLOTS_PER_BUCKET;
+const size_t DeadNonceFilter::MIN_GENERATION_SLOTS;
+const size_t DeadNonceFilter::MAX_GENERATION_SLOTS;
+
+namespace {
+
+/** \brief a cuckoo filter of fingerprints, with SLOTS_PER_BUCKET slots per bucket
+ *
+ *  A fingerprint is stored in one of two buckets. The first one is taken from the low bits of the
+ *  entry, and the second one is the first one XOR a hash of the fingerprint, so that either bucket
+ *  can be found from the other one when a fingerprint is relocated. A zero slot is empty.
+ *
+ *  When no slot is found after MAX_KICKS relocations, the last relocated fingerprint is kept as
+ *  the victim and the table is full.
+ */
+template<typename Fingerprint>
+class CuckooTable
+{
+public:
+  explicit
+  CuckooTable(size_t nSlots)
+    : m_slots(nSlots, 0)
+    , m_bucketMask(nSlots / DeadNonceFilter::SLOTS_PER_BUCKET - 1)
+  {
+    BOOST_ASSERT(nSlots >= DeadNonceFilter::SLOTS_PER_BUCKET && (nSlots & (nSlots - 1)) == 0);
+  }
+
+  bool
+  has(uint64_t entry, Fingerprint fp) const
+  {
+    size_t i1 = this->getBucket(entry);
+    size_t i2 = this->getAltBucket(i1, fp);
+    return this->bucketHas(i1, fp) | this->bucketHas(i2, fp) | (m_victim == fp);
+  }
+
+  /** \brief stores \p fp
+   *  \pre !isFull()
+   */
+  void
+  add(uint64_t entry, Fingerprint fp)
+  {
+    BOOST_ASSERT(!this->isFull());
+    ++m_size;
+
+    size_t i = this->getBucket(entry);
+    if (this->insertIntoBucket(i, fp)) {
+      return;
+    }
+    i = this->getAltBucket(i, fp);
+    if (this->insertIntoBucket(i, fp)) {
+      return;
+    }
+
+    // relocate a pseudo-randomly chosen fingerprint of the bucket to its other bucket
+    uint64_t random = entry;
+    for (size_t nKicks = 0; nKicks < MAX_KICKS; ++nKicks) {
+      random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+      size_t slot = i * DeadNonceFilter::SLOTS_PER_BUCKET + (random >> 62);
+      std::swap(fp, m_slots[slot]);
+      i = this->getAltBucket(i, fp);
+      if (this->insertIntoBucket(i, fp)) {
+        return;
+      }
+    }
+    m_victim = fp;
+  }
+
+  bool
+  isFull() const
+  {
+    return m_victim != 0;
+  }
+
+  size_t
+  size() const
+  {
+    return m_size;
+  }
+
+  size_t
+  getNSlots() const
+  {
+    return m_slots.size();
+  }
+
+private:
+  size_t
+  getBucket(uint64_t entry) const
+  {
+    return static_cast<size_t>(entry) & m_bucketMask;
+  }
+
+  size_t
+  getAltBucket(size_t i, Fingerprint fp) const
+  {
+    return (i ^ (static_cast<size_t>(fp) * 0x5bd1e995)) & m_bucketMask;
+  }
+
+  bool
+  bucketHas(size_t i, Fingerprint fp) const
+  {
+    static_assert(DeadNonceFilter::SLOTS_PER_BUCKET == 4, "bucketHas assumes 4 slots per bucket");
+    const Fingerprint* bucket = &m_slots[i * DeadNonceFilter::SLOTS_PER_BUCKET];
+    return (bucket[0] == fp) | (bucket[1] == fp) | (bucket[2] == fp) | (bucket[3] == fp);
+  }
+
+  bool
+  insertIntoBucket(size_t i, Fingerprint fp)
+  {
+    Fingerprint* bucket = &m_slots[i * DeadNonceFilter::SLOTS_PER_BUCKET];
+    for (size_t j = 0; j < DeadNonceFilter::SLOTS_PER_BUCKET; ++j) {
+      if (bucket[j] == 0) {
+        bucket[j] = fp;
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  static constexpr size_t MAX_KICKS = 500;
+
+  std::vector<Fingerprint> m_slots;
+  size_t m_bucketMask;
+  size_t m_size = 0;
+  Fingerprint m_victim = 0;
+};
+
+template<typename Fingerprint>
+class DeadNonceFilterImpl final : public DeadNonceFilter
+{
+public:
+  DeadNonceFilterImpl()
+  {
+    m_generations.emplace_back(MIN_GENERATION_SLOTS);
+  }
+
+  bool
+  has(uint64_t entry) const final
+  {
+    Fingerprint fp = makeFingerprint(entry);
+    return std::any_of(m_generations.begin(), m_generations.end(),
+                       [=] (const Generation& gen) { return gen.has(entry, fp); });
+  }
+
+  void
+  add(uint64_t entry) final
+  {
+    Fingerprint fp = makeFingerprint(entry);
+    if (m_generations.back().has(entry, fp)) {
+      return;
+    }
+
+    if (m_generations.back().tables.back().isFull()) {
+      Generation& gen = m_generations.back();
+      size_t nSlots = gen.tables.back().getNSlots() * 2;
+      if (gen.nSlots + nSlots <= MAX_GENERATION_SLOTS) {
+        gen.tables.emplace_back(nSlots);
+        gen.nSlots += nSlots;
+      }
+      else {
+        NFD_LOG_DEBUG("generation full nSlots=" << gen.nSlots << ", rotating early");
+        this->rotate();
+      }
+    }
+
+    Generation& gen = m_generations.back();
+    gen.tables.back().add(entry, fp);
+    ++gen.nEntries;
+  }
+
+  void
+  rotate() final
+  {
+    // size the new generation for as many entries as the last one, at most TARGET_LOAD full
+    size_t nEntries = m_generations.back().nEntries;
+    size_t nSlots = MIN_GENERATION_SLOTS;
+    while (nSlots * TARGET_LOAD < nEntries && nSlots < MAX_GENERATION_SLOTS) {
+      nSlots *= 2;
+    }
+
+    m_generations.emplace_back(nSlots);
+    if (m_generations.size() > N_GENERATIONS) {
+      m_generations.pop_front();
+    }
+
+    NFD_LOG_TRACE("rotate lastEntries=" << nEntries << " nSlots=" << nSlots <<
+                  " size=" << this->size() << " memory=" << this->getMemoryUsage());
+  }
+
+  size_t
+  size() const final
+  {
+    size_t n = 0;
+    for (const Generation& gen : m_generations) {
+      n += gen.nEntries;
+    }
+    return n;
+  }
+
+  size_t
+  getMemoryUsage() const final
+  {
+    size_t nSlots = 0;
+    for (const Generation& gen : m_generations) {
+      nSlots += gen.nSlots;
+    }
+    return nSlots * sizeof(Fingerprint);
+  }
+
+  size_t
+  getFingerprintBits() const final
+  {
+    return sizeof(Fingerprint) * 8;
+  }
+
+private:
+  static Fingerprint
+  makeFingerprint(uint64_t entry)
+  {
+    // the high bits are independent of the bucket, which is taken from the low bits
+    auto fp = static_cast<Fingerprint>(entry >> (64 - sizeof(Fingerprint) * 8));
+    return fp != 0 ? fp : 1;
+  }
+
+  struct Generation
+  {
+    explicit
+    Generation(size_t nSlots)
+      : nSlots(nSlots)
+    {
+      tables.emplace_back(nSlots);
+    }
+
+    bool
+    has(uint64_t entry, Fingerprint fp) const
+    {
+      return std::any_of(tables.begin(), tables.end(),
+                         [=] (const CuckooTable<Fingerprint>& table) { return table.has(entry, fp); });
+    }
+
+    std::vector<CuckooTable<Fingerprint>> tables;
+    size_t nSlots;
+    size_t nEntries = 0;
+  };
+
+private:
+  static constexpr double TARGET_LOAD = 0.9;
+
+  std::deque<Generation> m_generations; ///< oldest first
+};
+
+} // namespace
+
+unique_ptr<DeadNonceFilter>
+DeadNonceFilter::create(double falsePositiveRate)
+{
+  if (!(falsePositiveRate > 0.0 && falsePositiveRate < 1.0)) {
+    NDN_THROW(std::invalid_argument("falsePositiveRate must be in (0, 1)"));
+  }
+
+  // a lookup compares the fingerprint with two buckets in each generation
+  double nComparisons = 2.0 * SLOTS_PER_BUCKET * N_GENERATIONS;
+  if (nComparisons / (1 << 8) <= falsePositiveRate) {
+    return make_unique<DeadNonceFilterImpl<uint8_t>>();
+  }
+  if (nComparisons / (1 << 16) <= falsePositiveRate) {
+    return make_unique<DeadNonceFilterImpl<uint16_t>>();
+  }
+  return make_unique<DeadNonceFilterImpl<uint32_t>>();
+}
+
+} // namespace nfd
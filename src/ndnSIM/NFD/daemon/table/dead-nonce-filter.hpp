@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2014-2021,  Regents of the University of California,
+ *                           Arizona Board of Regents,
+ *                           Colorado State University,
+ *                           University Pierre & Marie Curie, Sorbonne University,
+ *                           Washington University in St. Louis,
+ *                           Beijing Institute of Technology,
+ *                           The University of Memphis.
+ *
+ * This file is part of NFD (Named Data Networking Forwarding Daemon).
+ * See AUTHORS.md for complete list of NFD authors and contributors.
+ *
+ * NFD is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NFD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NFD, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NFD_DAEMON_TABLE_DEAD_NONCE_FILTER_HPP
+#define NFD_DAEMON_TABLE_DEAD_NONCE_FILTER_HPP
+
+#include "core/common.hpp"
+
+namespace nfd {
+
+/** \brief a compact, probabilistic set of Dead Nonce List entries
+ *
+ *  Entries are the 64-bit hashes of Name and Nonce made by DeadNonceList. They are stored as
+ *  short fingerprints in cuckoo filters, one per generation. New entries go into the newest
+ *  generation; rotate() starts a new generation and drops the oldest one, so that an entry is
+ *  kept between N_GENERATIONS - 1 and N_GENERATIONS rotation intervals.
+ *
+ *  A new generation is sized from the number of entries added during the previous one. When its
+ *  filter fills up, another filter of twice the size is added to the generation, up to
+ *  MAX_GENERATION_SLOTS; beyond that, the oldest generation is dropped early.
+ *
+ *  has() never misses an entry that is still kept. It returns true for an entry that was never
+ *  added with a probability below the false positive rate given to create(), as long as each
+ *  generation holds a single filter.
+ */
+class DeadNonceFilter : noncopyable
+{
+public:
+  /** \brief creates a filter with fingerprints wide enough for \p falsePositiveRate
+   *  \throw std::invalid_argument falsePositiveRate is not in (0, 1)
+   */
+  static unique_ptr<DeadNonceFilter>
+  create(double falsePositiveRate);
+
+  virtual
+  ~DeadNonceFilter() = default;
+
+  virtual bool
+  has(uint64_t entry) const = 0;
+
+  /** \brief adds \p entry to the newest generation, unless it is already there
+   */
+  virtual void
+  add(uint64_t entry) = 0;
+
+  /** \brief starts a new generation, and drops the oldest one if there are N_GENERATIONS
+   */
+  virtual void
+  rotate() = 0;
+
+  /** \return number of stored entries
+   *  \note An entry added again in a later generation is counted again.
+   */
+  virtual size_t
+  size() const = 0;
+
+  /** \return number of bytes of fingerprint storage
+   */
+  virtual size_t
+  getMemoryUsage() const = 0;
+
+  /** \return number of bits of a fingerprint
+   */
+  virtual size_t
+  getFingerprintBits() const = 0;
+
+public:
+  static constexpr size_t N_GENERATIONS = 6;
+  static constexpr size_t SLOTS_PER_BUCKET = 4;
+  static constexpr size_t MIN_GENERATION_SLOTS = 1 << 10;
+  static constexpr size_t MAX_GENERATION_SLOTS = 1 << 22;
+};
+
+} // namespace nfd
+
+#endif // NFD_DAEMON_TABLE_DEAD_NONCE_FILTER_HPP
@@ -72,9 +72,27 @@ DeadNonceList::DeadNonceList(time::nanoseconds lifetime)
   static_assert(EVICT_LIMIT >= 1, "EVICT_LIMIT must be at least 1");
 }
 
+void
+DeadNonceList::useCompactBackend(double falsePositiveRate)
+{
+  m_filter = DeadNonceFilter::create(falsePositiveRate);
+  m_index.clear();
+  m_actualMarkCounts.clear();
+  m_adjustCapacityEvent.cancel();
+
+  NFD_LOG_DEBUG("compact backend falsePositiveRate=" << falsePositiveRate <<
+                " fingerprintBits=" << m_filter->getFingerprintBits());
+
+  m_markEvent = getScheduler().schedule(m_lifetime / (DeadNonceFilter::N_GENERATIONS - 1),
+                                        [this] { rotateFilter(); });
+}
+
 size_t
 DeadNonceList::size() const
 {
+  if (m_filter != nullptr) {
+    return m_filter->size();
+  }
   return m_queue.size() - countMarks();
 }
 
@@ -82,6 +100,9 @@ bool
 DeadNonceList::has(const Name& name, Interest::Nonce nonce) const
 {
   Entry entry = DeadNonceList::makeEntry(name, nonce);
+  if (m_filter != nullptr) {
+    return m_filter->has(entry);
+  }
   return m_ht.find(entry) != m_ht.end();
 }
 
@@ -89,6 +110,12 @@ void
 DeadNonceList::add(const Name& name, Interest::Nonce nonce)
 {
   Entry entry = DeadNonceList::makeEntry(name, nonce);
+  if (m_filter != nullptr) {
+    NFD_LOG_TRACE("adding " << name << " nonce=" << nonce);
+    m_filter->add(entry);
+    return;
+  }
+
   const auto iter = m_ht.find(entry);
   bool isDuplicate = iter != m_ht.end();
 
@@ -169,4 +196,13 @@ DeadNonceList::evictEntries()
   NFD_LOG_TRACE("evicted=" << nEvict << " size=" << size() << " capacity=" << m_capacity);
 }
 
+void
+DeadNonceList::rotateFilter()
+{
+  m_filter->rotate();
+
+  m_markEvent = getScheduler().schedule(m_lifetime / (DeadNonceFilter::N_GENERATIONS - 1),
+                                        [this] { rotateFilter(); });
+}
+
 } // namespace nfd
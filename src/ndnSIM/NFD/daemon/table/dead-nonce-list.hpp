@@ -27,6 +27,7 @@
 #define NFD_DAEMON_TABLE_DEAD_NONCE_LIST_HPP
 
 #include "core/common.hpp"
+#include "dead-nonce-filter.hpp"
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -50,6 +51,10 @@ namespace nfd {
  * At fixed intervals, a MARK (an entry with a special value) is inserted into the container.
  * The number of MARKs stored in the container reflects the lifetime of the entries,
  * because MARKs are inserted at fixed intervals.
+ *
+ * Alternatively, useCompactBackend() replaces the container with a DeadNonceFilter, which keeps
+ * short fingerprints of the hashes in time-bucketed cuckoo filters. It uses a fraction of the
+ * memory, at the cost of a configurable false positive rate.
  */
 class DeadNonceList : noncopyable
 {
@@ -77,6 +82,16 @@ public:
   void
   add(const Name& name, Interest::Nonce nonce);
 
+  /**
+   * \brief Replaces the container with a DeadNonceFilter
+   * \param falsePositiveRate upper bound of the probability that has() returns true for
+   *        a name+nonce that was not added
+   * \throw std::invalid_argument if falsePositiveRate is not in (0, 1)
+   * \note Entries already in the list are discarded.
+   */
+  void
+  useCompactBackend(double falsePositiveRate);
+
   /**
    * \brief Returns the number of stored nonces
    * \note The return value does not contain non-Nonce entries in the index, if any.
@@ -122,6 +137,11 @@ private:
   void
   evictEntries();
 
+  /** \brief Start a new generation of the compact backend
+   */
+  void
+  rotateFilter();
+
 public:
   /// Default entry lifetime
   static constexpr time::nanoseconds DEFAULT_LIFETIME = 6_s;
@@ -205,6 +225,14 @@ NFD_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
 
   /// Maximum number of entries to evict at each operation if the index is over capacity
   static constexpr size_t EVICT_LIMIT = 64;
+
+  // ---- compact backend
+
+  /** \brief The compact backend, replacing m_index if not nullptr
+   *
+   *  Its generations are rotated by m_markEvent, so that entries are kept for at least m_lifetime.
+   */
+  unique_ptr<DeadNonceFilter> m_filter;
 };
 
 } // namespace nfd
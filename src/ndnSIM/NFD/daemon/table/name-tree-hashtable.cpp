@@ -27,6 +27,10 @@
 #include "common/city-hash.hpp"
 #include "common/logger.hpp"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace nfd {
 namespace name_tree {
 
@@ -56,6 +60,81 @@ public:
  */
 using HashFunc = std::conditional<(sizeof(HashValue) > 4), Hash64, Hash32>::type;
 
+/** \brief control byte of an empty slot
+ */
+const int8_t CTRL_EMPTY = -128;
+
+/** \brief control byte of a slot whose node has been erased, probing continues past it
+ */
+const int8_t CTRL_DELETED = -2;
+
+/** \brief mix the hash value, so that both its high bits (group) and low bits (control byte) are well distributed
+ */
+static size_t
+mixHash(HashValue h)
+{
+  uint64_t x = static_cast<uint64_t>(h) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t>(x ^ (x >> 32));
+}
+
+/** \return control byte of a slot holding hash value h
+ */
+static int8_t
+computeCtrl(HashValue h)
+{
+  return static_cast<int8_t>(mixHash(h) & 0x7F);
+}
+
+/** \return bitmask of the slots in group whose control byte equals ctrl
+ */
+static uint32_t
+matchCtrl(const int8_t* group, int8_t ctrl)
+{
+#if defined(__SSE2__)
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(ctrl))));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < 16; ++i) {
+    mask |= static_cast<uint32_t>(group[i] == ctrl) << i;
+  }
+  return mask;
+#endif
+}
+
+/** \return bitmask of the empty or deleted slots in group, i.e. those with a negative control byte
+ */
+static uint32_t
+matchFree(const int8_t* group)
+{
+#if defined(__SSE2__)
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < 16; ++i) {
+    mask |= static_cast<uint32_t>(group[i] < 0) << i;
+  }
+  return mask;
+#endif
+}
+
+/** \brief invoke func(slot) for each slot in mask, stop when func returns true
+ *  \return whether func returned true
+ */
+template<typename F>
+static bool
+foreachMatch(uint32_t mask, size_t groupStart, const F& func)
+{
+  while (mask != 0) {
+    int i = __builtin_ctz(mask);
+    if (func(groupStart + i)) {
+      return true;
+    }
+    mask &= mask - 1;
+  }
+  return false;
+}
+
 HashValue
 computeHash(const Name& name, size_t prefixLen)
 {
@@ -118,6 +197,7 @@ HashtableOptions::HashtableOptions(size_t size)
 Hashtable::Hashtable(const Options& options)
   : m_options(options)
   , m_size(0)
+  , m_pool(make_shared<MemoryPool>())
 {
   BOOST_ASSERT(m_options.minSize > 0);
   BOOST_ASSERT(m_options.initialSize >= m_options.minSize);
@@ -129,18 +209,53 @@ Hashtable::Hashtable(const Options& options)
   BOOST_ASSERT(m_options.shrinkFactor > 0.0);
   BOOST_ASSERT(m_options.shrinkFactor < 1.0);
 
-  m_buckets.resize(options.initialSize);
+  if (m_options.layout == Options::Layout::OPEN_ADDRESSING) {
+    size_t capacity = computeOpenCapacity(options.initialSize);
+    m_table.ctrl.assign(capacity, CTRL_EMPTY);
+    m_table.slots.assign(capacity, Slot{0, nullptr});
+  }
+  else {
+    m_buckets.resize(options.initialSize);
+  }
   this->computeThresholds();
 }
 
 Hashtable::~Hashtable()
 {
   for (size_t i = 0; i < m_buckets.size(); ++i) {
-    foreachNode(m_buckets[i], [] (Node* node) {
+    foreachNode(m_buckets[i], [this] (Node* node) {
       node->prev = node->next = nullptr;
-      delete node;
+      this->destroyNode(node);
     });
   }
+
+  for (const OpenTable* table : {&m_table, &m_oldTable}) {
+    for (const Slot& slot : table->slots) {
+      if (slot.node != nullptr) {
+        this->destroyNode(slot.node);
+      }
+    }
+  }
+}
+
+Node*
+Hashtable::makeNode(HashValue h, const Name& name)
+{
+  void* p = m_pool->allocate(sizeof(Node));
+  try {
+    return new (p) Node(h, name);
+  }
+  catch (...) {
+    m_pool->deallocate(p, sizeof(Node));
+    throw;
+  }
+}
+
+void
+Hashtable::destroyNode(Node* node)
+{
+  node->~Node();
+  m_pool->deallocate(node, sizeof(Node));
 }
 
 void
@@ -180,6 +295,10 @@ Hashtable::detach(size_t bucket, Node* node)
 std::pair<const Node*, bool>
 Hashtable::findOrInsert(const Name& name, size_t prefixLen, HashValue h, bool allowInsert)
 {
+  if (m_options.layout == Options::Layout::OPEN_ADDRESSING) {
+    return this->openFindOrInsert(name, prefixLen, h, allowInsert);
+  }
+
   size_t bucket = this->computeBucketIndex(h);
 
   for (const Node* node = m_buckets[bucket]; node != nullptr; node = node->next) {
@@ -194,7 +313,7 @@ Hashtable::findOrInsert(const Name& name, size_t prefixLen, HashValue h, bool al
     return {nullptr, false};
   }
 
-  Node* node = new Node(h, name.getPrefix(prefixLen));
+  Node* node = this->makeNode(h, name.getPrefix(prefixLen));
   this->attach(bucket, node);
   NFD_LOG_TRACE("insert " << node->entry.getName() << " hash=" << h << " bucket=" << bucket);
   ++m_size;
@@ -233,11 +352,16 @@ Hashtable::erase(Node* node)
   BOOST_ASSERT(node != nullptr);
   BOOST_ASSERT(node->entry.getParent() == nullptr);
 
+  if (m_options.layout == Options::Layout::OPEN_ADDRESSING) {
+    this->openErase(node);
+    return;
+  }
+
   size_t bucket = this->computeBucketIndex(node->hash);
   NFD_LOG_TRACE("erase " << node->entry.getName() << " hash=" << node->hash << " bucket=" << bucket);
 
   this->detach(bucket, node);
-  delete node;
+  this->destroyNode(node);
   --m_size;
 
   if (m_size < m_shrinkThreshold) {
@@ -247,11 +371,31 @@ Hashtable::erase(Node* node)
   }
 }
 
+size_t
+Hashtable::getBucketIndex(const Node* node) const
+{
+  if (m_options.layout == Options::Layout::OPEN_ADDRESSING) {
+    size_t slot = this->openFindSlot(m_table, node);
+    if (slot < m_table.slots.size()) {
+      return slot;
+    }
+    slot = this->openFindSlot(m_oldTable, node);
+    BOOST_ASSERT(slot < m_oldTable.slots.size());
+    return m_table.slots.size() + slot;
+  }
+  return this->computeBucketIndex(node->hash);
+}
+
 void
 Hashtable::computeThresholds()
 {
-  m_expandThreshold = static_cast<size_t>(m_options.expandLoadFactor * this->getNBuckets());
-  m_shrinkThreshold = static_cast<size_t>(m_options.shrinkLoadFactor * this->getNBuckets());
+  size_t nBuckets = m_options.layout == Options::Layout::OPEN_ADDRESSING ? m_table.slots.size() :
+                                                                          m_buckets.size();
+  // an open addressing table needs free slots to terminate probing
+  float expandLoadFactor = m_options.layout == Options::Layout::OPEN_ADDRESSING ?
+                           std::min(m_options.expandLoadFactor, 0.875f) : m_options.expandLoadFactor;
+  m_expandThreshold = static_cast<size_t>(expandLoadFactor * nBuckets);
+  m_shrinkThreshold = static_cast<size_t>(m_options.shrinkLoadFactor * nBuckets);
   NFD_LOG_TRACE("thresholds expand=" << m_expandThreshold << " shrink=" << m_shrinkThreshold);
 }
 
@@ -277,5 +421,247 @@ Hashtable::resize(size_t newNBuckets)
   this->computeThresholds();
 }
 
+size_t
+Hashtable::computeOpenCapacity(size_t nBuckets)
+{
+  size_t capacity = GROUP_SIZE;
+  while (capacity < nBuckets) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+const Node*
+Hashtable::openFind(const OpenTable& table, const Name& name, size_t prefixLen, HashValue h) const
+{
+  size_t nGroups = table.slots.size() / GROUP_SIZE;
+  if (nGroups == 0) {
+    return nullptr;
+  }
+
+  int8_t ctrl = computeCtrl(h);
+  size_t group = (mixHash(h) >> 7) & (nGroups - 1);
+  const Node* found = nullptr;
+
+  // triangular probing visits every group once when the number of groups is a power of 2
+  for (size_t i = 0; i < nGroups; ++i) {
+    size_t start = group * GROUP_SIZE;
+    const int8_t* bytes = &table.ctrl[start];
+    bool isFound = foreachMatch(matchCtrl(bytes, ctrl), start, [&] (size_t slot) {
+      const Slot& s = table.slots[slot];
+      if (s.hash == h && name.compare(0, prefixLen, s.node->entry.getName()) == 0) {
+        found = s.node;
+        return true;
+      }
+      return false;
+    });
+    if (isFound) {
+      return found;
+    }
+    if (matchCtrl(bytes, CTRL_EMPTY) != 0) {
+      return nullptr;
+    }
+    group = (group + i + 1) & (nGroups - 1);
+  }
+  return nullptr;
+}
+
+size_t
+Hashtable::openFindSlot(const OpenTable& table, const Node* node) const
+{
+  size_t nGroups = table.slots.size() / GROUP_SIZE;
+  if (nGroups == 0) {
+    return table.slots.size();
+  }
+
+  int8_t ctrl = computeCtrl(node->hash);
+  size_t group = (mixHash(node->hash) >> 7) & (nGroups - 1);
+  size_t found = table.slots.size();
+
+  for (size_t i = 0; i < nGroups; ++i) {
+    size_t start = group * GROUP_SIZE;
+    const int8_t* bytes = &table.ctrl[start];
+    bool isFound = foreachMatch(matchCtrl(bytes, ctrl), start, [&] (size_t slot) {
+      if (table.slots[slot].node == node) {
+        found = slot;
+        return true;
+      }
+      return false;
+    });
+    if (isFound || matchCtrl(bytes, CTRL_EMPTY) != 0) {
+      break;
+    }
+    group = (group + i + 1) & (nGroups - 1);
+  }
+  return found;
+}
+
+void
+Hashtable::openPlace(OpenTable& table, Node* node)
+{
+  size_t nGroups = table.slots.size() / GROUP_SIZE;
+  BOOST_ASSERT(table.nFull < table.slots.size());
+
+  size_t group = (mixHash(node->hash) >> 7) & (nGroups - 1);
+  for (size_t i = 0; i < nGroups; ++i) {
+    size_t start = group * GROUP_SIZE;
+    uint32_t mask = matchFree(&table.ctrl[start]);
+    if (mask != 0) {
+      size_t slot = start + __builtin_ctz(mask);
+      if (table.ctrl[slot] == CTRL_DELETED) {
+        --table.nDeleted;
+      }
+      table.ctrl[slot] = computeCtrl(node->hash);
+      table.slots[slot] = Slot{node->hash, node};
+      ++table.nFull;
+      return;
+    }
+    group = (group + i + 1) & (nGroups - 1);
+  }
+  BOOST_ASSERT_MSG(false, "open addressing table is full");
+}
+
+void
+Hashtable::openClearSlot(OpenTable& table, size_t slot)
+{
+  // probing stops at a group with an empty slot, so if this group has one, no probe sequence passes through it
+  size_t start = slot - slot % GROUP_SIZE;
+  if (matchCtrl(&table.ctrl[start], CTRL_EMPTY) != 0) {
+    table.ctrl[slot] = CTRL_EMPTY;
+  }
+  else {
+    table.ctrl[slot] = CTRL_DELETED;
+    ++table.nDeleted;
+  }
+  table.slots[slot] = Slot{0, nullptr};
+  --table.nFull;
+}
+
+std::pair<const Node*, bool>
+Hashtable::openFindOrInsert(const Name& name, size_t prefixLen, HashValue h, bool allowInsert)
+{
+  const Node* found = this->openFind(m_table, name, prefixLen, h);
+  if (found == nullptr && this->isResizing()) {
+    found = this->openFind(m_oldTable, name, prefixLen, h);
+  }
+  if (found != nullptr) {
+    NFD_LOG_TRACE("found " << name.getPrefix(prefixLen) << " hash=" << h);
+    return {found, false};
+  }
+
+  if (!allowInsert) {
+    NFD_LOG_TRACE("not-found " << name.getPrefix(prefixLen) << " hash=" << h);
+    return {nullptr, false};
+  }
+
+  // the new table fills up faster than expected during migration, finish it first
+  if (this->isResizing() && m_table.nFull + m_table.nDeleted >= m_expandThreshold) {
+    this->openMigrate(m_oldTable.slots.size());
+  }
+
+  Node* node = this->makeNode(h, name.getPrefix(prefixLen));
+  this->openPlace(m_table, node);
+  NFD_LOG_TRACE("insert " << node->entry.getName() << " hash=" << h);
+  ++m_size;
+
+  if (this->isResizing()) {
+    this->openMigrate(m_options.migrationBatch);
+  }
+  // a finished resize may leave the table too full or too empty
+  if (!this->isResizing()) {
+    this->openCheckLoad();
+  }
+
+  return {node, true};
+}
+
+void
+Hashtable::openErase(Node* node)
+{
+  NFD_LOG_TRACE("erase " << node->entry.getName() << " hash=" << node->hash);
+
+  size_t slot = this->openFindSlot(m_table, node);
+  if (slot < m_table.slots.size()) {
+    this->openClearSlot(m_table, slot);
+  }
+  else {
+    slot = this->openFindSlot(m_oldTable, node);
+    BOOST_ASSERT(slot < m_oldTable.slots.size());
+    this->openClearSlot(m_oldTable, slot);
+  }
+  this->destroyNode(node);
+  --m_size;
+
+  if (this->isResizing()) {
+    this->openMigrate(m_options.migrationBatch);
+  }
+  // a finished resize may leave the table too full or too empty
+  if (!this->isResizing()) {
+    this->openCheckLoad();
+  }
+}
+
+void
+Hashtable::openCheckLoad()
+{
+  size_t capacity = m_table.slots.size();
+  if (m_table.nFull + m_table.nDeleted > m_expandThreshold) {
+    // mostly erased nodes are rehashed in place, otherwise the table grows
+    size_t newCapacity = m_size * 2 > m_expandThreshold ?
+                         computeOpenCapacity(static_cast<size_t>(m_options.expandFactor * capacity)) : capacity;
+    this->openResize(newCapacity);
+  }
+  else if (m_size < m_shrinkThreshold) {
+    // keep the shrunk table at most half full
+    size_t newCapacity = computeOpenCapacity(std::max({m_options.minSize, 2 * m_size,
+                                             static_cast<size_t>(m_options.shrinkFactor * capacity)}));
+    if (newCapacity < capacity) {
+      this->openResize(newCapacity);
+    }
+  }
+}
+
+void
+Hashtable::openResize(size_t newCapacity)
+{
+  if (this->isResizing()) {
+    this->openMigrate(m_oldTable.slots.size());
+  }
+  NFD_LOG_DEBUG("resize from=" << m_table.slots.size() << " to=" << newCapacity);
+
+  m_oldTable = std::move(m_table);
+  m_table = OpenTable();
+  m_table.ctrl.assign(newCapacity, CTRL_EMPTY);
+  m_table.slots.assign(newCapacity, Slot{0, nullptr});
+  m_migrateNext = 0;
+  this->computeThresholds();
+
+  if (m_oldTable.nFull == 0) {
+    m_oldTable = OpenTable();
+  }
+}
+
+void
+Hashtable::openMigrate(size_t nSlots)
+{
+  size_t end = std::min(m_migrateNext + nSlots, m_oldTable.slots.size());
+  for (; m_migrateNext < end; ++m_migrateNext) {
+    Slot& slot = m_oldTable.slots[m_migrateNext];
+    if (slot.node != nullptr) {
+      this->openPlace(m_table, slot.node);
+      // the old slot becomes deleted rather than empty, so that unmigrated nodes are still found
+      m_oldTable.ctrl[m_migrateNext] = CTRL_DELETED;
+      slot = Slot{0, nullptr};
+      --m_oldTable.nFull;
+    }
+  }
+
+  if (m_oldTable.nFull == 0) {
+    NFD_LOG_DEBUG("resize finished size=" << m_size);
+    m_oldTable = OpenTable();
+    m_migrateNext = 0;
+  }
+}
+
 } // namespace name_tree
 } // namespace nfd
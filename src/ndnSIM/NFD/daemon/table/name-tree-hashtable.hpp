@@ -27,6 +27,7 @@
 #define NFD_DAEMON_TABLE_NAME_TREE_HASHTABLE_HPP
 
 #include "name-tree-entry.hpp"
+#include "common/memory-pool.hpp"
 
 namespace nfd {
 namespace name_tree {
@@ -57,6 +58,7 @@ computeHashes(const Name& name, size_t prefixLen = std::numeric_limits<size_t>::
  *
  *  Zero or more nodes can be added to a hashtable bucket. They are organized as
  *  a doubly linked list through prev and next pointers.
+ *  In an open addressing hashtable, every bucket holds at most one node, and prev and next are unused.
  */
 class Node : noncopyable
 {
@@ -106,6 +108,18 @@ foreachNode(N* head, const F& func)
 class HashtableOptions
 {
 public:
+  /** \brief how hash collisions are resolved
+   */
+  enum class Layout {
+    /** \brief a doubly linked list of nodes per bucket
+     */
+    CHAINED,
+    /** \brief open addressing with SIMD probing of per-slot metadata (Swiss table),
+     *         the hashtable is resized incrementally
+     */
+    OPEN_ADDRESSING,
+  };
+
   /** \brief constructor
    *  \post initialSize == size
    *  \post minSize == size
@@ -137,6 +151,15 @@ public:
   /** \brief when hashtable is shrunk, its new size is max(nBuckets*shrinkFactor, minSize)
    */
   float shrinkFactor = 0.5;
+
+  /** \brief collision resolution
+   */
+  Layout layout = Layout::CHAINED;
+
+  /** \brief number of slots of the old table moved into the new one on every insert or erase,
+   *         while an open addressing hashtable is being resized
+   */
+  size_t migrationBatch = 32;
 };
 
 /** \brief a hashtable for fast exact name lookup
@@ -145,6 +168,13 @@ public:
  *  Each node is placed into a bucket determined by a hash value computed from its name.
  *  Hash collision is resolved through a doubly linked list in each bucket.
  *  The number of buckets is adjusted according to how many nodes are stored.
+ *
+ *  With HashtableOptions::Layout::OPEN_ADDRESSING, buckets are the slots of an open addressing table
+ *  instead. Slots store hash value and node pointer contiguously, and one control byte per slot
+ *  (7 bits of the hash, or empty/deleted) is probed 16 slots at a time. The table capacity is a
+ *  power of 2. When it is resized, the new table is filled incrementally by subsequent insert and
+ *  erase operations, while lookups search both tables; buckets of the old table then follow those
+ *  of the new table.
  */
 class Hashtable
 {
@@ -171,6 +201,9 @@ public:
   size_t
   getNBuckets() const
   {
+    if (m_options.layout == Options::Layout::OPEN_ADDRESSING) {
+      return m_table.slots.size() + m_oldTable.slots.size();
+    }
     return m_buckets.size();
   }
 
@@ -189,9 +222,27 @@ public:
   getBucket(size_t bucket) const
   {
     BOOST_ASSERT(bucket < this->getNBuckets());
+    if (m_options.layout == Options::Layout::OPEN_ADDRESSING) {
+      return bucket < m_table.slots.size() ? m_table.slots[bucket].node :
+                                             m_oldTable.slots[bucket - m_table.slots.size()].node;
+    }
     return m_buckets[bucket]; // don't use m_bucket.at() for better performance
   }
 
+  /** \return index of the bucket containing node
+   *  \pre node exists in this hashtable
+   */
+  size_t
+  getBucketIndex(const Node* node) const;
+
+  /** \return whether an open addressing hashtable is being resized
+   */
+  bool
+  isResizing() const
+  {
+    return !m_oldTable.slots.empty();
+  }
+
   /** \brief find node for name.getPrefix(prefixLen)
    *  \pre name.size() > prefixLen
    */
@@ -218,7 +269,21 @@ public:
   void
   erase(Node* node);
 
+  /** \return the pool from which nodes are allocated
+   */
+  const MemoryPool&
+  getMemoryPool() const
+  {
+    return *m_pool;
+  }
+
 private:
+  Node*
+  makeNode(HashValue h, const Name& name);
+
+  void
+  destroyNode(Node* node);
+
   /** \brief attach node to bucket
    */
   void
@@ -238,12 +303,78 @@ private:
   void
   resize(size_t newNBuckets);
 
+private: // open addressing
+  /** \brief a slot of an open addressing table
+   */
+  struct Slot
+  {
+    HashValue hash;
+    Node* node;
+  };
+
+  /** \brief an open addressing table, slots are probed in groups of GROUP_SIZE
+   */
+  struct OpenTable
+  {
+    std::vector<int8_t> ctrl; ///< control byte of each slot, CTRL_EMPTY, CTRL_DELETED, or 7 bits of the hash
+    std::vector<Slot> slots;
+    size_t nFull = 0;
+    size_t nDeleted = 0;
+  };
+
+  static constexpr size_t GROUP_SIZE = 16;
+
+  static size_t
+  computeOpenCapacity(size_t nBuckets);
+
+  const Node*
+  openFind(const OpenTable& table, const Name& name, size_t prefixLen, HashValue h) const;
+
+  /** \return slot holding node in table, or table.slots.size() if node isn't there
+   */
+  size_t
+  openFindSlot(const OpenTable& table, const Node* node) const;
+
+  /** \brief place node into the first free slot of its probe sequence
+   */
+  void
+  openPlace(OpenTable& table, Node* node);
+
+  void
+  openClearSlot(OpenTable& table, size_t slot);
+
+  std::pair<const Node*, bool>
+  openFindOrInsert(const Name& name, size_t prefixLen, HashValue h, bool allowInsert);
+
+  void
+  openErase(Node* node);
+
+  /** \brief start moving all nodes into a new table of newCapacity slots
+   */
+  void
+  openResize(size_t newCapacity);
+
+  /** \brief move up to nSlots slots of the old table into the new one
+   */
+  void
+  openMigrate(size_t nSlots);
+
+  /** \brief start a resize if the table is too full or too empty
+   */
+  void
+  openCheckLoad();
+
 private:
   std::vector<Node*> m_buckets;
   Options m_options;
   size_t m_size;
   size_t m_expandThreshold;
   size_t m_shrinkThreshold;
+  shared_ptr<MemoryPool> m_pool;
+
+  OpenTable m_table;
+  OpenTable m_oldTable; ///< table being migrated into m_table, empty unless resizing
+  size_t m_migrateNext = 0; ///< next slot of m_oldTable to migrate
 };
 
 } // namespace name_tree
@@ -40,6 +40,11 @@ NameTree::NameTree(size_t nBuckets)
 {
 }
 
+NameTree::NameTree(const HashtableOptions& options)
+  : m_ht(options)
+{
+}
+
 Entry&
 NameTree::lookup(const Name& name, size_t prefixLen)
 {
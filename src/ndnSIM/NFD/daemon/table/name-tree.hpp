@@ -39,6 +39,9 @@ public:
   explicit
   NameTree(size_t nBuckets = 1024);
 
+  explicit
+  NameTree(const HashtableOptions& options);
+
 public: // information
   /** \brief Maximum depth of the name tree
    *
@@ -69,6 +72,14 @@ public: // information
     return m_ht.getNBuckets();
   }
 
+  /** \return the pool from which name tree nodes, including their entries, are allocated
+   */
+  const MemoryPool&
+  getMemoryPool() const
+  {
+    return m_ht.getMemoryPool();
+  }
+
   /** \return name tree entry on which a table entry is attached,
    *          or nullptr if the table entry is detached
    */
@@ -63,8 +63,7 @@ Entry::insertOrUpdateInRecord(Face& face, const Interest& interest)
   auto it = std::find_if(m_inRecords.begin(), m_inRecords.end(),
     [&face] (const InRecord& inRecord) { return &inRecord.getFace() == &face; });
   if (it == m_inRecords.end()) {
-    m_inRecords.emplace_front(face);
-    it = m_inRecords.begin();
+    it = m_inRecords.emplace(m_inRecords.begin(), face);
   }
 
   it->update(interest);
@@ -102,8 +101,7 @@ Entry::insertOrUpdateOutRecord(Face& face, const Interest& interest)
   auto it = std::find_if(m_outRecords.begin(), m_outRecords.end(),
     [&face] (const OutRecord& outRecord) { return &outRecord.getFace() == &face; });
   if (it == m_outRecords.end()) {
-    m_outRecords.emplace_front(face);
-    it = m_outRecords.begin();
+    it = m_outRecords.emplace(m_outRecords.begin(), face);
   }
 
   it->update(interest);
@@ -29,7 +29,7 @@
 #include "pit-in-record.hpp"
 #include "pit-out-record.hpp"
 
-#include <list>
+#include <boost/container/small_vector.hpp>
 
 namespace nfd {
 
@@ -40,12 +40,22 @@ class Entry;
 namespace pit {
 
 /** \brief An unordered collection of in-records
+ *
+ *  Up to IN_RECORDS_INLINE in-records are stored inside the PIT entry without further allocation.
+ *  Inserting or deleting an in-record invalidates iterators and pointers to other in-records
+ *  of the same entry; forwarding pipelines and strategies must not hold them across such calls.
  */
-typedef std::list<InRecord> InRecordCollection;
+const size_t IN_RECORDS_INLINE = 1;
+typedef boost::container::small_vector<InRecord, IN_RECORDS_INLINE> InRecordCollection;
 
 /** \brief An unordered collection of out-records
+ *
+ *  Up to OUT_RECORDS_INLINE out-records are stored inside the PIT entry without further allocation.
+ *  Inserting or deleting an out-record invalidates iterators and pointers to other out-records
+ *  of the same entry; forwarding pipelines and strategies must not hold them across such calls.
  */
-typedef std::list<OutRecord> OutRecordCollection;
+const size_t OUT_RECORDS_INLINE = 2;
+typedef boost::container::small_vector<OutRecord, OUT_RECORDS_INLINE> OutRecordCollection;
 
 /** \brief An Interest table entry
  *
@@ -76,7 +76,8 @@ Pit::findOrInsert(const Interest& interest, bool allowInsert)
     return {nullptr, true};
   }
 
-  auto entry = make_shared<Entry>(interest);
+  // the allocator is kept with the entry, so the pool outlives entries still referenced elsewhere
+  auto entry = std::allocate_shared<Entry>(PoolAllocator<Entry>(m_pool), interest);
   nte->insertPitEntry(entry);
   ++m_nItems;
   return {entry, true};
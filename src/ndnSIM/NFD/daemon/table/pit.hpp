@@ -58,6 +58,14 @@ public:
     return m_nItems;
   }
 
+  /** \return the pool from which PIT entries are allocated
+   */
+  const MemoryPool&
+  getMemoryPool() const
+  {
+    return *m_pool;
+  }
+
   /** \brief Finds a PIT entry for \p interest
    *  \param interest the Interest
    *  \return an existing entry with same Name and Selectors; otherwise nullptr
@@ -136,6 +144,7 @@ private:
 private:
   NameTree& m_nameTree;
   size_t m_nItems = 0;
+  shared_ptr<MemoryPool> m_pool = make_shared<MemoryPool>();
 };
 
 } // namespace pit
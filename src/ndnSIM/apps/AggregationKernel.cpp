@@ -0,0 +1,327 @@
+#include "AggregationKernel.hpp"
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AGGREGATION_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+    // Function table of one instruction set
+    struct KernelTable {
+        void (*add)(float* acc, const float* in, size_t n);
+        void (*axpy)(float* acc, const float* in, float weight, size_t n);
+        void (*scale)(float* out, const float* in, float factor, size_t n);
+    };
+
+
+
+    /**
+     * Portable implementation, also used to process the tail of vectorized loops
+     */
+    void AddScalar(float* acc, const float* in, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            acc[i] += in[i];
+        }
+    }
+
+    void AxpyScalar(float* acc, const float* in, float weight, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            acc[i] += weight * in[i];
+        }
+    }
+
+    void ScaleScalar(float* out, const float* in, float factor, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = in[i] * factor;
+        }
+    }
+
+    const KernelTable kScalarTable = {AddScalar, AxpyScalar, ScaleScalar};
+
+
+
+#ifdef AGGREGATION_KERNEL_X86
+    /**
+     * SSE, 4 floats per iteration
+     */
+    __attribute__((target("sse2")))
+    void AddSSE(float* acc, const float* in, size_t n) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_loadu_ps(in + i)));
+        }
+        AddScalar(acc + i, in + i, n - i);
+    }
+
+    __attribute__((target("sse2")))
+    void AxpySSE(float* acc, const float* in, float weight, size_t n) {
+        const __m128 w = _mm_set1_ps(weight);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(w, _mm_loadu_ps(in + i))));
+        }
+        AxpyScalar(acc + i, in + i, weight, n - i);
+    }
+
+    __attribute__((target("sse2")))
+    void ScaleSSE(float* out, const float* in, float factor, size_t n) {
+        const __m128 f = _mm_set1_ps(factor);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), f));
+        }
+        ScaleScalar(out + i, in + i, factor, n - i);
+    }
+
+    const KernelTable kSSETable = {AddSSE, AxpySSE, ScaleSSE};
+
+
+
+    /**
+     * AVX2, 8 floats per iteration, loop unrolled twice to hide add latency
+     */
+    __attribute__((target("avx2")))
+    void AddAVX2(float* acc, const float* in, size_t n) {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m256 a0 = _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_loadu_ps(in + i));
+            __m256 a1 = _mm256_add_ps(_mm256_loadu_ps(acc + i + 8), _mm256_loadu_ps(in + i + 8));
+            _mm256_storeu_ps(acc + i, a0);
+            _mm256_storeu_ps(acc + i + 8, a1);
+        }
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_loadu_ps(in + i)));
+        }
+        AddScalar(acc + i, in + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    void AxpyAVX2(float* acc, const float* in, float weight, size_t n) {
+        const __m256 w = _mm256_set1_ps(weight);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(w, _mm256_loadu_ps(in + i))));
+        }
+        AxpyScalar(acc + i, in + i, weight, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    void ScaleAVX2(float* out, const float* in, float factor, size_t n) {
+        const __m256 f = _mm256_set1_ps(factor);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(in + i), f));
+        }
+        ScaleScalar(out + i, in + i, factor, n - i);
+    }
+
+    const KernelTable kAVX2Table = {AddAVX2, AxpyAVX2, ScaleAVX2};
+
+
+
+    /**
+     * AVX-512, 16 floats per iteration, the tail is handled with a masked load/store
+     */
+    __attribute__((target("avx512f")))
+    void AddAVX512(float* acc, const float* in, size_t n) {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_ps(acc + i, _mm512_add_ps(_mm512_loadu_ps(acc + i), _mm512_loadu_ps(in + i)));
+        }
+        if (i < n) {
+            __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+            __m512 a = _mm512_maskz_loadu_ps(mask, acc + i);
+            __m512 b = _mm512_maskz_loadu_ps(mask, in + i);
+            _mm512_mask_storeu_ps(acc + i, mask, _mm512_add_ps(a, b));
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    void AxpyAVX512(float* acc, const float* in, float weight, size_t n) {
+        const __m512 w = _mm512_set1_ps(weight);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_ps(acc + i, _mm512_add_ps(_mm512_loadu_ps(acc + i), _mm512_mul_ps(w, _mm512_loadu_ps(in + i))));
+        }
+        if (i < n) {
+            __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+            __m512 a = _mm512_maskz_loadu_ps(mask, acc + i);
+            __m512 b = _mm512_maskz_loadu_ps(mask, in + i);
+            _mm512_mask_storeu_ps(acc + i, mask, _mm512_add_ps(a, _mm512_mul_ps(w, b)));
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    void ScaleAVX512(float* out, const float* in, float factor, size_t n) {
+        const __m512 f = _mm512_set1_ps(factor);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_loadu_ps(in + i), f));
+        }
+        if (i < n) {
+            __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+            _mm512_mask_storeu_ps(out + i, mask, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, in + i), f));
+        }
+    }
+
+    const KernelTable kAVX512Table = {AddAVX512, AxpyAVX512, ScaleAVX512};
+#endif
+
+
+
+    /**
+     * Whether the running CPU is able to execute the given instruction set
+     * @param isa
+     * @return True if supported
+     */
+    bool IsSupported(AggregationKernel::Isa isa) {
+#ifdef AGGREGATION_KERNEL_X86
+        __builtin_cpu_init();
+        switch (isa) {
+            case AggregationKernel::Isa::kAVX512:
+                return __builtin_cpu_supports("avx512f");
+            case AggregationKernel::Isa::kAVX2:
+                return __builtin_cpu_supports("avx2");
+            case AggregationKernel::Isa::kSSE:
+                return __builtin_cpu_supports("sse2");
+            case AggregationKernel::Isa::kScalar:
+                return true;
+        }
+        return false;
+#else
+        return isa == AggregationKernel::Isa::kScalar;
+#endif
+    }
+
+
+
+    AggregationKernel::Isa DetectIsa() {
+        for (auto isa : {AggregationKernel::Isa::kAVX512, AggregationKernel::Isa::kAVX2, AggregationKernel::Isa::kSSE}) {
+            if (IsSupported(isa)) {
+                return isa;
+            }
+        }
+        return AggregationKernel::Isa::kScalar;
+    }
+
+
+
+    const KernelTable& GetTable(AggregationKernel::Isa isa) {
+        switch (isa) {
+#ifdef AGGREGATION_KERNEL_X86
+            case AggregationKernel::Isa::kAVX512:
+                return kAVX512Table;
+            case AggregationKernel::Isa::kAVX2:
+                return kAVX2Table;
+            case AggregationKernel::Isa::kSSE:
+                return kSSETable;
+#endif
+            default:
+                return kScalarTable;
+        }
+    }
+
+
+
+    // Selected implementation, detected on first use
+    struct Dispatcher {
+        Dispatcher()
+            : isa(DetectIsa())
+            , table(&GetTable(isa))
+        {}
+
+        AggregationKernel::Isa isa;
+        const KernelTable* table;
+    };
+
+    Dispatcher& GetDispatcher() {
+        static Dispatcher dispatcher;
+        return dispatcher;
+    }
+
+} // namespace
+
+
+
+AggregationKernel::Isa AggregationKernel::GetIsa() {
+    return GetDispatcher().isa;
+}
+
+
+
+std::string AggregationKernel::GetIsaName(Isa isa) {
+    switch (isa) {
+        case Isa::kAVX512:
+            return "avx512";
+        case Isa::kAVX2:
+            return "avx2";
+        case Isa::kSSE:
+            return "sse";
+        case Isa::kScalar:
+            return "scalar";
+    }
+    return "unknown";
+}
+
+
+
+void AggregationKernel::SetIsa(Isa isa) {
+    if (!IsSupported(isa)) {
+        isa = Isa::kScalar;
+    }
+    GetDispatcher().isa = isa;
+    GetDispatcher().table = &GetTable(isa);
+}
+
+
+
+/**
+ * Element-wise sum, used to add one incoming model into the aggregation buffer
+ * @param acc Aggregation buffer, updated in place
+ * @param in Incoming model parameters
+ */
+void AggregationKernel::Sum(ndn::span<float> acc, ndn::span<const float> in) {
+    size_t n = std::min(acc.size(), in.size());
+    GetDispatcher().table->add(acc.data(), in.data(), n);
+}
+
+
+
+/**
+ * Element-wise weighted sum
+ * @param acc Aggregation buffer, updated in place
+ * @param in Incoming model parameters
+ * @param weight Weight of incoming model, e.g. number of samples behind it
+ */
+void AggregationKernel::WeightedSum(ndn::span<float> acc, ndn::span<const float> in, float weight) {
+    size_t n = std::min(acc.size(), in.size());
+    GetDispatcher().table->axpy(acc.data(), in.data(), weight, n);
+}
+
+
+
+/**
+ * Mean average of aggregated parameters, out and sum may refer to the same buffer
+ * @param out Output
+ * @param sum Aggregated parameters
+ * @param count Number of models inside sum
+ */
+void AggregationKernel::Mean(ndn::span<float> out, ndn::span<const float> sum, float count) {
+    size_t n = std::min(out.size(), sum.size());
+    GetDispatcher().table->scale(out.data(), sum.data(), 1.0f / count, n);
+}
+
+
+
+/**
+ * Weighted mean average of aggregated parameters, out and sum may refer to the same buffer
+ * @param out Output
+ * @param sum Aggregated parameters (produced by WeightedSum)
+ * @param totalWeight Sum of all weights
+ */
+void AggregationKernel::WeightedMean(ndn::span<float> out, ndn::span<const float> sum, float totalWeight) {
+    Mean(out, sum, totalWeight);
+}
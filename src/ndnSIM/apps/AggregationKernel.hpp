@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ndn-cxx/util/span.hpp>
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Vectorized arithmetic used when aggregating model parameters (ModelData::parameters).
+ * The best instruction set supported by the running CPU (AVX-512, AVX2, SSE) is chosen once at runtime,
+ * a portable scalar implementation is used everywhere else.
+ */
+namespace AggregationKernel {
+
+    enum class Isa {
+        kScalar,
+        kSSE,
+        kAVX2,
+        kAVX512
+    };
+
+    // Instruction set used by all kernels below
+    Isa GetIsa();
+
+    std::string GetIsaName(Isa isa);
+
+    // Force a specific implementation, mainly for testing/benchmark; falls back to scalar if unsupported by CPU
+    void SetIsa(Isa isa);
+
+    // acc[i] += in[i]
+    void Sum(ndn::span<float> acc, ndn::span<const float> in);
+
+    // acc[i] += weight * in[i]
+    void WeightedSum(ndn::span<float> acc, ndn::span<const float> in, float weight);
+
+    // out[i] = sum[i] / count
+    void Mean(ndn::span<float> out, ndn::span<const float> sum, float count);
+
+    // out[i] = sum[i] / totalWeight, where sum is produced by WeightedSum()
+    void WeightedMean(ndn::span<float> out, ndn::span<const float> sum, float totalWeight);
+
+};
@@ -0,0 +1,382 @@
+#include "LogSink.hpp"
+
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+    const char BINARY_MAGIC[4] = {'C', 'F', 'N', 'L'};
+    const uint8_t BINARY_VERSION = 1;
+
+
+
+    void AppendBytes(std::string& blob, const void* data, size_t size) {
+        blob.append(reinterpret_cast<const char*>(data), size);
+    }
+
+
+
+    /**
+     * Binary log files use ".bin" instead of ".txt"
+     * @param path Text log path
+     * @return Binary log path
+     */
+    std::string BinaryPath(const std::string& path) {
+        const std::string ext = ".txt";
+        if (path.size() >= ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0) {
+            return path.substr(0, path.size() - ext.size()) + ".bin";
+        }
+        return path + ".bin";
+    }
+
+} // namespace
+
+
+
+LogSink& LogSink::Get() {
+    static LogSink sink;
+    return sink;
+}
+
+
+
+LogSink::~LogSink() {
+    Close();
+    StopWriter();
+}
+
+
+
+void LogSink::SetFormat(Format format) {
+    m_format = format;
+}
+
+
+
+LogSink::Format LogSink::GetFormat() const {
+    return m_format;
+}
+
+
+
+/**
+ * Set how many bytes a channel buffers before writing them out
+ * @param bytes
+ */
+void LogSink::SetBufferSize(size_t bytes) {
+    m_bufferSize = bytes;
+}
+
+
+
+/**
+ * Enable/disable background writer thread
+ * @param async
+ */
+void LogSink::SetAsync(bool async) {
+    if (async == m_async) {
+        return;
+    }
+    if (async) {
+        m_stop = false;
+        m_writer = std::thread(&LogSink::WriterLoop, this);
+    } else {
+        Flush();
+        StopWriter();
+    }
+    m_async = async;
+}
+
+
+
+/**
+ * Register a log file, the file is truncated on the first registration; registering the same path again returns the same channel
+ * @param path Log file path (text format)
+ * @param columns Column names, only stored in binary format
+ * @return Channel handle
+ */
+LogSink::Channel LogSink::Register(const std::string& path, const std::vector<std::string>& columns) {
+    auto it = m_channelByPath.find(path);
+    if (it != m_channelByPath.end()) {
+        return it->second;
+    }
+
+    // Make sure all logs are written out when the simulation is destroyed
+    if (!m_destroyScheduled) {
+        ns3::Simulator::ScheduleDestroy(&LogSink::Close, this);
+        m_destroyScheduled = true;
+    }
+
+    Channel channel = static_cast<Channel>(m_channels.size());
+    m_channels.emplace_back();
+    ChannelState& state = m_channels.back();
+    state.format = m_format;
+    state.path = (m_format == Format::kBinary) ? BinaryPath(path) : path;
+    state.file = std::fopen(state.path.c_str(), m_format == Format::kBinary ? "wb" : "w");
+    if (state.file == nullptr) {
+        std::cerr << "Failed to open the file: " << state.path << std::endl;
+    } else if (m_format == Format::kBinary) {
+        std::string header;
+        uint8_t version[4] = {BINARY_VERSION, 0, 0, 0};
+        uint32_t columnCount = static_cast<uint32_t>(columns.size());
+        AppendBytes(header, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        AppendBytes(header, version, sizeof(version));
+        AppendBytes(header, &columnCount, sizeof(uint32_t));
+        for (const auto& column : columns) {
+            uint32_t length = static_cast<uint32_t>(column.size());
+            AppendBytes(header, &length, sizeof(uint32_t));
+            header += column;
+        }
+        Submit(state.file, std::move(header));
+    }
+
+    m_channelByPath[path] = channel;
+    return channel;
+}
+
+
+
+/**
+ * @param channel
+ * @return State of given channel, or nullptr if the handle is invalid or the channel has been closed
+ */
+LogSink::ChannelState* LogSink::GetOpenChannel(Channel channel) {
+    if (channel >= m_channels.size() || m_channels[channel].closed) {
+        return nullptr;
+    }
+    return &m_channels[channel];
+}
+
+
+
+void LogSink::AppendInteger(Channel channel, int64_t value) {
+    ChannelState* channelState = GetOpenChannel(channel);
+    if (channelState == nullptr) {
+        return;
+    }
+    ChannelState& state = *channelState;
+    if (state.format == Format::kBinary) {
+        state.values.push_back(static_cast<double>(value));
+        return;
+    }
+
+    char field[24];
+    int length = std::snprintf(field, sizeof(field), "%" PRId64, value);
+    if (state.fieldWritten) {
+        state.text += ' ';
+    }
+    state.text.append(field, length);
+    state.fieldWritten = true;
+}
+
+
+
+void LogSink::AppendDouble(Channel channel, double value) {
+    ChannelState* channelState = GetOpenChannel(channel);
+    if (channelState == nullptr) {
+        return;
+    }
+    ChannelState& state = *channelState;
+    if (state.format == Format::kBinary) {
+        state.values.push_back(value);
+        return;
+    }
+
+    // Same representation as the default formatting of std::ostream
+    char field[32];
+    int length = std::snprintf(field, sizeof(field), "%g", value);
+    if (state.fieldWritten) {
+        state.text += ' ';
+    }
+    state.text.append(field, length);
+    state.fieldWritten = true;
+}
+
+
+
+/**
+ * Finish current record of given channel, the buffer is written out once it's large enough
+ * @param channel
+ */
+void LogSink::EndRecord(Channel channel) {
+    ChannelState* channelState = GetOpenChannel(channel);
+    if (channelState == nullptr) {
+        return;
+    }
+    ChannelState& state = *channelState;
+    if (state.format == Format::kBinary) {
+        state.rowEnds.push_back(state.values.size());
+    } else {
+        state.text += '\n';
+        state.fieldWritten = false;
+    }
+
+    if (BufferedBytes(state) >= m_bufferSize) {
+        FlushChannel(state);
+    }
+}
+
+
+
+size_t LogSink::BufferedBytes(const ChannelState& state) const {
+    return state.text.size() + state.values.size() * sizeof(double);
+}
+
+
+
+/**
+ * Encode buffered records and hand them to the writer
+ * @param state
+ */
+void LogSink::FlushChannel(ChannelState& state) {
+    if (state.file == nullptr) {
+        state.text.clear();
+        state.values.clear();
+        state.rowEnds.clear();
+        return;
+    }
+
+    if (state.format == Format::kText) {
+        if (!state.text.empty()) {
+            Submit(state.file, std::move(state.text));
+            state.text.clear();
+        }
+        return;
+    }
+
+    if (state.rowEnds.empty()) {
+        return;
+    }
+
+    // Transpose finished rows into one columnar block, values of an unfinished row are kept
+    uint32_t rows = static_cast<uint32_t>(state.rowEnds.size());
+    uint32_t columns = 0;
+    size_t begin = 0;
+    for (size_t end : state.rowEnds) {
+        columns = std::max<uint32_t>(columns, static_cast<uint32_t>(end - begin));
+        begin = end;
+    }
+
+    std::string blob;
+    blob.reserve(2 * sizeof(uint32_t) + static_cast<size_t>(rows) * columns * sizeof(double));
+    AppendBytes(blob, &rows, sizeof(uint32_t));
+    AppendBytes(blob, &columns, sizeof(uint32_t));
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    for (uint32_t column = 0; column < columns; ++column) {
+        begin = 0;
+        for (size_t end : state.rowEnds) {
+            const double& value = (begin + column < end) ? state.values[begin + column] : missing;
+            AppendBytes(blob, &value, sizeof(double));
+            begin = end;
+        }
+    }
+    Submit(state.file, std::move(blob));
+
+    size_t finished = state.rowEnds.back();
+    state.values.erase(state.values.begin(), state.values.begin() + finished);
+    state.rowEnds.clear();
+}
+
+
+
+/**
+ * Write a block into file, either directly or through the background writer
+ * @param file
+ * @param blob
+ */
+void LogSink::Submit(FILE* file, std::string&& blob) {
+    if (!m_async) {
+        std::fwrite(blob.data(), 1, blob.size(), file);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.emplace_back(file, std::move(blob));
+    }
+    m_hasWork.notify_one();
+}
+
+
+
+void LogSink::WriterLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_hasWork.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty()) {
+            return; // stopped and drained
+        }
+
+        auto item = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_writing = true;
+        lock.unlock();
+        std::fwrite(item.second.data(), 1, item.second.size(), item.first);
+        lock.lock();
+        m_writing = false;
+        if (m_queue.empty()) {
+            m_idle.notify_all();
+        }
+    }
+}
+
+
+
+void LogSink::StopWriter() {
+    if (!m_writer.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_hasWork.notify_one();
+    m_writer.join();
+}
+
+
+
+/**
+ * Write out all buffered records and wait until they reach the files
+ */
+void LogSink::Flush() {
+    for (auto& state : m_channels) {
+        FlushChannel(state);
+    }
+
+    if (m_async) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_queue.empty() && !m_writing; });
+    }
+
+    for (auto& state : m_channels) {
+        if (state.file != nullptr) {
+            std::fflush(state.file);
+        }
+    }
+}
+
+
+
+/**
+ * Flush and close all files, writes through handles registered before are ignored from now on,
+ * channels registered later start with new files and new handles
+ */
+void LogSink::Close() {
+    Flush();
+    for (auto& state : m_channels) {
+        if (state.file != nullptr) {
+            std::fclose(state.file);
+        }
+        // Keep the slot, only release its buffers
+        state = ChannelState();
+        state.closed = true;
+    }
+    m_channelByPath.clear();
+    m_destroyScheduled = false;
+}
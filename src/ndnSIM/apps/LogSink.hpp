@@ -0,0 +1,138 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Process-wide sink for the log files of CFNAgg apps (RTO, window, RTT, aggregation time, throughput).
+ *
+ * Apps register each log file once and get a channel handle, records are then buffered in memory and
+ * written out in large blocks, optionally by a background thread. Files stay open until Close(), which is
+ * also scheduled at Simulator::Destroy().
+ *
+ * Two formats are supported:
+ *  - Text: space separated fields, one record per line (the original log format)
+ *  - Binary: columnar blocks, written into "<name>.bin" instead of "<name>.txt"
+ *
+ *      file   := "CFNL" uint8 version(1) uint8[3] reserved
+ *                uint32 number of column names, { uint32 length, char[length] } column names
+ *                block*
+ *      block  := uint32 rows, uint32 columns, float64[columns][rows] (column-major, short rows padded with NaN)
+ */
+class LogSink {
+public:
+    enum class Format {
+        kText,
+        kBinary
+    };
+
+    typedef uint32_t Channel;
+
+    static const Channel INVALID_CHANNEL = UINT32_MAX; // writes to it are ignored
+
+    static LogSink& Get();
+
+    ~LogSink();
+
+    // Configuration, format only affects channels registered afterwards
+    void SetFormat(Format format);
+
+    Format GetFormat() const;
+
+    void SetBufferSize(size_t bytes);
+
+    void SetAsync(bool async);
+
+    Channel Register(const std::string& path, const std::vector<std::string>& columns = {});
+
+    /**
+     * Append one field to the current record of given channel
+     * @param channel
+     * @param value Integral (including bool) or floating point value
+     */
+    template<typename T>
+    void Append(Channel channel, T value)
+    {
+        if constexpr (std::is_floating_point<T>::value) {
+            AppendDouble(channel, static_cast<double>(value));
+        } else {
+            AppendInteger(channel, static_cast<int64_t>(value));
+        }
+    }
+
+    void EndRecord(Channel channel);
+
+    /**
+     * Write one complete record
+     * @param channel
+     * @param values
+     */
+    template<typename... Args>
+    void Write(Channel channel, Args... values)
+    {
+        (Append(channel, values), ...);
+        EndRecord(channel);
+    }
+
+    void Flush();
+
+    void Close();
+
+private:
+    LogSink() = default;
+
+    struct ChannelState {
+        std::string path;
+        FILE* file = nullptr;
+        Format format = Format::kText;
+        bool fieldWritten = false; // whether current text record has any field
+        bool closed = false; // set by Close(), the slot is never reused so stale handles can't reach a newer channel
+
+        std::string text; // text buffer
+        std::vector<double> values; // binary buffer, row-major
+        std::vector<size_t> rowEnds; // end of each finished row inside "values"
+    };
+
+    ChannelState* GetOpenChannel(Channel channel);
+
+    void AppendInteger(Channel channel, int64_t value);
+
+    void AppendDouble(Channel channel, double value);
+
+    size_t BufferedBytes(const ChannelState& state) const;
+
+    void FlushChannel(ChannelState& state);
+
+    void Submit(FILE* file, std::string&& blob);
+
+    void WriterLoop();
+
+    void StopWriter();
+
+private:
+    Format m_format = Format::kText;
+    size_t m_bufferSize = 1 << 20;
+    bool m_async = false;
+    bool m_destroyScheduled = false;
+
+    std::vector<ChannelState> m_channels;
+    std::map<std::string, Channel> m_channelByPath;
+
+    // Background writer
+    std::thread m_writer;
+    std::mutex m_mutex;
+    std::condition_variable m_hasWork;
+    std::condition_variable m_idle;
+    std::deque<std::pair<FILE*, std::string>> m_queue;
+    bool m_writing = false;
+    bool m_stop = false;
+};
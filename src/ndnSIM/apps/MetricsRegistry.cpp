@@ -0,0 +1,402 @@
+#include "MetricsRegistry.hpp"
+
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+    const char BINARY_MAGIC[4] = {'C', 'F', 'N', 'M'};
+    const uint8_t BINARY_VERSION = 1;
+
+    const char* TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+
+
+
+    void AppendBytes(std::string& blob, const void* data, size_t size) {
+        blob.append(reinterpret_cast<const char*>(data), size);
+    }
+
+
+
+    void AppendString(std::string& blob, const std::string& value) {
+        uint32_t length = static_cast<uint32_t>(value.size());
+        AppendBytes(blob, &length, sizeof(uint32_t));
+        blob += value;
+    }
+
+
+
+    bool WriteFile(const std::string& path, const std::string& blob, const char* mode) {
+        FILE* file = std::fopen(path.c_str(), mode);
+        if (file == nullptr) {
+            std::cerr << "Failed to open the file: " << path << std::endl;
+            return false;
+        }
+        bool written = std::fwrite(blob.data(), 1, blob.size(), file) == blob.size();
+        return std::fclose(file) == 0 && written;
+    }
+
+} // namespace
+
+
+
+void LatencyHistogram::record(int64_t value) {
+    value = std::max<int64_t>(value, 0);
+    size_t index = bucketIndex(value);
+    if (index >= m_buckets.size()) {
+        m_buckets.resize(index + 1, 0);
+    }
+    ++m_buckets[index];
+
+    if (m_count == 0 || value < m_min) {
+        m_min = value;
+    }
+    if (m_count == 0 || value > m_max) {
+        m_max = value;
+    }
+    ++m_count;
+    m_sum += value;
+}
+
+
+
+double LatencyHistogram::percentile(double q) const {
+    if (m_count == 0) {
+        return 0.0;
+    }
+    q = std::min(std::max(q, 0.0), 1.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * m_count)));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < m_buckets.size(); ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            double middle = (bucketLowest(i) + bucketHighest(i)) / 2.0;
+            return std::min(std::max(middle, static_cast<double>(m_min)), static_cast<double>(m_max));
+        }
+    }
+    return static_cast<double>(m_max);
+}
+
+
+
+void LatencyHistogram::clear() {
+    m_buckets.clear();
+    m_count = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+
+
+/**
+ * Bucket of a value, values below 2 * SUB_BUCKETS have a bucket each, above that the bucket width doubles
+ * every SUB_BUCKETS buckets
+ * @param value Non-negative value
+ * @return Bucket index
+ */
+size_t LatencyHistogram::bucketIndex(int64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+        return static_cast<size_t>(std::max<int64_t>(value, 0));
+    }
+    int msb = 63 - __builtin_clzll(static_cast<uint64_t>(value));
+    int shift = msb - SUB_BUCKET_BITS;
+    return static_cast<size_t>(shift * SUB_BUCKETS + (value >> shift));
+}
+
+
+
+int64_t LatencyHistogram::bucketLowest(size_t index) {
+    if (static_cast<int64_t>(index) < 2 * SUB_BUCKETS) {
+        return static_cast<int64_t>(index);
+    }
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    return (static_cast<int64_t>(index % SUB_BUCKETS) + SUB_BUCKETS) << shift;
+}
+
+
+
+int64_t LatencyHistogram::bucketHighest(size_t index) {
+    if (static_cast<int64_t>(index) < 2 * SUB_BUCKETS) {
+        return static_cast<int64_t>(index);
+    }
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    return bucketLowest(index) + (int64_t(1) << shift) - 1;
+}
+
+
+
+MetricsRegistry& MetricsRegistry::Get() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+
+
+void MetricsRegistry::SetEnabled(bool enabled) {
+    m_enabled = enabled;
+}
+
+
+
+bool MetricsRegistry::IsEnabled() const {
+    return m_enabled;
+}
+
+
+
+void MetricsRegistry::SetFormat(Format format) {
+    m_format = format;
+}
+
+
+
+void MetricsRegistry::SetOutputDirectory(const std::string& directory) {
+    m_directory = directory;
+}
+
+
+
+/**
+ * Set how often counters and gauges are sampled in simulation time, 0 disables sampling
+ * @param period
+ */
+void MetricsRegistry::SetSamplePeriod(ns3::Time period) {
+    m_samplePeriod = period;
+}
+
+
+
+MetricsRegistry::Id MetricsRegistry::Register(Type type, const std::string& node, const std::string& job, const std::string& name) {
+    if (!m_enabled) {
+        return INVALID_ID;
+    }
+
+    auto key = std::make_tuple(node, job, name);
+    auto it = m_idByKey.find(key);
+    if (it != m_idByKey.end()) {
+        return it->second;
+    }
+
+    // Make sure all metrics are exported when the simulation is destroyed
+    if (!m_destroyScheduled) {
+        ns3::Simulator::ScheduleDestroy(&MetricsRegistry::Close, this);
+        m_destroyScheduled = true;
+    }
+    ScheduleSample();
+
+    Id id = static_cast<Id>(m_metrics.size());
+    m_metrics.emplace_back();
+    Metric& metric = m_metrics.back();
+    metric.type = type;
+    metric.node = node;
+    metric.job = job;
+    metric.name = name;
+    m_idByKey[key] = id;
+    return id;
+}
+
+
+
+void MetricsRegistry::Increment(Id id, int64_t delta) {
+    if (id >= m_metrics.size()) {
+        return; // disabled or closed
+    }
+    m_metrics[id].value += delta;
+    ++m_metrics[id].updates;
+}
+
+
+
+void MetricsRegistry::Set(Id id, double value) {
+    if (id >= m_metrics.size()) {
+        return;
+    }
+    m_metrics[id].value = value;
+    ++m_metrics[id].updates;
+}
+
+
+
+void MetricsRegistry::Record(Id id, int64_t value) {
+    if (id >= m_metrics.size()) {
+        return;
+    }
+    m_metrics[id].histogram.record(value);
+    ++m_metrics[id].updates;
+}
+
+
+
+double MetricsRegistry::GetValue(Id id) const {
+    return id < m_metrics.size() ? m_metrics[id].value : 0.0;
+}
+
+
+
+const LatencyHistogram* MetricsRegistry::GetHistogram(Id id) const {
+    return id < m_metrics.size() ? &m_metrics[id].histogram : nullptr;
+}
+
+
+
+MetricsRegistry::Id MetricsRegistry::Find(const std::string& node, const std::string& job, const std::string& name) const {
+    auto it = m_idByKey.find(std::make_tuple(node, job, name));
+    return it == m_idByKey.end() ? INVALID_ID : it->second;
+}
+
+
+
+size_t MetricsRegistry::GetSampleCount() const {
+    return m_samples.size();
+}
+
+
+
+/**
+ * Append the value of every counter and gauge updated since the last sample to the time series
+ */
+void MetricsRegistry::Sample() {
+    double now = ns3::Simulator::Now().GetMilliSeconds();
+    for (Id id = 0; id < m_metrics.size(); ++id) {
+        Metric& metric = m_metrics[id];
+        if (metric.type == Type::kHistogram || metric.updates == metric.sampledUpdates) {
+            continue;
+        }
+        m_samples.push_back({now, id, metric.value});
+        metric.sampledUpdates = metric.updates;
+    }
+    ScheduleSample();
+}
+
+
+
+void MetricsRegistry::ScheduleSample() {
+    if (m_samplePeriod.IsStrictlyPositive() && !m_sampleEvent.IsRunning()) {
+        m_sampleEvent = ns3::Simulator::Schedule(m_samplePeriod, &MetricsRegistry::Sample, this);
+    }
+}
+
+
+
+/**
+ * Write all metrics into the output directory in the configured format
+ * @return False if a file couldn't be written
+ */
+bool MetricsRegistry::Export() const {
+    if (m_metrics.empty()) {
+        return true;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    return m_format == Format::kBinary ? ExportBinary() : ExportCsv();
+}
+
+
+
+bool MetricsRegistry::ExportCsv() const {
+    std::string summary = "node,job,metric,type,count,value,min,max,p50,p90,p99\n";
+    char line[256];
+    for (const auto& metric : m_metrics) {
+        summary += metric.node + "," + metric.job + "," + metric.name + "," + TYPE_NAMES[static_cast<int>(metric.type)] + ",";
+        if (metric.type == Type::kHistogram) {
+            const LatencyHistogram& histogram = metric.histogram;
+            std::snprintf(line, sizeof(line), "%llu,%g,%lld,%lld,%g,%g,%g\n",
+                          static_cast<unsigned long long>(histogram.count()), histogram.mean(),
+                          static_cast<long long>(histogram.min()), static_cast<long long>(histogram.max()),
+                          histogram.percentile(0.5), histogram.percentile(0.9), histogram.percentile(0.99));
+        } else {
+            std::snprintf(line, sizeof(line), "%llu,%g,,,,,\n", static_cast<unsigned long long>(metric.updates), metric.value);
+        }
+        summary += line;
+    }
+
+    std::string samples = "time,node,job,metric,value\n";
+    for (const auto& sample : m_samples) {
+        const Metric& metric = m_metrics[sample.id];
+        std::snprintf(line, sizeof(line), "%g,", sample.time);
+        samples += line;
+        samples += metric.node + "," + metric.job + "," + metric.name;
+        std::snprintf(line, sizeof(line), ",%g\n", sample.value);
+        samples += line;
+    }
+
+    bool summaryWritten = WriteFile(m_directory + "/metrics_summary.csv", summary, "w");
+    bool samplesWritten = WriteFile(m_directory + "/metrics_samples.csv", samples, "w");
+    return summaryWritten && samplesWritten;
+}
+
+
+
+bool MetricsRegistry::ExportBinary() const {
+    std::string blob;
+    uint8_t version[4] = {BINARY_VERSION, 0, 0, 0};
+    AppendBytes(blob, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    AppendBytes(blob, version, sizeof(version));
+
+    uint32_t metricCount = static_cast<uint32_t>(m_metrics.size());
+    AppendBytes(blob, &metricCount, sizeof(uint32_t));
+    for (const auto& metric : m_metrics) {
+        uint8_t type = static_cast<uint8_t>(metric.type);
+        AppendBytes(blob, &type, sizeof(uint8_t));
+        AppendString(blob, metric.node);
+        AppendString(blob, metric.job);
+        AppendString(blob, metric.name);
+
+        const LatencyHistogram& histogram = metric.histogram;
+        bool isHistogram = metric.type == Type::kHistogram;
+        uint64_t count = isHistogram ? histogram.count() : metric.updates;
+        double values[6] = {isHistogram ? histogram.mean() : metric.value,
+                            isHistogram ? static_cast<double>(histogram.min()) : NAN,
+                            isHistogram ? static_cast<double>(histogram.max()) : NAN,
+                            isHistogram ? histogram.percentile(0.5) : NAN,
+                            isHistogram ? histogram.percentile(0.9) : NAN,
+                            isHistogram ? histogram.percentile(0.99) : NAN};
+        AppendBytes(blob, &count, sizeof(uint64_t));
+        AppendBytes(blob, values, sizeof(values));
+    }
+
+    uint32_t sampleCount = static_cast<uint32_t>(m_samples.size());
+    AppendBytes(blob, &sampleCount, sizeof(uint32_t));
+    for (const auto& sample : m_samples) {
+        AppendBytes(blob, &sample.time, sizeof(double));
+        AppendBytes(blob, &sample.id, sizeof(uint32_t));
+        AppendBytes(blob, &sample.value, sizeof(double));
+    }
+
+    return WriteFile(m_directory + "/metrics.bin", blob, "wb");
+}
+
+
+
+/**
+ * Export all metrics and forget them, metrics registered later start a new export
+ */
+void MetricsRegistry::Close() {
+    Export();
+    m_metrics.clear();
+    m_idByKey.clear();
+    m_samples.clear();
+    m_sampleEvent.Cancel();
+    m_destroyScheduled = false;
+}
+
+
+
+void CongestionMetrics::Register(const std::string& node, const std::string& job, const std::string& prefix) {
+    MetricsRegistry& registry = MetricsRegistry::Get();
+    window = registry.Register(MetricsRegistry::Type::kGauge, node, job, prefix + "window");
+    inFlight = registry.Register(MetricsRegistry::Type::kGauge, node, job, prefix + "inFlight");
+    rto = registry.Register(MetricsRegistry::Type::kGauge, node, job, prefix + "RTO");
+    rttMeasurement = registry.Register(MetricsRegistry::Type::kGauge, node, job, prefix + "RTT_measurement");
+    rttThreshold = registry.Register(MetricsRegistry::Type::kGauge, node, job, prefix + "RTT_threshold");
+    timeouts = registry.Register(MetricsRegistry::Type::kCounter, node, job, prefix + "timeouts");
+    rtt = registry.Register(MetricsRegistry::Type::kHistogram, node, job, prefix + "RTT");
+}
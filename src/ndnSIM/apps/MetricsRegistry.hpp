@@ -0,0 +1,213 @@
+#pragma once
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/**
+ * Log-linear histogram of non-negative integer values (e.g. latencies in ms), in the style of HdrHistogram.
+ * Values below 2 * SUB_BUCKETS are counted exactly, larger ones in buckets whose width doubles every
+ * SUB_BUCKETS buckets, so the relative error of a reported value is below 1 / SUB_BUCKETS whatever the range.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 6;
+    static const int64_t SUB_BUCKETS = int64_t(1) << SUB_BUCKET_BITS;
+
+    void record(int64_t value);
+
+    /**
+     * Value at given quantile, i.e. the smallest recorded value v with at least q * count() values <= v
+     * @param q Quantile in [0, 1]
+     * @return Midpoint of the bucket holding it, 0 if nothing has been recorded
+     */
+    double percentile(double q) const;
+
+    uint64_t count() const
+    {
+        return m_count;
+    }
+
+    double mean() const
+    {
+        return m_count == 0 ? 0.0 : static_cast<double>(m_sum) / m_count;
+    }
+
+    int64_t min() const
+    {
+        return m_count == 0 ? 0 : m_min;
+    }
+
+    int64_t max() const
+    {
+        return m_count == 0 ? 0 : m_max;
+    }
+
+    void clear();
+
+    static size_t bucketIndex(int64_t value);
+
+    static int64_t bucketLowest(size_t index);
+
+    static int64_t bucketHighest(size_t index);
+
+private:
+    std::vector<uint64_t> m_buckets;
+    uint64_t m_count = 0;
+    int64_t m_sum = 0;
+    int64_t m_min = 0;
+    int64_t m_max = 0;
+};
+
+
+
+/**
+ * Process-wide registry of typed metrics of CFNAgg apps, counters, gauges and latency histograms,
+ * each one identified by node, job and metric name, e.g. ("agg0", "job0", "rtt").
+ *
+ * Apps update metrics in memory while the simulation runs. Every sample period, the current value of all
+ * counters and gauges is appended to an in-memory time series. When the simulation is destroyed, everything
+ * is exported into the output directory:
+ *  - CSV: "metrics_summary.csv" (one row per metric, with count/mean/min/max/p50/p90/p99 of histograms)
+ *         and "metrics_samples.csv" (time, node, job, metric, value)
+ *  - Binary: "metrics.bin"
+ *
+ *      file    := "CFNM" uint8 version(1) uint8[3] reserved
+ *                 uint32 number of metrics, metric*
+ *                 uint32 number of samples, sample*
+ *      metric  := uint8 type, string node, string job, string name,
+ *                 uint64 count, float64 value (counter/gauge) or mean (histogram),
+ *                 float64 min, max, p50, p90, p99
+ *      sample  := float64 time (ms), uint32 metric index, float64 value
+ *      string  := uint32 length, char[length]
+ *
+ * The registry is disabled by default, registration then returns INVALID_ID and updates are ignored.
+ */
+class MetricsRegistry {
+public:
+    enum class Type : uint8_t {
+        kCounter,
+        kGauge,
+        kHistogram
+    };
+
+    enum class Format {
+        kCsv,
+        kBinary
+    };
+
+    typedef uint32_t Id;
+
+    static constexpr Id INVALID_ID = UINT32_MAX; // updates of it are ignored
+
+    static MetricsRegistry& Get();
+
+    // Configuration, takes effect for metrics registered afterwards
+    void SetEnabled(bool enabled);
+
+    bool IsEnabled() const;
+
+    void SetFormat(Format format);
+
+    void SetOutputDirectory(const std::string& directory);
+
+    void SetSamplePeriod(ns3::Time period);
+
+    /**
+     * Register a metric, registering the same node, job and name again returns the same id
+     * @param type
+     * @param node Node name, e.g. "agg0" or "con0"
+     * @param job Job name
+     * @param name Metric name
+     * @return Metric id, INVALID_ID if the registry is disabled
+     */
+    Id Register(Type type, const std::string& node, const std::string& job, const std::string& name);
+
+    void Increment(Id id, int64_t delta = 1);
+
+    void Set(Id id, double value);
+
+    void Record(Id id, int64_t value);
+
+    // Current value of a counter or gauge
+    double GetValue(Id id) const;
+
+    const LatencyHistogram* GetHistogram(Id id) const;
+
+    Id Find(const std::string& node, const std::string& job, const std::string& name) const;
+
+    size_t GetSampleCount() const;
+
+    void Sample();
+
+    bool Export() const;
+
+    // Export and forget all metrics, scheduled at Simulator::Destroy()
+    void Close();
+
+private:
+    MetricsRegistry() = default;
+
+    struct Metric {
+        Type type;
+        std::string node;
+        std::string job;
+        std::string name;
+        double value = 0; // counter or gauge
+        uint64_t updates = 0;
+        uint64_t sampledUpdates = 0; // "updates" when last sampled, unchanged metrics aren't sampled again
+        LatencyHistogram histogram;
+    };
+
+    struct SamplePoint {
+        double time;
+        Id id;
+        double value;
+    };
+
+    void ScheduleSample();
+
+    bool ExportCsv() const;
+
+    bool ExportBinary() const;
+
+private:
+    bool m_enabled = false;
+    Format m_format = Format::kCsv;
+    std::string m_directory = "src/ndnSIM/results/logs";
+    ns3::Time m_samplePeriod = ns3::MilliSeconds(10);
+    bool m_destroyScheduled = false;
+    ns3::EventId m_sampleEvent;
+
+    std::vector<Metric> m_metrics;
+    std::map<std::tuple<std::string, std::string, std::string>, Id> m_idByKey;
+    std::vector<SamplePoint> m_samples;
+};
+
+
+
+/**
+ * Congestion control metrics of a CFNAgg app, registered per node and job (aggregator) or per round (consumer)
+ */
+struct CongestionMetrics {
+    MetricsRegistry::Id window = MetricsRegistry::INVALID_ID; // gauge
+    MetricsRegistry::Id inFlight = MetricsRegistry::INVALID_ID; // gauge
+    MetricsRegistry::Id rto = MetricsRegistry::INVALID_ID; // gauge, ms
+    MetricsRegistry::Id rttMeasurement = MetricsRegistry::INVALID_ID; // gauge, EWMA of RTT in ms
+    MetricsRegistry::Id rttThreshold = MetricsRegistry::INVALID_ID; // gauge, ms
+    MetricsRegistry::Id timeouts = MetricsRegistry::INVALID_ID; // counter
+    MetricsRegistry::Id rtt = MetricsRegistry::INVALID_ID; // histogram, ms
+
+    /**
+     * Register all metrics
+     * @param node
+     * @param job
+     * @param prefix Prepended to every metric name, e.g. "round1/"
+     */
+    void Register(const std::string& node, const std::string& job, const std::string& prefix = "");
+};
@@ -1,4 +1,5 @@
 #include "ModelData.hpp"
+#include <algorithm>
 #include <cstring>
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -6,9 +7,10 @@
 
 /**
  * Constructor
+ * @param modelSize The number of model parameters
  */
-ModelData::ModelData()
-: parameters(300, 0.0f)
+ModelData::ModelData(size_t modelSize)
+: parameters(modelSize, 0.0f)
 {}
 
 
@@ -19,62 +21,231 @@ ModelData::ModelData()
  * @param buffer ndn::Buffer format (can be considered as the output)
  */
 void serializeModelData(const ModelData& modelData, std::vector<uint8_t>& buffer){
-    // Clear the buffer first
-    buffer.clear();
+    serializeModelData(modelData.parameters, modelData.congestedNodes, buffer, modelData.contributors);
+}
+
 
-    // Transfer ModelData.parameters into bytes first
-    size_t paramSize = modelData.parameters.size() * sizeof(float);
-    buffer.resize(paramSize);
-    std::memcpy(buffer.data(), modelData.parameters.data(), paramSize);
 
+/**
+ * Serialize model parameters and congestion signal directly, pass an ndn::Buffer to avoid further copies
+ * @param parameters Model parameters
+ * @param congestedNodes Congested nodes
+ * @param buffer Output
+ * @param contributors The number of producers summed in "parameters"
+ * @param codec Encoding of the parameters
+ */
+void serializeModelData(ndn::span<const float> parameters, const std::vector<std::string>& congestedNodes, std::vector<uint8_t>& buffer,
+                        uint32_t contributors, const PayloadCodec& codec){
+    // Compute the total size first, allocate only once
+    uint32_t paramCount = static_cast<uint32_t>(parameters.size());
+    size_t paramSize = codec.EncodedSize(paramCount);
+    size_t totalSize = ModelDataFormat::HEADER_SIZE + paramSize;
+    for (const auto& str : congestedNodes) {
+        totalSize += sizeof(uint32_t) + str.size();
+    }
+    buffer.resize(totalSize);
+    uint8_t* out = buffer.data();
+
+    // Header
+    uint32_t nodeCount = static_cast<uint32_t>(congestedNodes.size());
+    out[0] = ModelDataFormat::MAGIC_0;
+    out[1] = ModelDataFormat::MAGIC_1;
+    out[2] = ModelDataFormat::VERSION;
+    out[3] = static_cast<uint8_t>(codec.GetType());
+    std::memcpy(out + 4, &paramCount, sizeof(uint32_t));
+    std::memcpy(out + 8, &nodeCount, sizeof(uint32_t));
+    std::memcpy(out + 12, &contributors, sizeof(uint32_t));
+
+    // Transfer ModelData.parameters into bytes
+    size_t currentIndex = ModelDataFormat::HEADER_SIZE;
+    codec.Encode(parameters, out + currentIndex);
+    currentIndex += paramSize;
 
     // Transfer ModelData.congestedNodes into bytes
-    for (const auto& str : modelData.congestedNodes) {
+    for (const auto& str : congestedNodes) {
         uint32_t strLength = static_cast<uint32_t>(str.size());
-        buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&strLength), reinterpret_cast<uint8_t*>(&strLength + 1)); // Insert the length of each string within the vector
-        buffer.insert(buffer.end(), str.begin(), str.end()); // Insert the string
+        std::memcpy(out + currentIndex, &strLength, sizeof(uint32_t)); // Insert the length of each string within the vector
+        currentIndex += sizeof(uint32_t);
+        std::memcpy(out + currentIndex, str.data(), strLength); // Insert the string
+        currentIndex += strLength;
     }
 }
 
 
 
 /**
- * Transfer the ndn::Buffer object back into struct format, extract information
- * @param buffer Input ndn::Buffer object, this is input
- * @param modelData Original struct, this is output
- * @return If operation finishes successfully, return true
+ * Prepare a buffer to be filled with model parameters in place, e.g. by producers generating them
+ * @param paramCount The number of parameters
+ * @param buffer Output, resized to hold the header and parameters
+ * @return Start of the parameter area, (paramCount * sizeof(float)) bytes to be written by the caller
  */
-bool deserializeModelData(const std::vector<uint8_t>& buffer, ModelData& modelData){
+uint8_t* serializeModelDataHeader(uint32_t paramCount, std::vector<uint8_t>& buffer){
+    buffer.resize(ModelDataFormat::HEADER_SIZE + static_cast<size_t>(paramCount) * sizeof(float));
+    uint8_t* out = buffer.data();
+    uint32_t nodeCount = 0;
+    uint32_t contributors = 1;
+    out[0] = ModelDataFormat::MAGIC_0;
+    out[1] = ModelDataFormat::MAGIC_1;
+    out[2] = ModelDataFormat::VERSION;
+    out[3] = 0;
+    std::memcpy(out + 4, &paramCount, sizeof(uint32_t));
+    std::memcpy(out + 8, &nodeCount, sizeof(uint32_t));
+    std::memcpy(out + 12, &contributors, sizeof(uint32_t));
+    return out + ModelDataFormat::HEADER_SIZE;
+}
 
-    // Transfer ModelData.parameters back first
-    size_t paramSize = modelData.parameters.size() * sizeof(float);
-    if (buffer.size() < paramSize){
-        std::cout << "Buffer size is smaller than expected!" << std::endl;
-        return false;
-    }
-    std::memcpy(modelData.parameters.data(), buffer.data(), paramSize);
 
 
-    // Transfer ModelData.congestedNodes back
-    size_t currentIndex = paramSize;
-    while (currentIndex < buffer.size()) {
-        if (currentIndex + sizeof(uint32_t) > buffer.size()) {
-            std::cout << "Buffer size can't hold string length!" << std::endl;
+namespace {
+
+    /**
+     * Validate header and congested node list of a serialized ModelData
+     * @param buffer Serialized ModelData
+     * @param paramCount Output, the number of parameters
+     * @param codec Output, encoding of the parameters
+     * @param congestedNodes Output, congested nodes
+     * @param contributors Output, the number of producers summed in the parameters
+     * @return If the buffer is well-formed, return true
+     */
+    bool parseModelData(ndn::span<const uint8_t> buffer, uint32_t& paramCount, PayloadCodec::Type& codec,
+                        std::vector<std::string>& congestedNodes, uint32_t& contributors) {
+        if (buffer.size() < ModelDataFormat::HEADER_SIZE ||
+            buffer[0] != ModelDataFormat::MAGIC_0 || buffer[1] != ModelDataFormat::MAGIC_1) {
+            std::cout << "Buffer doesn't contain a ModelData header!" << std::endl;
+            return false;
+        }
+        if (buffer[2] != ModelDataFormat::VERSION) {
+            std::cout << "Unsupported ModelData version " << static_cast<int>(buffer[2]) << "!" << std::endl;
             return false;
         }
 
-        uint32_t strLength;
-        std::memcpy(&strLength, buffer.data() + currentIndex, sizeof(uint32_t)); // Copy memory of the string's length
-        currentIndex += sizeof(uint32_t);
+        if (!PayloadCodec::IsKnownType(buffer[3])) {
+            std::cout << "Unsupported payload codec " << static_cast<int>(buffer[3]) << "!" << std::endl;
+            return false;
+        }
+        codec = static_cast<PayloadCodec::Type>(buffer[3]);
 
-        if (currentIndex + strLength > buffer.size()) {
-            std::cout << "Buffer size can't hold string content!" << std::endl;
+        uint32_t nodeCount;
+        std::memcpy(&paramCount, buffer.data() + 4, sizeof(uint32_t));
+        std::memcpy(&nodeCount, buffer.data() + 8, sizeof(uint32_t));
+        std::memcpy(&contributors, buffer.data() + 12, sizeof(uint32_t));
+        contributors = std::max<uint32_t>(contributors, 1); // Written as reserved 0 by older senders
+
+        size_t paramSize;
+        if (!PayloadCodec::GetEncodedSize(codec, buffer.subspan(ModelDataFormat::HEADER_SIZE), paramCount, paramSize)) {
+            std::cout << "Buffer size is smaller than expected!" << std::endl;
             return false;
         }
-        std::string str(reinterpret_cast<const char*>(buffer.data() + currentIndex), strLength);
-        modelData.congestedNodes.push_back(str);
-        currentIndex += strLength;
+
+        // Transfer ModelData.congestedNodes back
+        size_t currentIndex = ModelDataFormat::HEADER_SIZE + paramSize;
+        congestedNodes.clear();
+        for (uint32_t i = 0; i < nodeCount; ++i) {
+            if (currentIndex + sizeof(uint32_t) > buffer.size()) {
+                std::cout << "Buffer size can't hold string length!" << std::endl;
+                return false;
+            }
+
+            uint32_t strLength;
+            std::memcpy(&strLength, buffer.data() + currentIndex, sizeof(uint32_t)); // Copy memory of the string's length
+            currentIndex += sizeof(uint32_t);
+
+            if (currentIndex + strLength > buffer.size()) {
+                std::cout << "Buffer size can't hold string content!" << std::endl;
+                return false;
+            }
+            congestedNodes.emplace_back(reinterpret_cast<const char*>(buffer.data() + currentIndex), strLength);
+            currentIndex += strLength;
+        }
+
+        return true;
+    }
+
+} // namespace
+
+
+
+/**
+ * Transfer the serialized bytes back into struct format, extract information
+ * @param buffer Input bytes, e.g. value of Data's content block
+ * @param modelData Original struct, this is output
+ * @return If operation finishes successfully, return true
+ */
+bool deserializeModelData(ndn::span<const uint8_t> buffer, ModelData& modelData){
+    uint32_t paramCount;
+    PayloadCodec::Type codec;
+    if (!parseModelData(buffer, paramCount, codec, modelData.congestedNodes, modelData.contributors)) {
+        return false;
     }
 
+    // Transfer ModelData.parameters back
+    modelData.parameters.resize(paramCount);
+    PayloadCodec::Decode(codec, buffer.subspan(ModelDataFormat::HEADER_SIZE), paramCount, modelData.parameters.data());
+
     return true;
 }
+
+
+
+/**
+ * Parse the content block of Data packet, the block is retained so the view stays valid
+ * @param content Content block
+ * @return If operation finishes successfully, return true
+ */
+bool ModelDataView::parse(const ndn::Block& content) {
+    m_content = content;
+    return parse(m_content.value_bytes());
+}
+
+
+
+/**
+ * Parse serialized ModelData, caller must keep the buffer alive while using this view
+ * @param buffer Serialized ModelData
+ * @return If operation finishes successfully, return true
+ */
+bool ModelDataView::parse(ndn::span<const uint8_t> buffer) {
+    m_parameters = {};
+    m_decoded.clear();
+
+    uint32_t paramCount;
+    if (!parseModelData(buffer, paramCount, m_codec, m_congestedNodes, m_contributors)) {
+        return false;
+    }
+
+    const uint8_t* begin = buffer.data() + ModelDataFormat::HEADER_SIZE;
+    if (m_codec == PayloadCodec::Type::kFp32 && reinterpret_cast<uintptr_t>(begin) % alignof(float) == 0) {
+        m_parameters = ndn::span<const float>(reinterpret_cast<const float*>(begin), paramCount);
+    } else {
+        // The payload is encoded or placed at an odd offset inside the packet, fall back to a single decode
+        m_decoded.resize(paramCount);
+        PayloadCodec::Decode(m_codec, buffer.subspan(ModelDataFormat::HEADER_SIZE), paramCount, m_decoded.data());
+        m_parameters = m_decoded;
+    }
+
+    return true;
+}
+
+
+
+ndn::span<const float> ModelDataView::parameters() const {
+    return m_parameters;
+}
+
+
+
+const std::vector<std::string>& ModelDataView::congestedNodes() const {
+    return m_congestedNodes;
+}
+
+
+
+uint32_t ModelDataView::contributors() const {
+    return m_contributors;
+}
+
+
+
+PayloadCodec::Type ModelDataView::codec() const {
+    return m_codec;
+}
@@ -3,15 +3,80 @@
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include "ns3/callback.h"
+#include "PayloadCodec.hpp"
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/util/span.hpp>
 #include <vector>
+#include <string>
 #include <cstdint>
 
+/**
+ * Wire format of ModelData (version 1), all fields in host byte order:
+ *
+ *   0  uint8   magic 'M'
+ *   1  uint8   magic 'D'
+ *   2  uint8   version
+ *   3  uint8   payload codec (PayloadCodec::Type), 0 is raw fp32
+ *   4  uint32  number of parameters (n)
+ *   8  uint32  number of congested nodes (m)
+ *  12  uint32  number of producers whose parameters are summed in (contributors), 0 is read as 1
+ *  16  float[n] parameters, or their encoding by the payload codec
+ *   .  m x (uint32 length, char[length]) congested node names
+ *
+ * The 16-byte header keeps parameters 4-byte aligned relative to the start of the payload only,
+ * the TLV headers before the Content value are not padded, so a received payload may start at any offset.
+ * Producers send contributors = 1, aggregators forwarding a partial sum send the number of producers in it,
+ * so the consumer divides by the producers actually aggregated rather than by all producers.
+ */
+namespace ModelDataFormat {
+    const uint8_t MAGIC_0 = 'M';
+    const uint8_t MAGIC_1 = 'D';
+    const uint8_t VERSION = 1;
+    const size_t HEADER_SIZE = 16;
+};
+
 struct ModelData {
     std::vector<float> parameters;
     std::vector<std::string> congestedNodes;
+    uint32_t contributors = 1;
 
-    ModelData();
+    ModelData(size_t modelSize = 300);
 };
 
 void serializeModelData(const ModelData& modelData, std::vector<uint8_t>& buffer);
-bool deserializeModelData(const std::vector<uint8_t>& buffer, ModelData& modelData);
+void serializeModelData(ndn::span<const float> parameters, const std::vector<std::string>& congestedNodes, std::vector<uint8_t>& buffer,
+                        uint32_t contributors = 1, const PayloadCodec& codec = PayloadCodec());
+bool deserializeModelData(ndn::span<const uint8_t> buffer, ModelData& modelData);
+
+// Size the buffer for a ModelData without congested nodes and write its header, return where parameters start
+uint8_t* serializeModelDataHeader(uint32_t paramCount, std::vector<uint8_t>& buffer);
+
+
+
+/**
+ * Read-only view over a serialized ModelData, e.g. the Content block of a received Data packet.
+ * fp32 parameters are read in place only if they happen to be 4-byte aligned in memory, which depends on
+ * the name and TLV lengths of the packet, otherwise they are copied once, as other codecs are decoded once into the view.
+ */
+class ModelDataView {
+public:
+    bool parse(const ndn::Block& content);
+
+    bool parse(ndn::span<const uint8_t> buffer);
+
+    ndn::span<const float> parameters() const;
+
+    const std::vector<std::string>& congestedNodes() const;
+
+    uint32_t contributors() const;
+
+    PayloadCodec::Type codec() const;
+
+private:
+    ndn::Block m_content; // Keep the underlying buffer alive
+    ndn::span<const float> m_parameters;
+    std::vector<float> m_decoded; // Used when the payload is encoded or isn't aligned for float access
+    std::vector<std::string> m_congestedNodes;
+    uint32_t m_contributors = 1;
+    PayloadCodec::Type m_codec = PayloadCodec::Type::kFp32;
+};
@@ -0,0 +1,341 @@
+#include "PayloadCodec.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+    uint32_t floatBits(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float bitsFloat(uint32_t bits) {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    size_t numInt8Blocks(uint32_t paramCount) {
+        return (paramCount + PayloadCodec::INT8_BLOCK_SIZE - 1) / PayloadCodec::INT8_BLOCK_SIZE;
+    }
+
+} // namespace
+
+
+
+bool PayloadCodec::ParseType(const std::string& name, Type& type) {
+    if (name == "fp32") {
+        type = Type::kFp32;
+    } else if (name == "fp16") {
+        type = Type::kFp16;
+    } else if (name == "bf16") {
+        type = Type::kBf16;
+    } else if (name == "int8") {
+        type = Type::kInt8;
+    } else if (name == "topk") {
+        type = Type::kTopK;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+
+
+std::string PayloadCodec::GetTypeName(Type type) {
+    switch (type) {
+        case Type::kFp32:
+            return "fp32";
+        case Type::kFp16:
+            return "fp16";
+        case Type::kBf16:
+            return "bf16";
+        case Type::kInt8:
+            return "int8";
+        case Type::kTopK:
+            return "topk";
+    }
+    return "unknown";
+}
+
+
+
+bool PayloadCodec::IsKnownType(uint8_t value) {
+    return value <= static_cast<uint8_t>(Type::kTopK);
+}
+
+
+
+/**
+ * Constructor
+ * @param type
+ * @param topKRatio Fraction of parameters kept by top-k, at least one parameter is kept
+ */
+PayloadCodec::PayloadCodec(Type type, double topKRatio)
+    : m_type(type)
+    , m_topKRatio(topKRatio)
+{
+}
+
+
+
+uint32_t PayloadCodec::GetTopK(uint32_t paramCount) const {
+    if (paramCount == 0) {
+        return 0;
+    }
+    double k = std::ceil(m_topKRatio * paramCount);
+    return static_cast<uint32_t>(std::min<double>(std::max<double>(k, 1.0), paramCount));
+}
+
+
+
+size_t PayloadCodec::EncodedSize(uint32_t paramCount) const {
+    switch (m_type) {
+        case Type::kFp32:
+            return static_cast<size_t>(paramCount) * sizeof(float);
+        case Type::kFp16:
+        case Type::kBf16:
+            return static_cast<size_t>(paramCount) * sizeof(uint16_t);
+        case Type::kInt8:
+            return numInt8Blocks(paramCount) * sizeof(float) + paramCount;
+        case Type::kTopK:
+            return sizeof(uint32_t) + static_cast<size_t>(GetTopK(paramCount)) * (sizeof(uint32_t) + sizeof(float));
+    }
+    return 0;
+}
+
+
+
+/**
+ * Encode model parameters
+ * @param parameters
+ * @param out Output, EncodedSize(parameters.size()) bytes are written
+ */
+void PayloadCodec::Encode(ndn::span<const float> parameters, uint8_t* out) const {
+    uint32_t paramCount = static_cast<uint32_t>(parameters.size());
+    switch (m_type) {
+        case Type::kFp32: {
+            if (paramCount > 0) {
+                std::memcpy(out, parameters.data(), paramCount * sizeof(float));
+            }
+            break;
+        }
+        case Type::kFp16:
+        case Type::kBf16: {
+            bool isHalf = m_type == Type::kFp16;
+            for (uint32_t i = 0; i < paramCount; ++i) {
+                uint16_t value = isHalf ? FloatToHalf(parameters[i]) : FloatToBfloat(parameters[i]);
+                std::memcpy(out + i * sizeof(uint16_t), &value, sizeof(uint16_t));
+            }
+            break;
+        }
+        case Type::kInt8: {
+            // Scales first, so that they stay 4-byte aligned after the ModelData header
+            size_t numBlocks = numInt8Blocks(paramCount);
+            uint8_t* values = out + numBlocks * sizeof(float);
+            for (size_t block = 0; block < numBlocks; ++block) {
+                size_t begin = block * INT8_BLOCK_SIZE;
+                size_t end = std::min<size_t>(begin + INT8_BLOCK_SIZE, paramCount);
+                float maxAbs = 0.0f;
+                for (size_t i = begin; i < end; ++i) {
+                    maxAbs = std::max(maxAbs, std::fabs(parameters[i]));
+                }
+                float scale = maxAbs / 127.0f;
+                float inverse = scale > 0.0f ? 1.0f / scale : 0.0f;
+                std::memcpy(out + block * sizeof(float), &scale, sizeof(float));
+                for (size_t i = begin; i < end; ++i) {
+                    long q = std::lrint(parameters[i] * inverse);
+                    values[i] = static_cast<uint8_t>(static_cast<int8_t>(std::min<long>(std::max<long>(q, -127), 127)));
+                }
+            }
+            break;
+        }
+        case Type::kTopK: {
+            uint32_t k = GetTopK(paramCount);
+            std::vector<uint32_t> indices(paramCount);
+            std::iota(indices.begin(), indices.end(), 0);
+            auto larger = [&parameters](uint32_t a, uint32_t b) {
+                float absA = std::fabs(parameters[a]);
+                float absB = std::fabs(parameters[b]);
+                return absA > absB || (absA == absB && a < b);
+            };
+            std::nth_element(indices.begin(), indices.begin() + k, indices.end(), larger);
+            std::sort(indices.begin(), indices.begin() + k);
+
+            std::memcpy(out, &k, sizeof(uint32_t));
+            uint8_t* indexOut = out + sizeof(uint32_t);
+            uint8_t* valueOut = indexOut + static_cast<size_t>(k) * sizeof(uint32_t);
+            for (uint32_t i = 0; i < k; ++i) {
+                std::memcpy(indexOut + i * sizeof(uint32_t), &indices[i], sizeof(uint32_t));
+                std::memcpy(valueOut + i * sizeof(float), &parameters[indices[i]], sizeof(float));
+            }
+            break;
+        }
+    }
+}
+
+
+
+/**
+ * Compute the size of encoded parameters, top-k reads its k from the payload
+ * @param type
+ * @param encoded Bytes starting with the encoded parameters
+ * @param paramCount The number of parameters
+ * @param size Output
+ * @return If "encoded" holds all encoded parameters, return true
+ */
+bool PayloadCodec::GetEncodedSize(Type type, ndn::span<const uint8_t> encoded, uint32_t paramCount, size_t& size) {
+    if (type == Type::kTopK) {
+        if (encoded.size() < sizeof(uint32_t)) {
+            return false;
+        }
+        uint32_t k;
+        std::memcpy(&k, encoded.data(), sizeof(uint32_t));
+        if (k > paramCount) {
+            return false;
+        }
+        size = sizeof(uint32_t) + static_cast<size_t>(k) * (sizeof(uint32_t) + sizeof(float));
+    } else {
+        size = PayloadCodec(type).EncodedSize(paramCount);
+    }
+    return encoded.size() >= size;
+}
+
+
+
+/**
+ * Decode model parameters
+ * @param type
+ * @param encoded Encoded parameters
+ * @param paramCount The number of parameters
+ * @param out Output, paramCount floats
+ */
+void PayloadCodec::Decode(Type type, ndn::span<const uint8_t> encoded, uint32_t paramCount, float* out) {
+    const uint8_t* in = encoded.data();
+    switch (type) {
+        case Type::kFp32: {
+            if (paramCount > 0) {
+                std::memcpy(out, in, paramCount * sizeof(float));
+            }
+            break;
+        }
+        case Type::kFp16:
+        case Type::kBf16: {
+            bool isHalf = type == Type::kFp16;
+            for (uint32_t i = 0; i < paramCount; ++i) {
+                uint16_t value;
+                std::memcpy(&value, in + i * sizeof(uint16_t), sizeof(uint16_t));
+                out[i] = isHalf ? HalfToFloat(value) : BfloatToFloat(value);
+            }
+            break;
+        }
+        case Type::kInt8: {
+            size_t numBlocks = numInt8Blocks(paramCount);
+            const uint8_t* values = in + numBlocks * sizeof(float);
+            for (size_t block = 0; block < numBlocks; ++block) {
+                float scale;
+                std::memcpy(&scale, in + block * sizeof(float), sizeof(float));
+                size_t end = std::min<size_t>((block + 1) * INT8_BLOCK_SIZE, paramCount);
+                for (size_t i = block * INT8_BLOCK_SIZE; i < end; ++i) {
+                    out[i] = scale * static_cast<int8_t>(values[i]);
+                }
+            }
+            break;
+        }
+        case Type::kTopK: {
+            std::fill(out, out + paramCount, 0.0f);
+            uint32_t k;
+            std::memcpy(&k, in, sizeof(uint32_t));
+            const uint8_t* indexIn = in + sizeof(uint32_t);
+            const uint8_t* valueIn = indexIn + static_cast<size_t>(k) * sizeof(uint32_t);
+            for (uint32_t i = 0; i < k; ++i) {
+                uint32_t index;
+                std::memcpy(&index, indexIn + i * sizeof(uint32_t), sizeof(uint32_t));
+                if (index < paramCount) {
+                    std::memcpy(out + index, valueIn + i * sizeof(float), sizeof(float));
+                }
+            }
+            break;
+        }
+    }
+}
+
+
+
+// Round to nearest even, overflow becomes infinity and tiny values become subnormal/zero
+uint16_t PayloadCodec::FloatToHalf(float value) {
+    uint32_t bits = floatBits(value);
+    uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    uint32_t absBits = bits & 0x7FFFFFFF;
+
+    if (absBits >= 0x7F800000) {
+        // Infinity or NaN, NaN stays quiet
+        return sign | 0x7C00 | (absBits > 0x7F800000 ? 0x0200 : 0);
+    }
+    if (absBits >= 0x477FF000) {
+        // Rounds beyond 65504
+        return sign | 0x7C00;
+    }
+    if (absBits < 0x38800000) {
+        // Below the smallest normal half (2^-14)
+        if (absBits < 0x33000000) {
+            return sign;
+        }
+        uint32_t exponent = absBits >> 23;
+        uint32_t mantissa = (absBits & 0x7FFFFF) | 0x800000;
+        uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1))) {
+            ++half;
+        }
+        return sign | static_cast<uint16_t>(half);
+    }
+
+    uint32_t half = (absBits - 0x38000000) >> 13;
+    uint32_t remainder = absBits & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        ++half;
+    }
+    return sign | static_cast<uint16_t>(half);
+}
+
+
+
+float PayloadCodec::HalfToFloat(uint16_t value) {
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+
+    if (exponent == 0) {
+        float result = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+        return sign ? -result : result;
+    }
+    if (exponent == 31) {
+        return bitsFloat(sign | 0x7F800000 | (mantissa << 13));
+    }
+    return bitsFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+
+
+// Round to nearest even on the dropped 16 bits
+uint16_t PayloadCodec::FloatToBfloat(float value) {
+    uint32_t bits = floatBits(value);
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+        return static_cast<uint16_t>((bits >> 16) | 0x0040);
+    }
+    bits += 0x7FFF + ((bits >> 16) & 1);
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+
+
+float PayloadCodec::BfloatToFloat(uint16_t value) {
+    return bitsFloat(static_cast<uint32_t>(value) << 16);
+}
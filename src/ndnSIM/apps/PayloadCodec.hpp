@@ -0,0 +1,71 @@
+#pragma once
+
+#include <ndn-cxx/util/span.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Encoding of model parameters inside ModelData, the type is stored in the flags byte of the header:
+ *
+ *   fp32 - raw float[n], the original format
+ *   fp16 - IEEE half precision, uint16[n]
+ *   bf16 - upper half of float (bfloat16), uint16[n]
+ *   int8 - float[ceil(n / INT8_BLOCK_SIZE)] per-block scales followed by int8[n], value = scale * q
+ *   topk - uint32 k, uint32[k] ascending indices, float[k] values; parameters not listed are 0
+ *
+ * Producers encode, aggregators decode into their fp32 sum and re-encode, the consumer decodes.
+ * Only fp32 can be read in place, other codecs are decoded once when ModelDataView parses them.
+ */
+class PayloadCodec {
+public:
+    enum class Type : uint8_t {
+        kFp32 = 0,
+        kFp16 = 1,
+        kBf16 = 2,
+        kInt8 = 3,
+        kTopK = 4
+    };
+
+    static constexpr size_t INT8_BLOCK_SIZE = 64;
+
+    static bool ParseType(const std::string& name, Type& type);
+
+    static std::string GetTypeName(Type type);
+
+    static bool IsKnownType(uint8_t value);
+
+    PayloadCodec(Type type = Type::kFp32, double topKRatio = 0.1);
+
+    Type GetType() const { return m_type; }
+
+    // Number of values kept by top-k for "paramCount" parameters
+    uint32_t GetTopK(uint32_t paramCount) const;
+
+    // Size of the encoded parameters
+    size_t EncodedSize(uint32_t paramCount) const;
+
+    // Write EncodedSize(parameters.size()) bytes at "out"
+    void Encode(ndn::span<const float> parameters, uint8_t* out) const;
+
+    /**
+     * Size of the encoded parameters at the start of "encoded", which may be followed by other fields
+     * @return False if "encoded" is too short
+     */
+    static bool GetEncodedSize(Type type, ndn::span<const uint8_t> encoded, uint32_t paramCount, size_t& size);
+
+    // Decode "paramCount" parameters into "out", the input must have been validated by GetEncodedSize()
+    static void Decode(Type type, ndn::span<const uint8_t> encoded, uint32_t paramCount, float* out);
+
+    static uint16_t FloatToHalf(float value);
+
+    static float HalfToFloat(uint16_t value);
+
+    static uint16_t FloatToBfloat(float value);
+
+    static float BfloatToFloat(uint16_t value);
+
+private:
+    Type m_type;
+    double m_topKRatio;
+};
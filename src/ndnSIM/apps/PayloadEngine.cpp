@@ -0,0 +1,183 @@
+#include "PayloadEngine.hpp"
+#include "ModelData.hpp"
+#include <ndn-cxx/encoding/encoding-buffer.hpp>
+#include <ndn-cxx/encoding/tlv.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+    const float PARAMETER_RANGE = 10.0f;
+
+    uint64_t splitmix64(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    // Top 24 bits of a random word to a float in [0, PARAMETER_RANGE)
+    float toParameter(uint32_t bits) {
+        return static_cast<float>(bits >> 8) * (PARAMETER_RANGE / 16777216.0f);
+    }
+
+} // namespace
+
+
+
+bool PayloadEngine::ParseMode(const std::string& name, Mode& mode) {
+    if (name == "Random") {
+        mode = Mode::kRandom;
+    } else if (name == "Pool") {
+        mode = Mode::kPool;
+    } else if (name == "Counter") {
+        mode = Mode::kCounter;
+    } else if (name == "Template") {
+        mode = Mode::kTemplate;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+
+
+std::string PayloadEngine::GetModeName(Mode mode) {
+    switch (mode) {
+        case Mode::kRandom:
+            return "Random";
+        case Mode::kPool:
+            return "Pool";
+        case Mode::kCounter:
+            return "Counter";
+        case Mode::kTemplate:
+            return "Template";
+    }
+    return "Unknown";
+}
+
+
+
+/**
+ * Set up the engine, payloads of pool/template modes are generated here
+ * @param mode
+ * @param modelSize The number of model parameters
+ * @param seed Per-producer seed
+ * @param poolSize Number of pre-generated payloads in pool mode
+ */
+void PayloadEngine::Configure(Mode mode, uint32_t modelSize, uint64_t seed, uint32_t poolSize) {
+    m_mode = mode;
+    m_modelSize = modelSize;
+    m_seed = seed;
+    m_counter = 0;
+    m_engine.seed(static_cast<std::default_random_engine::result_type>(seed));
+    m_pool.clear();
+    m_poolIndex = 0;
+
+    size_t numPayloads = 0;
+    if (mode == Mode::kPool) {
+        numPayloads = std::max<uint32_t>(poolSize, 1);
+    } else if (mode == Mode::kTemplate) {
+        numPayloads = 1;
+    }
+    for (size_t i = 0; i < numPayloads; ++i) {
+        m_pool.push_back(GenerateCounter());
+    }
+}
+
+
+
+ndn::ConstBufferPtr PayloadEngine::Next() {
+    switch (m_mode) {
+        case Mode::kRandom:
+            return Generate();
+        case Mode::kCounter:
+            return GenerateCounter();
+        case Mode::kPool:
+        case Mode::kTemplate:
+            break;
+    }
+    const auto& payload = m_pool[m_poolIndex];
+    m_poolIndex = (m_poolIndex + 1) % m_pool.size();
+    return payload;
+}
+
+
+
+ndn::ConstBufferPtr PayloadEngine::Generate() {
+    auto buffer = std::make_shared<ndn::Buffer>();
+    uint8_t* out = serializeModelDataHeader(m_modelSize, *buffer);
+    std::uniform_real_distribution<float> distribution(0.0f, PARAMETER_RANGE);
+    for (uint32_t i = 0; i < m_modelSize; ++i) {
+        float parameter = distribution(m_engine);
+        std::memcpy(out + i * sizeof(float), &parameter, sizeof(float));
+    }
+    return Encode(buffer);
+}
+
+
+
+// Each 64-bit draw yields two parameters, written in place without an intermediate vector
+ndn::ConstBufferPtr PayloadEngine::GenerateCounter() {
+    auto buffer = std::make_shared<ndn::Buffer>();
+    uint8_t* out = serializeModelDataHeader(m_modelSize, *buffer);
+    uint32_t i = 0;
+    for (; i + 1 < m_modelSize; i += 2) {
+        uint64_t bits = splitmix64(m_seed + m_counter++);
+        float pair[2] = {toParameter(static_cast<uint32_t>(bits)), toParameter(static_cast<uint32_t>(bits >> 32))};
+        std::memcpy(out + i * sizeof(float), pair, sizeof(pair));
+    }
+    if (i < m_modelSize) {
+        float parameter = toParameter(static_cast<uint32_t>(splitmix64(m_seed + m_counter++)));
+        std::memcpy(out + i * sizeof(float), &parameter, sizeof(float));
+    }
+    return Encode(buffer);
+}
+
+
+
+ndn::ConstBufferPtr PayloadEngine::Encode(const std::shared_ptr<ndn::Buffer>& payload) const {
+    if (m_codec.GetType() == PayloadCodec::Type::kFp32) {
+        return payload;
+    }
+    ndn::span<const float> parameters(reinterpret_cast<const float*>(payload->data() + ModelDataFormat::HEADER_SIZE), m_modelSize);
+    auto encoded = std::make_shared<ndn::Buffer>();
+    serializeModelData(parameters, {}, *encoded, 1, m_codec);
+    return encoded;
+}
+
+
+
+/**
+ * Encode the prototype once and keep all elements after its Name
+ * @param prototype Data packet with the content and signature every response carries
+ */
+void DataTemplate::Set(const ndn::Data& prototype) {
+    const ndn::Block& wire = prototype.wireEncode();
+    wire.parse();
+    m_tail.clear();
+    for (const auto& element : wire.elements()) {
+        if (element.type() == ndn::tlv::Name) {
+            continue;
+        }
+        m_tail.insert(m_tail.end(), element.begin(), element.end());
+    }
+}
+
+
+
+/**
+ * Build a Data packet named "name" from the template, only the Name and the outer TLV header are encoded
+ * @param name
+ * @return Data packet decoded from the assembled wire
+ */
+std::shared_ptr<ndn::Data> DataTemplate::Make(const ndn::Name& name) const {
+    const ndn::Block& nameWire = name.wireEncode();
+    ndn::EncodingBuffer encoder(m_tail.size() + nameWire.size() + 16, 0);
+    size_t length = encoder.prependBytes(m_tail);
+    length += encoder.prependBytes(ndn::make_span(nameWire.wire(), nameWire.size()));
+    encoder.prependVarNumber(length);
+    encoder.prependVarNumber(ndn::tlv::Data);
+    return std::make_shared<ndn::Data>(encoder.block());
+}
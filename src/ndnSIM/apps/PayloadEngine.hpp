@@ -0,0 +1,80 @@
+#pragma once
+
+#include "PayloadCodec.hpp"
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/encoding/buffer.hpp>
+#include <random>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+/**
+ * Generates the serialized ModelData carried by producer responses.
+ *
+ *   Random   - draw every parameter from a per-producer std::default_random_engine (seeded once)
+ *   Pool     - pre-serialize "poolSize" payloads at start, responses cycle through them without copying
+ *   Counter  - counter-based PRNG (splitmix64 of seed + counter), parameters are written straight into the buffer
+ *   Template - a single payload, producers additionally reuse a pre-encoded Data packet (see DataTemplate)
+ *
+ * All modes produce parameters uniformly distributed in [0, 10) and are reproducible for a given seed.
+ * Payloads are encoded by the codec set before Configure(), pool/template payloads are encoded only once.
+ */
+class PayloadEngine {
+public:
+    enum class Mode {
+        kRandom,
+        kPool,
+        kCounter,
+        kTemplate
+    };
+
+    static bool ParseMode(const std::string& name, Mode& mode);
+
+    static std::string GetModeName(Mode mode);
+
+    void SetCodec(const PayloadCodec& codec) { m_codec = codec; }
+
+    void Configure(Mode mode, uint32_t modelSize, uint64_t seed, uint32_t poolSize);
+
+    Mode GetMode() const { return m_mode; }
+
+    // Serialized ModelData for the next response
+    ndn::ConstBufferPtr Next();
+
+private:
+    ndn::ConstBufferPtr Generate();
+
+    ndn::ConstBufferPtr GenerateCounter();
+
+    // Re-encode a generated fp32 payload with the codec
+    ndn::ConstBufferPtr Encode(const std::shared_ptr<ndn::Buffer>& payload) const;
+
+private:
+    Mode m_mode = Mode::kCounter;
+    uint32_t m_modelSize = 0;
+    PayloadCodec m_codec;
+    uint64_t m_seed = 0;
+    uint64_t m_counter = 0;
+    std::default_random_engine m_engine;
+    std::vector<ndn::ConstBufferPtr> m_pool;
+    size_t m_poolIndex = 0;
+};
+
+
+
+/**
+ * Pre-encoded Data packet, only the Name is replaced per response.
+ * Everything after the Name (MetaInfo, Content, SignatureInfo, SignatureValue) is encoded once and copied as bytes.
+ */
+class DataTemplate {
+public:
+    void Set(const ndn::Data& prototype);
+
+    bool IsSet() const { return !m_tail.empty(); }
+
+    std::shared_ptr<ndn::Data> Make(const ndn::Name& name) const;
+
+private:
+    ndn::Buffer m_tail;
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "ns3/nstime.h"
+#include "ns3/ndnSIM/model/ndn-common.hpp"
+
+#include <boost/functional/hash.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Recently retransmitted Interests of CFNAgg apps (Consumer, Aggregator).
+ * Names are "/.../Seq", each one is indexed by the hash of its components before the sequence number
+ * plus the sequence number, so neither lookups nor inserts depend on how many Interests are remembered.
+ *
+ * An entry is forgotten once its lifetime has passed, or when more than "capacity" entries are
+ * remembered, oldest first. Re-inserting a name refreshes its lifetime and moves it to the back of
+ * the FIFO, so the FIFO never holds more than one entry per name.
+ */
+class RetxFilter {
+public:
+    using Key = std::pair<size_t, uint64_t>; // hash of the name without sequence number, sequence number
+
+    /**
+     * Constructor
+     * @param capacity Maximum number of remembered names, 0 disables the filter
+     * @param lifetime How long a name is remembered after insert()
+     */
+    explicit RetxFilter(size_t capacity = 4096, ns3::Time lifetime = ns3::Seconds(1))
+        : m_capacity(capacity)
+        , m_lifetime(lifetime)
+    {
+    }
+
+
+
+    /**
+     * Build the key of a name, the last component must be a sequence number
+     * @param name
+     * @return Key of the name
+     */
+    static Key makeKey(const ns3::ndn::Name& name)
+    {
+        size_t hash = 0;
+        if (name.empty()) {
+            return {hash, 0};
+        }
+        for (size_t i = 0; i + 1 < name.size(); ++i) {
+            const auto& component = name.get(i);
+            boost::hash_combine(hash, component.type());
+            boost::hash_range(hash, component.value_begin(), component.value_end());
+        }
+        const auto& last = name.get(-1);
+        return {hash, last.isSequenceNumber() ? last.toSequenceNumber() : 0};
+    }
+
+
+
+    /**
+     * Remember a retransmitted name until now + lifetime
+     * @param name
+     * @param now
+     */
+    void insert(const ns3::ndn::Name& name, ns3::Time now)
+    {
+        if (m_capacity == 0) {
+            return;
+        }
+        expire(now);
+
+        Key key = makeKey(name);
+        auto [it, isNew] = m_entries.try_emplace(key);
+        it->second.deadline = (now + m_lifetime).GetTimeStep();
+        if (isNew) {
+            it->second.position = m_fifo.insert(m_fifo.end(), key);
+        } else {
+            m_fifo.splice(m_fifo.end(), m_fifo, it->second.position);
+        }
+
+        while (m_entries.size() > m_capacity) {
+            pop();
+        }
+    }
+
+
+
+    /**
+     * Check whether a name has been retransmitted recently
+     * @param name
+     * @param now
+     * @return True if the name was inserted and its lifetime hasn't passed
+     */
+    bool contains(const ns3::ndn::Name& name, ns3::Time now) const
+    {
+        auto it = m_entries.find(makeKey(name));
+        return it != m_entries.end() && it->second.deadline > now.GetTimeStep();
+    }
+
+
+
+    /**
+     * Forget names whose lifetime has passed
+     * @param now
+     */
+    void expire(ns3::Time now)
+    {
+        int64_t nowStep = now.GetTimeStep();
+        while (!m_fifo.empty() && m_entries.find(m_fifo.front())->second.deadline <= nowStep) {
+            pop();
+        }
+    }
+
+
+
+    void setCapacity(size_t capacity)
+    {
+        m_capacity = capacity;
+        while (m_entries.size() > m_capacity) {
+            pop();
+        }
+    }
+
+    void setLifetime(ns3::Time lifetime)
+    {
+        m_lifetime = lifetime;
+    }
+
+    size_t size() const
+    {
+        return m_entries.size();
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_fifo.clear();
+    }
+
+private:
+    // Forget the least recently inserted name
+    void pop()
+    {
+        m_entries.erase(m_fifo.front());
+        m_fifo.pop_front();
+    }
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const
+        {
+            size_t hash = key.first;
+            boost::hash_combine(hash, key.second);
+            return hash;
+        }
+    };
+
+    struct Entry {
+        int64_t deadline; // in simulator time steps
+        std::list<Key>::iterator position; // in m_fifo
+    };
+
+    size_t m_capacity;
+    ns3::Time m_lifetime;
+    std::unordered_map<Key, Entry, KeyHash> m_entries;
+    std::list<Key> m_fifo; // keys by last insertion, used for expiry and capacity
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Flat table of per-sequence state, organized as a ring buffer indexed by "seq % capacity".
+ * Used by CFNAgg apps to track one slot per outstanding iteration without string keys or tree lookups.
+ *
+ * Slot type must be default constructible and provide "void reset()", which is invoked every time a slot is
+ * (re)used, so buffers inside the slot (e.g. aggregation accumulator) keep their capacity across iterations.
+ * When two active sequences collide on the same index, the table doubles its capacity.
+ * Pointers/references to slots are invalidated when the table grows.
+ */
+template<typename Slot>
+class SeqSlotTable {
+public:
+    explicit SeqSlotTable(size_t capacity = 64)
+    {
+        size_t actual = 1;
+        while (actual < capacity) {
+            actual <<= 1;
+        }
+        m_entries.resize(actual);
+    }
+
+
+
+    /**
+     * Find the slot of given sequence
+     * @param seq
+     * @return Pointer to slot, nullptr if the sequence isn't active
+     */
+    Slot* find(uint32_t seq)
+    {
+        Entry& entry = m_entries[index(seq)];
+        return (entry.active && entry.seq == seq) ? &entry.slot : nullptr;
+    }
+
+
+
+    /**
+     * Activate the slot of given sequence, reset its content if it wasn't active
+     * @param seq
+     * @return Reference to slot
+     */
+    Slot& insert(uint32_t seq)
+    {
+        while (true) {
+            Entry& entry = m_entries[index(seq)];
+            if (!entry.active) {
+                entry.active = true;
+                entry.seq = seq;
+                entry.slot.reset();
+                ++m_size;
+                return entry.slot;
+            }
+            if (entry.seq == seq) {
+                return entry.slot;
+            }
+            grow();
+        }
+    }
+
+
+
+    /**
+     * Release the slot of given sequence, its buffers are kept for reuse
+     * @param seq
+     */
+    void erase(uint32_t seq)
+    {
+        Entry& entry = m_entries[index(seq)];
+        if (entry.active && entry.seq == seq) {
+            entry.active = false;
+            --m_size;
+        }
+    }
+
+
+
+    /**
+     * Invoke f(seq, slot) for every active slot
+     * @param f
+     */
+    template<typename F>
+    void forEach(F&& f)
+    {
+        for (auto& entry : m_entries) {
+            if (entry.active) {
+                f(entry.seq, entry.slot);
+            }
+        }
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    size_t capacity() const
+    {
+        return m_entries.size();
+    }
+
+    void clear()
+    {
+        for (auto& entry : m_entries) {
+            entry.active = false;
+        }
+        m_size = 0;
+    }
+
+private:
+    size_t index(uint32_t seq) const
+    {
+        return seq & (m_entries.size() - 1);
+    }
+
+
+
+    /**
+     * Double the capacity until all active sequences map to distinct indexes
+     */
+    void grow()
+    {
+        size_t newCapacity = m_entries.size() * 2;
+        while (hasCollision(newCapacity)) {
+            newCapacity *= 2;
+        }
+
+        std::vector<Entry> entries(newCapacity);
+        for (auto& entry : m_entries) {
+            if (entry.active) {
+                Entry& target = entries[entry.seq & (newCapacity - 1)];
+                target.active = true;
+                target.seq = entry.seq;
+                target.slot = std::move(entry.slot);
+            }
+        }
+        m_entries = std::move(entries);
+    }
+
+    bool hasCollision(size_t capacity) const
+    {
+        std::vector<bool> used(capacity, false);
+        for (const auto& entry : m_entries) {
+            if (entry.active) {
+                size_t i = entry.seq & (capacity - 1);
+                if (used[i]) {
+                    return true;
+                }
+                used[i] = true;
+            }
+        }
+        return false;
+    }
+
+    struct Entry {
+        bool active = false;
+        uint32_t seq = 0;
+        Slot slot;
+    };
+
+    std::vector<Entry> m_entries;
+    size_t m_size = 0;
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "ns3/nstime.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Hashed timing wheel for retransmission timeouts of CFNAgg apps (Consumer, ConsumerINA, Aggregator).
+ * Each outstanding Interest is armed once with its own deadline, expire() then only visits the buckets
+ * whose ticks elapsed since the previous call, instead of scanning every outstanding Interest.
+ *
+ * Re-arming or cancelling a key is O(1): the stale wheel entry stays in its bucket and is dropped
+ * when the bucket is visited. Deadlines further away than one rotation stay in their bucket until
+ * the rotation they belong to.
+ */
+template<typename Key, typename Hash = std::hash<Key>>
+class TimerWheel {
+public:
+    /**
+     * Constructor
+     * @param tick Granularity of the wheel
+     * @param numBuckets Number of buckets, rounded up to a power of two
+     */
+    explicit TimerWheel(ns3::Time tick = ns3::MilliSeconds(1), size_t numBuckets = 1024)
+        : m_tick(tick.GetTimeStep() > 0 ? tick.GetTimeStep() : 1)
+        , m_lastTick(0)
+    {
+        size_t actual = 1;
+        while (actual < numBuckets) {
+            actual <<= 1;
+        }
+        m_buckets.resize(actual);
+    }
+
+
+
+    /**
+     * Arm the timer of given key, an existing timer of the same key is replaced
+     * @param key
+     * @param deadline Absolute time at which the key expires
+     * @return Time from which expire() pops the key, i.e. the deadline rounded up to the tick of the wheel
+     */
+    ns3::Time schedule(const Key& key, ns3::Time deadline)
+    {
+        Timer& timer = m_timers[key];
+        timer.deadline = deadline.GetTimeStep();
+        timer.generation = ++m_generation;
+
+        // Round up, so the bucket is never visited before the deadline
+        int64_t tick = (timer.deadline + m_tick - 1) / m_tick;
+        if (tick <= m_lastTick) {
+            tick = m_lastTick + 1;
+        }
+        m_buckets[tick & (m_buckets.size() - 1)].push_back({key, timer.generation});
+        return ns3::TimeStep(tick * m_tick);
+    }
+
+
+
+    /**
+     * Disarm the timer of given key
+     * @param key
+     * @return True if the key was armed
+     */
+    bool cancel(const Key& key)
+    {
+        return m_timers.erase(key) > 0;
+    }
+
+
+
+    bool contains(const Key& key) const
+    {
+        return m_timers.find(key) != m_timers.end();
+    }
+
+
+
+    /**
+     * Pop all keys whose deadline is not later than now, and invoke f(key) for each of them.
+     * The callback is invoked after the wheel has been updated, so it may re-arm the key.
+     * @param now
+     * @param f
+     */
+    template<typename F>
+    void expire(ns3::Time now, F&& f)
+    {
+        int64_t nowStep = now.GetTimeStep();
+        int64_t nowTick = nowStep / m_tick;
+        if (nowTick <= m_lastTick) {
+            return;
+        }
+
+        // Visit each bucket at most once, even if more than one rotation has elapsed
+        int64_t first = m_lastTick + 1;
+        if (nowTick - first >= static_cast<int64_t>(m_buckets.size())) {
+            first = nowTick - static_cast<int64_t>(m_buckets.size()) + 1;
+        }
+
+        m_expired.clear();
+        for (int64_t tick = first; tick <= nowTick; ++tick) {
+            auto& bucket = m_buckets[tick & (m_buckets.size() - 1)];
+            size_t kept = 0;
+            for (size_t i = 0; i < bucket.size(); ++i) {
+                auto it = m_timers.find(bucket[i].key);
+                if (it == m_timers.end() || it->second.generation != bucket[i].generation) {
+                    continue; // cancelled or re-armed
+                }
+                if (it->second.deadline <= nowStep) {
+                    m_timers.erase(it);
+                    m_expired.push_back(std::move(bucket[i].key));
+                    continue;
+                }
+                if (kept != i) {
+                    bucket[kept] = std::move(bucket[i]);
+                }
+                ++kept;
+            }
+            bucket.resize(kept);
+        }
+        m_lastTick = nowTick;
+
+        for (const auto& key : m_expired) {
+            f(key);
+        }
+    }
+
+
+
+    /**
+     * Find the first tick whose bucket holds an armed key, so callers can run expire() only when it has work to do.
+     * A key armed more than one rotation ahead makes the result earlier than its deadline, never later.
+     * @return Time from which expire() pops the next key, or Time::Max() if no key is armed
+     */
+    ns3::Time nextExpiry() const
+    {
+        if (m_timers.empty()) {
+            return ns3::Time::Max();
+        }
+
+        for (int64_t tick = m_lastTick + 1; tick <= m_lastTick + static_cast<int64_t>(m_buckets.size()); ++tick) {
+            for (const auto& item : m_buckets[tick & (m_buckets.size() - 1)]) {
+                auto it = m_timers.find(item.key);
+                if (it != m_timers.end() && it->second.generation == item.generation) {
+                    return ns3::TimeStep(tick * m_tick);
+                }
+            }
+        }
+        return ns3::Time::Max();
+    }
+
+
+
+    size_t size() const
+    {
+        return m_timers.size();
+    }
+
+    void clear()
+    {
+        for (auto& bucket : m_buckets) {
+            bucket.clear();
+        }
+        m_timers.clear();
+    }
+
+private:
+    struct Timer {
+        int64_t deadline;
+        uint64_t generation;
+    };
+
+    struct Item {
+        Key key;
+        uint64_t generation;
+    };
+
+    int64_t m_tick; // in simulator time steps
+    int64_t m_lastTick; // last tick that has been processed
+    uint64_t m_generation = 0;
+    std::vector<std::vector<Item>> m_buckets;
+    std::unordered_map<Key, Timer, Hash> m_timers;
+    std::vector<Key> m_expired;
+};
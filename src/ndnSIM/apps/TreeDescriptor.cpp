@@ -0,0 +1,208 @@
+#include "TreeDescriptor.hpp"
+#include <ndn-cxx/encoding/block-helpers.hpp>
+#include <ndn-cxx/encoding/tlv.hpp>
+#include <climits>
+#include <iostream>
+
+namespace {
+
+    const size_t BITS_PER_BLOCK = LeafBitmap::bits_per_block;
+    const size_t BYTES_PER_BLOCK = BITS_PER_BLOCK / CHAR_BIT;
+
+    uint8_t getByte(const std::vector<LeafBitmap::block_type>& blocks, size_t index) {
+        return static_cast<uint8_t>(blocks[index / BYTES_PER_BLOCK] >> (CHAR_BIT * (index % BYTES_PER_BLOCK)));
+    }
+
+} // namespace
+
+
+
+/**
+ * Encode a leaf bitmap into LeafBitmap TLV, zero bytes at both ends are skipped
+ * @param bitmap Bit i is set if producer i is included
+ * @return LeafBitmap block
+ */
+ndn::Block encodeLeafBitmap(const LeafBitmap& bitmap) {
+    std::vector<LeafBitmap::block_type> blocks;
+    blocks.reserve(bitmap.num_blocks());
+    boost::to_block_range(bitmap, std::back_inserter(blocks));
+
+    size_t numBytes = blocks.size() * BYTES_PER_BLOCK;
+    size_t first = 0;
+    while (first < numBytes && getByte(blocks, first) == 0) {
+        ++first;
+    }
+    size_t last = numBytes;
+    while (last > first && getByte(blocks, last - 1) == 0) {
+        --last;
+    }
+
+    std::vector<uint8_t> bytes;
+    bytes.reserve(last - first);
+    for (size_t i = first; i < last; ++i) {
+        bytes.push_back(getByte(blocks, i));
+    }
+
+    ndn::Block block(TreeDescriptorFormat::LEAF_BITMAP);
+    block.push_back(ndn::encoding::makeNonNegativeIntegerBlock(TreeDescriptorFormat::BITMAP_OFFSET, first));
+    block.push_back(ndn::encoding::makeBinaryBlock(TreeDescriptorFormat::BITMAP_VALUE, bytes));
+    block.encode();
+    return block;
+}
+
+
+
+/**
+ * Decode LeafBitmap TLV, bits beyond the number of producers are dropped
+ * @param block LeafBitmap block
+ * @param numProducers Size of the output bitmap
+ * @param bitmap Output
+ * @return If operation finishes successfully, return true
+ */
+bool decodeLeafBitmap(const ndn::Block& block, size_t numProducers, LeafBitmap& bitmap) {
+    if (block.type() != TreeDescriptorFormat::LEAF_BITMAP) {
+        std::cout << "Block isn't a LeafBitmap!" << std::endl;
+        return false;
+    }
+    try {
+        block.parse();
+        auto offsetIt = block.find(TreeDescriptorFormat::BITMAP_OFFSET);
+        auto valueIt = block.find(TreeDescriptorFormat::BITMAP_VALUE);
+        if (offsetIt == block.elements_end() || valueIt == block.elements_end()) {
+            std::cout << "LeafBitmap misses offset or value!" << std::endl;
+            return false;
+        }
+        uint64_t offset = ndn::encoding::readNonNegativeInteger(*offsetIt);
+
+        // Assemble blocks directly, bytes of the value are placed from "offset" on
+        std::vector<LeafBitmap::block_type> blocks((numProducers + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK, 0);
+        size_t numBytes = blocks.size() * BYTES_PER_BLOCK;
+        ndn::span<const uint8_t> value = valueIt->value_bytes();
+        for (size_t i = 0; i < value.size() && offset + i < numBytes; ++i) {
+            size_t index = offset + i;
+            blocks[index / BYTES_PER_BLOCK] |= static_cast<LeafBitmap::block_type>(value[i]) << (CHAR_BIT * (index % BYTES_PER_BLOCK));
+        }
+
+        bitmap.clear();
+        bitmap.append(blocks.begin(), blocks.end());
+        bitmap.resize(numProducers);
+    } catch (const ndn::tlv::Error& e) {
+        std::cout << "Malformed LeafBitmap: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+
+/**
+ * Name component carrying a leaf bitmap, used as the destination segment of "data" interests
+ * @param bitmap
+ * @return Generic name component whose value is a LeafBitmap block
+ */
+ndn::name::Component makeLeafComponent(const LeafBitmap& bitmap) {
+    ndn::Block block = encodeLeafBitmap(bitmap);
+    return ndn::name::Component(ndn::tlv::GenericNameComponent, ndn::span<const uint8_t>(block.wire(), block.size()));
+}
+
+
+
+/**
+ * Parse the destination segment of "data" interests
+ * @param component
+ * @param numProducers Size of the output bitmap
+ * @param bitmap Output
+ * @return If operation finishes successfully, return true
+ */
+bool parseLeafComponent(const ndn::name::Component& component, size_t numProducers, LeafBitmap& bitmap) {
+    bool isOk;
+    ndn::Block block;
+    std::tie(isOk, block) = ndn::Block::fromBuffer(component.value_bytes());
+    if (!isOk) {
+        std::cout << "Name component doesn't contain a LeafBitmap!" << std::endl;
+        return false;
+    }
+    return decodeLeafBitmap(block, numProducers, bitmap);
+}
+
+
+
+ndn::Name stripParametersDigest(const ndn::Name& name) {
+    if (!name.empty() && name.get(-1).isParametersSha256Digest()) {
+        return name.getPrefix(-1);
+    }
+    return name;
+}
+
+
+
+ndn::Block TreeDescriptor::wireEncode() const {
+    ndn::Block block(TreeDescriptorFormat::TREE_DESCRIPTOR);
+    block.push_back(ndn::encoding::makeNonNegativeIntegerBlock(TreeDescriptorFormat::NUM_PRODUCERS, numProducers));
+    for (const auto& [childName, leaves] : children) {
+        ndn::Block child(TreeDescriptorFormat::CHILD);
+        child.push_back(ndn::encoding::makeStringBlock(TreeDescriptorFormat::CHILD_NAME, childName));
+        child.push_back(encodeLeafBitmap(leaves));
+        child.encode();
+        block.push_back(child);
+    }
+    block.encode();
+    return block;
+}
+
+
+
+/**
+ * Parse a TreeDescriptor, e.g. ApplicationParameters of a received "initialization" interest
+ * @param block TreeDescriptor block, or ApplicationParameters block containing it
+ * @return If operation finishes successfully, return true
+ */
+bool TreeDescriptor::wireDecode(const ndn::Block& block) {
+    children.clear();
+    try {
+        ndn::Block descriptor = block;
+        if (descriptor.type() == ndn::tlv::ApplicationParameters) {
+            descriptor.parse();
+            auto it = descriptor.find(TreeDescriptorFormat::TREE_DESCRIPTOR);
+            if (it == descriptor.elements_end()) {
+                std::cout << "ApplicationParameters don't contain a TreeDescriptor!" << std::endl;
+                return false;
+            }
+            descriptor = *it;
+        }
+        if (descriptor.type() != TreeDescriptorFormat::TREE_DESCRIPTOR) {
+            std::cout << "Block isn't a TreeDescriptor!" << std::endl;
+            return false;
+        }
+
+        descriptor.parse();
+        auto numIt = descriptor.find(TreeDescriptorFormat::NUM_PRODUCERS);
+        if (numIt == descriptor.elements_end()) {
+            std::cout << "TreeDescriptor misses the number of producers!" << std::endl;
+            return false;
+        }
+        numProducers = ndn::encoding::readNonNegativeIntegerAs<uint32_t>(*numIt);
+
+        for (const auto& element : descriptor.elements()) {
+            if (element.type() != TreeDescriptorFormat::CHILD) {
+                continue;
+            }
+            element.parse();
+            auto nameIt = element.find(TreeDescriptorFormat::CHILD_NAME);
+            auto bitmapIt = element.find(TreeDescriptorFormat::LEAF_BITMAP);
+            if (nameIt == element.elements_end() || bitmapIt == element.elements_end()) {
+                std::cout << "Child of TreeDescriptor misses name or leaf bitmap!" << std::endl;
+                return false;
+            }
+            LeafBitmap leaves;
+            if (!decodeLeafBitmap(*bitmapIt, numProducers, leaves)) {
+                return false;
+            }
+            children.emplace_back(ndn::encoding::readString(*nameIt), std::move(leaves));
+        }
+    } catch (const ndn::tlv::Error& e) {
+        std::cout << "Malformed TreeDescriptor: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
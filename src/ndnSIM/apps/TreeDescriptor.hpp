@@ -0,0 +1,59 @@
+#pragma once
+
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/name.hpp>
+#include <boost/dynamic_bitset.hpp>
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
+
+/**
+ * Binary descriptor of one aggregator's sub-tree, carried in ApplicationParameters of "initialization" interests:
+ *
+ *   TreeDescriptor = TREE_DESCRIPTOR TLV-LENGTH
+ *                      NumProducers
+ *                      *Child
+ *   NumProducers   = NUM_PRODUCERS TLV-LENGTH NonNegativeInteger
+ *   Child          = CHILD TLV-LENGTH ChildName LeafBitmap
+ *   ChildName      = CHILD_NAME TLV-LENGTH *OCTET
+ *   LeafBitmap     = LEAF_BITMAP TLV-LENGTH BitmapOffset BitmapValue
+ *   BitmapOffset   = BITMAP_OFFSET TLV-LENGTH NonNegativeInteger
+ *   BitmapValue    = BITMAP_VALUE TLV-LENGTH *OCTET
+ *
+ * Leaf sets are bitmaps over producer indices assigned by the consumer, bit i of the bitmap is bit (i % 8) of
+ * byte (i / 8). Zero bytes at both ends are trimmed, BitmapOffset is the index of the first byte kept.
+ * The same LeafBitmap block is the third name component of "data" interests ("/NextHop/Job/LeafBitmap/data/Seq"),
+ * so aggregators split interests by intersecting bitmaps instead of comparing producer names.
+ * The Job component keeps the trees and sequence spaces of concurrent training jobs apart.
+ */
+namespace TreeDescriptorFormat {
+    const uint32_t TREE_DESCRIPTOR = 200;
+    const uint32_t NUM_PRODUCERS = 201;
+    const uint32_t CHILD = 202;
+    const uint32_t CHILD_NAME = 203;
+    const uint32_t LEAF_BITMAP = 204;
+    const uint32_t BITMAP_OFFSET = 205;
+    const uint32_t BITMAP_VALUE = 206;
+};
+
+using LeafBitmap = boost::dynamic_bitset<>;
+
+ndn::Block encodeLeafBitmap(const LeafBitmap& bitmap);
+bool decodeLeafBitmap(const ndn::Block& block, size_t numProducers, LeafBitmap& bitmap);
+
+ndn::name::Component makeLeafComponent(const LeafBitmap& bitmap);
+bool parseLeafComponent(const ndn::name::Component& component, size_t numProducers, LeafBitmap& bitmap);
+
+// Interests carrying ApplicationParameters end with a ParametersSha256Digest component, return the name without it
+ndn::Name stripParametersDigest(const ndn::Name& name);
+
+struct TreeDescriptor {
+    uint32_t numProducers = 0;
+    std::vector<std::pair<std::string, LeafBitmap>> children; // Child node and the producers reached through it
+
+    ndn::Block wireEncode() const;
+
+    // Accept either the TreeDescriptor block or the ApplicationParameters block containing it
+    bool wireDecode(const ndn::Block& block);
+};
@@ -1,3 +1,6 @@
+#ifndef AGGREGATION_TREE_H_
+#define AGGREGATION_TREE_H_
+
 #include <iostream>
 #include <vector>
 #include <cmath> // For ceil
@@ -14,24 +17,74 @@
 #include <set>
 #include <algorithm>
 
+#include "../utility/utility.hpp"
+
 class AggregationTree {
 public:
-    AggregationTree(std::string file);
+    // Changes of the network since the tree was built, nodes are given by name
+    struct TreeChange {
+        std::vector<std::string> joinedProducers;
+        std::vector<std::string> leftProducers;
+        std::vector<std::string> joinedAggregators;
+        std::vector<std::string> leftAggregators;
+        bool linkChanged = false; // Topology file has been updated, link costs are recomputed
+    };
+
+    AggregationTree(std::string file, std::string client = "con0");
     virtual ~AggregationTree(){};
 
     std::string findCH(std::vector<std::string> clusterNodes, std::vector<std::string> clusterHeadCandidate, std::string client);
 
+    int findCH(const std::vector<int>& clusterNodes, const std::vector<int>& clusterHeadCandidate, int client) const;
+
     bool aggregationTreeConstruction(std::vector<std::string> dataPointNames, int C);
 
+    bool aggregationTreeConstruction(const std::vector<int>& dataPoints, int C);
+
+    bool aggregationTreeRepair(const TreeChange& change);
+
     // Global variables
     std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> graph;
     //std::string filename = "src/ndnSIM/examples/topologies/DataCenterTopology.txt";
     std::string filename;
     std::vector<std::string> fullList;
-    std::vector<std::string> CHList;
-    std::string globalClient = "con0";
+    std::vector<int> CHList; // Ids of CH candidates inside "costMatrix", in the order of "fullList"
+    std::string globalClient; // Consumer of the job, root of the tree
+    int runs = 4; // Number of independent restarts of balanced k-means for each layer
     std::map<std::string, std::vector<std::string>> aggregationAllocation;
     std::vector<std::vector<std::string>> noCHTree;
-    std::map<std::string, std::map<std::string, int>> linkCostMatrix;
+    Utility::CostMatrix costMatrix;
+
+private:
+    std::vector<std::string> toNames(const std::vector<int>& ids) const;
+
+    std::vector<std::vector<int>> solveClusters(const std::vector<int>& dataPoints, int numClusters, const std::vector<int>& initialAssignments);
+
+    int assignCH(const std::vector<int>& clusterNodes);
+
+    void releaseCH(int node);
+
+    void updateCHList();
+
+    bool buildUpperLayers();
+
+    void composeTree();
+
+    bool reloadCostMatrix(std::vector<bool>& affected);
+
+    // Bottom layer, clusters of producers and their CHs (client id if no CH is found), kept for repair
+    int constraint = 0;
+    int client = -1;
+    std::vector<std::vector<int>> dataClusters;
+    std::vector<int> dataClusterHeads;
+    std::vector<bool> isCandidate; // Whether a node is still available as CH
+    std::vector<bool> isExcluded; // Aggregators that left
+    // Layers above the bottom one
+    std::vector<int> upperHeads;
+    std::map<std::string, std::vector<std::string>> upperAllocation;
+    std::vector<std::vector<std::string>> upperNoCHTree;
+    bool clientTakesSubTree = false;
+
+};
 
-};
\ No newline at end of file
+#endif  // AGGREGATION_TREE_H_
@@ -6,35 +6,46 @@
 #include <map>
 #include <string>
 
+#include "../utility/utility.hpp"
+
+// Data points are node ids of the cost matrix, distances are read from the matrix directly
 class KMeans {
 public:
     enum InitMethod { kForgy, kRandomPartition };
-    KMeans(const std::vector<std::string>& data, int k,
+    KMeans(const std::vector<int>& data, int k, const Utility::CostMatrix& cost_matrix,
            InitMethod init_method, unsigned int seed);
-    const std::vector<std::vector<std::string>>& cluster_centers() const;
+    const std::vector<std::vector<int>>& cluster_centers() const;
     const std::vector<int>& assignments() const;
-    double GetSumSquaredError(const std::map<std::string, std::map<std::string, int>> linkCostMatrix) const;
-    std::vector<std::vector<std::string>> clusters;
+    double GetSumSquaredError() const;
+    // Start from given assignments instead of a random one, e.g. the current clustering when repairing a tree
+    void SetInitialAssignments(const std::vector<int>& assignments);
+    std::vector<std::vector<int>> clusters;
 
 protected:
     void Init();
-    int CalDistance(const std::string& data1,
-                    const std::string& data2,
-                    std::map<std::string, std::map<std::string, int>> linkCostMatrix) const;
-    int CalDistance(const std::string& data1,
-                    const std::vector<std::string>& clu,
-                    std::map<std::string, std::map<std::string, int>> linkCostMatrix) const;
+    int CalDistance(int data1, int data2) const;
+    // Average distance between data point i and all members of cluster j
+    int CalClusterDistance(int i, int j) const;
     void UpdateClusterCenter();
     void InitWithRandomCenter();
     void InitWithRandomAssignment();
+    void ResetDistanceSums();
+    void MovePoint(int point, int from, int to);
     const int n_;
     // const int s_;
     const int k_;
-    const std::vector<std::string> data_;
+    const std::vector<int> data_;
+    const Utility::CostMatrix& cost_matrix_;
     InitMethod init_method_;
     const unsigned int seed_;
     std::vector<int> assignments_;
+    std::vector<int> initial_assignments_;
     std::default_random_engine el_;
+    // Sum of distances from all members of cluster j to data point i, stored at [i * k_ + j]
+    std::vector<long long> distance_sums_;
+    std::vector<int> cluster_sizes_;
+    // Assignments the distance sums correspond to
+    std::vector<int> sum_assignments_;
 };
 
 #endif  // K_MEANS_H_
@@ -45,6 +45,8 @@ private:
     int n_;
     int k_;
     static constexpr double kEps = 1e-6;
+    static constexpr int kMinBlockSize = 10;
+    static constexpr double kBlockSizeFactor = 0.0625;
 };
 
 #endif  // NETWORK_SIMPLEX_H_
@@ -10,8 +10,8 @@
 
 class RegularizedKMeans : public KMeans {
 public:
-    RegularizedKMeans(const std::vector<std::string>& data, int k,
-                      std::map<std::string, std::map<std::string, int>> costMatrix,
+    RegularizedKMeans(const std::vector<int>& data, int k,
+                      const Utility::CostMatrix& costMatrix,
                       InitMethod init_method = KMeans::kForgy,
                       bool warm_start = true, int n_jobs = 1,
                       unsigned int seed = std::random_device{}());
@@ -25,7 +25,6 @@ protected:
     const bool warm_start_;
     const int n_jobs_;
     std::vector<std::vector<double>> costs_;
-    std::map<std::string, std::map<std::string, int>> linkCostMatrix;
 };
 
 #endif  // REGULARIZED_K_MEANS_H_
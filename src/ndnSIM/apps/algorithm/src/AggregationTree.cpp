@@ -1,6 +1,7 @@
 #include "../include/AggregationTree.hpp"
 #include "../include/regularized_k_means.hpp"
 #include "../utility/utility.hpp"
+#include "../utility/thread_pool.hpp"
 
 #include <iostream>
 #include <cmath> // For ceil
@@ -24,27 +25,76 @@
 
 
 
-AggregationTree::AggregationTree(std::string file){
+AggregationTree::AggregationTree(std::string file, std::string client){
     filename = file;
+    globalClient = client;
     fullList = Utility::getContextInfo(filename);
-    CHList = fullList;
-    linkCostMatrix = Utility::GetAllLinkCost(filename);
+    costMatrix = Utility::GetLinkCostMatrix(filename);
+    isCandidate.assign(costMatrix.size(), false);
+    isExcluded.assign(costMatrix.size(), false);
+    for (const auto& node : fullList) {
+        int id = costMatrix.id(node);
+        if (id != -1) {
+            isCandidate[id] = true;
+        }
+    }
+    updateCHList();
     //graph = Utility::initializeGraph(filename);
     //std::cout << "Finish initialization!" << std::endl;
 }
 
 
+
+std::vector<std::string> AggregationTree::toNames(const std::vector<int>& ids) const {
+    std::vector<std::string> names;
+    names.reserve(ids.size());
+    for (int id : ids) {
+        names.push_back(costMatrix.name(id));
+    }
+    return names;
+}
+
+
+
+// Rebuild CHList from "isCandidate", keeping the order of "fullList"
+void AggregationTree::updateCHList() {
+    CHList.clear();
+    for (const auto& node : fullList) {
+        int id = costMatrix.id(node);
+        if (id != -1 && isCandidate[id]) {
+            CHList.push_back(id);
+        }
+    }
+}
+
+
+
 std::string AggregationTree::findCH(std::vector<std::string> clusterNodes, std::vector<std::string> clusterHeadCandidate, std::string client) {
+    std::vector<int> nodeIds;
+    std::vector<int> candidateIds;
+    for (const auto& node : clusterNodes) {
+        nodeIds.push_back(costMatrix.id(node));
+    }
+    for (const auto& candidate : clusterHeadCandidate) {
+        candidateIds.push_back(costMatrix.id(candidate));
+    }
+    int clientId = costMatrix.id(client);
+    int CH = findCH(nodeIds, candidateIds, clientId);
+    return CH == clientId ? client : costMatrix.name(CH);
+}
 
-    std::string CH = client;
+
+int AggregationTree::findCH(const std::vector<int>& clusterNodes, const std::vector<int>& clusterHeadCandidate, int client) const {
+
+    int CH = client;
     // Initiate a large enough cost
-    int leastCost = 1000;
+    int leastCost = INT_MAX;
 
-    for (const auto& headCandidate : clusterHeadCandidate) {
+    for (int headCandidate : clusterHeadCandidate) {
         bool canBeCH = true;
 
-        for (const auto& node : clusterNodes) {
-            if (linkCostMatrix[node][client] < linkCostMatrix[node][headCandidate]) {
+        for (int node : clusterNodes) {
+            if (costMatrix.at(node, client) < costMatrix.at(node, headCandidate)) {
                 canBeCH = false;
                 break;
             }
@@ -53,10 +103,10 @@ std::string AggregationTree::findCH(std::vector<std::string> clusterNodes, std::
         // This candidate is closer to client
         long long totalCost = 0;
         if (canBeCH) {
-            for (const auto& node : clusterNodes) {
-                totalCost += linkCostMatrix[node][headCandidate];
+            for (int node : clusterNodes) {
+                totalCost += costMatrix.at(node, headCandidate);
             }
-            int averageCost = static_cast<int>(totalCost / clusterNodes.size());
+            int averageCost = static_cast<int>(totalCost / static_cast<long long>(clusterNodes.size()));
 
             if (averageCost < leastCost) {
                 leastCost = averageCost;
@@ -69,7 +119,7 @@ std::string AggregationTree::findCH(std::vector<std::string> clusterNodes, std::
         std::cerr << "No CH is found for current cluster!!!!!!!!!!!" << std::endl;
         return CH;
     } else {
-        std::cout << "CH " << CH << " is chosen." << std::endl;
+        std::cout << "CH " << costMatrix.name(CH) << " is chosen." << std::endl;
         return CH;
     }
 
@@ -78,129 +128,448 @@ std::string AggregationTree::findCH(std::vector<std::string> clusterNodes, std::
 
 // End of cluster head construction
 
+/**
+ * Pick CH for given cluster among the current candidates, the chosen CH is no longer a candidate
+ * @param clusterNodes
+ * @return CH id, "client" if no CH is found
+ */
+int AggregationTree::assignCH(const std::vector<int>& clusterNodes) {
+    int clusterHead = findCH(clusterNodes, CHList, client);
+    // "globalClient" doesn't exist in candidate list, if CH == globalClient, it means no CH is found
+    if (clusterHead != client) {
+        isCandidate[clusterHead] = false;
+        CHList.erase(std::remove(CHList.begin(), CHList.end(), clusterHead), CHList.end());
+    }
+    return clusterHead;
+}
+
+
+
+// Make a CH available again, unless it has left
+void AggregationTree::releaseCH(int node) {
+    if (node != client && !isExcluded[node]) {
+        isCandidate[node] = true;
+    }
+}
+
+
+
+/**
+ * Balanced k-means on given data points
+ * @param dataPoints
+ * @param numClusters
+ * @param initialAssignments Warm start, if empty, "runs" random restarts are performed in parallel and the one with least SSE is kept
+ * @return Clusters of node ids
+ */
+std::vector<std::vector<int>> AggregationTree::solveClusters(const std::vector<int>& dataPoints, int numClusters, const std::vector<int>& initialAssignments) {
+    bool no_warm_start = false; // must have warm start
+    unsigned int seed = std::random_device{}(); // seed for initialization, restart r uses seed + r
+    RegularizedKMeans::InitMethod init_method = RegularizedKMeans::InitMethod::kForgy;
+
+    int numRuns = initialAssignments.empty() ? std::max(runs, 1) : 1;
+    std::vector<double> results(numRuns);
+    std::vector<std::vector<std::vector<int>>> runClusters(numRuns);
+    Utility::ThreadPool::Shared().ParallelFor(0, numRuns, [&](int run, int) {
+        RegularizedKMeans rkm(dataPoints, numClusters, costMatrix, init_method, !no_warm_start, 1, seed + run);
+        rkm.SetInitialAssignments(initialAssignments);
+        results[run] = rkm.SolveHard();
+        runClusters[run] = std::move(rkm.clusters);
+    });
+    int bestRun = static_cast<int>(std::min_element(results.begin(), results.end()) - results.begin());
+
+    // Empty clusters are dropped
+    std::vector<std::vector<int>> newCluster;
+    for (auto& cluster : runClusters[bestRun]) {
+        if (!cluster.empty()) {
+            newCluster.push_back(std::move(cluster));
+        }
+    }
+
+    int i = 0;
+    std::cout << "\nIterating new clusters." << std::endl;
+    for (const auto& iteCluster: newCluster) {
+        std::cout << "Cluster " << i << " contains the following nodes:" <<std::endl;
+        for (int iteNode: iteCluster) {
+            std::cout << costMatrix.name(iteNode) << " ";
+        }
+        std::cout << std::endl;
+        ++i;
+    }
+    return newCluster;
+}
+
+
+
 bool AggregationTree::aggregationTreeConstruction(std::vector<std::string> dataPointNames, int C) {
+    std::vector<int> dataPoints;
+    dataPoints.reserve(dataPointNames.size());
+    for (const auto& name : dataPointNames) {
+        int id = costMatrix.id(name);
+        if (id == -1) {
+            std::cerr << "Node " << name << " doesn't exist in link cost matrix!" << std::endl;
+            return false;
+        }
+        dataPoints.push_back(id);
+    }
+    return aggregationTreeConstruction(dataPoints, C);
+}
+
+
+bool AggregationTree::aggregationTreeConstruction(const std::vector<int>& dataPoints, int C) {
 
     // Compute N
-    int N = dataPointNames.size();
+    int N = dataPoints.size();
+    client = costMatrix.id(globalClient);
+    if (N == 0 || C <= 0 || client == -1) {
+        std::cerr << "Invalid input for aggregation tree construction!" << std::endl;
+        return false;
+    }
+    constraint = C;
 
     // Compute the number of clusters k
     int numClusters = static_cast<int>(ceil(static_cast<double>(N) / C));
 
-    // Create a vector to store cluster assignments
-    std::vector<int> clusterAssignment(N);
-    for (int i = 0; i < N; ++i) {
-        clusterAssignment[i] = i % numClusters; // Cluster assignment based on modulus operation
+    // BKM on the bottom layer
+    dataClusters = solveClusters(dataPoints, numClusters, {});
+    for (const auto& cluster : dataClusters) {
+        for (int node : cluster) {
+            isCandidate[node] = false;
+        }
     }
+    updateCHList();
+
+    // Start CH allocation
+    std::cout << "\nStarting CH allocation." << std::endl;
+    dataClusterHeads.clear();
+    for (const auto& clusterNodes : dataClusters) {
+        dataClusterHeads.push_back(assignCH(clusterNodes));
+    }
+
+    return buildUpperLayers();
+}
 
-/*    // Output the cluster assignments
-    std::cout << "Cluster initialization." << std::endl;
-    std::cout << "There are " << numClusters << " clusters." << std::endl;
-    for (int i = 0; i < N; ++i) {
-        std::cout << "Data point " << dataPointNames[i] << " is in cluster " << clusterAssignment[i] << std::endl;
-    }*/
 
-    // Create a map of clusters to their data points, store data point's ID inside cluster's vector
-    std::vector<std::vector<std::string>> clusters(numClusters);
-    for (int i = 0; i < N; ++i) {
-        clusters[clusterAssignment[i]].push_back(dataPointNames[i]);
+
+/**
+ * Construct the layers above the bottom one from CHs of the bottom layer
+ * @return Whether tree is constructed
+ */
+bool AggregationTree::buildUpperLayers() {
+    for (int head : upperHeads) {
+        releaseCH(head);
+    }
+    upperHeads.clear();
+    upperAllocation.clear();
+    upperNoCHTree.clear();
+    clientTakesSubTree = false;
+    updateCHList();
+
+    std::vector<int> newDataPoints;
+    for (int head : dataClusterHeads) {
+        if (head != client) {
+            newDataPoints.push_back(head);
+        }
     }
 
-    // Start of balanced K-Means
-    // Get the output at current layer (data point allocation for each cluster)
-    //BalancedKMeans BKM;
-    //std::vector<std::vector<std::string>> newCluster = BKM.balancedKMeans(N, C, numClusters, clusterAssignment, dataPointNames, clusters, linkCostMatrix);
+    // If newDataPoints are more than C, perform tree construction for next layer
+    while (static_cast<int>(newDataPoints.size()) >= constraint) {
+        int numClusters = static_cast<int>(ceil(static_cast<double>(newDataPoints.size()) / constraint));
+        auto newCluster = solveClusters(newDataPoints, numClusters, {});
+
+        std::vector<int> nextDataPoints;
+        std::cout << "\nStarting CH allocation." << std::endl;
+        for (const auto& clusterNodes : newCluster) {
+            int clusterHead = assignCH(clusterNodes);
+            if (clusterHead != client) {
+                upperHeads.push_back(clusterHead);
+                upperAllocation[costMatrix.name(clusterHead)] = toNames(clusterNodes);
+                nextDataPoints.push_back(clusterHead);
+            } else {
+                std::cout << "No cluster head found for current cluster, combine them into sub-tree." << std::endl;
+                upperNoCHTree.push_back(toNames(clusterNodes));
+            }
+        }
+        newDataPoints = std::move(nextDataPoints);
+    }
 
+    if (newDataPoints.empty()) {
+        // If all clusters can't find CH, allocate the first sub-tree to aggregationAllocation for first round, then iterate other sub-trees in later rounds
+        clientTakesSubTree = true;
+    } else {
+        // If some clusters can find CH, put them into aggregationAllocation for first round, iterate other sub-trees in later rounds
+        upperAllocation[globalClient] = toNames(newDataPoints);
+    }
 
+    composeTree();
+    if (aggregationAllocation.find(globalClient) == aggregationAllocation.end()) {
+        std::cerr << "Fail to construct aggregation tree, no child is found for " << globalClient << std::endl;
+        return false;
+    }
 
+    std::cout << "\nThe rest CH candidates after CH allocation: " << std::endl;
+    for (int item : CHList) {
+        std::cout << costMatrix.name(item) << std::endl;
+    }
+    return true;
+}
 
 
-    // BKM begins...
-    //std::string file = "../data/ndn_test.csv"; // input file
-    //std::string assignment_file = "assignments";
-    //std::string cluster_center_file = "clusters";
-    //std::string summary_file = "summary.txt";
-    int runs = 1; // number of repeat
-    //int k = 4; // number of clusters
-    int threads = -1; // default, auto-detect
-    bool no_warm_start = false; // must have warm start
-    unsigned int seed = std::random_device{}(); // seed for initialization
-    RegularizedKMeans::InitMethod init_method = RegularizedKMeans::InitMethod::kForgy;
 
+// Compose public outputs from the bottom layer and the layers above it
+void AggregationTree::composeTree() {
+    aggregationAllocation = upperAllocation;
+    noCHTree.clear();
+    for (size_t i = 0; i < dataClusters.size(); ++i) {
+        if (dataClusterHeads[i] != client) {
+            aggregationAllocation[costMatrix.name(dataClusterHeads[i])] = toNames(dataClusters[i]);
+        } else {
+            std::cout << "No cluster head found for current cluster, combine them into sub-tree." << std::endl;
+            noCHTree.push_back(toNames(dataClusters[i]));
+        }
+    }
+    noCHTree.insert(noCHTree.end(), upperNoCHTree.begin(), upperNoCHTree.end());
 
-    //auto data = ReadData(file);
-    //auto start_time = std::chrono::high_resolution_clock::now();
-    double result;
-    KMeans* k_means;
-    auto* rkm = new RegularizedKMeans(
-            dataPointNames, numClusters,linkCostMatrix, init_method, !no_warm_start,
-            threads, seed);
-    result = rkm->SolveHard();
-    k_means = rkm;
-    //delete k_means;
+    if (clientTakesSubTree && !noCHTree.empty()) {
+        // Move the first sub-tree to "aggregationAllocation"
+        aggregationAllocation[globalClient] = noCHTree[0];
+        noCHTree.erase(noCHTree.begin());
+    }
+}
 
-    // BKM finish...
 
-    std::vector<std::vector<std::string>> newCluster = k_means->clusters;
 
-    // Construct the nodeList for CH allocation
-    int i = 0;
-    std::cout << "\nIterating new clusters." << std::endl;
-    for (const auto& iteCluster: newCluster) {
-        std::cout << "Cluster " << i << " contains the following nodes:" <<std::endl;
-        for (const auto& iteNode: iteCluster) {
-            CHList.erase(std::remove(CHList.begin(), CHList.end(), iteNode), CHList.end());
-            std::cout << iteNode << " ";
+/**
+ * Recompute link costs after topology file changed, and map current state onto the new node ids
+ * @param affected Output, bottom clusters whose link costs changed
+ * @return False if the client doesn't exist anymore
+ */
+bool AggregationTree::reloadCostMatrix(std::vector<bool>& affected) {
+    Utility::CostMatrix oldMatrix = std::move(costMatrix);
+    int oldClient = client;
+    costMatrix = Utility::GetLinkCostMatrix(filename);
+    fullList = Utility::getContextInfo(filename);
+    client = costMatrix.id(globalClient);
+    if (client == -1) {
+        std::cerr << "Client " << globalClient << " doesn't exist in link cost matrix!" << std::endl;
+        return false;
+    }
+
+    auto remap = [&](int oldId) {
+        return oldId == oldClient ? client : costMatrix.id(oldMatrix.name(oldId));
+    };
+
+    std::vector<bool> candidate(costMatrix.size(), false);
+    std::vector<bool> excluded(costMatrix.size(), false);
+    for (const auto& node : fullList) {
+        int id = costMatrix.id(node);
+        int oldId = oldMatrix.id(node);
+        if (id != -1) {
+            candidate[id] = (oldId == -1) || isCandidate[oldId]; // New nodes are candidates
+            excluded[id] = (oldId != -1) && isExcluded[oldId];
         }
-        std::cout << std::endl;
-        ++i;
+    }
+    isCandidate = std::move(candidate);
+    isExcluded = std::move(excluded);
+
+    for (size_t c = 0; c < dataClusters.size(); ++c) {
+        int oldHead = dataClusterHeads[c];
+        int head = remap(oldHead);
+        std::vector<int> cluster;
+        for (int oldNode : dataClusters[c]) {
+            int node = remap(oldNode);
+            if (node == -1) {
+                affected[c] = true; // Producer has been removed from the topology
+                continue;
+            }
+            if (head == -1 || oldMatrix.at(oldNode, oldHead) != costMatrix.at(node, head) || oldMatrix.at(oldNode, oldClient) != costMatrix.at(node, client)) {
+                affected[c] = true;
+            }
+            cluster.push_back(node);
+        }
+        dataClusters[c] = std::move(cluster);
+        dataClusterHeads[c] = (head == -1) ? client : head;
     }
 
+    std::vector<int> heads;
+    for (int oldHead : upperHeads) {
+        int head = remap(oldHead);
+        if (head != -1) {
+            heads.push_back(head);
+        }
+    }
+    upperHeads = std::move(heads);
+    return true;
+}
+
 
-    std::cout << "\nCurrent CH candidates: " << std::endl;
-    for (const auto& item : CHList) {
-        std::cout << item << std::endl;
+
+/**
+ * Repair the tree after producers/aggregators join or leave, or link costs change.
+ * Only bottom clusters affected by the change are re-solved, warm-started from their current assignment;
+ * layers above are rebuilt only if the set of bottom CHs changed.
+ * @param change
+ * @return Whether tree is repaired
+ */
+bool AggregationTree::aggregationTreeRepair(const TreeChange& change) {
+    if (client == -1) {
+        std::cerr << "Aggregation tree hasn't been constructed yet!" << std::endl;
+        return false;
     }
 
-    // Start CH allocation
-    std::vector<std::string> newDataPoints;
-    std::cout << "\nStarting CH allocation." << std::endl;
-    for (const auto& clusterNodes : newCluster) {
-        std::string clusterHead = findCH(clusterNodes, CHList, globalClient);
-         // "globalClient" doesn't exist in candidate list, if CH == globalClient, it means no CH is found
-        if (clusterHead != globalClient) {
-            CHList.erase(std::remove(CHList.begin(), CHList.end(), clusterHead), CHList.end());
-            aggregationAllocation[clusterHead] = clusterNodes;
-            newDataPoints.push_back(clusterHead); // If newDataPoints are more than C, perform tree construction for next layer
-        }
-        else {
-            std::cout << "No cluster head found for current cluster, combine them into sub-tree." << std::endl;
-            noCHTree.push_back(clusterNodes);
+    std::vector<bool> affected(dataClusters.size(), false);
+    bool upperInvalid = change.linkChanged;
+    std::vector<int> oldHeads = dataClusterHeads;
+
+    if (change.linkChanged && !reloadCostMatrix(affected)) {
+        return false;
+    }
+
+    // Cluster of each producer
+    std::vector<int> clusterOf(costMatrix.size(), -1);
+    for (size_t c = 0; c < dataClusters.size(); ++c) {
+        for (int node : dataClusters[c]) {
+            clusterOf[node] = static_cast<int>(c);
         }
+    }
 
+    for (const auto& name : change.leftAggregators) {
+        int id = costMatrix.id(name);
+        if (id == -1 || id == client) {
+            continue;
+        }
+        isExcluded[id] = true;
+        isCandidate[id] = false;
+        for (size_t c = 0; c < dataClusters.size(); ++c) {
+            if (dataClusterHeads[c] == id) {
+                affected[c] = true;
+            }
+        }
+        if (std::find(upperHeads.begin(), upperHeads.end(), id) != upperHeads.end()) {
+            upperInvalid = true;
+        }
     }
 
-    std::cout << "\nThe rest CH candidates after CH allocation: " << std::endl;
-    for (const auto& item : CHList) {
-        std::cout << item << std::endl;
+    for (const auto& name : change.joinedAggregators) {
+        int id = costMatrix.id(name);
+        if (id == -1 || id == client) {
+            continue;
+        }
+        isExcluded[id] = false;
+        bool inUse = clusterOf[id] != -1 || std::find(dataClusterHeads.begin(), dataClusterHeads.end(), id) != dataClusterHeads.end();
+        if (!inUse) {
+            isCandidate[id] = true;
+        }
+        // Clusters without CH may find one now
+        for (size_t c = 0; c < dataClusters.size(); ++c) {
+            if (dataClusterHeads[c] == client) {
+                affected[c] = true;
+            }
+        }
     }
 
+    for (const auto& name : change.leftProducers) {
+        int id = costMatrix.id(name);
+        if (id == -1 || clusterOf[id] == -1) {
+            continue;
+        }
+        auto& cluster = dataClusters[clusterOf[id]];
+        cluster.erase(std::remove(cluster.begin(), cluster.end(), id), cluster.end());
+        affected[clusterOf[id]] = true;
+        clusterOf[id] = -1;
+    }
 
+    for (const auto& name : change.joinedProducers) {
+        int id = costMatrix.id(name);
+        if (id == -1 || clusterOf[id] != -1) {
+            continue;
+        }
+        isCandidate[id] = false;
+
+        // Join the closest cluster, re-solving splits it if it's full
+        int closest = -1;
+        long long leastCost = LLONG_MAX;
+        for (size_t c = 0; c < dataClusters.size(); ++c) {
+            if (dataClusters[c].empty()) {
+                continue;
+            }
+            long long totalCost = 0;
+            for (int node : dataClusters[c]) {
+                totalCost += costMatrix.at(node, id);
+            }
+            long long averageCost = totalCost / static_cast<long long>(dataClusters[c].size());
+            if (averageCost < leastCost) {
+                leastCost = averageCost;
+                closest = static_cast<int>(c);
+            }
+        }
+        if (closest == -1) {
+            dataClusters.emplace_back();
+            dataClusterHeads.push_back(client);
+            affected.push_back(true);
+            closest = static_cast<int>(dataClusters.size()) - 1;
+        }
+        dataClusters[closest].push_back(id);
+        affected[closest] = true;
+        clusterOf[id] = closest;
+    }
 
-    if (newDataPoints.size() < C){
+    // Re-solve affected clusters together, warm-started from the cluster each point is currently in
+    std::vector<int> points;
+    std::vector<int> initialAssignments;
+    std::vector<std::vector<int>> keptClusters;
+    std::vector<int> keptHeads;
+    int numAffected = 0;
+    for (size_t c = 0; c < dataClusters.size(); ++c) {
+        if (!affected[c]) {
+            keptClusters.push_back(std::move(dataClusters[c]));
+            keptHeads.push_back(dataClusterHeads[c]);
+            continue;
+        }
+        releaseCH(dataClusterHeads[c]);
+        if (dataClusters[c].empty()) {
+            continue;
+        }
+        for (int node : dataClusters[c]) {
+            points.push_back(node);
+            initialAssignments.push_back(numAffected);
+        }
+        ++numAffected;
+    }
+    updateCHList();
+
+    dataClusters = std::move(keptClusters);
+    dataClusterHeads = std::move(keptHeads);
+    if (!points.empty()) {
+        int numClusters = static_cast<int>(ceil(static_cast<double>(points.size()) / constraint));
+        std::vector<std::vector<int>> newCluster;
+        if (numClusters == 1) {
+            newCluster.push_back(points);
+        } else {
+            for (auto& assignment : initialAssignments) {
+                assignment %= numClusters;
+            }
+            newCluster = solveClusters(points, numClusters, initialAssignments);
+        }
 
-        if (newDataPoints.empty()) // If all clusters can't find CH, allocate the first sub-tree to aggregationAllocation for first round, then iterate other sub-trees in later rounds
-        {
-            // Move the first sub-tree to "aggregationAllocation"
-            const auto& firstSubTree = noCHTree[0];
-            aggregationAllocation[globalClient] = firstSubTree;
-            noCHTree.erase(noCHTree.begin());
-            return true;
-        } else // If some clusters can find CH, put them into aggregationAllocation for first round, iterate other sub-trees in later rounds
-        {
-            aggregationAllocation[globalClient] = newDataPoints;
-            return true;
+        std::cout << "\nStarting CH allocation for repaired clusters." << std::endl;
+        for (auto& clusterNodes : newCluster) {
+            dataClusterHeads.push_back(assignCH(clusterNodes));
+            dataClusters.push_back(std::move(clusterNodes));
         }
-    } else {
-        aggregationTreeConstruction(newDataPoints, C);
     }
+
+    if (dataClusters.empty()) {
+        std::cerr << "No producer is left in aggregation tree!" << std::endl;
+        return false;
+    }
+
+    // Layers above only depend on the set of bottom CHs
+    std::vector<int> newHeads = dataClusterHeads;
+    std::sort(oldHeads.begin(), oldHeads.end());
+    std::sort(newHeads.begin(), newHeads.end());
+    if (upperInvalid || oldHeads != newHeads) {
+        return buildUpperLayers();
+    }
+    composeTree();
+    return true;
 }
@@ -3,19 +3,20 @@
 // Pseudo-random number generation
 std::random_device rd;
 
-KMeans::KMeans(const std::vector<std::string>& data, int k,
+KMeans::KMeans(const std::vector<int>& data, int k, const Utility::CostMatrix& cost_matrix,
                InitMethod init_method, unsigned int seed)
-        : data_(data),
+        : clusters(std::vector<std::vector<int>>(k)), // initialization of clusters
           n_(static_cast<int>(data.size())),
         // Do not have feature in each data point.
         // s_(static_cast<int>(data.front().size())),
           k_(k),
-          clusters(std::vector<std::vector<std::string>>(k)), // initialization of clusters
+          data_(data),
+          cost_matrix_(cost_matrix),
           init_method_(init_method),
-          el_(seed),
-          seed_(seed) {}
+          seed_(seed),
+          el_(seed) {}
 
-const std::vector<std::vector<std::string>>& KMeans::cluster_centers() const {
+const std::vector<std::vector<int>>& KMeans::cluster_centers() const {
     return this->clusters;
 }
 
@@ -24,26 +25,29 @@ const std::vector<int>& KMeans::assignments() const {
 }
 
 // todo: Done!
-int KMeans::CalDistance(const std::string& data1,
-                        const std::string& data2,
-                        std::map<std::string, std::map<std::string, int>> linkCostMatrix) const {
-    return linkCostMatrix[data1][data2];
+int KMeans::CalDistance(int data1, int data2) const {
+    return cost_matrix_.at(data1, data2);
 }
 
-// todo: Done!
-int KMeans::CalDistance(const std::string& data1,
-                        const std::vector<std::string>& cluster,
-                        std::map<std::string, std::map<std::string, int>> linkCostMatrix) const {
-    int distance = 0;
-    for (const auto& node : cluster) {
-        distance += linkCostMatrix[node][data1];
+// Average is read from the maintained distance sums instead of iterating the cluster
+int KMeans::CalClusterDistance(int i, int j) const {
+    if (cluster_sizes_[j] == 0) {
+        return 0;
     }
-    distance = distance / cluster.size();
-    return distance;
+    return static_cast<int>(distance_sums_[static_cast<size_t>(i) * k_ + j] / cluster_sizes_[j]);
+}
+
+void KMeans::SetInitialAssignments(const std::vector<int>& assignments) {
+    initial_assignments_ = assignments;
 }
 
 void KMeans::Init() {
-    InitWithRandomAssignment();
+    if (static_cast<int>(initial_assignments_.size()) == n_) {
+        assignments_ = initial_assignments_;
+    } else {
+        InitWithRandomAssignment();
+    }
+    ResetDistanceSums();
     switch (init_method_) {
         case kForgy:
             InitWithRandomCenter();
@@ -54,8 +58,42 @@ void KMeans::Init() {
     }
 }
 
+// Recompute distance sums of the current assignments from scratch
+void KMeans::ResetDistanceSums() {
+    distance_sums_.assign(static_cast<size_t>(n_) * k_, 0);
+    cluster_sizes_.assign(k_, 0);
+    for (int m = 0; m < n_; ++m) {
+        const int* row = cost_matrix_.row(data_[m]);
+        long long* sums = distance_sums_.data() + assignments_[m];
+        for (int i = 0; i < n_; ++i) {
+            sums[static_cast<size_t>(i) * k_] += row[data_[i]];
+        }
+        ++cluster_sizes_[assignments_[m]];
+    }
+    sum_assignments_ = assignments_;
+}
+
+// Move one member between clusters, only the two affected columns of distance sums change
+void KMeans::MovePoint(int point, int from, int to) {
+    const int* row = cost_matrix_.row(data_[point]);
+    for (int i = 0; i < n_; ++i) {
+        long long* sums = distance_sums_.data() + static_cast<size_t>(i) * k_;
+        sums[from] -= row[data_[i]];
+        sums[to] += row[data_[i]];
+    }
+    --cluster_sizes_[from];
+    ++cluster_sizes_[to];
+}
+
 // update the clusters according to the new results assignment
 void KMeans::UpdateClusterCenter() {
+    for (int i = 0; i < n_; ++i) {
+        if (sum_assignments_[i] != assignments_[i]) {
+            MovePoint(i, sum_assignments_[i], assignments_[i]);
+            sum_assignments_[i] = assignments_[i];
+        }
+    }
+
     clusters.clear();
     clusters.resize(k_);
     for (int i = 0; i < n_; ++i) {
@@ -63,17 +101,18 @@ void KMeans::UpdateClusterCenter() {
     }
 }
 
-double KMeans::GetSumSquaredError(const std::map<std::string, std::map<std::string, int>> linkCostMatrix) const {
+double KMeans::GetSumSquaredError() const {
     double sum = 0;
     for (int i = 0; i < n_; ++i) {
         // ToDo: change the code
-        sum += CalDistance(data_[i], clusters[assignments_[i]], linkCostMatrix);
+        sum += CalClusterDistance(i, assignments_[i]);
     }
     return sum;
 }
 
 // Use the result of assignment, assign the data to the clusters
 void KMeans::InitWithRandomCenter() {
+    clusters.clear();
     clusters.resize(k_);
     for (int i = 0; i < n_; ++i) {
         clusters[assignments_[i]].emplace_back(data_[i]);
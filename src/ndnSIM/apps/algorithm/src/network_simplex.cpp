@@ -1,5 +1,8 @@
 #include "../include/network_simplex.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 void NetworkSimplex::BuildHard(const std::vector<std::vector<double>>& costs,
                                int k, int lower_bound, int upper_bound) {
     const std::vector<int>& sum_flow = BuildBasic(costs, 1);
@@ -82,23 +85,41 @@ void NetworkSimplex::BuildTree() {
     }
 }
 
+// Block search pivot rule: scan edges in blocks of c * sqrt(m), enter the most violating edge of each block.
+// Warm-started solves need few pivots, so blocks are kept small, larger blocks spend more time scanning than they save.
 void NetworkSimplex::Simplex() {
     int num_edges = static_cast<int>(edge_list_.size());
-    for (int edge_index = 0, scaned = 0; scaned < num_edges;
-         ++edge_index, ++scaned) {
-        if (edge_index == num_edges) {
-            edge_index = 0;
-        }
-        Edge& edge = edge_list_[edge_index];
-        if (edge.in_tree || edge.cap == 0) {
-            continue;
+    if (num_edges == 0) {
+        return;
+    }
+    int block_size = std::max(kMinBlockSize, static_cast<int>(kBlockSizeFactor * std::sqrt(static_cast<double>(num_edges))));
+    block_size = std::min(block_size, num_edges);
+    int edge_index = 0;
+    for (int scaned = 0; scaned < num_edges;) {
+        int best_edge = -1;
+        int best_direction = 0;
+        double best_delta = -kEps;
+        for (int i = 0; i < block_size && scaned < num_edges; ++i, ++scaned) {
+            Edge& edge = edge_list_[edge_index];
+            int current = edge_index;
+            if (++edge_index == num_edges) {
+                edge_index = 0;
+            }
+            if (edge.in_tree || edge.cap == 0) {
+                continue;
+            }
+            double potential_from = GetPotential(edge.from);
+            double potential_to = GetPotential(edge.to);
+            int direction = edge.flow == 0 ? 1 : -1;
+            double delta = (potential_to - potential_from + edge.cost) * direction;
+            if (delta < best_delta) {
+                best_delta = delta;
+                best_edge = current;
+                best_direction = direction;
+            }
         }
-        double potential_from = GetPotential(edge.from);
-        double potential_to = GetPotential(edge.to);
-        int direction = edge.flow == 0 ? 1 : -1;
-        double delta = (potential_to - potential_from + edge.cost) * direction;
-        if (delta < -kEps) {
-            Pivot(edge_index, direction, delta);
+        if (best_edge != -1) {
+            Pivot(best_edge, best_direction, best_delta);
             scaned = 0;
         }
     }
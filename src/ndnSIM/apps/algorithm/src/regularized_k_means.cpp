@@ -4,13 +4,12 @@
 #include <thread>
 
 RegularizedKMeans::RegularizedKMeans(
-        const std::vector<std::string>& data, int k, std::map<std::string, std::map<std::string, int>> costMatrix, InitMethod init_method,
+        const std::vector<int>& data, int k, const Utility::CostMatrix& costMatrix, InitMethod init_method,
         bool warm_start, int n_jobs, unsigned int seed)
-        : KMeans(data, k, init_method, seed),
+        : KMeans(data, k, costMatrix, init_method, seed),
           warm_start_(warm_start),
           n_jobs_(n_jobs == -1 ? std::thread::hardware_concurrency() : n_jobs),
-          costs_(static_cast<int>(data.size()), std::vector<double>(k)),
-          linkCostMatrix(costMatrix){}
+          costs_(static_cast<int>(data.size()), std::vector<double>(k)) {}
 
 double RegularizedKMeans::SolveHard() {
     return SolveHard(n_ / k_, (n_ + k_ - 1) / k_);
@@ -51,30 +50,14 @@ double RegularizedKMeans::Solve(std::function<NetworkSimplex()> builder) {
         ns_solver.Simplex();
         ns_solver.GetAssignments(&assignments_);
     } while (old_assignments != assignments_);
-    return GetSumSquaredError(linkCostMatrix);
+    return GetSumSquaredError();
 }
 
+// Cluster distances are maintained incrementally, filling the cost matrix is O(n * k)
 void RegularizedKMeans::UpdateCostMatrix() {
-    if (n_jobs_ <= 1) {
-        for (int i = 0; i < n_; ++i) {
-            for (int j = 0; j < k_; ++j) {
-                costs_[i][j] = CalDistance(data_[i], clusters[j], linkCostMatrix);
-            }
+    for (int i = 0; i < n_; ++i) {
+        for (int j = 0; j < k_; ++j) {
+            costs_[i][j] = CalClusterDistance(i, j);
         }
-    } else {
-        std::vector<std::thread> threads(n_jobs_);
-        for (int t = 0; t < n_jobs_; ++t) {
-            threads[t] = std::thread(std::bind(
-                    [this](int thread_idx) {
-                        for (int idx = thread_idx; idx < n_ * k_; idx += n_jobs_) {
-                            int i = idx / k_;
-                            int j = idx % k_;
-                            costs_[i][j] = CalDistance(data_[i], clusters[j], linkCostMatrix);
-                        }
-                    },
-                    t));
-        }
-        std::for_each(threads.begin(), threads.end(),
-                      [](std::thread& x) { x.join(); });
     }
 }
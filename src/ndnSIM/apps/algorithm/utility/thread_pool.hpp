@@ -0,0 +1,138 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Utility {
+
+    // Persistent worker threads shared by the tree construction algorithms, so threads are not spawned per call
+    class ThreadPool {
+    public:
+        explicit ThreadPool(int numThreads = static_cast<int>(std::thread::hardware_concurrency())) {
+            numThreads = std::max(numThreads, 1);
+            for (int i = 0; i < numThreads; ++i) {
+                workers_.emplace_back([this] { WorkerLoop(); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            has_task_.notify_all();
+            for (auto& worker : workers_) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Process-wide pool
+        static ThreadPool& Shared() {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        int size() const { return static_cast<int>(workers_.size()); }
+
+        /**
+         * Invoke f(index, worker) for every index in [begin, end), and wait until all of them finish.
+         * "worker" is in [0, size()), no two concurrent calls share the same worker value, so it can select per-thread buffers.
+         * Calls made from a worker of this pool run inline on that worker, with the worker value of the enclosing call,
+         * so nested calls can't deadlock and still use their own buffers.
+         * @param begin
+         * @param end
+         * @param f
+         */
+        template<typename F>
+        void ParallelFor(int begin, int end, F&& f) {
+            if (begin >= end) {
+                return;
+            }
+            const WorkerState& current = CurrentWorker();
+            if (current.pool == this) {
+                for (int i = begin; i < end; ++i) {
+                    f(i, current.worker);
+                }
+                return;
+            }
+
+            std::atomic<int> next(begin);
+            int numTasks = std::min(size(), end - begin);
+            int remaining = numTasks;
+            std::mutex done_mutex;
+            std::condition_variable done;
+
+            for (int worker = 0; worker < numTasks; ++worker) {
+                Submit([&, worker] {
+                    CurrentWorker() = {this, worker};
+                    for (int i = next++; i < end; i = next++) {
+                        f(i, worker);
+                    }
+                    CurrentWorker() = {};
+                    std::lock_guard<std::mutex> lock(done_mutex);
+                    if (--remaining == 0) {
+                        done.notify_one();
+                    }
+                });
+            }
+
+            std::unique_lock<std::mutex> lock(done_mutex);
+            done.wait(lock, [&remaining] { return remaining == 0; });
+        }
+
+    private:
+        // Pool and worker value of the ParallelFor task running on current thread, if any
+        struct WorkerState {
+            const ThreadPool* pool = nullptr;
+            int worker = -1;
+        };
+
+        static WorkerState& CurrentWorker() {
+            static thread_local WorkerState state;
+            return state;
+        }
+
+        void Submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.push(std::move(task));
+            }
+            has_task_.notify_one();
+        }
+
+        void WorkerLoop() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    has_task_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                    if (tasks_.empty()) {
+                        return;
+                    }
+                    task = std::move(tasks_.front());
+                    tasks_.pop();
+                }
+                task();
+            }
+        }
+
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable has_task_;
+        bool stop_ = false;
+    };
+
+}
+
+#endif  // THREAD_POOL_H_
@@ -14,6 +14,16 @@
 #include <unordered_map>
 #include <climits>
 #include <stdexcept>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "thread_pool.hpp"
 
 
 
@@ -235,46 +245,420 @@ int Utility::countProducers(std::string filename) {
     return producerCount;
 }
 
+// Anonymous namespace for topology parsing, shared by cost matrix computation
+namespace {
+
+    const char COST_CACHE_MAGIC[4] = {'C', 'F', 'N', 'C'};
+    const uint32_t COST_CACHE_VERSION = 1;
+
+    std::string costMatrixCacheDir = "/tmp/cfnagg-cost-cache";
+
+
+
+    bool isCostMatrixNode(const std::string& line) {
+        return line.substr(0, 3) == "pro" || line.substr(0, 3) == "agg" || line.substr(0, 3) == "con";
+    }
+
+
+
+    std::vector<std::string> parseCostMatrixNodes(std::istream& input) {
+        std::vector<std::string> nodeList;
+        std::string line;
+        bool isRouterSection = false;
+
+        while (std::getline(input, line)) {
+            line.erase(0, line.find_first_not_of(" \t\n\r\f\v")); // Trim leading whitespace
+            if (line == "router") {
+                isRouterSection = true;
+            } else if (line == "link") {
+                break;
+            } else if (isRouterSection) {
+                if (isCostMatrixNode(line))
+                    nodeList.push_back(line);
+            }
+        }
+        return nodeList;
+    }
+
+
+
+    // Undirected graph in compressed sparse row format, neighbors of node u are in [offsets[u], offsets[u + 1])
+    struct CsrGraph {
+        std::unordered_map<std::string, int> ids;
+        std::vector<int> offsets;
+        std::vector<int> targets;
+        std::vector<int> weights;
+    };
+
+
+
+    CsrGraph parseCsrGraph(const std::string& content) {
+        CsrGraph graph;
+        std::vector<std::pair<int, int>> edges;
+        std::vector<int> costs;
+
+        auto nodeId = [&graph](const std::string& name) {
+            return graph.ids.emplace(name, static_cast<int>(graph.ids.size())).first->second;
+        };
+
+        std::istringstream input(content);
+        std::string line;
+        bool linkSection = false;
+        while (std::getline(input, line)) {
+            if (line == "link") {
+                linkSection = true;
+                continue;
+            }
+
+            if (linkSection && !line.empty()) {
+                std::istringstream iss(line);
+                std::string node1, node2;
+                std::string speed; // Placeholder for speed
+                int cost;
+
+                if (!(iss >> node1 >> node2 >> speed >> cost)) {
+                    continue;
+                }
+                edges.emplace_back(nodeId(node1), nodeId(node2));
+                costs.push_back(cost);
+            }
+        }
+
+        // Counting sort of both directions of every link
+        int numNodes = static_cast<int>(graph.ids.size());
+        graph.offsets.assign(numNodes + 1, 0);
+        for (const auto& edge : edges) {
+            ++graph.offsets[edge.first + 1];
+            ++graph.offsets[edge.second + 1];
+        }
+        for (int u = 0; u < numNodes; ++u) {
+            graph.offsets[u + 1] += graph.offsets[u];
+        }
+        graph.targets.resize(edges.size() * 2);
+        graph.weights.resize(edges.size() * 2);
+        std::vector<int> position(graph.offsets.begin(), graph.offsets.end() - 1);
+        for (size_t i = 0; i < edges.size(); ++i) {
+            int u = edges[i].first;
+            int v = edges[i].second;
+            graph.targets[position[u]] = v;
+            graph.weights[position[u]++] = costs[i];
+            graph.targets[position[v]] = u;
+            graph.weights[position[v]++] = costs[i];
+        }
+        return graph;
+    }
+
+
+
+    bool readFile(const std::string& filename, std::string& content) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        content = buffer.str();
+        return true;
+    }
+
+
+
+    void writeBytes(std::ofstream& file, const void* data, size_t size) {
+        file.write(reinterpret_cast<const char*>(data), size);
+    }
+
+}
+
+// Return nodes taking part in aggregation, i.e. producers, aggregators and consumers
+std::vector<std::string> Utility::getCostMatrixNodes(std::string filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Fail to open file." << filename << std::endl;
+        return {};
+    }
+    return parseCostMatrixNodes(file);
+}
+
 std::map<std::string, std::map<std::string, int>> Utility::GetAllLinkCost(std::string filename)
 {
+    // Kept for compatibility, computed from the dense matrix
     std::map<std::string, std::map<std::string, int>> linkCostMatrix;
-    std::vector<std::string> nodeList;
-    std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> graph;
+    CostMatrix costMatrix = GetLinkCostMatrix(filename);
+    for (int i = 0; i < costMatrix.size(); ++i) {
+        auto& row = linkCostMatrix[costMatrix.name(i)];
+        for (int j = 0; j < costMatrix.size(); ++j) {
+            row[costMatrix.name(j)] = costMatrix.at(i, j);
+        }
+    }
+    return linkCostMatrix;
+}
 
-    std::ifstream file(filename);
+
+
+Utility::CostMatrix::CostMatrix(const std::vector<std::string>& names)
+    : m_names(names)
+    , m_costs(names.size() * names.size(), 0)
+{
+    indexNames();
+}
+
+Utility::CostMatrix::CostMatrix(const std::vector<std::string>& names, std::shared_ptr<const int32_t> costs)
+    : m_names(names)
+    , m_mapped(std::move(costs))
+{
+    indexNames();
+}
+
+void Utility::CostMatrix::indexNames() {
+    m_ids.reserve(m_names.size());
+    for (int i = 0; i < static_cast<int>(m_names.size()); ++i) {
+        m_ids.emplace(m_names[i], i);
+    }
+}
+
+int Utility::CostMatrix::id(const std::string& name) const {
+    auto it = m_ids.find(name);
+    return it == m_ids.end() ? -1 : it->second;
+}
+
+
+
+void Utility::SetCostMatrixCacheDir(const std::string& dir) {
+    costMatrixCacheDir = dir;
+}
+
+std::string Utility::GetCostMatrixCacheDir() {
+    return costMatrixCacheDir;
+}
+
+// FNV-1a, identifies topology file content
+uint64_t Utility::hashTopology(const std::string& content) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : content) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+
+/**
+ * Cache file layout (native byte order):
+ *   "CFNC" uint32 version, uint64 topology hash, uint32 number of nodes n,
+ *   { uint32 length, char[length] } node names, zero padding to 8 bytes, int32[n][n] costs (row-major)
+ * @param costMatrix
+ * @param path
+ * @param topologyHash
+ * @return True if the file is written
+ */
+bool Utility::saveCostMatrix(const CostMatrix& costMatrix, const std::string& path, uint64_t topologyHash) {
+    // Write into temporary file first, so concurrent runs never map a partial file
+    std::string tmpPath = path + ".tmp" + std::to_string(::getpid());
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
     if (!file.is_open()) {
-        std::cerr << "Fail to open file." << filename << std::endl;
-        return linkCostMatrix;
+        return false;
     }
-    std::string line;
-    bool isRouterSection = false;
 
-    while (std::getline(file, line)) {
-        line.erase(0, line.find_first_not_of(" \t\n\r\f\v")); // Trim leading whitespace
-        if (line == "router") {
-            isRouterSection = true;
-        } else if (line == "link") {
-            break;
-        } else if (isRouterSection) {
-            if (line.substr(0, 3) == "pro" || line.substr(0, 3) == "agg" || line.substr(0, 3) == "con")
-                nodeList.push_back(line);
+    uint32_t numNodes = static_cast<uint32_t>(costMatrix.size());
+    size_t offset = sizeof(COST_CACHE_MAGIC) + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+    writeBytes(file, COST_CACHE_MAGIC, sizeof(COST_CACHE_MAGIC));
+    writeBytes(file, &COST_CACHE_VERSION, sizeof(uint32_t));
+    writeBytes(file, &topologyHash, sizeof(uint64_t));
+    writeBytes(file, &numNodes, sizeof(uint32_t));
+    for (const auto& name : costMatrix.names()) {
+        uint32_t length = static_cast<uint32_t>(name.size());
+        writeBytes(file, &length, sizeof(uint32_t));
+        writeBytes(file, name.data(), length);
+        offset += sizeof(uint32_t) + length;
+    }
+    const char padding[8] = {0};
+    writeBytes(file, padding, (8 - offset % 8) % 8);
+    writeBytes(file, costMatrix.data(), static_cast<size_t>(numNodes) * numNodes * sizeof(int32_t));
+    file.close();
+
+    if (!file || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+
+/**
+ * Map a cache file written by saveCostMatrix, costs are used in place without copying
+ * @param path
+ * @param topologyHash Expected hash of the topology
+ * @param costMatrix Output
+ * @return False if the file doesn't exist or doesn't match the topology
+ */
+bool Utility::loadCostMatrix(const std::string& path, uint64_t topologyHash, CostMatrix& costMatrix) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || status.st_size < 20) {
+        ::close(fd);
+        return false;
+    }
+    size_t fileSize = static_cast<size_t>(status.st_size);
+    void* base = ::mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    std::shared_ptr<const char> mapping(static_cast<const char*>(base), [fileSize](const char* p) {
+        ::munmap(const_cast<char*>(p), fileSize);
+    });
+
+    const char* data = mapping.get();
+    uint32_t version;
+    uint64_t hash;
+    uint32_t numNodes;
+    std::memcpy(&version, data + 4, sizeof(uint32_t));
+    std::memcpy(&hash, data + 8, sizeof(uint64_t));
+    std::memcpy(&numNodes, data + 16, sizeof(uint32_t));
+    if (std::memcmp(data, COST_CACHE_MAGIC, sizeof(COST_CACHE_MAGIC)) != 0 || version != COST_CACHE_VERSION || hash != topologyHash) {
+        return false;
+    }
+
+    std::vector<std::string> names;
+    names.reserve(numNodes);
+    size_t offset = 20;
+    for (uint32_t i = 0; i < numNodes; ++i) {
+        uint32_t length;
+        if (offset + sizeof(uint32_t) > fileSize) {
+            return false;
         }
+        std::memcpy(&length, data + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        if (offset + length > fileSize) {
+            return false;
+        }
+        names.emplace_back(data + offset, length);
+        offset += length;
+    }
+    offset += (8 - offset % 8) % 8;
+    if (offset + static_cast<size_t>(numNodes) * numNodes * sizeof(int32_t) != fileSize) {
+        return false;
+    }
+
+    // Aliasing constructor, keeps the mapping alive as long as the matrix refers to it
+    std::shared_ptr<const int32_t> costs(mapping, reinterpret_cast<const int32_t*>(data + offset));
+    costMatrix = CostMatrix(names, std::move(costs));
+    return true;
+}
+
+
+
+/**
+ * Compute link cost between all nodes of the matrix.
+ * One Dijkstra per source node on a CSR graph, sources are distributed over the shared thread pool.
+ * @param content Topology file content
+ * @return
+ */
+Utility::CostMatrix Utility::ComputeLinkCostMatrix(const std::string& content) {
+    std::istringstream input(content);
+    CostMatrix costMatrix(parseCostMatrixNodes(input));
+    CsrGraph graph = parseCsrGraph(content);
+
+    int numGraphNodes = static_cast<int>(graph.ids.size());
+    std::vector<int> graphIds(costMatrix.size());
+    for (int i = 0; i < costMatrix.size(); ++i) {
+        auto it = graph.ids.find(costMatrix.name(i));
+        graphIds[i] = (it == graph.ids.end()) ? -1 : it->second;
     }
 
-    // Get graph for further computation
-    graph = initializeGraph(filename);
+    typedef std::pair<int, int> QueueItem; // cost, node
+    ThreadPool& pool = ThreadPool::Shared();
+    std::vector<std::vector<int>> distanceBuffers(pool.size(), std::vector<int>(numGraphNodes));
+    std::vector<std::vector<QueueItem>> heapBuffers(pool.size());
+    std::atomic<bool> unreachable(false);
 
-    // Compute link cost matrix
-    for (const auto& node1: nodeList) {
-        for (const auto& node2 : nodeList) {
-            if (node1 == node2) {
-                linkCostMatrix[node1][node2] = 0;
-            } else if (linkCostMatrix[node1].find(node2) == linkCostMatrix[node1].end()) {
-                int cost = findLinkCost(node1, node2, graph);
-                linkCostMatrix[node1][node2] = cost;
-                linkCostMatrix[node2][node1] = cost;
+    pool.ParallelFor(0, costMatrix.size(), [&](int i, int worker) {
+        if (graphIds[i] == -1) {
+            for (int j = 0; j < costMatrix.size(); ++j) {
+                costMatrix.set(i, j, i == j ? 0 : -1); // Nodes are not present in the graph
             }
+            return;
         }
+
+        std::vector<int>& distances = distanceBuffers[worker];
+        std::vector<QueueItem>& heap = heapBuffers[worker];
+        std::fill(distances.begin(), distances.end(), INT_MAX);
+        heap.clear();
+        distances[graphIds[i]] = 0;
+        heap.emplace_back(0, graphIds[i]);
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<QueueItem>());
+            auto [cost, node] = heap.back();
+            heap.pop_back();
+            if (cost > distances[node]) {
+                continue;
+            }
+            for (int e = graph.offsets[node]; e < graph.offsets[node + 1]; ++e) {
+                int next = graph.targets[e];
+                if (cost + graph.weights[e] < distances[next]) {
+                    distances[next] = cost + graph.weights[e];
+                    heap.emplace_back(distances[next], next);
+                    std::push_heap(heap.begin(), heap.end(), std::greater<QueueItem>());
+                }
+            }
+        }
+
+        for (int j = 0; j < costMatrix.size(); ++j) {
+            if (graphIds[j] == -1) {
+                costMatrix.set(i, j, i == j ? 0 : -1);
+            } else if (distances[graphIds[j]] == INT_MAX) {
+                unreachable = true;
+                costMatrix.set(i, j, -1);
+            } else {
+                costMatrix.set(i, j, distances[graphIds[j]]);
+            }
+        }
+    });
+
+    if (unreachable) {
+        std::cout << "Error happened, no route is found!!!!!!!!!!!" << std::endl;
     }
-    return linkCostMatrix;
-}
\ No newline at end of file
+    return costMatrix;
+}
+
+
+
+/**
+ * Get link cost matrix of given topology, from the cache if the same topology has been computed before
+ * @param filename Topology file
+ * @return
+ */
+Utility::CostMatrix Utility::GetLinkCostMatrix(std::string filename)
+{
+    std::string content;
+    if (!readFile(filename, content)) {
+        std::cerr << "Fail to open file." << filename << std::endl;
+        return CostMatrix();
+    }
+
+    if (costMatrixCacheDir.empty()) {
+        return ComputeLinkCostMatrix(content);
+    }
+
+    uint64_t hash = hashTopology(content);
+    char hashText[17];
+    std::snprintf(hashText, sizeof(hashText), "%016llx", static_cast<unsigned long long>(hash));
+    std::string path = costMatrixCacheDir + "/cost-matrix-" + hashText + ".bin";
+
+    CostMatrix costMatrix;
+    if (loadCostMatrix(path, hash, costMatrix)) {
+        return costMatrix;
+    }
+
+    costMatrix = ComputeLinkCostMatrix(content);
+    ::mkdir(costMatrixCacheDir.c_str(), 0755);
+    if (!saveCostMatrix(costMatrix, path, hash)) {
+        std::cerr << "Fail to write cost matrix cache: " << path << std::endl;
+    }
+    return costMatrix;
+}
@@ -1,3 +1,6 @@
+#ifndef UTILITY_H_
+#define UTILITY_H_
+
 #include <iostream>
 #include <vector>
 #include <cmath> // For ceil
@@ -12,6 +15,8 @@
 #include <unordered_map>
 #include <climits>
 #include <set>
+#include <memory>
+#include <cstdint>
 
 
 
@@ -38,4 +43,71 @@ namespace Utility{
 
     std::map<std::string, std::map<std::string, int>> GetAllLinkCost(std::string filename);
 
-};
\ No newline at end of file
+
+
+    /**
+     * Dense link cost matrix, nodes are referred by integer ids (index of the node name).
+     * Costs are stored row-major in one contiguous buffer, either owned or mapped from a cache file.
+     */
+    class CostMatrix {
+    public:
+        CostMatrix() = default;
+
+        explicit CostMatrix(const std::vector<std::string>& names);
+
+        // Read-only matrix over an external buffer of names.size() * names.size() costs, e.g. a mapped file
+        CostMatrix(const std::vector<std::string>& names, std::shared_ptr<const int32_t> costs);
+
+        int size() const { return static_cast<int>(m_names.size()); }
+
+        // Return -1 if the node doesn't exist
+        int id(const std::string& name) const;
+
+        const std::string& name(int id) const { return m_names[id]; }
+
+        const std::vector<std::string>& names() const { return m_names; }
+
+        int at(int from, int to) const { return data()[static_cast<size_t>(from) * m_names.size() + to]; }
+
+        // Only valid for owned buffer, rows can be written concurrently
+        void set(int from, int to, int cost) { m_costs[static_cast<size_t>(from) * m_names.size() + to] = cost; }
+
+        // Row of one node, i.e. its cost to all other nodes
+        const int32_t* row(int from) const { return data() + static_cast<size_t>(from) * m_names.size(); }
+
+        const int32_t* data() const { return m_mapped ? m_mapped.get() : m_costs.data(); }
+
+        bool isMapped() const { return static_cast<bool>(m_mapped); }
+
+    private:
+        void indexNames();
+
+        std::vector<std::string> m_names;
+        std::unordered_map<std::string, int> m_ids;
+        std::vector<int32_t> m_costs;
+        std::shared_ptr<const int32_t> m_mapped;
+    };
+
+    std::vector<std::string> getCostMatrixNodes(std::string filename);
+
+    /**
+     * Directory of cached cost matrices, files are named by the hash of topology file content.
+     * Empty string disables the cache.
+     */
+    void SetCostMatrixCacheDir(const std::string& dir);
+
+    std::string GetCostMatrixCacheDir();
+
+    uint64_t hashTopology(const std::string& content);
+
+    bool saveCostMatrix(const CostMatrix& costMatrix, const std::string& path, uint64_t topologyHash);
+
+    bool loadCostMatrix(const std::string& path, uint64_t topologyHash, CostMatrix& costMatrix);
+
+    CostMatrix ComputeLinkCostMatrix(const std::string& content);
+
+    CostMatrix GetLinkCostMatrix(std::string filename);
+
+};
+
+#endif  // UTILITY_H_
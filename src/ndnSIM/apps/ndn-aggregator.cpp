@@ -9,6 +9,8 @@
 #include "model/ndn-l3-protocol.hpp"
 #include "helper/ndn-fib-helper.hpp"
 #include "ModelData.hpp"
+#include "TreeDescriptor.hpp"
+#include "AggregationKernel.hpp"
 #include "ndn-consumer.hpp"
 
 #include "ns3/ptr.h"
@@ -22,6 +24,7 @@
 #include "ns3/integer.h"
 #include "ns3/double.h"
 #include <limits>
+#include <cmath>
 
 #include <set>
 #include <map>
@@ -78,7 +81,7 @@ Aggregator::GetTypeId(void)
                           MakeTimeAccessor(&Aggregator::m_interestLifeTime),
                           MakeTimeChecker())
             .AddAttribute("RetxTimer",
-                          "Timeout defining how frequent retransmission timeouts should be checked",
+                          "Initial retransmission timeout, used until the RTO of a job is measured",
                           StringValue("50ms"),
                           MakeTimeAccessor(&Aggregator::GetRetxTimer, &Aggregator::SetRetxTimer),
                           MakeTimeChecker())
@@ -162,6 +165,41 @@ Aggregator::GetTypeId(void)
                           IntegerValue(50),
                           MakeIntegerAccessor(&Aggregator::m_maxQueue),
                           MakeIntegerChecker<int>())
+            .AddAttribute("RetxFilterCapacity",
+                          "Number of recently retransmitted interests remembered to drop duplicate retransmissions from upstream, 0 disables it",
+                          UintegerValue(4096),
+                          MakeUintegerAccessor(&Aggregator::m_retxFilterCapacity),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RetxFilterLifetime",
+                          "How long a retransmitted interest is remembered",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&Aggregator::m_retxFilterLifetime),
+                          MakeTimeChecker())
+            .AddAttribute("SlotWindow",
+                          "Initial number of iterations whose states are kept at the same time, grows when necessary",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&Aggregator::m_slotWindow),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("PartialFraction",
+                          "Forward the partial aggregation once this fraction of children has responded, 1.0 waits for all children",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&Aggregator::m_partialFraction),
+                          MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute("PartialDeadline",
+                          "Forward the partial aggregation once this time has passed since the iteration started, 0 disables the deadline",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&Aggregator::m_partialDeadline),
+                          MakeTimeChecker())
+            .AddAttribute("PayloadCodec",
+                          "Encoding of forwarded model parameters: fp32, fp16, bf16, int8 or topk",
+                          StringValue("fp32"),
+                          MakeStringAccessor(&Aggregator::m_payloadCodec),
+                          MakeStringChecker())
+            .AddAttribute("TopKRatio",
+                          "Fraction of model parameters kept by the topk codec",
+                          DoubleValue(0.1),
+                          MakeDoubleAccessor(&Aggregator::m_topKRatio),
+                          MakeDoubleChecker<double>(0.0, 1.0))
             .AddTraceSource("LastRetransmittedInterestDataDelay",
                             "Delay between last retransmitted Interest and received Data",
                             MakeTraceSourceAccessor(&Aggregator::m_lastRetransmittedInterestDataDelay),
@@ -191,20 +229,10 @@ Aggregator::Aggregator()
     , totalInterestThroughput(0)
     , totalDataThroughput(0)
     , m_rand(CreateObject<UniformRandomVariable>())
-    , treeSync(false)
-    , RTT_threshold(0)
-    , RTT_measurement(0)
-    , RTT_count(0)
-    , RTT_a(0.3)
+    , m_window(0.0)
     , m_inFlight(0)
-    , m_ssthresh(std::numeric_limits<double>::max())
-    , m_highData(0)
-    , m_recPoint(0.0)
+    , numStragglers(0)
     , m_seq(0)
-    , SRTT(0)
-    , RTTVAR(0)
-    , roundRTT(0)
-    , m_timeoutList(100)
     , totalResponseTime(0)
     , round(0)
     , totalAggregateTime(0)
@@ -215,57 +243,6 @@ Aggregator::Aggregator()
 
 
 
-/**
- * Intermediate function to parse string, used in aggTreeProcessStrings()
- * @param input
- * @return Parsed string
- */
-std::pair<std::string, std::set<std::string>>
-Aggregator::aggTreeProcessSingleString(const std::string& input)
-{
-    std::istringstream iss(input);
-    std::string segment;
-    std::vector<std::string> segments;
-
-    // Use getline to split the string by '.'
-    while (getline(iss, segment, '.')) {
-        segments.push_back(segment);
-    }
-
-    // Check if there are enough segments to form a key and a set
-    if (segments.size() > 1) {
-        std::string key = segments[0];
-        std::set<std::string> values(segments.begin() + 1, segments.end());
-        return {key, values};
-    }
-
-    return {};  // Return an empty pair if not enough segments
-}
-
-
-
-/**
- * When receive "initialization" message (tree construction) from consumer, parse the message to get required info
- * @param inputs
- * @return A map consist child node info for current aggregator
- */
-std::map<std::string, std::set<std::string>>
-Aggregator::aggTreeProcessStrings(const std::vector<std::string>& inputs)
-{
-    std::map<std::string, std::set<std::string>> result;
-
-    for (const std::string& input : inputs) {
-        auto entry = aggTreeProcessSingleString(input);
-        if (!entry.first.empty()) {
-            result[entry.first].insert(entry.second.begin(), entry.second.end());
-        }
-    }
-
-    return result;
-}
-
-
-
 /**
  * Sum response time
  * @param response_time
@@ -329,7 +306,7 @@ Aggregator::GetAggregateTimeAverage()
 
 
 /**
- * Check timeout every certain interval
+ * Pop the interests whose deadline has passed, then wait for the next deadline of the timer wheel
  */
 void
 Aggregator::CheckRetxTimeout()
@@ -341,17 +318,44 @@ Aggregator::CheckRetxTimeout()
     //NS_LOG_DEBUG("Check timeout after: " << m_retxTimer.GetMilliSeconds() << " ms");
     //NS_LOG_DEBUG("Current timeout threshold is: " << m_timeoutThreshold.GetMilliSeconds() << " ms");
 
-    for (auto it = m_timeoutCheck.begin(); it != m_timeoutCheck.end();){
-        NS_LOG_DEBUG("Interest name: " << it->first);
-        if (now - it->second > m_timeoutThreshold) {
-            std::string name = it->first;
-            it = m_timeoutCheck.erase(it);
-            OnTimeout(name);
-        } else {
-            ++it;
+    // Only interests whose deadline has passed are popped from the timer wheel
+    m_retxWheel.expire(now, [this](uint64_t key) {
+        uint32_t jobId = static_cast<uint32_t>(key >> 48);
+        uint32_t childId = static_cast<uint32_t>((key >> 32) & 0xFFFF);
+        uint32_t seq = static_cast<uint32_t>(key);
+        if (jobId >= m_jobs.size()) {
+            return;
+        }
+        JobState& job = m_jobs[jobId];
+        AggregationSlot* slot = job.slots.find(seq);
+        if (slot != nullptr && slot->inFlight.test(childId)) {
+            slot->inFlight.reset(childId);
+            OnTimeout(job, seq, childId);
+        }
+    });
+
+    // Nothing to check until an interest is sent again
+    if (m_retxWheel.size() > 0) {
+        ScheduleRetxCheck(m_retxWheel.nextExpiry());
+    }
+}
+
+
+
+/**
+ * Make sure the timeout check runs no later than given time, an earlier pending check is kept
+ * @param when Time from which the timer wheel pops an outstanding interest
+ */
+void
+Aggregator::ScheduleRetxCheck(Time when)
+{
+    if (m_retxEvent.IsRunning()) {
+        if (TimeStep(m_retxEvent.GetTs()) <= when) {
+            return;
         }
+        Simulator::Remove(m_retxEvent);
     }
-    m_retxEvent = Simulator::Schedule(m_retxTimer, &Aggregator::CheckRetxTimeout, this);
+    m_retxEvent = Simulator::Schedule(std::max(when - Simulator::Now(), Time(0)), &Aggregator::CheckRetxTimeout, this);
 }
 
 
@@ -359,44 +363,46 @@ Aggregator::CheckRetxTimeout()
 /**
  * Based on RTT of the first iteration, compute their RTT average as threshold, use the threshold for congestion control
  * Apply Exponentially Weighted Moving Average (EWMA) for RTT Threshold Computation
+ * @param job
  * @param responseTime
  */
 void
-Aggregator::RTTThresholdMeasure(int64_t responseTime)
+Aggregator::RTTThresholdMeasure(JobState& job, int64_t responseTime)
 {
-    if (RTT_count == 0) {
-        RTT_measurement = responseTime;
+    if (job.RTT_count == 0) {
+        job.RTT_measurement = responseTime;
     } else {
-        RTT_measurement = m_EWMAFactor * responseTime + (1 - m_EWMAFactor) * RTT_measurement;
-        RTT_threshold = m_thresholdFactor * RTT_measurement;
+        job.RTT_measurement = m_EWMAFactor * responseTime + (1 - m_EWMAFactor) * job.RTT_measurement;
+        job.RTT_threshold = m_thresholdFactor * job.RTT_measurement;
     }
 
-    if (RTT_count >= numChild * 3) // Whether it's larger than 3 iterations
+    if (job.RTT_count >= job.numChild * 3) // Whether it's larger than 3 iterations
     {
-        NS_LOG_DEBUG("Apply RTT_threshold, current value is: " << RTT_threshold);
+        NS_LOG_DEBUG("Apply RTT_threshold of job " << job.name << ", current value is: " << job.RTT_threshold);
     }
-    RTT_count++;
+    job.RTT_count++;
 }
 
 
 
 /**
  * Measure new RTO
+ * @param job
  * @param resTime
  * @return New RTO
  */
 Time
-Aggregator::RTOMeasurement(int64_t resTime)
+Aggregator::RTOMeasurement(JobState& job, int64_t resTime)
 {
-    if (roundRTT == 0) {
-        RTTVAR = resTime / 2;
-        SRTT = resTime;
+    if (job.roundRTT == 0) {
+        job.RTTVAR = resTime / 2;
+        job.SRTT = resTime;
     } else {
-        RTTVAR = 0.75 * RTTVAR + 0.25 * std::abs(SRTT - resTime); // RTTVAR = (1 - b) * RTTVAR + b * |SRTT - RTTsample|, where b = 0.25
-        SRTT = 0.875 * SRTT + 0.125 * resTime; // SRTT = (1 - a) * SRTT + a * RTTsample, where a = 0.125
+        job.RTTVAR = 0.75 * job.RTTVAR + 0.25 * std::abs(job.SRTT - resTime); // RTTVAR = (1 - b) * RTTVAR + b * |SRTT - RTTsample|, where b = 0.25
+        job.SRTT = 0.875 * job.SRTT + 0.125 * resTime; // SRTT = (1 - a) * SRTT + a * RTTsample, where a = 0.125
     }
-    roundRTT++;
-    int64_t RTO = SRTT + 4 * RTTVAR; // RTO = SRTT + K * RTTVAR, where K = 4
+    job.roundRTT++;
+    int64_t RTO = job.SRTT + 4 * job.RTTVAR; // RTO = SRTT + K * RTTVAR, where K = 4
 
     return MilliSeconds(2 * RTO);
 }
@@ -405,50 +411,53 @@ Aggregator::RTOMeasurement(int64_t resTime)
 
 /**
  * Triggered when timeout
- * @param nameString
+ * @param job
+ * @param seq
+ * @param childId
  */
 void
-Aggregator::OnTimeout(std::string nameString)
+Aggregator::OnTimeout(JobState& job, uint32_t seq, uint32_t childId)
 {
+    AggregationSlot* slot = job.slots.find(seq);
+    if (slot == nullptr) {
+        return;
+    }
+
     // Designed for AIMD
-    WindowDecrease("timeout");
+    WindowDecrease(job, "timeout");
 
     // Start tracing timeout packets
-    m_timeoutList.push_back(nameString);
+    m_retxFilter.insert(slot->childName[childId], Simulator::Now());
 
-    if (m_inFlight > static_cast<uint32_t>(0)){
+    if (job.inFlight > static_cast<uint32_t>(0)){
+        job.inFlight--;
         m_inFlight--;
     } else {
         NS_LOG_DEBUG("m_inFlight is 0, stop.");
         Simulator::Stop();
     }
-    NS_LOG_DEBUG("Window: " << m_window << ", InFlight: " << m_inFlight);
+    NS_LOG_DEBUG("Job " << job.name << ", Window: " << job.window << ", InFlight: " << job.inFlight);
 
-    shared_ptr<Name> name = make_shared<Name>(nameString);
-    SendInterest(name);
+    SendInterest(job, seq, childId);
 
     // Add one to "suspiciousPacketCount"
     suspiciousPacketCount++;
+    MetricsRegistry::Get().Increment(job.metrics.timeouts);
 }
 
 
 
 /**
- * Set initial timeout checking interval
+ * Set initial retransmission timeout
  * @param retxTimer
  */
 void
 Aggregator::SetRetxTimer(Time retxTimer)
 {
     m_retxTimer = retxTimer;
-    if (m_retxEvent.IsRunning()) {
-        Simulator::Remove(m_retxEvent);
-    }
 
-    // Schedule new timeout
-    m_timeoutThreshold = retxTimer;
-    //NS_LOG_DEBUG("Next interval to check timeout is: " << m_retxTimer.GetMilliSeconds() << " ms");
-    m_retxEvent = Simulator::Schedule(m_retxTimer, &Aggregator::CheckRetxTimeout, this);
+    // Jobs start from this timeout until their RTO is measured, timeouts are checked at the deadlines of the interests
+    m_initialTimeout = retxTimer;
 }
 
 
@@ -474,6 +483,17 @@ Aggregator::StartApplication()
     //NS_LOG_FUNCTION_NOARGS();
     App::StartApplication();
     FibHelper::AddRoute(GetNode(), m_prefix, m_face, 0);
+
+    // Children's payloads are decoded into the fp32 sum, the result is re-encoded with this codec
+    PayloadCodec::Type codec;
+    if (!PayloadCodec::ParseType(m_payloadCodec, codec)) {
+        NS_LOG_DEBUG("Unknown payload codec " << m_payloadCodec << ", use fp32 instead.");
+        codec = PayloadCodec::Type::kFp32;
+    }
+    m_codec = PayloadCodec(codec, m_topKRatio);
+
+    m_retxFilter.setCapacity(m_retxFilterCapacity);
+    m_retxFilter.setLifetime(m_retxFilterLifetime);
 }
 
 
@@ -485,64 +505,140 @@ void
 Aggregator::StopApplication()
 {
     /// Cancel packet generation - can be a way to stop simulation gracefully?
-    Simulator::Cancel(m_sendEvent);
+    for (auto& job : m_jobs) {
+        Simulator::Cancel(job.sendEvent);
+    }
 
     //NS_LOG_INFO("The average response time of Aggregator in " << round << " aggregation rounds is: " << GetResponseTimeAverage() << " ms");
     //NS_LOG_INFO("The average aggregate time is: " << GetAggregateTimeAverage() << " ms");
+    if (numStragglers > 0) {
+        NS_LOG_INFO("Responses of " << numStragglers << " children were abandoned by partial aggregation");
+    }
     App::StopApplication();
 }
 
 
 
+/**
+ * Find the states of a job
+ * @param jobName Job component of interest names
+ * @return Pointer to the job, nullptr if the job hasn't announced its tree
+ */
+Aggregator::JobState*
+Aggregator::FindJob(const std::string& jobName)
+{
+    auto it = m_jobId.find(jobName);
+    return it != m_jobId.end() ? &m_jobs[it->second] : nullptr;
+}
+
+
+
+/**
+ * Register a new job, it starts with the initial window and timeout of this aggregator
+ * @param jobName Job component of interest names
+ * @return States of the new job
+ */
+Aggregator::JobState&
+Aggregator::AddJob(const std::string& jobName)
+{
+    uint32_t jobId = static_cast<uint32_t>(m_jobs.size());
+    m_jobId[jobName] = jobId;
+    m_jobs.emplace_back();
+
+    JobState& job = m_jobs.back();
+    job.id = jobId;
+    job.name = jobName;
+    job.slots = SeqSlotTable<AggregationSlot>(m_slotWindow);
+    job.window = m_initialWindow;
+    job.timeoutThreshold = m_initialTimeout;
+    UpdateWindowTrace();
+
+    NS_LOG_INFO("Aggregator " << m_prefix << " serves job " << jobName << ", " << m_jobs.size() << " jobs in total.");
+    return job;
+}
+
+
+
+/**
+ * Trace the sum of windows of all jobs
+ */
+void
+Aggregator::UpdateWindowTrace()
+{
+    double window = 0.0;
+    for (const auto& job : m_jobs) {
+        window += job.window;
+    }
+    m_window = window;
+}
+
+
+
 /**
  * Perform aggregation for incoming data packets (sum)
  * @param data
- * @param dataName
+ * @param slot States of the iteration
  */
-void Aggregator::aggregate(const ModelData& data, const uint32_t& seq) {
-    // first initialization
-    if (sumParameters.find(seq) == sumParameters.end()){
-        sumParameters[seq] = std::vector<float>(300, 0.0f);
-        count[seq] = 0;
+void Aggregator::aggregate(const ModelDataView& data, AggregationSlot& slot) {
+    // first data of this iteration, model size is decided by it
+    if (slot.count == 0) {
+        slot.sum.assign(data.parameters().size(), 0.0f);
     }
 
     // Aggregate data
-    std::transform(sumParameters[seq].begin(), sumParameters[seq].end(), data.parameters.begin(), sumParameters[seq].begin(), std::plus<float>());
+    AggregationKernel::Sum(slot.sum, data.parameters());
 
     // Aggregate congestion signal
-    congestionSignalList[seq].insert(congestionSignalList[seq].end(), data.congestedNodes.begin(), data.congestedNodes.end());
+    slot.congestedNodes.insert(slot.congestedNodes.end(), data.congestedNodes().begin(), data.congestedNodes().end());
 
-    count[seq]++;
+    slot.count++;
+    slot.contributors += data.contributors();
 }
 
 
 
 /**
- * Don't get mean for now, just reformating the data packets, perform aggregation at consumer
- * @param dataName
- * @return Data content
+ * Check whether the iteration can be forwarded before all children have responded
+ * @param slot States of the iteration
+ * @return True if the deadline has passed or enough children have responded
  */
-ModelData Aggregator::getMean(const uint32_t& seq){
-    ModelData result;
-    if (sumParameters.find(seq) != sumParameters.end() && congestionSignalList.find(seq) != congestionSignalList.end()) {
-        result.parameters = sumParameters[seq];
-
-        // Add congestionSignal of current node if necessary
-        if (congestionSignal[seq]) {
-            congestionSignalList[seq].push_back(m_prefix.toUri());
-            NS_LOG_DEBUG("Congestion detected on current node!");
-        }
+bool Aggregator::IsPartialReady(const AggregationSlot& slot) const {
+    if (slot.count == 0) {
+        return false;
+    }
+    if (slot.expired) {
+        return true;
+    }
+    if (m_partialFraction >= 1.0) {
+        return false;
+    }
+    uint32_t required = std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(m_partialFraction * slot.expected)));
+    return static_cast<uint32_t>(slot.count) >= required;
+}
 
 
-        result.congestedNodes = congestionSignalList[seq];
 
+/**
+ * Triggered when the deadline of an iteration expires, forward whatever has been aggregated
+ * @param jobId
+ * @param seq
+ */
+void Aggregator::OnAggregationDeadline(uint32_t jobId, uint32_t seq) {
+    JobState& job = m_jobs[jobId];
+    AggregationSlot* slot = job.slots.find(seq);
+    if (slot == nullptr) {
+        return;
+    }
 
-    } else {
-        NS_LOG_DEBUG("Error when get aggregation result, please exit and check!");
-        ns3::Simulator::Stop();
+    // Nothing to forward yet, the first response will be forwarded right away
+    slot->expired = true;
+    if (slot->count == 0) {
+        NS_LOG_INFO("Deadline of seq " << seq << " of job " << job.name << " passed without any response, forward the first one.");
+        return;
     }
 
-    return result;
+    NS_LOG_INFO("Deadline of seq " << seq << " of job " << job.name << " passed, forward " << slot->count << " of " << slot->expected << " children.");
+    SendAggregatedData(job, seq, *slot);
 }
 
 
@@ -615,48 +711,53 @@ Aggregator::GetSeqMax() const
 
 /**
  * Increase cwnd
+ * @param job
  */
 void
-Aggregator::WindowIncrease()
+Aggregator::WindowIncrease(JobState& job)
 {
-    if (m_window < m_ssthresh) {
-        m_window += 1.0;
+    if (job.window < job.ssthresh) {
+        job.window += 1.0;
     } else {
-        m_window += (1.0 / m_window);
+        job.window += (1.0 / job.window);
     }
-    NS_LOG_DEBUG("Window size increased to " << m_window);
+    UpdateWindowTrace();
+    NS_LOG_DEBUG("Window size of job " << job.name << " increased to " << job.window);
 }
 
 
 
 /**
  * Decrease cwnd
+ * @param job
+ * @param type
  */
 void
-Aggregator::WindowDecrease(std::string type)
+Aggregator::WindowDecrease(JobState& job, std::string type)
 {
     // AIMD for timeout
     if (type == "timeout") {
-        m_ssthresh = m_window * m_alpha;
-        m_window = m_ssthresh;
+        job.ssthresh = job.window * m_alpha;
+        job.window = job.ssthresh;
     }
     else if (type == "LocalCongestion") {
-        m_ssthresh = m_window * m_beta;
-        m_window = m_ssthresh;
+        job.ssthresh = job.window * m_beta;
+        job.window = job.ssthresh;
 
         // Perform CWA when handling consumer congestion
-        LastWindowDecreaseTime = Simulator::Now();
+        job.lastWindowDecreaseTime = Simulator::Now();
     }
     else if (type == "RemoteCongestion") {
-        m_ssthresh = m_window * m_gamma;
-        m_window = m_ssthresh;
+        job.ssthresh = job.window * m_gamma;
+        job.window = job.ssthresh;
     }
 
     // Window size can't be reduced below initial size
-    if (m_window < m_initialWindow) {
-        m_window = m_initialWindow;
+    if (job.window < m_initialWindow) {
+        job.window = m_initialWindow;
     }
-    NS_LOG_DEBUG("Window size decreased to " << m_window);
+    UpdateWindowTrace();
+    NS_LOG_DEBUG("Window size of job " << job.name << " decreased to " << job.window);
 }
 
 
@@ -672,137 +773,140 @@ Aggregator::OnInterest(shared_ptr<const Interest> interest)
     //NS_LOG_DEBUG("The incoming interest packet size is: " << interest->wireEncode().size());
     App::OnInterest(interest);
 
-    std::string interestType = interest->getName().get(-2).toUri();
+    // "initialization" interests carry the tree in ApplicationParameters, which appends a digest to the name
+    Name interestName = stripParametersDigest(interest->getName());
+    std::string interestType = interestName.get(-2).toUri();
+    std::string jobName = interestName.get(1).toUri();
+    JobState* job = FindJob(jobName);
 
     if (interestType == "data") {
 
-        // Parse incoming interest, retrieve their name segments, currently use "/NextHop/Destination/Type/Seq"
-        std::string dest = interest->getName().get(1).toUri();
-        uint32_t seq = interest->getName().get(-1).toSequenceNumber();
-        std::string originalName = interest->getName().toUri();
-
-        std::vector<std::string> segments;  // Vector to store the segments
-        std::istringstream iss(dest);
-        std::string segment;
-
-        // Store the interest segments
-        std::vector<std::string> value_agg;
+        // Parse incoming interest, retrieve their name segments, currently use "/NextHop/Job/LeafBitmap/Type/Seq"
+        uint32_t seq = interestName.get(-1).toSequenceNumber();
 
-        // Store divided elements and push them into interest queue
-        std::vector<std::tuple<uint32_t, bool, shared_ptr<Name>>> interestList;
-
-        // split the destination segment into several ones and store them individually in a vector called "segments"
-        while (std::getline(iss, segment, '.')) {
-            segments.push_back(segment);
+        // Check whether aggregation tree of this job is received
+        if (job == nullptr || !job->treeSync){
+            NS_LOG_DEBUG("Error! No aggregation tree info of job " << jobName << "!");
+            ns3::Simulator::Stop();
+            return;
         }
 
-        // Check whether aggregation tree is received
-        if (!treeSync){
-            NS_LOG_DEBUG("Error! No aggregation tree info!");
-            ns3::Simulator::Stop();
+        // Producers required by this interest
+        if (!parseLeafComponent(interestName.get(2), job->numProducers, m_requestedLeaves)) {
+            NS_LOG_DEBUG("Error! Can't parse leaf bitmap of interest " << interestName);
+            return;
         }
 
-        // Initialize new iteration bool
-        bool isNewIteration = true;
+        // Store divided interests (child id, interest name) and push them into interest queue
+        std::vector<std::pair<uint32_t, Name>> interestList;
 
         // Signal indicating duplicate retransmission
         bool isDuplicate = false;
 
-        // Divide interests and push them into queue
-        for (const auto& [child, leaves] : aggregationMap) {
-            std::string name_sec1;
-            std::string name;
-
-            // interest is divided
-            for (const auto& leaf : leaves) {
-                if (std::find(segments.begin(), segments.end(), leaf) != segments.end()) {
-                    name_sec1 += leaf + ".";
-                } else {
-                    NS_LOG_DEBUG("Data from " << leaf << " is not required for this iteration.");
-                }
-            }
-            name_sec1.resize(name_sec1.size() - 1);
+        // Divide interests by intersecting the requested producers with the leaves of each child, child ids stay stable across tree updates
+        for (const auto& [child, leaves] : job->aggregationMap) {
+            uint32_t childId = job->childId.at(child);
+            m_childLeaves = m_requestedLeaves;
+            m_childLeaves &= leaves;
 
-            if (name_sec1.empty()) {
+            if (m_childLeaves.none()) {
                 NS_LOG_INFO("No interest needs to be sent to node " << child << " in this iteration");
-                continue;
             } else {
-                name = "/" + child + "/" + name_sec1 + "/data";
-                shared_ptr<Name> newName = make_shared<Name>(name);
-                newName->appendSequenceNumber(seq);
-                std::string newNameString = newName->toUri();
-                value_agg.push_back(newNameString);
+                Name newName;
+                newName.append(child).append(interestName.get(1)).append(makeLeafComponent(m_childLeaves)).append("data");
+                newName.appendSequenceNumber(seq);
 
                 // Check whether incoming interest is a retransmission duplicate, if so, drop it directly
-                auto it = std::find(m_timeoutList.begin(), m_timeoutList.end(), newNameString);
-                if (it != m_timeoutList.end()) {
+                if (m_retxFilter.contains(newName, Simulator::Now())) {
                     isDuplicate = true;
                 }
 
                 // Store divided interests into interest list first, push into interest queue later if they're not duplicate retransmission
-                interestList.push_back(std::make_tuple(seq, isNewIteration, newName));
-                isNewIteration = false;
+                interestList.emplace_back(childId, std::move(newName));
             }
         }
 
         // If current packet isn't duplicate, then push divided interests into interest queue; otherwise, drop this interest
         // ToDo: is it possible to add logic to check whether the interest queue is full, if not, then drop the interest?
-        if (!isDuplicate) {
-            for (const auto& element : interestList) {
-                interestQueue.push(element);
-            }
-        } else {
+        if (isDuplicate) {
             NS_LOG_INFO("This is a duplicate retransmission from downstream, drop the entire packet!");
             return;
         }
 
-        if (map_agg_oldSeq_newName.find(seq) == map_agg_oldSeq_newName.end() && m_agg_newDataName.find(seq) == m_agg_newDataName.end()){
-            map_agg_oldSeq_newName[seq] = value_agg; // name segments
-            m_agg_newDataName[seq] = originalName; // whole name
+        // Names of an ongoing iteration are kept, only new iteration initializes the slot
+        bool isNewIteration = job->slots.find(seq) == nullptr;
+        AggregationSlot& slot = job->slots.insert(seq);
+        if (isNewIteration) {
+            slot.resize(job->childNames.size());
+            slot.dataName = interest->getName();
+            for (auto& [id, name] : interestList) {
+                slot.pending.set(id);
+                slot.childName[id] = std::move(name);
+            }
+            slot.expected = static_cast<uint32_t>(slot.pending.count());
+        }
+
+        for (const auto& element : interestList) {
+            // A child added by a tree update isn't part of iterations that started before the update
+            if (element.first >= slot.pending.size()) {
+                continue;
+            }
+            job->interestQueue.push(std::make_tuple(seq, isNewIteration, element.first));
+            isNewIteration = false;
         }
 
-        ScheduleNextPacket();
+        ScheduleNextPacket(*job);
     } else if (interestType == "initialization") {
+        // A tree that arrives after the first one is a repair of the aggregation tree of this job
+        bool isUpdate = job != nullptr && job->treeSync;
+
+        // Parse the binary tree descriptor
+        TreeDescriptor descriptor;
+        if (!interest->hasApplicationParameters() || !descriptor.wireDecode(interest->getApplicationParameters())) {
+            NS_LOG_DEBUG("Error! Can't parse aggregation tree from interest " << interestName);
+            return;
+        }
+
+        // A job is registered by the first tree it announces
+        if (job == nullptr) {
+            job = &AddJob(jobName);
+        }
+
         // Synchronize signal
-        treeSync = true;
+        job->treeSync = true;
 
-        // Extract useful info and parse it into readable format
-        std::vector<std::string> inputs;
-        if (interest->getName().size() > 3) {
-            for (size_t i = 1; i < interest->getName().size() - 2; ++i) {
-                inputs.push_back(interest->getName().get(i).toUri());
-            }
+        job->numProducers = descriptor.numProducers;
+        job->aggregationMap.clear();
+        for (auto& [child, leaves] : descriptor.children) {
+            job->aggregationMap[child] = std::move(leaves);
         }
-        aggregationMap = aggTreeProcessStrings(inputs);
 
         // Define for new congestion control
-        numChild = static_cast<int> (aggregationMap.size());
-        NS_LOG_DEBUG("The number of child nodes: " << numChild);
-
-        // testing, delete later!!!!
-/*        if (aggregationMap.empty())
-            NS_LOG_DEBUG("aggregationMap is empty!!!!!!!!!!!!!!!!!!!!!!!!!!!!");
-        else {
-            // Print the result mapping
-            for (const auto& [node, leaves] : aggregationMap) {
-                NS_LOG_DEBUG(node << " contains leaf nodes: ");
-                for (const auto& leaf : leaves) {
-                    NS_LOG_DEBUG(leaf << " ");
-                }
+        job->numChild = static_cast<int> (job->aggregationMap.size());
+        NS_LOG_DEBUG("The number of child nodes of job " << jobName << ": " << job->numChild);
+
+        // Assign child ids, on tree update existing children keep their ids so that ongoing iterations stay valid
+        if (!isUpdate) {
+            job->childNames.clear();
+            job->childId.clear();
+            job->slots.clear();
+        }
+        for (const auto& entry : job->aggregationMap) {
+            if (job->childId.find(entry.first) == job->childId.end()) {
+                job->childId[entry.first] = static_cast<uint32_t>(job->childNames.size());
+                job->childNames.push_back(entry.first);
             }
-        }*/
-
-        // Initialize file name
-        RTO_recorder = folderPath + "/" + m_prefix.toUri() + "_RTO.txt";
-        window_Recorder = folderPath + "/" + m_prefix.toUri() + "_window.txt";
-        responseTime_recorder = folderPath + "/" + m_prefix.toUri() + "_RTT.txt";
-        aggregateTime_recorder = folderPath + "/" + m_prefix.toUri() + "_aggregationTime.txt";
+        }
 
-        // Initialize logging session
-        InitializeLogFile();
+        if (isUpdate) {
+            NS_LOG_INFO("Aggregation tree of job " << jobName << " is updated, number of children: " << job->numChild);
+        } else {
+            // Initialize logging session
+            InitializeLogFile(*job);
 
-        // Start recording into logs
-        Simulator::Schedule(MilliSeconds(5), &Aggregator::RTORecorder, this);
+            // Start recording into logs
+            Simulator::Schedule(MilliSeconds(5), &Aggregator::RTORecorder, this, job->id);
+        }
 
         // Generate a new data packet to respond to tree broadcasting
         Name dataName(interest->getName());
@@ -830,58 +934,68 @@ Aggregator::OnInterest(shared_ptr<const Interest> interest)
 
 
 /**
- * Schedule next packet sending operation by cwnd
+ * Schedule next packet sending operation by cwnd of the job
+ * @param job
  */
 void
-Aggregator::ScheduleNextPacket()
+Aggregator::ScheduleNextPacket(JobState& job)
 {
-    if (!treeSync) {
-        NS_LOG_INFO("Haven't received aggregation tree, don't send new interests for now.");
+    if (!job.treeSync) {
+        NS_LOG_INFO("Haven't received aggregation tree of job " << job.name << ", don't send new interests for now.");
     }
-    else if (m_window == static_cast<uint32_t>(0)) {
-        Simulator::Remove(m_sendEvent);
+    else if (job.window == 0.0) {
+        Simulator::Remove(job.sendEvent);
         NS_LOG_DEBUG("New event in " << (std::min<double>(0.5, m_rtt->RetransmitTimeout().ToDouble(Time::S))) << " sec");
 
-        m_sendEvent = Simulator::Schedule(Seconds(std::min<double>(0.5, (m_retxTimer * 6).GetSeconds())), &Aggregator::SendPacket, this);
+        job.sendEvent = Simulator::Schedule(Seconds(std::min<double>(0.5, (m_retxTimer * 6).GetSeconds())), &Aggregator::SendPacket, this, job.id);
     }
-    else if (m_inFlight >= m_window) {
+    else if (job.inFlight >= job.window) {
         // do nothing
-        NS_LOG_INFO("m_inFlight >= m_window, do nothing.");
-        NS_LOG_DEBUG("Window: " << m_window << ", InFlight: " << m_inFlight);
+        NS_LOG_INFO("m_inFlight >= m_window of job " << job.name << ", do nothing.");
+        NS_LOG_DEBUG("Window: " << job.window << ", InFlight: " << job.inFlight);
     }
     else {
         // This step seems necessary if "m_window = 0" condition is triggered before
-        if (m_sendEvent.IsRunning()) {
-            Simulator::Remove(m_sendEvent);
+        if (job.sendEvent.IsRunning()) {
+            Simulator::Remove(job.sendEvent);
         }
-        NS_LOG_DEBUG("Window: " << m_window << ", InFlight: " << m_inFlight);
-        m_sendEvent = Simulator::ScheduleNow(&Aggregator::SendPacket, this);
+        NS_LOG_DEBUG("Job " << job.name << ", Window: " << job.window << ", InFlight: " << job.inFlight);
+        job.sendEvent = Simulator::ScheduleNow(&Aggregator::SendPacket, this, job.id);
     }
 }
 
 
 
 /**
- * Schedule to send new interests
+ * Schedule to send new interests of a job
+ * @param jobId
  */
 void
-Aggregator::SendPacket()
+Aggregator::SendPacket(uint32_t jobId)
 {
-    if (!interestQueue.empty()) {
-        auto interestTuple = interestQueue.front();
-        interestQueue.pop();
+    JobState& job = m_jobs[jobId];
+    if (!job.interestQueue.empty()) {
+        auto interestTuple = job.interestQueue.front();
+        job.interestQueue.pop();
         uint32_t iteration = std::get<0>(interestTuple);
         bool isNewIteration = std::get<1>(interestTuple);
-        shared_ptr<Name> name = std::get<2>(interestTuple);
-
-        // New iteration, start compute aggregation time
-        if (isNewIteration) {
-            aggregateStartTime[iteration] = ns3::Simulator::Now();
+        uint32_t childId = std::get<2>(interestTuple);
+
+        // Data of this child may have arrived already (e.g. retransmission from upper tier), no need to send again
+        AggregationSlot* slot = job.slots.find(iteration);
+        if (slot != nullptr && slot->pending.test(childId)) {
+            // New iteration, start compute aggregation time, the deadline measures the same interval
+            if (isNewIteration) {
+                slot->aggregateStart = ns3::Simulator::Now();
+                if (!m_partialDeadline.IsZero()) {
+                    slot->deadline = Simulator::Schedule(m_partialDeadline, &Aggregator::OnAggregationDeadline, this, jobId, iteration);
+                }
+            }
+            SendInterest(job, iteration, childId);
         }
-        SendInterest(name);
-        ScheduleNextPacket();
+        ScheduleNextPacket(job);
     } else {
-        NS_LOG_INFO("Pending new interests from upper tier...");
+        NS_LOG_INFO("Pending new interests of job " << job.name << " from upper tier...");
     }
 }
 
@@ -889,33 +1003,39 @@ Aggregator::SendPacket()
 
 /**
  * Format the interest packet and send out interests
- * @param newName
+ * @param job
+ * @param seq
+ * @param childId
  */
 void
-Aggregator::SendInterest(shared_ptr<Name> newName)
+Aggregator::SendInterest(JobState& job, uint32_t seq, uint32_t childId)
 {
     if (!m_active)
         return;
 
-    std::string nameWithSeq = newName->toUri();
-
-    // Trace timeout
-    m_timeoutCheck[nameWithSeq] = ns3::Simulator::Now();
+    AggregationSlot* slot = job.slots.find(seq);
+    if (slot == nullptr) {
+        NS_LOG_DEBUG("No state for seq " << seq << " of job " << job.name << ", interest isn't sent!");
+        return;
+    }
 
-    // Start response time
-    startTime[nameWithSeq] = ns3::Simulator::Now();
+    // Trace timeout and start response time
+    slot->inFlight.set(childId);
+    slot->sendTime[childId] = ns3::Simulator::Now();
+    ScheduleRetxCheck(m_retxWheel.schedule(RetxKey(job.id, seq, childId), slot->sendTime[childId] + job.timeoutThreshold));
 
-    NS_LOG_INFO("Sending new interest >>>> " << nameWithSeq);
+    NS_LOG_INFO("Sending new interest >>>> " << slot->childName[childId]);
     shared_ptr<Interest> newInterest = make_shared<Interest>();
     newInterest->setNonce(m_rand->GetValue(0, std::numeric_limits<uint32_t>::max()));
     newInterest->setCanBePrefix(false);
-    newInterest->setName(*newName);
+    newInterest->setName(slot->childName[childId]);
     time::milliseconds interestLifeTime(m_interestLifeTime.GetMilliSeconds());
     newInterest->setInterestLifetime(interestLifeTime);
     m_transmittedInterests(newInterest, this, m_face);
     m_appLink->onReceiveInterest(*newInterest);
 
     // Designed for Window
+    job.inFlight++;
     m_inFlight++;
 
     // Record interest throughput
@@ -951,288 +1071,300 @@ Aggregator::OnData(shared_ptr<const Data> data)
     totalDataThroughput += dataSize;
     NS_LOG_DEBUG("The incoming data packet size is: " << dataSize);
 
-    // Stop checking timeout associated with this seq
-    if (m_timeoutCheck.find(dataName) != m_timeoutCheck.end())
-        m_timeoutCheck.erase(dataName);
-    else
-        NS_LOG_DEBUG("Data " << dataName << " doesn't exist in the map, please check!");
+    // Find the job, the state of this iteration and the child who sends the data, names are "/Child/Job/LeafBitmap/data/Seq"
+    JobState* job = FindJob(data->getName().get(1).toUri());
+    if (job == nullptr) {
+        NS_LOG_INFO("Data " << dataName << " doesn't belong to any job served by this aggregator, do nothing!");
+        return;
+    }
+    AggregationSlot* slot = job->slots.find(seq);
+    auto childIt = job->childId.find(data->getName().get(0).toUri());
+    if (slot == nullptr || childIt == job->childId.end() || childIt->second >= slot->pending.size() || !slot->pending.test(childIt->second)) {
+        NS_LOG_INFO("Data " << dataName << " isn't required by any ongoing iteration, meaning this data packet is duplicate, do nothing!");
+        return;
+    }
+    uint32_t childId = childIt->second;
 
     // Check whether this is a retransmission packet
-    auto timeoutItem = std::find(m_timeoutList.begin(),  m_timeoutList.end(), dataName);
-    if (timeoutItem != m_timeoutList.end()) {
+    if (m_retxFilter.contains(data->getName(), Simulator::Now())) {
         NS_LOG_INFO("This packet is retransmission packet.");
     }
 
     // Perform data name matching with interest name
-    ModelData modelData;
+    ModelDataView modelData;
+    if (!modelData.parse(data->getContent())) {
+        // Keep the child in flight, its retransmission timer requests the data again
+        NS_LOG_INFO("Data " << dataName << " can't be parsed, do nothing!");
+        return;
+    }
 
-    // Initialize congestionSignal for new iteration
-    if (sumParameters.find(seq) == sumParameters.end())
-        congestionSignal[seq] = false;
+    // Stop checking timeout associated with this seq
+    slot->inFlight.reset(childId);
+    m_retxWheel.cancel(RetxKey(job->id, seq, childId));
+
+    // Response time computation (RTT)
+    Time responseTime = ns3::Simulator::Now() - slot->sendTime[childId];
+    ResponseTimeSum(responseTime.GetMilliSeconds());
+
+    // Reset RetxTimer and timeout interval
+    job->RTO_Timer = RTOMeasurement(*job, responseTime.GetMilliSeconds());
+    job->timeoutThreshold = job->RTO_Timer;
+    NS_LOG_DEBUG("responseTime for name : " << dataName << " is: " << responseTime.GetMilliSeconds() << " ms");
+    NS_LOG_DEBUG("RTO measurement of job " << job->name << ": " << job->RTO_Timer.GetMilliSeconds() << " ms");
+
+    // Setup RTT_threshold based on RTT of the first 5 iterations, then update RTT_threshold after each new iteration based on EWMA
+    // ToDo: What about setting up a initial cwnd to run several iterations, other than start cwnd from 1
+    RTTThresholdMeasure(*job, responseTime.GetMilliSeconds());
+
+    // RTT_threshold measurement initialization is done after 3 iterations, before that, don't perform cwnd control
+    if (job->RTT_count >= job->numChild * 3 && responseTime.GetMilliSeconds() > job->RTT_threshold) {
+        ECNLocal = true;
+    }
 
-    auto data_map = map_agg_oldSeq_newName.find(seq);
-    if (data_map != map_agg_oldSeq_newName.end())
-    {
-        // Response time computation (RTT)
-        if (startTime.find(dataName) != startTime.end()){
-            responseTime[dataName] = ns3::Simulator::Now() - startTime[dataName];
-            ResponseTimeSum(responseTime[dataName].GetMilliSeconds());
-            startTime.erase(dataName);
-        }
+    // Aggregation starts
+    aggregate(modelData, *slot);
+    ECNRemote = !modelData.congestedNodes().empty();
+    slot->pending.reset(childId);
 
-        // Reset RetxTimer and timeout interval
-        RTO_Timer = RTOMeasurement(responseTime[dataName].GetMilliSeconds());
-        m_timeoutThreshold = RTO_Timer;
-        NS_LOG_DEBUG("responseTime for name : " << dataName << " is: " << responseTime[dataName].GetMilliSeconds() << " ms");
-        NS_LOG_DEBUG("RTO measurement: " << RTO_Timer.GetMilliSeconds() << " ms");
+    // Record RTT
+    ResponseTimeRecorder(*job, responseTime, seq, ECNLocal, job->RTT_threshold);
 
-        // Setup RTT_threshold based on RTT of the first 5 iterations, then update RTT_threshold after each new iteration based on EWMA
-        // ToDo: What about setting up a initial cwnd to run several iterations, other than start cwnd from 1
-        RTTThresholdMeasure(responseTime[dataName].GetMilliSeconds());
+    /// AIMD begins
+    if (job->highData < seq) {
+        job->highData = seq;
+    }
 
-        // RTT_threshold measurement initialization is done after 3 iterations, before that, don't perform cwnd control
-        if (RTT_count >= numChild * 3 && responseTime[dataName].GetMilliSeconds() > RTT_threshold) {
-            ECNLocal = true;
+    if (data->getCongestionMark() > 0) {
+        if (m_reactToCongestionMarks) {
+            NS_LOG_DEBUG("Received congestion mark: " << data->getCongestionMark());
+            //WindowDecrease("RTT_threshold");
         }
-
-        // Aggregation starts
-        auto& vec = data_map->second;
-        auto vecIt = std::find(vec.begin(), vec.end(), dataName);
-        std::vector<uint8_t> oldbuffer(data->getContent().value(), data->getContent().value() + data->getContent().value_size());
-
-        if (deserializeModelData(oldbuffer, modelData) && vecIt != vec.end()) {
-            aggregate(modelData, seq);
-            ECNRemote = !modelData.congestedNodes.empty();
-            vec.erase(vecIt);
-        } else{
-            NS_LOG_INFO("Data name doesn't exist in map_agg_oldSeq_newName, meaning this data packet is duplicate, do nothing!");
-            return;
+        else {
+            NS_LOG_DEBUG("Ignored received congestion mark: " << data->getCongestionMark());
         }
+    }
+    else if (ECNLocal) {
+        if (!CanDecreaseWindow(*job, job->RTT_measurement)) {
+            NS_LOG_INFO("Window decrease is suppressed.");
+        } else {
+            NS_LOG_INFO("Congestion signal exists in consumer!");
+            WindowDecrease(*job, "LocalCongestion");
+        }
+        slot->congestionSignal = true;
+    }
+/*    else if (ECNRemote) {
+        NS_LOG_INFO("Remote congestion is detected.");
+        WindowDecrease("RemoteCongestion");
+    }*/
+    else {
+        NS_LOG_INFO("No congestion, increase the cwnd.");
+        WindowIncrease(*job);
+    }
 
-        // Record RTT
-        ResponseTimeRecorder(responseTime[dataName], seq, ECNLocal, RTT_threshold);
+    if (job->inFlight > static_cast<uint32_t>(0)) {
+        job->inFlight--;
+        m_inFlight--;
+    }
 
-        /// AIMD begins
-        if (m_highData < seq) {
-            m_highData = seq;
-        }
+    NS_LOG_DEBUG("Job " << job->name << ", Window: " << job->window << ", InFlight: " << job->inFlight);
 
-        if (data->getCongestionMark() > 0) {
-            if (m_reactToCongestionMarks) {
-                NS_LOG_DEBUG("Received congestion mark: " << data->getCongestionMark());
-                //WindowDecrease("RTT_threshold");
-            }
-            else {
-                NS_LOG_DEBUG("Ignored received congestion mark: " << data->getCongestionMark());
-            }
-        }
-        else if (ECNLocal) {
-            if (!CanDecreaseWindow(RTT_measurement)) {
-                NS_LOG_INFO("Window decrease is suppressed.");
-            } else {
-                NS_LOG_INFO("Congestion signal exists in consumer!");
-                WindowDecrease("LocalCongestion");
-            }
-            congestionSignal[seq] = true;
-        }
-/*        else if (ECNRemote) {
-            NS_LOG_INFO("Remote congestion is detected.");
-            WindowDecrease("RemoteCongestion");
-        }*/
-        else {
-            NS_LOG_INFO("No congestion, increase the cwnd.");
-            WindowIncrease();
-        }
+    // Record window after each new packet arrives
+    WindowRecorder(*job);
 
-        if (m_inFlight > static_cast<uint32_t>(0)) {
-            m_inFlight--;
-        }
+    ScheduleNextPacket(*job);
+    /// AIMD ends
 
-        NS_LOG_DEBUG("Window: " << m_window << ", InFlight: " << m_inFlight);
+    // Check whether the aggregation of current iteration is done, or enough children have responded
+    if (slot->pending.none() || IsPartialReady(*slot)){
+        SendAggregatedData(*job, seq, *slot);
+    } else{
+        NS_LOG_DEBUG("Wait for others to aggregate.");
+    }
+}
 
-        // Record window after each new packet arrives
-        WindowRecorder();
 
-        ScheduleNextPacket();
-        /// AIMD ends
 
-        // Check whether the aggregation of current iteration is done
-        if (vec.empty()){
-            NS_LOG_DEBUG("Aggregation finished.");
-            // reset the aggregation count
-            count[seq] = 0;
+/**
+ * Send the aggregation result of an iteration to upper tier and release its states
+ * @param job
+ * @param seq
+ * @param slot States of the iteration, children still pending are abandoned
+ */
+void
+Aggregator::SendAggregatedData(JobState& job, uint32_t seq, AggregationSlot& slot)
+{
+    if (slot.pending.none()) {
+        NS_LOG_DEBUG("Aggregation finished.");
+    } else {
+        NS_LOG_DEBUG("Partial aggregation finished, " << slot.pending.count() << " children are abandoned.");
+    }
 
-            // Aggregation time computation
-            if (aggregateStartTime.find(seq) != aggregateStartTime.end()) {
-                aggregateTime[seq] = ns3::Simulator::Now() - aggregateStartTime[seq];
-                AggregateTimeSum(aggregateTime[seq].GetMilliSeconds());
-                aggregateStartTime.erase(seq);
-                NS_LOG_INFO("Aggregator's aggregate time of sequence " << seq << " is: " << aggregateTime[seq].GetMilliSeconds() << " ms");
-            } else {
-                NS_LOG_DEBUG("Error when calculating aggregation time, no reference found for seq " << seq);
-            }
+    // Aggregation time computation
+    Time aggregateTime = ns3::Simulator::Now() - slot.aggregateStart;
+    AggregateTimeSum(aggregateTime.GetMilliSeconds());
+    NS_LOG_INFO("Aggregator's aggregate time of sequence " << seq << " of job " << job.name << " is: " << aggregateTime.GetMilliSeconds() << " ms");
 
-            // Record aggregation time
-            AggregateTimeRecorder(aggregateTime[seq]);
+    // Record aggregation time
+    AggregateTimeRecorder(job, aggregateTime);
 
-            // Get aggregation result for current iteration
-            std::vector<uint8_t> newbuffer;
-            serializeModelData(getMean(seq), newbuffer);
+    // Add congestionSignal of current node if necessary
+    if (slot.congestionSignal) {
+        slot.congestedNodes.push_back(m_prefix.toUri());
+        NS_LOG_DEBUG("Congestion detected on current node!");
+    }
 
-            // create data packet
-            auto data = make_shared<Data>();
+    // Get aggregation result for current iteration, serialize straight from the slot
+    auto newbuffer = make_shared< ::ndn::Buffer>();
+    serializeModelData(slot.sum, slot.congestedNodes, *newbuffer, slot.contributors, m_codec);
 
-            std::string name_string = m_agg_newDataName[seq];
-            NS_LOG_DEBUG("New aggregated data's name: " << name_string);
+    // create data packet
+    auto data = make_shared<Data>();
 
-            shared_ptr<Name> newName = make_shared<Name>(name_string);
-            data->setName(*newName);
-            data->setContent(make_shared< ::ndn::Buffer>(newbuffer.begin(), newbuffer.end()));
-            data->setFreshnessPeriod(::ndn::time::milliseconds(m_freshness.GetMilliSeconds()));
-            SignatureInfo signatureInfo(static_cast< ::ndn::tlv::SignatureTypeValue>(255));
+    NS_LOG_DEBUG("New aggregated data's name: " << slot.dataName);
+    data->setName(slot.dataName);
+    data->setContent(newbuffer);
+    data->setFreshnessPeriod(::ndn::time::milliseconds(m_freshness.GetMilliSeconds()));
+    SignatureInfo signatureInfo(static_cast< ::ndn::tlv::SignatureTypeValue>(255));
 
-            if (m_keyLocator.size() > 0){
-                signatureInfo.setKeyLocator(m_keyLocator);
-            }
-            data->setSignatureInfo(signatureInfo);
-            ::ndn::EncodingEstimator estimator;
-            ::ndn::EncodingBuffer encoder(estimator.appendVarNumber(m_signature), 0);
-            encoder.appendVarNumber(m_signature);
-            data->setSignatureValue(encoder.getBuffer());
-            data->wireEncode();
-            m_transmittedDatas(data, this, m_face);
-            m_appLink->onReceiveData(*data);
-
-            // All iterations have finished, record the entire throughput
-            if (seq == m_iteNum) {
-                ThroughputRecorder(totalInterestThroughput, totalDataThroughput);
+    if (m_keyLocator.size() > 0){
+        signatureInfo.setKeyLocator(m_keyLocator);
+    }
+    data->setSignatureInfo(signatureInfo);
+    ::ndn::EncodingEstimator estimator;
+    ::ndn::EncodingBuffer encoder(estimator.appendVarNumber(m_signature), 0);
+    encoder.appendVarNumber(m_signature);
+    data->setSignatureValue(encoder.getBuffer());
+    data->wireEncode();
+    m_transmittedDatas(data, this, m_face);
+    m_appLink->onReceiveData(*data);
+
+    // Stop waiting for stragglers, their late responses are dropped as duplicates once the slot is released
+    bool released = false;
+    for (size_t childId = slot.pending.find_first(); childId != boost::dynamic_bitset<>::npos; childId = slot.pending.find_next(childId)) {
+        ++numStragglers;
+        if (slot.inFlight.test(childId)) {
+            m_retxWheel.cancel(RetxKey(job.id, seq, childId));
+            if (job.inFlight > static_cast<uint32_t>(0)) {
+                job.inFlight--;
+                m_inFlight--;
             }
-
-        } else{
-            NS_LOG_DEBUG("Wait for others to aggregate.");
+            released = true;
         }
-    }else{
-        NS_LOG_DEBUG("Error, data name can't be recognized!");
-        ns3::Simulator::Stop();
+    }
+    slot.deadline.Cancel();
+
+    // Release the slot, its buffers are reused by later iterations
+    job.slots.erase(seq);
+    if (released) {
+        ScheduleNextPacket(job);
+    }
+
+    // All iterations of the job have finished, record the entire throughput
+    if (seq == m_iteNum) {
+        ThroughputRecorder(totalInterestThroughput, totalDataThroughput);
     }
 }
 
 
 
 /**
- * Record window when receiving a new packet
+ * Record window of a job when receiving a new packet
+ * @param job
  */
 void
-Aggregator::WindowRecorder()
+Aggregator::WindowRecorder(JobState& job)
 {
-    // Open file; on first call, truncate it to delete old content
-    std::ofstream file(window_Recorder, std::ios::app);
-
-    if (file.is_open()) {
-        file << ns3::Simulator::Now().GetMilliSeconds() << " " << m_window << "\n";  // Write text followed by a newline
-        file.close();          // Close the file after writing
-    } else {
-        std::cerr << "Unable to open file: " << window_Recorder << std::endl;
-    }
+    LogSink::Get().Write(job.windowLog, ns3::Simulator::Now().GetMilliSeconds(), job.window);
+    MetricsRegistry::Get().Set(job.metrics.window, job.window);
+    MetricsRegistry::Get().Set(job.metrics.inFlight, job.inFlight);
 }
 
 
 
 /**
- * Record RTT every 5 ms, and store them in a file
+ * Record RTT of a job every 5 ms, and store them in a file
+ * @param jobId
  */
 void
-Aggregator::RTORecorder()
+Aggregator::RTORecorder(uint32_t jobId)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(RTO_recorder, std::ios::app);
-
-    if (!file.is_open()) {
-        std::cerr << "Failed to open the file: " << RTO_recorder << std::endl;
-        return;
-    }
-
-    // Write the response_time to the file, followed by a newline
-    file << ns3::Simulator::Now().GetMilliSeconds() << " " << RTO_Timer.GetMilliSeconds() << std::endl;
-
-    // Close the file
-    file.close();
-    Simulator::Schedule(MilliSeconds(5), &Aggregator::RTORecorder, this);
+    JobState& job = m_jobs[jobId];
+    LogSink::Get().Write(job.rtoLog, ns3::Simulator::Now().GetMilliSeconds(), job.RTO_Timer.GetMilliSeconds());
+    MetricsRegistry::Get().Set(job.metrics.rto, job.RTO_Timer.GetMilliSeconds());
+    Simulator::Schedule(MilliSeconds(5), &Aggregator::RTORecorder, this, jobId);
 }
 
 
 
 /**
  * Record the response time for each returned packet, store them in a file
+ * @param job
  * @param responseTime
  */
 void
-Aggregator::ResponseTimeRecorder(Time responseTime, uint32_t seq, bool ECN, int64_t threshold_actual) {
-    // Open the file using fstream in append mode
-    std::ofstream file(responseTime_recorder, std::ios::app);
-
-    if (!file.is_open()) {
-        std::cerr << "Failed to open the file: " << responseTime_recorder << std::endl;
-        return;
-    }
+Aggregator::ResponseTimeRecorder(JobState& job, Time responseTime, uint32_t seq, bool ECN, int64_t threshold_actual) {
+    LogSink::Get().Write(job.responseTimeLog, ns3::Simulator::Now().GetMilliSeconds(), seq, ECN, threshold_actual, responseTime.GetMilliSeconds());
 
-    // Write the response_time to the file, followed by a newline
-    file << ns3::Simulator::Now().GetMilliSeconds() << " " << seq << " " << ECN << " " << threshold_actual << " " << responseTime.GetMilliSeconds() << std::endl;
-
-    // Close the file
-    file.close();
+    MetricsRegistry& registry = MetricsRegistry::Get();
+    registry.Record(job.metrics.rtt, responseTime.GetMilliSeconds());
+    registry.Set(job.metrics.rttMeasurement, job.RTT_measurement);
+    registry.Set(job.metrics.rttThreshold, threshold_actual);
 }
 
 
 
 /**
  * Record the aggregate time when each iteration finished
+ * @param job
  * @param aggregateTime
  */
 void
-Aggregator::AggregateTimeRecorder(Time aggregateTime) {
-    // Open the file using fstream in append mode
-    std::ofstream file(aggregateTime_recorder, std::ios::app);
-
-    if (!file.is_open()) {
-        std::cerr << "Failed to open the file: " << aggregateTime_recorder << std::endl;
-        return;
-    }
-
-    // Write aggregation time to file, followed by a new line
-    file << Simulator::Now().GetMilliSeconds() << " " << aggregateTime.GetMilliSeconds() << std::endl;
-
-    file.close();
+Aggregator::AggregateTimeRecorder(JobState& job, Time aggregateTime) {
+    LogSink::Get().Write(job.aggregateTimeLog, Simulator::Now().GetMilliSeconds(), aggregateTime.GetMilliSeconds());
+    MetricsRegistry::Get().Record(job.aggregateTimeMetric, aggregateTime.GetMilliSeconds());
 }
 
 
 
 /**
- * Initialize all new log files, called in the beginning of simulation
+ * Initialize all new log files of a job, called when the job announces its tree
+ * The default job keeps the files named after the aggregator, other jobs append their name, e.g. "agg0-job1_RTO.txt"
+ * @param job
  */
 void
-Aggregator::InitializeLogFile()
+Aggregator::InitializeLogFile(JobState& job)
 {
     // Check whether the object path exists, if not, create it first
     CheckDirectoryExist(folderPath);
 
-    // Open the file and clear all contents for all log files
-    OpenFile(RTO_recorder);
-    OpenFile(responseTime_recorder);
-    OpenFile(aggregateTime_recorder);
-    OpenFile(window_Recorder);
+    // Register all log files, their contents are cleared
+    std::string node = m_prefix.toUri().substr(1);
+    std::string prefix = GetLogPrefix(node, job.name);
+    job.rtoLog = OpenLog(prefix + "_RTO.txt", {"time", "RTO"});
+    job.responseTimeLog = OpenLog(prefix + "_RTT.txt", {"time", "seq", "ECN", "threshold", "RTT"});
+    job.aggregateTimeLog = OpenLog(prefix + "_aggregationTime.txt", {"time", "aggregateTime"});
+    job.windowLog = OpenLog(prefix + "_window.txt", {"time", "window"});
+    if (m_throughputLog == LogSink::INVALID_CHANNEL) {
+        throughput_recorder = folderPath + "/throughput.txt";
+        m_throughputLog = OpenLog(throughput_recorder, {"interestThroughput", "dataThroughput", "time"});
+    }
+
+    // Register metrics of the job, ignored unless the metrics registry is enabled
+    job.metrics.Register(node, job.name);
+    job.aggregateTimeMetric = MetricsRegistry::Get().Register(MetricsRegistry::Type::kHistogram, node, job.name, "aggregationTime");
 }
 
 
 
 /**
- * Check whether the cwnd has been decreased within the last RTT duration
+ * Check whether the cwnd of a job has been decreased within the last RTT duration
+ * @param job
  * @param threshold
  */
 bool
-Aggregator::CanDecreaseWindow(int64_t threshold)
+Aggregator::CanDecreaseWindow(JobState& job, int64_t threshold)
 {
-    if (Simulator::Now().GetMilliSeconds() - LastWindowDecreaseTime.GetMilliSeconds() >= threshold) {
+    if (Simulator::Now().GetMilliSeconds() - job.lastWindowDecreaseTime.GetMilliSeconds() >= threshold) {
         return true;
     } else {
         return false;
@@ -1249,18 +1381,7 @@ Aggregator::CanDecreaseWindow(int64_t threshold)
 void
 Aggregator::ThroughputRecorder(int interestThroughput, int dataThroughput)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(throughput_recorder, std::ios::app);
-
-    if (!file.is_open()) {
-        std::cerr << "Failed to open the file: " << throughput_recorder << std::endl;
-        return;
-    }
-
-    // Write aggregation time to file, followed by a new line
-    file << interestThroughput << " " << dataThroughput << " 0" << std::endl;
-
-    file.close();
+    LogSink::Get().Write(m_throughputLog, interestThroughput, dataThroughput, 0);
 }
 
 } // namespace ndn
@@ -9,6 +9,12 @@
 
 #include "ndn-app.hpp"
 #include "ModelData.hpp"
+#include "TreeDescriptor.hpp"
+#include "SeqSlotTable.hpp"
+#include "TimerWheel.hpp"
+#include "RetxFilter.hpp"
+#include "LogSink.hpp"
+#include "MetricsRegistry.hpp"
 
 #include "ns3/random-variable-stream.h"
 #include "ns3/nstime.h"
@@ -30,12 +36,14 @@
 #include <queue>
 #include <utility>
 #include <deque>
+#include <unordered_map>
+#include <limits>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/tag.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/member.hpp>
-#include <boost/circular_buffer.hpp>
+#include <boost/dynamic_bitset.hpp>
 
 namespace ns3{
 namespace ndn{
@@ -55,13 +63,20 @@ public:
 
     virtual void OnData(shared_ptr<const Data> data);
 
-    virtual void ScheduleNextPacket();
+    // Training jobs served by this aggregator
+    struct JobState;
 
-    void SendPacket();
+    JobState* FindJob(const std::string& jobName);
 
-    void SendInterest(shared_ptr<Name> newName);
+    JobState& AddJob(const std::string& jobName);
 
-    virtual void OnTimeout(std::string nameString);
+    void ScheduleNextPacket(JobState& job);
+
+    void SendPacket(uint32_t jobId);
+
+    void SendInterest(JobState& job, uint32_t seq, uint32_t childId);
+
+    virtual void OnTimeout(JobState& job, uint32_t seq, uint32_t childId);
 
     virtual void OnNack(shared_ptr<const lp::Nack> nack);
 
@@ -75,14 +90,21 @@ public:
 
     uint32_t GetSeqMax() const;
 
-    void WindowIncrease();
+    void WindowIncrease(JobState& job);
 
-    void WindowDecrease(std::string type);
+    void WindowDecrease(JobState& job, std::string type);
 
     // Data aggregation
-    void aggregate(const ModelData& data, const uint32_t& seq);
+    struct AggregationSlot;
+
+    void aggregate(const ModelDataView& data, AggregationSlot& slot);
 
-    ModelData getMean(const uint32_t& seq);
+    // Straggler-tolerant (k-of-n) aggregation
+    bool IsPartialReady(const AggregationSlot& slot) const;
+
+    void OnAggregationDeadline(uint32_t jobId, uint32_t seq);
+
+    void SendAggregatedData(JobState& job, uint32_t seq, AggregationSlot& slot);
 
 
     // Compute RTT/ Aggregation time
@@ -98,30 +120,25 @@ public:
     int64_t
     GetAggregateTimeAverage();
 
-    Time RTOMeasurement(int64_t resTime);
+    Time RTOMeasurement(JobState& job, int64_t resTime);
 
     // Measure threshold for congestion control
-    void RTTThresholdMeasure(int64_t responseTime);
-
-
-    // Parse the received aggregation tree
-    std::pair<std::string, std::set<std::string>> aggTreeProcessSingleString(const std::string& input);
+    void RTTThresholdMeasure(JobState& job, int64_t responseTime);
 
-    std::map<std::string, std::set<std::string>> aggTreeProcessStrings(const std::vector<std::string>& inputs);
 
 
     // For testing purpose, measure the consumer's window
-    void WindowRecorder();
+    void WindowRecorder(JobState& job);
 
-    void RTORecorder();
+    void RTORecorder(uint32_t jobId);
 
-    void ResponseTimeRecorder(Time responseTime, uint32_t seq, bool ECN, int64_t threshold_actual);
+    void ResponseTimeRecorder(JobState& job, Time responseTime, uint32_t seq, bool ECN, int64_t threshold_actual);
 
-    void AggregateTimeRecorder(Time aggregateTime);
+    void AggregateTimeRecorder(JobState& job, Time aggregateTime);
 
-    void InitializeLogFile();
+    void InitializeLogFile(JobState& job);
 
-    bool CanDecreaseWindow(int64_t threshold);
+    bool CanDecreaseWindow(JobState& job, int64_t threshold);
 
     void ThroughputRecorder(int interestThroughput, int dataThroughput);
 
@@ -132,6 +149,8 @@ protected:
 
     void CheckRetxTimeout();
 
+    void ScheduleRetxCheck(Time when);
+
     void SetRetxTimer(Time retxTimer);
 
     Time GetRetxTimer() const;
@@ -153,14 +172,9 @@ public:
 protected:
     // log file
     // All logs start to write after synchronization, make sure only the chosen aggregators will generate log files; those aren't chosen will disable this function
-    std::string RTO_recorder;
-    std::string window_Recorder;
-    std::string responseTime_recorder;
-    std::string aggregateTime_recorder;
+    LogSink::Channel m_throughputLog = LogSink::INVALID_CHANNEL;
     int suspiciousPacketCount;
 
-    // Update when WindowDecrease() is called every time, used for CWA algorithm
-    Time LastWindowDecreaseTime;
     bool isWindowDecreaseSuppressed;
 
 
@@ -168,33 +182,18 @@ protected:
     int totalInterestThroughput;
     int totalDataThroughput;
 
-    // Tree broadcast synchronization
-    bool treeSync;
-
-    // Congestion control, measure RTT threshold to detect congestion
-    int numChild;
-    std::vector<int64_t> RTT_threshold_vec;
-    int64_t RTT_threshold; // Actual threshold used to detect congestion
-    int64_t RTT_measurement; // The estimated RTT value using EWMA
-    int RTT_count; // How many RTT packets this node has received, used to estimate how many iterations have passed
-    float RTT_a; // Factor used in EWMA, recommended value is between 0.1 and 0.3
-    float Threshold_factor; // Factor to compute "RTT_threshold", i.e. "RTT_threshold = Threshold_factor * RTT_measurement"
-
     // Congestion signal
     bool ECNLocal;
     bool ECNRemote;
 
-    // cwnd management
+    // cwnd management, every job has its own window starting from the initial one
     uint32_t m_initialWindow;
-    TracedValue<double> m_window;
-    TracedValue<uint32_t> m_inFlight;
+    TracedValue<double> m_window; // Sum of windows of all jobs
+    TracedValue<uint32_t> m_inFlight; // Outstanding interests of all jobs
     bool m_setInitialWindowOnTimeout;
 
     // AIMD cwnd management
-    double m_ssthresh;
     bool m_useCwa;
-    uint32_t m_highData;
-    double m_recPoint;
     double m_alpha; // Timeout decrease factor
     double m_beta; // Local congestion decrease factor
     double m_gamma; // Remote congestion decrease factor
@@ -205,10 +204,20 @@ protected:
     int m_maxQueue; // Max queue size
     uint32_t m_iteNum;
 
+    // Forward a partial sum once this fraction of children has arrived, 1.0 waits for all of them
+    double m_partialFraction;
+    // Forward whatever has arrived once this time has passed since the iteration started, 0 disables it
+    Time m_partialDeadline;
+    int numStragglers; // Child responses abandoned by partial aggregation
+
+    // Encoding of forwarded aggregation results, children may use any codec
+    std::string m_payloadCodec;
+    double m_topKRatio;
+    PayloadCodec m_codec;
+
 
     uint32_t m_seq;      ///< @brief currently requested sequence number
     uint32_t m_seqMax;   ///< @brief maximum number of sequence number
-    EventId m_sendEvent; ///< @brief EventId of pending "send packet" event
     Time m_retxTimer;    ///< @brief Currently estimated retransmission timer
     EventId m_retxEvent; ///< @brief Event to check whether or not retransmission should be performed
 
@@ -221,45 +230,141 @@ protected:
     Name m_keyLocator;
 
 
-    // Interest queue definition (interest name)
-    std::queue<std::tuple<uint32_t, bool, shared_ptr<Name>>> interestQueue;
-
-    // Timeout check and RTT measurement
-    std::map<std::string, ns3::Time> m_timeoutCheck;
-    Time m_timeoutThreshold;
-    int64_t SRTT;
-    int64_t RTTVAR;
-    int roundRTT;
-    Time RTO_Timer;
-    int numTimeout;
+    // Timeout check of all jobs, timers are keyed by (job id << 48 | child id << 32 | seq)
+    TimerWheel<uint64_t> m_retxWheel;
+    Time m_initialTimeout;
 
     // This one is used to make sure duplicate retransmission request from upper tier will be ignored
-    boost::circular_buffer<std::string> m_timeoutList; // Currently initialize with size of 100
-
-    // Aggregation list
-    std::map<uint32_t, std::vector<std::string>> map_agg_oldSeq_newName; // name segments
-    std::map<uint32_t, std::string> m_agg_newDataName; // whole name
-
-    // Aggregation variables storage
-    std::map<uint32_t, std::vector<float>> sumParameters; // result after performing mean average aggregation
-    std::map<uint32_t, int> count; // count of aggregation
-    std::map<uint32_t, std::vector<std::string>> congestionSignalList; // result after aggregating congestion signal
-    std::map<uint32_t, bool> congestionSignal; // congestion signal for current node
-
+    RetxFilter m_retxFilter;
+    uint32_t m_retxFilterCapacity;
+    Time m_retxFilterLifetime;
 
     // Response/Aggregation time measurement
-    std::map<std::string, ns3::Time> startTime;
-    std::map<std::string, ns3::Time> responseTime;
     int64_t totalResponseTime;
     int round;
 
-    std::map<uint32_t, ns3::Time> aggregateStartTime;
-    std::map<uint32_t, ns3::Time> aggregateTime;
     int64_t totalAggregateTime;
     int iteration;
 
-    // Receive aggregation tree from consumer
-    std::map<std::string, std::set<std::string>> aggregationMap;
+    LeafBitmap m_requestedLeaves; // Scratch bitmaps for interest splitting, reused to avoid allocation
+    LeafBitmap m_childLeaves;
+
+public:
+    /**
+     * All states of one iteration (seq), indexed by child id where applicable
+     */
+    struct AggregationSlot {
+        boost::dynamic_bitset<> pending; // children whose data is still required
+        boost::dynamic_bitset<> inFlight; // children with an outstanding interest, checked for timeout
+        std::vector<Time> sendTime; // last (re)transmission time of each child's interest
+        std::vector<Name> childName; // interest name sent to each child
+        Name dataName; // name of the aggregated data returned to upper tier
+        std::vector<float> sum; // aggregation buffer, capacity is kept when the slot is reused
+        int count; // children aggregated so far
+        uint32_t expected; // children required when the iteration started
+        uint32_t contributors; // producers summed in "sum"
+        bool expired; // deadline has passed, forward as soon as anything is aggregated
+        EventId deadline;
+        std::vector<std::string> congestedNodes; // result after aggregating congestion signal
+        bool congestionSignal; // congestion signal for current node
+        Time aggregateStart;
+
+        void reset()
+        {
+            pending.reset();
+            inFlight.reset();
+            sum.clear();
+            count = 0;
+            expected = 0;
+            contributors = 0;
+            expired = false;
+            deadline.Cancel();
+            congestedNodes.clear();
+            congestionSignal = false;
+            aggregateStart = Time();
+        }
+
+        void resize(size_t numChild)
+        {
+            pending.resize(numChild);
+            inFlight.resize(numChild);
+            sendTime.resize(numChild);
+            childName.resize(numChild);
+        }
+    };
+
+    /**
+     * All states of one training job, identified by the job component of interest names ("/NextHop/Job/LeafBitmap/Type/Seq")
+     * Jobs share the face and links of the aggregator, but each has its own tree, sequence space, window and slots
+     */
+    struct JobState {
+        uint32_t id;
+        std::string name;
+
+        // Receive aggregation tree from consumer, child node -> bitmap of producers reached through it
+        bool treeSync = false;
+        std::map<std::string, LeafBitmap> aggregationMap;
+        uint32_t numProducers = 0;
+        int numChild = 0;
+
+        // Child nodes are referred by compact ids, assigned in the order of aggregationMap
+        std::vector<std::string> childNames;
+        std::unordered_map<std::string, uint32_t> childId;
+
+        // Per-iteration states, ring buffer indexed by seq
+        SeqSlotTable<AggregationSlot> slots;
+
+        // Interest queue definition (seq, whether it's a new iteration, child id)
+        std::queue<std::tuple<uint32_t, bool, uint32_t>> interestQueue;
+        EventId sendEvent;
+
+        // cwnd management
+        double window = 0.0;
+        uint32_t inFlight = 0;
+        double ssthresh = std::numeric_limits<double>::max();
+        uint32_t highData = 0;
+        Time lastWindowDecreaseTime; // Used for CWA algorithm
+
+        // Congestion control, measure RTT threshold to detect congestion
+        int64_t RTT_threshold = 0; // Actual threshold used to detect congestion
+        int64_t RTT_measurement = 0; // The estimated RTT value using EWMA
+        int RTT_count = 0; // How many RTT packets this job has received, used to estimate how many iterations have passed
+
+        // RTO measurement
+        Time timeoutThreshold;
+        int64_t SRTT = 0;
+        int64_t RTTVAR = 0;
+        int roundRTT = 0;
+        Time RTO_Timer;
+
+        // Log files
+        LogSink::Channel rtoLog = LogSink::INVALID_CHANNEL;
+        LogSink::Channel windowLog = LogSink::INVALID_CHANNEL;
+        LogSink::Channel responseTimeLog = LogSink::INVALID_CHANNEL;
+        LogSink::Channel aggregateTimeLog = LogSink::INVALID_CHANNEL;
+
+        // Metrics, registered together with the log files
+        CongestionMetrics metrics;
+        MetricsRegistry::Id aggregateTimeMetric = MetricsRegistry::INVALID_ID;
+    };
+
+protected:
+    // The job and the child take 16 bits each above the sequence number, CheckRetxTimeout() decodes them.
+    // Checked in optimized builds too, a truncated key would time out another child's interest
+    static uint64_t RetxKey(uint32_t jobId, uint32_t seq, uint32_t childId)
+    {
+        if (jobId > 0xFFFF || childId > 0xFFFF) {
+            NS_FATAL_ERROR("Job " << jobId << " or child " << childId << " doesn't fit in a retransmission key");
+        }
+        return (static_cast<uint64_t>(jobId) << 48) | (static_cast<uint64_t>(childId) << 32) | seq;
+    }
+
+    void UpdateWindowTrace();
+
+    // Jobs in the order they're announced, a deque keeps references valid when jobs are added
+    std::deque<JobState> m_jobs;
+    std::unordered_map<std::string, uint32_t> m_jobId;
+    uint32_t m_slotWindow;
 
 
 
@@ -21,6 +21,7 @@
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "ns3/packet.h"
+#include "ns3/string.h"
 
 #include "model/ndn-l3-protocol.hpp"
 #include "model/ndn-app-link-service.hpp"
@@ -54,6 +55,10 @@ App::GetTypeId(void)
                         .SetParent<Application>()
                         .AddConstructor<App>()
 
+                        .AddAttribute("LogDirectory", "Directory all log files of the app are written into",
+                                      StringValue("src/ndnSIM/results/logs"),
+                                      MakeStringAccessor(&App::folderPath), MakeStringChecker())
+
                         .AddTraceSource("ReceivedInterests", "ReceivedInterests",
                                         MakeTraceSourceAccessor(&App::m_receivedInterests),
                                         "ns3::ndn::App::InterestTraceCallback")
@@ -193,17 +198,32 @@ App::CheckDirectoryExist(const std::string& path)
 
 
 /**
- * Open and clear the file
+ * Register the log file in the shared log sink, its content is cleared
  * @param filename
+ * @param columns Column names, used by binary log format
+ * @return Channel handle used to write records
  */
-void
-App::OpenFile(const std::string& filename)
+LogSink::Channel
+App::OpenLog(const std::string& filename, const std::vector<std::string>& columns)
+{
+    return LogSink::Get().Register(filename, columns);
+}
+
+
+
+/**
+ * Path prefix of the log files written by a node for a training job
+ * @param node Node name, e.g. "agg0" or "consumer"
+ * @param job Job name, the default job keeps the file names of single-job runs
+ * @return e.g. "<folderPath>/agg0" for the default job, "<folderPath>/agg0-job1" otherwise
+ */
+std::string
+App::GetLogPrefix(const std::string& node, const std::string& job) const
 {
-    std::ofstream file(filename, std::ofstream::out | std::ofstream::trunc);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open the file: " << filename << std::endl;
+    if (job == DEFAULT_JOB) {
+        return folderPath + "/" + node;
     }
-    file.close();
+    return folderPath + "/" + node + "-" + job;
 }
 
 
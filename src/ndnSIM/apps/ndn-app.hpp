@@ -38,6 +38,8 @@
 #include "ns3/callback.h"
 #include "ns3/traced-callback.h"
 
+#include "LogSink.hpp"
+
 
 namespace ns3 {
 
@@ -127,15 +129,20 @@ protected:
 
   void CheckDirectoryExist(const std::string& path);
 
-  void OpenFile(const std::string& filename);
+  LogSink::Channel OpenLog(const std::string& filename, const std::vector<std::string>& columns = {});
+
+  std::string GetLogPrefix(const std::string& node, const std::string& job) const;
 
 // New design for tree topology to get child node info
 public:
     std::map<std::string, std::vector<std::string>> m_linkInfo;
 
-    // Define log directory
+    // Training job of single-job runs, every CFNAgg name carries a job component after the node name
+    static constexpr const char* DEFAULT_JOB = "job0";
+
+    // Define log directory, set by the "LogDirectory" attribute
     std::string folderPath = "src/ndnSIM/results/logs";
-    std::string throughput_recorder = folderPath + "/throughput.txt"; // "totalInterestThroughput", "totalDataThroughput", "total time"
+    std::string throughput_recorder; // "<folderPath>/throughput.txt": "totalInterestThroughput", "totalDataThroughput", "total time"
 
 protected:
 
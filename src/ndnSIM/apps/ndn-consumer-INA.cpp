@@ -76,9 +76,14 @@ ConsumerINA::GetTypeId()
                     BooleanValue(false),
                     MakeBooleanAccessor(&ConsumerINA::m_useCwa),
                     MakeBooleanChecker())
-      .AddAttribute("Window", "Initial size of the window", StringValue("1"),
+      .AddAttribute("Window", "Initial size of the window of each round", StringValue("1"),
                     MakeUintegerAccessor(&ConsumerINA::GetWindow, &ConsumerINA::SetWindow),
                     MakeUintegerChecker<uint32_t>())
+      .AddAttribute("TokenBudget",
+                    "Interests all rounds may have outstanding together, 0 limits each round by its own window only",
+                    UintegerValue(0),
+                    MakeUintegerAccessor(&ConsumerINA::m_tokenBudget),
+                    MakeUintegerChecker<uint32_t>())
       .AddAttribute("InitialWindowOnTimeout", "Set window to initial value when timeout occurs",
                     BooleanValue(true),
                     MakeBooleanAccessor(&ConsumerINA::m_setInitialWindowOnTimeout),
@@ -100,7 +105,8 @@ ConsumerINA::GetTypeId()
  */
 ConsumerINA::ConsumerINA()
     : m_inFlight(0)
-    , m_ssthresh(std::numeric_limits<double>::max())
+    , m_tokenBudget(0)
+    , m_nextRound(0)
     , m_highData(0)
     , m_recPoint(0.0)
 {
@@ -109,36 +115,101 @@ ConsumerINA::ConsumerINA()
 
 
 /**
- * Override from consumer class
+ * Override from consumer class, "data" interests are counted in the window of their round
  * @param newName
  */
 void
-ConsumerINA::SendInterest(shared_ptr<Name> newName)
+ConsumerINA::SendInterest(const Name& newName)
 {
     m_inFlight++;
+    if (newName.get(-2).toUri() == "data") {
+        int roundIndex = findRoundIndex(newName.get(0).toUri());
+        if (roundIndex != -1) {
+            GetRoundWindow(roundIndex).inFlight++;
+        }
+    }
     Consumer::SendInterest(newName);
 }
 
 
 
 /**
- * Based on cwnd, schedule when to send packets
+ * Return the window of a round, rounds added by tree repair start from the initial window
+ * @param roundIndex
+ * @return Window of the round
+ */
+ConsumerINA::RoundWindow&
+ConsumerINA::GetRoundWindow(int roundIndex)
+{
+    while (m_roundWindow.size() <= static_cast<size_t>(roundIndex)) {
+        RoundWindow roundWindow;
+        roundWindow.window = m_initialWindow;
+        m_roundWindow.push_back(roundWindow);
+    }
+    return m_roundWindow[roundIndex];
+}
+
+
+
+/**
+ * Round scheduler, serve rounds with queued interests round-robin, a round may send if its own window and the shared token budget allow
+ * Rounds don't wait for each other, so a slow sub-tree doesn't hold back the next iteration of the others
+ * @return Round index, -1 if no round can send now
+ */
+int
+ConsumerINA::NextRound()
+{
+    if (m_tokenBudget != 0 && m_inFlight >= m_tokenBudget) {
+        NS_LOG_INFO("Token budget is used up, wait until outstanding interests return.");
+        return -1;
+    }
+
+    size_t numRound = m_rounds.size();
+    for (size_t i = 0; i < numRound; i++) {
+        int roundIndex = static_cast<int>((m_nextRound + i) % numRound);
+        if (!HasQueuedInterests(roundIndex)) {
+            continue;
+        }
+        RoundWindow& roundWindow = GetRoundWindow(roundIndex);
+        if (roundWindow.window - roundWindow.inFlight <= 0) {
+            continue;
+        }
+        m_nextRound = roundIndex + 1;
+        return roundIndex;
+    }
+    return -1;
+}
+
+
+
+/**
+ * Based on cwnd of each round, schedule when to send packets
  */
 void
 ConsumerINA::ScheduleNextPacket()
 {
     if (!broadcastSync && globalSeq != 0) {
         NS_LOG_INFO("Haven't finished tree broadcasting synchronization, don't send actual data packet for now.");
+        return;
     }
-    else if (m_window == static_cast<uint32_t>(0)) {
-        Simulator::Remove(m_sendEvent);
 
+    int roundIndex = NextRound();
+    if (m_initialWindow == 0 && roundIndex == -1) {
+        // Windows never drop below the initial one, probe the next non-empty round after a while
         NS_LOG_INFO("Error! Window becomes 0!!!!!!");
-        //NS_LOG_DEBUG("New event in " << (std::min<double>(0.5, m_rtt->RetransmitTimeout().ToDouble(Time::S))) << " sec");
-        m_sendEvent = Simulator::Schedule(Seconds(std::min<double>(0.5, (m_retxTimer*6).GetSeconds())),
-                                          &Consumer::SendPacket, this);
+        for (size_t i = 0; i < m_rounds.size(); i++) {
+            if (HasQueuedInterests(static_cast<int>(i))) {
+                roundIndex = static_cast<int>(i);
+                break;
+            }
+        }
+        if (roundIndex != -1) {
+            Simulator::Remove(m_sendEvent);
+            m_sendEvent = Simulator::Schedule(Seconds(std::min<double>(0.5, (m_retxTimer*6).GetSeconds())),
+                                              &Consumer::SendPacket, this, roundIndex);
+        }
     }
-    else if (m_window - m_inFlight <= 0) {
+    else if (roundIndex == -1) {
         NS_LOG_INFO("Wait until cwnd allows new transmission.");
         NS_LOG_DEBUG("Window: " << m_window << ", InFlight: " << m_inFlight);
         // do nothing
@@ -147,8 +218,8 @@ ConsumerINA::ScheduleNextPacket()
         if (m_sendEvent.IsRunning()) {
             Simulator::Remove(m_sendEvent);
         }
-        NS_LOG_DEBUG("Window: " << m_window << ", InFlight: " << m_inFlight);
-        m_sendEvent = Simulator::ScheduleNow(&Consumer::SendPacket, this);
+        NS_LOG_DEBUG("Round " << roundIndex << " window: " << m_roundWindow[roundIndex].window << ", InFlight: " << m_roundWindow[roundIndex].inFlight);
+        m_sendEvent = Simulator::ScheduleNow(&Consumer::SendPacket, this, roundIndex);
     }
 }
 
@@ -178,10 +249,11 @@ ConsumerINA::OnData(shared_ptr<const Data> data)
     Consumer::OnData(data);
 
 
-    std::string dataName = data->getName().toUri();
-    uint64_t sequenceNum = data->getName().get(-1).toSequenceNumber();
-    std::string type = data->getName().get(-2).toUri();
-    std::string name_sec0 = data->getName().get(0).toUri();
+    Name name = stripParametersDigest(data->getName());
+    std::string dataName = name.toUri();
+    uint64_t sequenceNum = name.get(-1).toSequenceNumber();
+    std::string type = name.get(-2).toUri();
+    std::string name_sec0 = name.get(0).toUri();
 
     // Set highest received Data to sequence number
     if (m_highData < sequenceNum) {
@@ -189,12 +261,14 @@ ConsumerINA::OnData(shared_ptr<const Data> data)
     }
 
     // Only perform congestion control for those type is "data", disable this function for "initialization" type
+    int roundIndex = -1;
     if (type == "data") {
         // Get current packet's round index
-        int roundIndex = Consumer::findRoundIndex(name_sec0);
+        roundIndex = Consumer::findRoundIndex(name_sec0);
         if (roundIndex == -1) {
             NS_LOG_DEBUG("Error on roundIndex!");
             ns3::Simulator::Stop();
+            return;
         }
         NS_LOG_DEBUG("This packet comes from round " << roundIndex);
 
@@ -218,25 +292,30 @@ ConsumerINA::OnData(shared_ptr<const Data> data)
         }*/
         else if (ECNLocal) {
             // Whether CWA is enabled
-            if (m_useCwa && !CanDecreaseWindow(RTT_measurement[roundIndex])) {
+            if (m_useCwa && !CanDecreaseWindow(RTT_measurement[roundIndex], roundIndex)) {
                 isWindowDecreaseSuppressed = true;
                 NS_LOG_INFO("Window decrease is suppressed.");
             } else {
                 NS_LOG_INFO("Congestion signal exists in consumer!");
-                WindowDecrease("ConsumerCongestion");
+                WindowDecrease(roundIndex, "ConsumerCongestion");
             }
         }
 /*        else if (ECNRemote) {
             NS_LOG_INFO("Congestion signal exists in aggregator!");
-            WindowDecrease("AggregatorCongestion");
+            WindowDecrease(roundIndex, "AggregatorCongestion");
         }*/
         else {
             NS_LOG_INFO("No congestion, increase the cwnd.");
-            WindowIncrease();
+            WindowIncrease(roundIndex);
         }
 
         // Record the last flag in in RTT's log
         ResponseTimeRecorder(isWindowDecreaseSuppressed);
+
+        RoundWindow& roundWindow = GetRoundWindow(roundIndex);
+        if (roundWindow.inFlight > 0) {
+            roundWindow.inFlight--;
+        }
     }
 
     if (m_inFlight > static_cast<uint32_t>(0)) {
@@ -246,7 +325,9 @@ ConsumerINA::OnData(shared_ptr<const Data> data)
     NS_LOG_DEBUG("Window: " << m_window << ", InFlight: " << m_inFlight);
 
     // Record cwnd
-    WindowRecorder();
+    if (roundIndex != -1) {
+        WindowRecorder(roundIndex);
+    }
 
     ScheduleNextPacket();
 }
@@ -254,13 +335,23 @@ ConsumerINA::OnData(shared_ptr<const Data> data)
 
 
 /**
- * Multiplicative decrease cwnd when timeout
+ * Multiplicative decrease cwnd of the interest's round when timeout
  * @param nameString
  */
 void
 ConsumerINA::OnTimeout(std::string nameString)
 {
-    WindowDecrease("timeout");
+    Name name(nameString);
+    if (name.get(-2).toUri() == "data") {
+        int roundIndex = findRoundIndex(name.get(0).toUri());
+        if (roundIndex != -1) {
+            WindowDecrease(roundIndex, "timeout");
+            RoundWindow& roundWindow = GetRoundWindow(roundIndex);
+            if (roundWindow.inFlight > 0) {
+                roundWindow.inFlight--;
+            }
+        }
+    }
 
     if (m_inFlight > static_cast<uint32_t>(0)) {
         m_inFlight--;
@@ -273,6 +364,29 @@ ConsumerINA::OnTimeout(std::string nameString)
 
 
 
+/**
+ * A released straggler no longer occupies the window of its round
+ * @param nameString
+ */
+void
+ConsumerINA::OnInterestReleased(const std::string& nameString)
+{
+    Name name(nameString);
+    int roundIndex = findRoundIndex(name.get(0).toUri());
+    if (roundIndex != -1) {
+        RoundWindow& roundWindow = GetRoundWindow(roundIndex);
+        if (roundWindow.inFlight > 0) {
+            roundWindow.inFlight--;
+        }
+    }
+
+    if (m_inFlight > static_cast<uint32_t>(0)) {
+        m_inFlight--;
+    }
+}
+
+
+
 /**
  * Set cwnd
  * @param window
@@ -299,72 +413,91 @@ ConsumerINA::GetWindow() const
 
 
 /**
- * Increase cwnd
+ * Update "m_window" trace with the sum of all rounds' windows
  */
 void
-ConsumerINA::WindowIncrease()
+ConsumerINA::UpdateWindowTrace()
 {
-    if (m_window < m_ssthresh) {
-        m_window += 1.0;
+    double window = 0;
+    for (const auto& roundWindow : m_roundWindow) {
+        window += roundWindow.window;
+    }
+    m_window = window;
+}
+
+
+
+/**
+ * Increase cwnd of a round
+ * @param roundIndex
+ */
+void
+ConsumerINA::WindowIncrease(int roundIndex)
+{
+    RoundWindow& roundWindow = GetRoundWindow(roundIndex);
+    if (roundWindow.window < roundWindow.ssthresh) {
+        roundWindow.window += 1.0;
     }else {
-        m_window += (1.0 / m_window);
+        roundWindow.window += (1.0 / roundWindow.window);
     }
-    NS_LOG_DEBUG("Window size increased to " << m_window);
+    UpdateWindowTrace();
+    NS_LOG_DEBUG("Window size of round " << roundIndex << " increased to " << roundWindow.window);
 }
 
 
 
 /**
- * Decrease cwnd
+ * Decrease cwnd of a round
+ * @param roundIndex
  * @param type
  */
 void
-ConsumerINA::WindowDecrease(std::string type)
+ConsumerINA::WindowDecrease(int roundIndex, std::string type)
 {
+    RoundWindow& roundWindow = GetRoundWindow(roundIndex);
+
     // AIMD for timeout
     if (type == "timeout") {
-        m_ssthresh = m_window * m_alpha;
-        m_window = m_ssthresh;
+        roundWindow.ssthresh = roundWindow.window * m_alpha;
+        roundWindow.window = roundWindow.ssthresh;
     }
     else if (type == "ConsumerCongestion") {
-        m_ssthresh = m_window * m_beta;
-        m_window = m_ssthresh;
+        roundWindow.ssthresh = roundWindow.window * m_beta;
+        roundWindow.window = roundWindow.ssthresh;
 
         // Perform CWA when handling consumer congestion
-        lastWindowDecreaseTime = Simulator::Now();
+        lastWindowDecreaseTime[roundIndex] = Simulator::Now();
     }
     else if (type == "AggregatorCongestion") {
-        m_ssthresh = m_window * m_gamma;
-        m_window = m_ssthresh;
+        roundWindow.ssthresh = roundWindow.window * m_gamma;
+        roundWindow.window = roundWindow.ssthresh;
     }
 
     // Window size can't be reduced below initial size
-    if (m_window < m_initialWindow) {
-        m_window = m_initialWindow;
+    if (roundWindow.window < m_initialWindow) {
+        roundWindow.window = m_initialWindow;
     }
+    UpdateWindowTrace();
 
-    NS_LOG_DEBUG("Encounter " << type << ". Window size decreased to " << m_window);
+    NS_LOG_DEBUG("Encounter " << type << ". Window size of round " << roundIndex << " decreased to " << roundWindow.window);
 }
 
 
 
 /**
- * Record window every 5 ms, store them into a file
+ * Record the total window and the window of the round that has just changed, store them into a file
+ * @param roundIndex
  */
 void
-ConsumerINA::WindowRecorder()
+ConsumerINA::WindowRecorder(int roundIndex)
 {
-    // Open file; on first call, truncate it to delete old content
-    std::ofstream file(windowTimeRecorder, std::ios::app);
+    const RoundWindow& roundWindow = GetRoundWindow(roundIndex);
+    LogSink::Get().Write(m_windowLog, ns3::Simulator::Now().GetMilliSeconds(), static_cast<double>(m_window),
+                         roundIndex, roundWindow.window, roundWindow.ssthresh);
 
-    if (!file.is_open()) {
-        std::cerr << "Failed to open the file: " << responseTime_recorder << std::endl;
-        return;
-    }
-
-    file << ns3::Simulator::Now().GetMilliSeconds() << " " << m_window << " " << m_ssthresh << std::endl;
-
-    file.close();
+    const CongestionMetrics& metrics = GetRoundMetrics(roundIndex);
+    MetricsRegistry::Get().Set(metrics.window, roundWindow.window);
+    MetricsRegistry::Get().Set(metrics.inFlight, roundWindow.inFlight);
 }
 
 
@@ -376,19 +509,9 @@ ConsumerINA::WindowRecorder()
 void
 ConsumerINA::ResponseTimeRecorder(bool flag)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(responseTime_recorder, std::ios::app);
-
-    if (!file.is_open()) {
-        std::cerr << "Failed to open the file: " << responseTime_recorder << std::endl;
-        return;
-    }
-
-    // Write the response_time to the file, followed by a newline
-    file << " " << flag << std::endl;
-
-    // Close the file
-    file.close();
+    // Finish the record started by Consumer::ResponseTimeRecorder()
+    LogSink::Get().Append(m_responseTimeLog, flag);
+    LogSink::Get().EndRecord(m_responseTimeLog);
 }
 
 
@@ -401,8 +524,9 @@ ConsumerINA::InitializeLogFile()
     // Check whether object path exists, create it if not
     CheckDirectoryExist(folderPath);
 
-    // Open the file and clear all contents for log file
-    OpenFile(windowTimeRecorder);
+    // Register log file, its content is cleared
+    windowTimeRecorder = GetLogPrefix("consumer", m_jobName) + "_window.txt";
+    m_windowLog = OpenLog(windowTimeRecorder, {"time", "window", "round", "roundWindow", "ssthresh"});
 
     Consumer::InitializeLogFile();
 }
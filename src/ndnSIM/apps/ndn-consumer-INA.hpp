@@ -47,6 +47,9 @@ namespace ndn {
  *
  * It implements slow start, conservative window adaptation (RFC 6675),
  * and 3 different TCP algorithms: AIMD, BIC, and CUBIC (RFC 8312).
+ *
+ * Each round (main tree or sub-tree without cluster head) has its own window, rounds are
+ * served round-robin and share a token budget that caps their outstanding interests.
  */
 class ConsumerINA : public Consumer {
 public:
@@ -65,17 +68,37 @@ public:
     OnTimeout(std::string nameString) override;
 
     virtual void
-    SendInterest(shared_ptr<Name> newName);
+    OnInterestReleased(const std::string& nameString) override;
+
+    virtual void
+    SendInterest(const Name& newName);
 
     virtual void
     ScheduleNextPacket();
 
 private:
+    // Congestion window of one round
+    struct RoundWindow {
+        double window;
+        uint32_t inFlight = 0;
+        double ssthresh = std::numeric_limits<double>::max();
+    };
+
+    RoundWindow&
+    GetRoundWindow(int roundIndex);
+
+    // Pick the next round allowed to send, -1 if none
+    int
+    NextRound();
+
+    void
+    UpdateWindowTrace();
+
     void
-    WindowIncrease();
+    WindowIncrease(int roundIndex);
 
     void
-    WindowDecrease(std::string type);
+    WindowDecrease(int roundIndex, std::string type);
 
     virtual void
     SetWindow(uint32_t window);
@@ -84,7 +107,7 @@ private:
     GetWindow() const;
 
     // For testing purpose, measure the consumer's window
-    void WindowRecorder();
+    void WindowRecorder(int roundIndex);
 
     void ResponseTimeRecorder(bool flag);
 
@@ -96,12 +119,16 @@ public:
 private:
     // Window design
     uint32_t m_initialWindow;
-    TracedValue<double> m_window;
-    TracedValue<uint32_t> m_inFlight;
+    TracedValue<double> m_window; // Sum of all rounds' windows
+    TracedValue<uint32_t> m_inFlight; // All outstanding interests, including "initialization" ones
     bool m_setInitialWindowOnTimeout;
 
+    // Round scheduler
+    std::vector<RoundWindow> m_roundWindow;
+    uint32_t m_tokenBudget; // Outstanding interests shared by all rounds, 0 disables the budget
+    size_t m_nextRound; // Round-robin position
+
     // AIMD design
-    double m_ssthresh;
     bool m_useCwa;
     uint32_t m_highData;
     double m_recPoint;
@@ -112,7 +139,8 @@ private:
     bool m_reactToCongestionMarks;
 
     // For testing purpose, consumer window monitor
-    std::string windowTimeRecorder = folderPath + "/consumer_window.txt";
+    std::string windowTimeRecorder; // Named after the job, e.g. "consumer_window.txt" for the default job
+    LogSink::Channel m_windowLog = LogSink::INVALID_CHANNEL;
     EventId windowMonitor;
 
 
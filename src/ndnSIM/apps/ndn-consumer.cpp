@@ -28,6 +28,7 @@
 #include <string>
 #include <sstream>
 #include <chrono>
+#include <cmath>
 
 #include "ndn-consumer.hpp"
 #include "ns3/ptr.h"
@@ -50,6 +51,7 @@
 #include <boost/ref.hpp>
 
 #include "ModelData.hpp"
+#include "AggregationKernel.hpp"
 
 #include "src/ndnSIM/apps/algorithm/include/AggregationTree.hpp"
 #include "src/ndnSIM/apps/algorithm/utility/utility.hpp"
@@ -63,6 +65,8 @@ namespace ndn {
 
 NS_OBJECT_ENSURE_REGISTERED(Consumer);
 
+uint32_t Consumer::s_runningJobs = 0;
+
 
 
 /**
@@ -94,6 +98,16 @@ Consumer::GetTypeId(void)
                     StringValue(),
                     MakeStringAccessor(&Consumer::m_nodeprefix),
                     MakeStringChecker())
+      .AddAttribute("TopologyFile",
+                    "Topology file the aggregation tree is computed from",
+                    StringValue("src/ndnSIM/examples/topologies/DataCenterTopology.txt"),
+                    MakeStringAccessor(&Consumer::filename),
+                    MakeStringChecker())
+      .AddAttribute("JobName",
+                    "Training job of this consumer, carried after the node name in all interests so aggregators can serve several jobs",
+                    StringValue(App::DEFAULT_JOB),
+                    MakeStringAccessor(&Consumer::m_jobName),
+                    MakeStringChecker())
       .AddAttribute("LifeTime",
                     "LifeTime for interest packet",
                     StringValue("4s"),
@@ -125,10 +139,40 @@ Consumer::GetTypeId(void)
                     MakeIntegerAccessor(&Consumer::m_constraint),
                     MakeIntegerChecker<int>())
       .AddAttribute("RetxTimer",
-                    "Timeout defining how frequent retransmission timeouts should be checked",
+                    "Initial retransmission timeout, used until the RTO of a round is measured",
                     StringValue("50ms"),
                     MakeTimeAccessor(&Consumer::GetRetxTimer, &Consumer::SetRetxTimer),
                     MakeTimeChecker())
+      .AddAttribute("RepairTimeouts",
+                    "Consecutive timeouts of one direct child after which the aggregation tree is repaired without it, 0 disables it",
+                    UintegerValue(0),
+                    MakeUintegerAccessor(&Consumer::m_repairTimeouts),
+                    MakeUintegerChecker<uint32_t>())
+      .AddAttribute("RetxFilterCapacity",
+                    "Number of recently retransmitted interests remembered, 0 disables it",
+                    UintegerValue(4096),
+                    MakeUintegerAccessor(&Consumer::m_retxFilterCapacity),
+                    MakeUintegerChecker<uint32_t>())
+      .AddAttribute("RetxFilterLifetime",
+                    "How long a retransmitted interest is remembered",
+                    TimeValue(Seconds(1)),
+                    MakeTimeAccessor(&Consumer::m_retxFilterLifetime),
+                    MakeTimeChecker())
+      .AddAttribute("PartialFraction",
+                    "Finish an iteration once this fraction of direct children has responded, 1.0 waits for all children",
+                    DoubleValue(1.0),
+                    MakeDoubleAccessor(&Consumer::m_partialFraction),
+                    MakeDoubleChecker<double>(0.0, 1.0))
+      .AddAttribute("PartialDeadline",
+                    "Finish an iteration once this time has passed since it started, 0 disables the deadline",
+                    TimeValue(Seconds(0)),
+                    MakeTimeAccessor(&Consumer::m_partialDeadline),
+                    MakeTimeChecker())
+      .AddAttribute("FoldLateArrivals",
+                    "If true, responses arriving after an iteration finished are added into its result",
+                    BooleanValue(false),
+                    MakeBooleanAccessor(&Consumer::m_foldLateArrivals),
+                    MakeBooleanChecker())
       .AddTraceSource("LastRetransmittedInterestDataDelay",
                     "Delay between last retransmitted Interest and received Data",
                     MakeTraceSourceAccessor(&Consumer::m_lastRetransmittedInterestDataDelay),
@@ -152,6 +196,7 @@ Consumer::Consumer()
     , numChild(0)
     , globalSeq(0)
     , globalRound(0)
+    , m_treeVersion(0)
     , broadcastSync(false)
     , m_rand(CreateObject<UniformRandomVariable>())
     , m_seq(0)
@@ -171,41 +216,140 @@ Consumer::Consumer()
 void
 Consumer::TreeBroadcast()
 {
-     const auto& broadcastTree = aggregationTree[0];
-
-     for (const auto& [parentNode, childList] : broadcastTree) {
+     for (const auto& [parentNode, childList] : aggregationTree[0]) {
          // Don't broadcast to itself
          if (parentNode == m_nodeprefix) {
              continue;
          }
-
-         std::string nameWithType;
-         std::string nameType = "initialization";
-         nameWithType += "/" + parentNode;
-         auto result = getLeafNodes(parentNode, broadcastTree);
-
-         // Construct nameWithType variable for tree broadcast
-         for (const auto& [childNode, leaves] : result) {
-             std::string name_indication;
-             name_indication += childNode + ".";
-             for (const auto& leaf : leaves) {
-                 name_indication += leaf + ".";
-             }
-             name_indication.resize(name_indication.size() - 1);
-             nameWithType += "/" + name_indication;
-         }
-         nameWithType += "/" + nameType;
-
-         std::cout << "Node " << parentNode << "'s name is: " << nameWithType << std::endl;
-         shared_ptr<Name> newName = make_shared<Name>(nameWithType);
-         newName->appendSequenceNumber(globalSeq);
-         SendInterest(newName);
+         SendTreeInfo(parentNode, globalSeq);
      }
      globalSeq++;
 }
 
 
 
+/**
+ * Send the sub-tree of one aggregator inside an "initialization" interest, the tree is carried as a binary TreeDescriptor
+ * @param parentNode aggregator to receive its sub-tree
+ * @param seq sequence number, keeps the interest name unique among tree versions
+ */
+void
+Consumer::SendTreeInfo(const std::string& parentNode, uint32_t seq)
+{
+    TreeDescriptor descriptor;
+    descriptor.numProducers = static_cast<uint32_t>(m_producerIndex.size());
+    for (const auto& [childNode, leaves] : getLeafNodes(parentNode, aggregationTree[0])) {
+        descriptor.children.emplace_back(childNode, GetLeafBitmap(leaves));
+    }
+
+    Name newName("/" + parentNode + "/" + m_jobName + "/initialization");
+    newName.appendSequenceNumber(seq);
+    NS_LOG_DEBUG("Node " << parentNode << " receives " << descriptor.children.size() << " child nodes in " << newName.toUri());
+
+    // Kept until the aggregator confirms, retransmissions carry the same descriptor
+    m_treeInfo[newName.toUri()] = descriptor.wireEncode();
+    SendInterest(newName);
+}
+
+
+
+/**
+ * Bitmap over producer indices of the given producers
+ * @param leaves
+ * @return Leaf bitmap
+ */
+LeafBitmap
+Consumer::GetLeafBitmap(const std::set<std::string>& leaves) const
+{
+    LeafBitmap bitmap(m_producerIndex.size());
+    for (const auto& leaf : leaves) {
+        auto it = m_producerIndex.find(leaf);
+        if (it != m_producerIndex.end()) {
+            bitmap.set(it->second);
+        } else {
+            NS_LOG_DEBUG("Leaf " << leaf << " isn't a known producer!");
+        }
+    }
+    return bitmap;
+}
+
+
+
+/**
+ * Build the name prefix of every child of every round, interests only append the sequence number to them later
+ * Rounds start from the next unregistered iteration, rounds that no longer exist after a repair keep only their leftovers
+ */
+void
+Consumer::BuildRoundGenerators()
+{
+    if (m_rounds.size() < aggregationTree.size()) {
+        m_rounds.resize(aggregationTree.size());
+    }
+
+    m_iterationChildren.clear();
+    for (size_t i = 0; i < m_rounds.size(); i++) {
+        RoundGenerator& round = m_rounds[i];
+        round.prefixes.clear();
+        round.seq = globalSeq;
+        round.next = 0;
+        if (i >= aggregationTree.size()) {
+            continue;
+        }
+
+        for (const auto& [child, leaves] : getLeafNodes(m_nodeprefix, aggregationTree[i])) {
+            auto childIt = m_childIndex.emplace(child, static_cast<uint32_t>(m_children.size())).first;
+            if (childIt->second == m_children.size()) {
+                m_children.push_back(child);
+            }
+            m_iterationChildren.resize(m_children.size());
+            m_iterationChildren.set(childIt->second);
+
+            // Section 1 is the job, section 2 is the bitmap of required producers
+            Name prefix;
+            prefix.append(child).append(m_jobName).append(makeLeafComponent(GetLeafBitmap(leaves))).append("data");
+            round.prefixes.push_back(std::move(prefix));
+        }
+    }
+}
+
+
+
+/**
+ * Count the interests of registered iterations that haven't been sent yet
+ * @return Total number of queued interests
+ */
+size_t
+Consumer::GetQueuedInterests() const
+{
+    size_t queued = 0;
+    for (const auto& round : m_rounds) {
+        queued += round.leftover.size();
+        if (!round.prefixes.empty() && round.seq < globalSeq) {
+            queued += (globalSeq - round.seq) * round.prefixes.size() - round.next;
+        }
+    }
+    return queued;
+}
+
+
+
+/**
+ * Check whether a round has an interest to send
+ * @param roundIndex
+ * @return True if the round has leftovers or registered iterations it hasn't finished sending
+ */
+bool
+Consumer::HasQueuedInterests(int roundIndex) const
+{
+    if (roundIndex < 0 || roundIndex >= static_cast<int>(m_rounds.size())) {
+        return false;
+    }
+    const RoundGenerator& round = m_rounds[roundIndex];
+    return !round.leftover.empty() || (!round.prefixes.empty() && round.seq < globalSeq);
+}
+
+
+
 /**
  * Implement the algorithm to compute aggregation tree
  */
@@ -213,58 +357,66 @@ void
 Consumer::ConstructAggregationTree()
 {
     App::ConstructAggregationTree();
-    AggregationTree tree(filename);
-    std::vector<std::string> dataPointNames = Utility::getProducers(filename);
-    std::map<std::string, std::vector<std::string>> rawAggregationTree;
-    std::vector<std::vector<std::string>> rawSubTree;
+    m_aggTree = std::make_shared<AggregationTree>(filename, m_nodeprefix);
+    m_producers = Utility::getProducers(filename);
 
+    // Producer indices never change, bitmaps sent before a repair stay valid
+    m_producerIndex.clear();
+    for (const auto& producer : m_producers) {
+        m_producerIndex.emplace(producer, static_cast<uint32_t>(m_producerIndex.size()));
+    }
 
-    if (tree.aggregationTreeConstruction(dataPointNames, m_constraint)) {
-        rawAggregationTree = tree.aggregationAllocation;
-        rawSubTree = tree.noCHTree;
-    } else {
+    if (!m_aggTree->aggregationTreeConstruction(m_producers, m_constraint)) {
         NS_LOG_DEBUG("Fail to construct aggregation tree!");
         ns3::Simulator::Stop();
     }
 
-    // Get the number of producers
-    producerCount = Utility::countProducers(filename);
+    UpdateTreeRounds();
 
-    // Create producer list
-    for (const auto& item : dataPointNames) {
-        proList += item + ".";
+    // Initialize "broadcastList" for tree broadcasting synchronization
+    broadcastList.clear();
+    for (const auto& pair : aggregationTree[0]) {
+        if (pair.first != m_nodeprefix) {
+            broadcastList.push_back(pair.first);
+        }
     }
-    proList.resize(proList.size() - 1);
+}
 
 
-/*     std::cout << "\nAggregation tree: " << std::endl;
-     for (const auto& pair : rawAggregationTree) {
-         std::cout << pair.first << ": ";
-         for (const auto& item : pair.second) {
-             std::cout << item << " ";
-         }
-         std::cout << std::endl;
-     }
 
-     std::cout << "\nSub Tree without CH: " << std::endl;
-     for (const auto& pair : rawSubTree) {
-         for (const auto& item : pair) {
-             std::cout << item << " ";
-         }
-         std::cout << std::endl;
-     }*/
+/**
+ * Rebuild "aggregationTree" (main tree and sub-trees) and the per-round states from the current tree of "m_aggTree"
+ */
+void
+Consumer::UpdateTreeRounds()
+{
+    std::map<std::string, std::vector<std::string>> rawAggregationTree = m_aggTree->aggregationAllocation;
+    std::vector<std::vector<std::string>> rawSubTree = m_aggTree->noCHTree;
+
+    // Get the number of producers
+    producerCount = static_cast<int>(m_producers.size());
+
+    // Create producer list
+    proList.clear();
+    for (const auto& item : m_producers) {
+        proList += item + ".";
+    }
+    if (!proList.empty()) {
+        proList.resize(proList.size() - 1);
+    }
 
     // Create complete "aggregationTree" from raw ones
+    aggregationTree.clear();
     aggregationTree.push_back(rawAggregationTree);
-    while (!rawSubTree.empty()) {
-        const auto& item = rawSubTree[0];
+    for (const auto& item : rawSubTree) {
         rawAggregationTree[m_nodeprefix] = item;
         aggregationTree.push_back(rawAggregationTree);
-        rawSubTree.erase(rawSubTree.begin());
     }
 
 
     int i = 0;
+    globalTreeRound.clear();
+    numChild = 0;
     std::cout << "\nIterate all aggregation tree (including main tree and sub-trees)." << std::endl;
     for (const auto& map : aggregationTree) {
         for (const auto& pair : map) {
@@ -274,14 +426,8 @@ Consumer::ConstructAggregationTree()
             }
             std::cout << std::endl;
 
-            // 1. Aggregator
-            // Initialize "broadcastList" for tree broadcasting synchronization
-            if (pair.first != m_nodeprefix) {
-                broadcastList.push_back(pair.first);
-            }
-            // 2. Consumer
             // Initialize "globalTreeRound" for all rounds (if there're multiple sub-trees)
-            else {
+            if (pair.first == m_nodeprefix) {
                 // Specify the number of consumer's child nodes (links)
                 if (numChild == 0) {
                     numChild = pair.second.size();
@@ -302,15 +448,125 @@ Consumer::ConstructAggregationTree()
         i++;
     }
 
-    // Initialize variables for RTO computation/congestion control
-    for (int i = 0; i < globalTreeRound.size(); i++) {
+    // Initialize variables for RTO computation/congestion control, rounds that exist already keep their measurements
+    for (int i = 0; i < static_cast<int>(globalTreeRound.size()); i++) {
+        if (initRTO.find(i) != initRTO.end()) {
+            continue;
+        }
         initRTO[i] = false;
         RTO_Timer[i] = 6 * m_retxTimer;
         m_timeoutThreshold[i] = 6 * m_retxTimer;
         RTT_threshold[i] = 0;
         RTT_count[i] = 0;
     }
- }
+
+    // Index rounds by node name, so round lookup of each packet doesn't scan "globalTreeRound"
+    // Nodes removed by a repair keep their last round, retransmissions of iterations started on the old tree still need it
+    for (int i = 0; i < static_cast<int>(globalTreeRound.size()); i++) {
+        for (const auto& node : globalTreeRound[i]) {
+            m_roundIndex[node] = i;
+        }
+    }
+}
+
+
+
+/**
+ * Repair the aggregation tree after producers/aggregators join or leave, or link costs change
+ * Only the affected clusters are re-solved, and only aggregators whose sub-tree changed receive the tree again
+ * Iterations that have already started finish on the old tree, iterations not started yet are regenerated on the new one
+ * Called when a child keeps timing out (see OnChildTimeout()), scenarios may also call it when they change the topology
+ * @param change
+ */
+void
+Consumer::RepairAggregationTree(const AggregationTree::TreeChange& change)
+{
+    if (m_aggTree == nullptr || aggregationTree.empty()) {
+        NS_LOG_DEBUG("Aggregation tree hasn't been constructed, nothing to repair!");
+        return;
+    }
+
+    for (const auto& producer : change.leftProducers) {
+        m_producers.erase(std::remove(m_producers.begin(), m_producers.end(), producer), m_producers.end());
+    }
+    for (const auto& producer : change.joinedProducers) {
+        if (std::find(m_producers.begin(), m_producers.end(), producer) == m_producers.end()) {
+            m_producers.push_back(producer);
+        }
+        m_producerIndex.emplace(producer, static_cast<uint32_t>(m_producerIndex.size()));
+    }
+
+    std::map<std::string, std::vector<std::string>> oldTree = aggregationTree[0];
+    if (!m_aggTree->aggregationTreeRepair(change)) {
+        NS_LOG_DEBUG("Fail to repair aggregation tree!");
+        ns3::Simulator::Stop();
+        return;
+    }
+    UpdateTreeRounds();
+
+    // Re-broadcast changed sub-trees only
+    ++m_treeVersion;
+    broadcastList = GetChangedSubTrees(oldTree, aggregationTree[0]);
+    for (const auto& parentNode : broadcastList) {
+        SendTreeInfo(parentNode, m_treeVersion);
+    }
+    broadcastSync = broadcastList.empty();
+    NS_LOG_INFO("Aggregation tree is repaired, " << broadcastList.size() << " aggregators receive the updated tree.");
+
+    // Drop registered iterations that haven't started, they're generated again on the new tree
+    // Unsent interests of started iterations become leftovers of their round, so they still finish on the old tree
+    uint32_t firstDropped = globalSeq;
+    for (const auto& [seq, progress] : m_progress) {
+        if (!progress.started) {
+            firstDropped = std::min(firstDropped, seq);
+        }
+    }
+    for (auto& round : m_rounds) {
+        while (!round.prefixes.empty() && round.seq < firstDropped) {
+            Name name = round.prefixes[round.next];
+            name.appendSequenceNumber(round.seq);
+            round.leftover.push(std::make_pair(round.seq, std::move(name)));
+            if (++round.next == round.prefixes.size()) {
+                round.next = 0;
+                ++round.seq;
+            }
+        }
+    }
+    for (uint32_t seq = firstDropped; seq < globalSeq; ++seq) {
+        m_progress.erase(seq);
+    }
+    globalSeq = firstDropped;
+
+    m_iterationChildren.clear();
+    InterestGenerator();
+    ScheduleNextPacket();
+}
+
+
+
+/**
+ * Find the aggregators of the new tree whose children or their leaves changed, new aggregators included
+ * @param oldTree Main tree before the repair
+ * @param newTree Main tree after the repair
+ * @return Aggregators that have to receive the tree again
+ */
+std::vector<std::string>
+Consumer::GetChangedSubTrees(const std::map<std::string, std::vector<std::string>>& oldTree,
+                             const std::map<std::string, std::vector<std::string>>& newTree)
+{
+    std::vector<std::string> changed;
+    for (const auto& pair : newTree) {
+        const std::string& parentNode = pair.first;
+        if (parentNode == m_nodeprefix) {
+            continue;
+        }
+        if (oldTree.find(parentNode) != oldTree.end() && getLeafNodes(parentNode, oldTree) == getLeafNodes(parentNode, newTree)) {
+            continue;
+        }
+        changed.push_back(parentNode);
+    }
+    return changed;
+}
 
 
 
@@ -324,6 +580,12 @@ Consumer::StartApplication() // Called at time specified by Start
 
     App::StartApplication();
 
+    NS_LOG_INFO("Aggregation kernel uses " << AggregationKernel::GetIsaName(AggregationKernel::GetIsa()) << " instructions.");
+    NS_LOG_INFO("Consumer " << m_nodeprefix << " runs job " << m_jobName);
+    m_retxFilter.setCapacity(m_retxFilterCapacity);
+    m_retxFilter.setLifetime(m_retxFilterLifetime);
+    ++s_runningJobs;
+
     // Construct the tree
     ConstructAggregationTree();
 
@@ -374,6 +636,10 @@ Consumer::getLeafNodes(const std::string& key, const std::map<std::string, std::
 int
 Consumer::findRoundIndex(const std::string& target)
 {
+    auto it = m_roundIndex.find(target);
+    if (it != m_roundIndex.end()) {
+        return it->second;
+    }
     return App::findRoundIndex(globalTreeRound, target);
 }
 
@@ -385,15 +651,19 @@ Consumer::findRoundIndex(const std::string& target)
  * @param seq
  */
 void
-Consumer::aggregate(const ModelData& data, const uint32_t& seq)
+Consumer::aggregate(const ModelDataView& data, const uint32_t& seq)
 {
-    // first initialization
+    // first initialization, model size is decided by the first incoming data
     if (sumParameters.find(seq) == sumParameters.end()){
-        sumParameters[seq] = std::vector<float>(300, 0.0f);
+        sumParameters[seq] = std::vector<float>(data.parameters().size(), 0.0f);
     }
 
     // Aggregate data
-    std::transform(sumParameters[seq].begin(), sumParameters[seq].end(), data.parameters.begin(), sumParameters[seq].begin(), std::plus<float>());
+    AggregationKernel::Sum(sumParameters[seq], data.parameters());
+
+    IterationProgress& progress = m_progress[seq];
+    progress.arrived++;
+    progress.contributors += data.contributors();
 }
 
 
@@ -407,20 +677,78 @@ std::vector<float>
 Consumer::getMean(const uint32_t& seq)
 {
     std::vector<float> result;
-    if (sumParameters[seq].empty() || producerCount == 0) {
+    auto progressIt = m_progress.find(seq);
+    uint32_t contributors = progressIt != m_progress.end() ? progressIt->second.contributors : 0;
+    if (sumParameters[seq].empty() || contributors == 0) {
         NS_LOG_DEBUG("Error when calculating average model, please check!");
         return result;
     }
 
-    for (auto value : sumParameters[seq]) {
-        result.push_back(value / static_cast<float>(producerCount));
+    // Divide by the producers summed in, which is less than producerCount after partial aggregation
+    if (contributors != static_cast<uint32_t>(producerCount)) {
+        NS_LOG_DEBUG("Iteration " << seq << " averages " << contributors << " of " << producerCount << " producers");
     }
+    result.resize(sumParameters[seq].size());
+    AggregationKernel::Mean(result, sumParameters[seq], static_cast<float>(contributors));
 
     return result;
 }
 
 
 
+/**
+ * Check whether the iteration can finish before all children have responded
+ * @param seq
+ * @return True if the deadline has passed or enough children have responded
+ */
+bool
+Consumer::IsPartialReady(uint32_t seq) const
+{
+    auto it = m_progress.find(seq);
+    if (it == m_progress.end() || it->second.arrived == 0) {
+        return false;
+    }
+    const IterationProgress& progress = it->second;
+    if (progress.expired) {
+        return true;
+    }
+    if (m_partialFraction >= 1.0) {
+        return false;
+    }
+    uint32_t required = std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(m_partialFraction * progress.expected)));
+    return progress.arrived >= required;
+}
+
+
+
+/**
+ * Triggered when the deadline of an iteration expires, finish it with whatever has been aggregated
+ * @param seq
+ */
+void
+Consumer::OnAggregationDeadline(uint32_t seq)
+{
+    auto it = m_progress.find(seq);
+    if (it == m_progress.end() || it->second.finished) {
+        return;
+    }
+
+    // Nothing has arrived yet, the first response finishes the iteration
+    it->second.expired = true;
+    if (it->second.arrived == 0) {
+        NS_LOG_INFO("Deadline of iteration " << seq << " passed without any response.");
+        return;
+    }
+
+    NS_LOG_INFO("Deadline of iteration " << seq << " passed, finish with " << it->second.arrived << " of " << it->second.expected << " children.");
+    FinishIteration(seq);
+
+    // Released stragglers may have made room in the windows
+    ScheduleNextPacket();
+}
+
+
+
 /**
  * Compute the total response time for average computation later
  * @param response_time
@@ -503,7 +831,8 @@ Consumer::OnNack(shared_ptr<const lp::Nack> nack)
 void
 Consumer::OnTimeout(std::string nameString)
 {
-    shared_ptr<Name> name = make_shared<Name>(nameString);
+    Name name(nameString);
+    m_retxFilter.insert(name, Simulator::Now());
     SendInterest(name);
 
     // Add one to "suspiciousPacketCount"
@@ -513,20 +842,24 @@ Consumer::OnTimeout(std::string nameString)
 
 
 /**
- * Set initial interval on how long to check timeout
+ * Called when the interest of a straggler is dropped from timeout checking, nothing to do by default
+ * @param nameString
+ */
+void
+Consumer::OnInterestReleased(const std::string& nameString)
+{
+}
+
+
+
+/**
+ * Set initial retransmission timeout, timeouts are checked at the deadlines of the interests
  * @param retxTimer
  */
 void
 Consumer::SetRetxTimer(Time retxTimer)
 {
     m_retxTimer = retxTimer;
-    if (m_retxEvent.IsRunning()) {
-        Simulator::Remove(m_retxEvent); // slower, but better for memory
-    }
-
-    // Schedule timeout check event
-    NS_LOG_DEBUG("Next interval to check timeout is: " << m_retxTimer.GetMilliSeconds() << " ms");
-    m_retxEvent = Simulator::Schedule(m_retxTimer, &Consumer::CheckRetxTimeout, this);
 }
 
 
@@ -544,7 +877,7 @@ Consumer::GetRetxTimer() const
 
 
 /**
- * When invoked, check whether timeout happened for all packets in timeout list
+ * Pop the interests whose deadline has passed, then wait for the next deadline of the timer wheel
  */
 void
 Consumer::CheckRetxTimeout()
@@ -554,35 +887,72 @@ Consumer::CheckRetxTimeout()
     //NS_LOG_DEBUG("Check timeout after: " << m_retxTimer.GetMilliSeconds() << " ms");
     //NS_LOG_DEBUG("Current timeout threshold is: " << m_timeoutThreshold.GetMilliSeconds() << " ms");
 
-    for (auto it = m_timeoutCheck.begin(); it != m_timeoutCheck.end();){
-        // Parse the string and extract the first segment, e.g. "agg0", then find out its round
-        std::string type = make_shared<Name>(it->first)->get(-2).toUri();
-
-        // For two types of data, check timeout respectively
-        if (type == "initialization") {
-            if (now - it->second > (3 * m_retxTimer)) {
-                std::string name = it->first;
-                it = m_timeoutCheck.erase(it);
-                OnTimeout(name);
-            } else {
-                ++it;
-            }
-        } else if (type == "data") {
-            std::string name = it->first;
-            std::string seg0 = make_shared<Name>(name)->get(0).toUri();
-            int roundIndex = findRoundIndex(seg0);
-
-            if (now - it->second > m_timeoutThreshold[roundIndex]) {
-                std::string name = it->first;
-                it = m_timeoutCheck.erase(it);
-                numTimeout[roundIndex]++;
-                OnTimeout(name);
-            } else {
-                ++it;
-            }
+    // Only interests whose deadline has passed are popped from the timer wheel, deadlines are set in SendInterest()
+    m_retxWheel.expire(now, [this](const std::string& nameString) {
+        Name name(nameString);
+        if (name.get(-2).toUri() == "data") {
+            std::string child = name.get(0).toUri();
+            int roundIndex = findRoundIndex(child);
+            numTimeout[roundIndex]++;
+            MetricsRegistry::Get().Increment(GetRoundMetrics(roundIndex).timeouts);
+            OnChildTimeout(child);
         }
+        OnTimeout(nameString);
+    });
+
+    // Nothing to check until an interest is sent again
+    if (m_retxWheel.size() > 0) {
+        ScheduleRetxCheck(m_retxWheel.nextExpiry());
     }
-    m_retxEvent = Simulator::Schedule(m_retxTimer, &Consumer::CheckRetxTimeout, this);
+}
+
+
+
+/**
+ * Count consecutive timeouts of a direct child, once they reach "RepairTimeouts" the tree is repaired without the child
+ * The consumer only sees its direct children, so a failure deeper in a sub-tree is attributed to the child heading it
+ * @param child
+ */
+void
+Consumer::OnChildTimeout(const std::string& child)
+{
+    if (m_repairTimeouts == 0 || ++m_childTimeouts[child] != m_repairTimeouts) {
+        return;
+    }
+
+    // Leftover interests of a child that a previous repair has taken out
+    if (App::findRoundIndex(globalTreeRound, child) == -1) {
+        return;
+    }
+
+    AggregationTree::TreeChange change;
+    if (std::find(m_producers.begin(), m_producers.end(), child) != m_producers.end()) {
+        change.leftProducers.push_back(child);
+    } else {
+        change.leftAggregators.push_back(child);
+    }
+    NS_LOG_INFO("Child " << child << " timed out " << m_repairTimeouts << " times in a row, repair the aggregation tree without it");
+
+    // Not inside the timer wheel callback, the repair arms timers of its own
+    Simulator::ScheduleNow(&Consumer::RepairAggregationTree, this, change);
+}
+
+
+
+/**
+ * Make sure the timeout check runs no later than given time, an earlier pending check is kept
+ * @param when Time from which the timer wheel pops an outstanding interest
+ */
+void
+Consumer::ScheduleRetxCheck(Time when)
+{
+    if (m_retxEvent.IsRunning()) {
+        if (TimeStep(m_retxEvent.GetTs()) <= when) {
+            return;
+        }
+        Simulator::Remove(m_retxEvent); // slower, but better for memory
+    }
+    m_retxEvent = Simulator::Schedule(std::max(when - Simulator::Now(), Time(0)), &Consumer::CheckRetxTimeout, this);
 }
 
 
@@ -613,115 +983,81 @@ Consumer::RTOMeasurement(int64_t resTime, int roundIndex)
 
 
 /**
- * When ScheduleNextPacket() is invoked, this function is called. Pop elements from the interest queue, and prepare for actual interest sending
+ * When ScheduleNextPacket() picks a round, this function is called. Build the round's next interest from its cursor, and prepare for actual interest sending
+ * An iteration starts when its first interest of any round is sent, so rounds of successive iterations overlap
+ * @param roundIndex
  */
 void
-Consumer::SendPacket()
+Consumer::SendPacket(int roundIndex)
 {
-    if (!interestQueue.empty()) {
-        auto interestTuple = interestQueue.front();
-        interestQueue.pop();
-        uint32_t iteration = std::get<0>(interestTuple);
-        bool isNewIteration = std::get<1>(interestTuple);
-        shared_ptr<Name> name = std::get<2>(interestTuple);
-
-        // New iteration, start compute aggregation time
-        if (isNewIteration) {
-            aggregateStartTime[iteration] = ns3::Simulator::Now();
+    if (!HasQueuedInterests(roundIndex)) {
+        NS_LOG_INFO("All available interests of round " << roundIndex << " have been sent, no further operation required.");
+        return;
+    }
+
+    RoundGenerator& round = m_rounds[roundIndex];
+    uint32_t iteration;
+    Name name;
+    if (!round.leftover.empty()) {
+        iteration = round.leftover.front().first;
+        name = std::move(round.leftover.front().second);
+        round.leftover.pop();
+    } else {
+        iteration = round.seq;
+        name = round.prefixes[round.next];
+        name.appendSequenceNumber(iteration);
+        if (++round.next == round.prefixes.size()) {
+            round.next = 0;
+            ++round.seq;
         }
-        SendInterest(name);
+    }
+
+    // Pending children of a finished iteration are stragglers, their interests are no longer needed
+    auto progressIt = m_progress.find(iteration);
+    if (progressIt == m_progress.end() || progressIt->second.finished) {
+        NS_LOG_DEBUG("Iteration " << iteration << " has finished, " << name << " isn't sent.");
         ScheduleNextPacket();
-    } else {
-        NS_LOG_INFO("All available interests have been sent, no further operation required.");
+        return;
     }
+
+    // New iteration, start compute aggregation time
+    if (!progressIt->second.started) {
+        progressIt->second.started = true;
+        aggregateStartTime[iteration] = ns3::Simulator::Now();
+        if (!m_partialDeadline.IsZero()) {
+            progressIt->second.deadline = Simulator::Schedule(m_partialDeadline, &Consumer::OnAggregationDeadline, this, iteration);
+        }
+    }
+    SendInterest(name);
+    ScheduleNextPacket();
 }
 
 
 
 /**
- * Generate interests for all iterations and push them into queue for further interest sending scheduling
- * First invoke when start simulation, every time when one iteration finished aggregation, update interestQueue again
+ * Register upcoming iterations until the rounds have "m_interestQueue" unsent interests
+ * First invoke when start simulation, every time when one iteration finished aggregation, register iterations again
+ * Only a bitset of children is kept per iteration, the interests themselves are built in SendPacket()
  */
 void
 Consumer::InterestGenerator()
 {
-    // Generate name from section 1 to 3 (except for seq)
-    if (map_round_nameSec1_3.empty()) {
-        std::vector<std::string> objectProducer;
-        std::string token;
-        std::istringstream tokenStream(proList);
-        char delimiter = '.';
-        while (std::getline(tokenStream, token, delimiter)) {
-            objectProducer.push_back(token);
-        }
-
-        int i = 0;
-        for (const auto& aggTree : aggregationTree) {
-            auto initialAllocation = getLeafNodes(m_nodeprefix, aggTree);
-            std::vector<std::string> roundChild;
-            std::vector<std::string> vec_sec1_3;
-
-            for (const auto& [child, leaves] : initialAllocation) {
-                std::string name_sec1_3;
-                std::string name_sec1;
-                roundChild.push_back(child);
-
-                for (const auto& leaf : leaves) {
-                    name_sec1 += leaf + ".";
-                }
-                name_sec1.resize(name_sec1.size() - 1);
-                name_sec1_3 = "/" + child + "/" + name_sec1 + "/data";
-                vec_sec1_3.push_back(name_sec1_3);
-
-                vec_iteration.push_back(child); // Iteration's vector
-            }
-            vec_round.push_back(roundChild); // Round's vector
-            map_round_nameSec1_3[i] = vec_sec1_3; // Name (section1 - section3), to be pushed into queue later
-            i++;
-        }
+    // Generate name prefixes once per tree
+    if (m_iterationChildren.empty()) {
+        BuildRoundGenerators();
     }
 
-/*  // For testing
-    std::cout << "map_round_nameSec1_3: " << std::endl;
-    for (const auto& pair : map_round_nameSec1_3) {
-        std::cout << "Key: " << pair.first << std::endl;
-        for (const auto& str : pair.second) {
-            std::cout << "  Value: " << str << std::endl;
-        }
-    }
-
-    std::cout << "vec_iteration" << std::endl;
-    for (const auto& vec : vec_iteration) {
-        std::cout << vec << std::endl;
-    }
-
-    std::cout << "vec_round" << std::endl;
-    for (const auto& innerVec : vec_round) {
-        for (const auto& vec : innerVec) {
-            std::cout << vec << " ";
-        }
-        std::cout << std::endl;
-    }*/
-
-    // Generate entire interest name for all iterations
-    while (interestQueue.size() <= m_interestQueue) {
-        // Generate new interest for upcoming iteration if necessary
+    size_t perIteration = m_iterationChildren.count();
+    size_t queued = GetQueuedInterests();
+    while (queued <= static_cast<size_t>(m_interestQueue)) {
+        // Register upcoming iteration if necessary
         if (globalSeq <= m_iteNum) {
-            map_agg_oldSeq_newName[globalSeq] = vec_round;
-            m_agg_newDataName[globalSeq] = vec_iteration;
-
-            bool isNewIteration = true;
-
-            for (const auto& map : map_round_nameSec1_3) {
-                for (const auto& name1_3 : map.second) {
-                    shared_ptr<Name> name = make_shared<Name>(name1_3);
-                    name->appendSequenceNumber(globalSeq);
-                    interestQueue.push(std::make_tuple(globalSeq, isNewIteration, name));
-
-                    isNewIteration = false;
-                }
-            }
+            IterationProgress& progress = m_progress[globalSeq];
+            progress = IterationProgress();
+            progress.pending = m_iterationChildren;
+            progress.expected = static_cast<uint32_t>(perIteration);
 
+            queued += perIteration;
             globalSeq++;
         } else {
             NS_LOG_INFO("All iterations' interests have been generated, no need for further operation.");
@@ -736,24 +1072,39 @@ Consumer::InterestGenerator()
  * Called in SendPacket() function, construct interest packet and send it actually
  * @param newName
  */
-void Consumer::SendInterest(shared_ptr<Name> newName)
+void Consumer::SendInterest(const Name& newName)
 {
     if (!m_active)
         return;
 
-    std::string nameWithSeq = newName->toUri();
-
-    // Trace timeout
-    m_timeoutCheck[nameWithSeq] = ns3::Simulator::Now();
-
-    // Start response time
-    if (startTime.find(nameWithSeq) == startTime.end())
-        startTime[nameWithSeq] = ns3::Simulator::Now();
+    std::string nameWithSeq = newName.toUri();
+
+    // Trace timeout, for two types of interests, timeout is set respectively
+    std::string type = newName.get(-2).toUri();
+    if (type == "initialization") {
+        ScheduleRetxCheck(m_retxWheel.schedule(nameWithSeq, ns3::Simulator::Now() + 3 * m_retxTimer));
+    } else if (type == "data") {
+        int roundIndex = findRoundIndex(newName.get(0).toUri());
+        ScheduleRetxCheck(m_retxWheel.schedule(nameWithSeq, ns3::Simulator::Now() + m_timeoutThreshold[roundIndex]));
+
+        // Start response time, retransmissions keep the time of the first transmission
+        auto progressIt = m_progress.find(newName.at(-1).toSequenceNumber());
+        auto childIt = m_childIndex.find(newName.get(0).toUri());
+        if (progressIt != m_progress.end() && childIt != m_childIndex.end()) {
+            progressIt->second.sent.emplace(childIt->second, std::make_pair(nameWithSeq, ns3::Simulator::Now()));
+        }
+    }
 
     shared_ptr<Interest> interest = make_shared<Interest>();
     interest->setNonce(m_rand->GetValue(0, std::numeric_limits<uint32_t>::max()));
-    interest->setName(*newName);
+    interest->setName(newName);
     interest->setCanBePrefix(false);
+    if (type == "initialization") {
+        auto treeInfo = m_treeInfo.find(nameWithSeq);
+        if (treeInfo != m_treeInfo.end()) {
+            interest->setApplicationParameters(treeInfo->second);
+        }
+    }
     time::milliseconds interestLifeTime(m_interestLifeTime.GetMilliSeconds());
     interest->setInterestLifetime(interestLifeTime);
     NS_LOG_INFO("Sending interest >>>>" << nameWithSeq);
@@ -781,9 +1132,10 @@ Consumer::OnData(shared_ptr<const Data> data)
         return;
 
     App::OnData(data); // tracing inside
-    std::string type = data->getName().get(-2).toUri();
-    uint32_t seq = data->getName().at(-1).toSequenceNumber();
-    std::string dataName = data->getName().toUri();
+    Name name = stripParametersDigest(data->getName());
+    std::string type = name.get(-2).toUri();
+    uint32_t seq = name.at(-1).toSequenceNumber();
+    std::string dataName = name.toUri();
     int dataSize = data->wireEncode().size();
     ECNRemote = false;
     ECNLocal = false;
@@ -795,27 +1147,22 @@ Consumer::OnData(shared_ptr<const Data> data)
     NS_LOG_DEBUG("The incoming data packet size is: " << dataSize);
 
     // Erase timeout
-    if (m_timeoutCheck.find(dataName) != m_timeoutCheck.end())
-        m_timeoutCheck.erase(dataName);
-    else
+    if (!m_retxWheel.cancel(dataName))
         NS_LOG_DEBUG("Suspicious data packet, not exists in timeout list.");
 
+    // Check whether this is a retransmission packet
+    if (m_retxFilter.contains(name, Simulator::Now())) {
+        NS_LOG_INFO("This packet is retransmission packet.");
+    }
+
     if (type == "data") {
         std::string name_sec0 = data->getName().get(0).toUri();
+        m_childTimeouts.erase(name_sec0);
 
         // Perform data name matching with interest name
-        ModelData modelData;
-        auto data_map = map_agg_oldSeq_newName.find(seq);
-        auto data_agg = m_agg_newDataName.find(seq);
-        if (data_map != map_agg_oldSeq_newName.end() && data_agg != m_agg_newDataName.end()) {
-
-            // Response time computation (RTT)
-            if (startTime.find(dataName) != startTime.end()){
-                responseTime[dataName] = ns3::Simulator::Now() - startTime[dataName];
-                ResponseTimeSum(responseTime[dataName].GetMilliSeconds());
-                startTime.erase(dataName);
-                NS_LOG_INFO("Consumer's response time of sequence " << dataName << " is: " << responseTime[dataName].GetMilliSeconds() << " ms");
-            }
+        ModelDataView modelData;
+        auto progressIt = m_progress.find(seq);
+        if (progressIt != m_progress.end()) {
 
             // Search round index
             int roundIndex = findRoundIndex(name_sec0);
@@ -825,88 +1172,76 @@ Consumer::OnData(shared_ptr<const Data> data)
             }
             NS_LOG_DEBUG("This packet comes from round " << roundIndex);
 
+            // Response time computation (RTT), only the child's first response is a sample
+            auto childIt = m_childIndex.find(name_sec0);
+            auto& sent = progressIt->second.sent;
+            auto sentIt = childIt != m_childIndex.end() ? sent.find(childIt->second) : sent.end();
+            if (sentIt != sent.end()) {
+                Time responseTime = ns3::Simulator::Now() - sentIt->second.second;
+                ResponseTimeSum(responseTime.GetMilliSeconds());
+                NS_LOG_INFO("Consumer's response time of sequence " << dataName << " is: " << responseTime.GetMilliSeconds() << " ms");
+
+                // RTT_threshold measurement initialization is done after 3 iterations, before that, don't perform cwnd control
+                if (static_cast<size_t>(RTT_count[roundIndex]) >= globalTreeRound[roundIndex].size() * 3 && responseTime.GetMilliSeconds() > RTT_threshold[roundIndex]) {
+                    ECNLocal = true;
+                }
 
-            // RTT_threshold measurement initialization is done after 3 iterations, before that, don't perform cwnd control
-            if (RTT_count[roundIndex] >= globalTreeRound[roundIndex].size() * 3 && responseTime[dataName].GetMilliSeconds() > RTT_threshold[roundIndex]) {
-                ECNLocal = true;
-            }
-
-            // Setup RTT_threshold based on RTT of the first 5 iterations, then update RTT_threshold after each new iteration based on EWMA
-            // ToDo: What about setting up a initial cwnd to run several iterations, other than start cwnd from 1
-            RTTThresholdMeasure(responseTime[dataName].GetMilliSeconds(), roundIndex);
-
-            // Record response time
-            ResponseTimeRecorder(responseTime[dataName], seq, ECNLocal, RTT_measurement[roundIndex], RTT_threshold[roundIndex]);
+                // Setup RTT_threshold based on RTT of the first 5 iterations, then update RTT_threshold after each new iteration based on EWMA
+                // ToDo: What about setting up a initial cwnd to run several iterations, other than start cwnd from 1
+                RTTThresholdMeasure(responseTime.GetMilliSeconds(), roundIndex);
 
-            // Reset RetxTimer and timeout interval
-            RTO_Timer[roundIndex] = RTOMeasurement(responseTime[dataName].GetMilliSeconds(), roundIndex);
-            m_timeoutThreshold[roundIndex] = RTO_Timer[roundIndex];
-            NS_LOG_DEBUG("responseTime for name : " << dataName << " is: " << responseTime[dataName].GetMilliSeconds() << " ms");
-            NS_LOG_DEBUG("Current RTO measurement: " << RTO_Timer[roundIndex].GetMilliSeconds() << " ms");
+                // Record response time
+                ResponseTimeRecorder(responseTime, seq, ECNLocal, RTT_measurement[roundIndex], RTT_threshold[roundIndex], roundIndex);
 
+                // Reset RetxTimer and timeout interval
+                RTO_Timer[roundIndex] = RTOMeasurement(responseTime.GetMilliSeconds(), roundIndex);
+                m_timeoutThreshold[roundIndex] = RTO_Timer[roundIndex];
+                NS_LOG_DEBUG("responseTime for name : " << dataName << " is: " << responseTime.GetMilliSeconds() << " ms");
+                NS_LOG_DEBUG("Current RTO measurement: " << RTO_Timer[roundIndex].GetMilliSeconds() << " ms");
+            }
 
-            // This data exist in the map, perform aggregation
-            auto& aggVec = data_agg->second;
-            auto aggVecIt = std::find(aggVec.begin(), aggVec.end(), name_sec0);
 
-            std::vector<uint8_t> oldbuffer(data->getContent().value(), data->getContent().value() + data->getContent().value_size());
+            // This child is still pending in the iteration, perform aggregation
+            boost::dynamic_bitset<>& pending = progressIt->second.pending;
+            bool isPending = childIt != m_childIndex.end() && childIt->second < pending.size() && pending.test(childIt->second);
 
-            if (deserializeModelData(oldbuffer, modelData) && aggVecIt != aggVec.end()) {
-                aggregate(modelData, seq); // Aggregate data payload
-                ECNRemote = !modelData.congestedNodes.empty();
-                aggVec.erase(aggVecIt);
+            // An iteration finished by partial aggregation still accepts its stragglers, they are only added if folding is enabled
+            bool isLate = progressIt->second.finished;
+            if (isPending && modelData.parse(data->getContent())) {
+                pending.reset(childIt->second);
+                sent.erase(childIt->second);
+                ECNRemote = !modelData.congestedNodes().empty();
+                if (!isLate || m_foldLateArrivals) {
+                    aggregate(modelData, seq); // Aggregate data payload
+                }
             } else{
-                NS_LOG_INFO("Data name doesn't exist in map_agg_oldSeq_newName, meaning this data packet is duplicate, do nothing!");
+                NS_LOG_INFO("Data of " << name_sec0 << " isn't pending in iteration " << seq << ", meaning this data packet is duplicate, do nothing!");
                 return;
             }
 
-            // Judge whether the aggregation iteration has finished
-            if (aggVec.empty()) {
-                NS_LOG_DEBUG("Aggregation of iteration " << seq << " finished!");
-
-                // Get aggregation result and store them
-                aggregationResult[seq] = getMean(seq);
-
-                // Update new elements for interestQueue if necessary
-                if (interestQueue.size() < m_interestQueue && globalSeq <= m_iteNum) {
-                    InterestGenerator();
-                }
-
-                // Calculate aggregation time
-                if (aggregateStartTime.find(seq) != aggregateStartTime.end()) {
-                    aggregateTime[seq] = ns3::Simulator::Now() - aggregateStartTime[seq];
-                    AggregateTimeSum(aggregateTime[seq].GetMilliSeconds());
-                    NS_LOG_DEBUG("Iteration " << std::to_string(seq) << " aggregation time is: " << aggregateTime[seq].GetMilliSeconds() << " ms");
-                    aggregateStartTime.erase(seq);
+            if (isLate) {
+                if (m_foldLateArrivals) {
+                    aggregationResult[seq] = getMean(seq);
+                    NS_LOG_DEBUG("Late data from " << name_sec0 << " is folded into iteration " << seq);
                 } else {
-                    NS_LOG_DEBUG("Error when calculating aggregation time, no reference found for seq " << seq);
+                    NS_LOG_DEBUG("Late data from " << name_sec0 << " is dropped, iteration " << seq << " has finished");
                 }
-
-                // Record aggregation time
-                AggregateTimeRecorder(aggregateTime[seq]);
-            }
-
-            /// Stop simulation
-            if (iterationCount == m_iteNum) {
-                NS_LOG_DEBUG("Reach " << m_iteNum << " iterations, stop!");
-                NS_LOG_INFO("Timeout is triggered " << suspiciousPacketCount << " times.");
-                NS_LOG_INFO("Total interest throughput is: " << totalInterestThroughput << " bytes.");
-                NS_LOG_INFO("Total data throughput is: " << totalDataThroughput << " bytes.");
-                NS_LOG_INFO("The average aggregation time of Consumer in " << iterationCount << " iteration is: " << GetAggregateTimeAverage() << " ms");
-
-                // Record throughput into file
-                ThroughputRecorder(totalInterestThroughput, totalDataThroughput);
-
-                // Stop simulation
-                ns3::Simulator::Stop();
-                return;
+                if (pending.none()) {
+                    ReleaseIteration(seq);
+                }
+            } else if (pending.none() || IsPartialReady(seq)) {
+                // Judge whether the aggregation iteration has finished
+                FinishIteration(seq);
             }
+        } else if (seq < globalSeq) {
+            NS_LOG_INFO("Iteration " << seq << " has received all its data, meaning this data packet is duplicate, do nothing!");
         } else {
-            NS_LOG_DEBUG("Suspicious data packet, not exist in data map.");
+            NS_LOG_DEBUG("Suspicious data packet, iteration " << seq << " hasn't been generated.");
             ns3::Simulator::Stop();
         }
     } else if (type == "initialization") {
         std::string destNode = data->getName().get(0).toUri();
+        m_treeInfo.erase(dataName);
 
         // Update synchronization info
         auto it = std::find(broadcastList.begin(), broadcastList.end(), destNode);
@@ -925,6 +1260,106 @@ Consumer::OnData(shared_ptr<const Data> data)
 
 
 
+/**
+ * Compute the result of an iteration, children that haven't responded yet are stragglers
+ * @param seq
+ */
+void
+Consumer::FinishIteration(uint32_t seq)
+{
+    NS_LOG_DEBUG("Aggregation of iteration " << seq << " finished!");
+    IterationProgress& progress = m_progress[seq];
+    progress.deadline.Cancel();
+    progress.finished = true;
+    if (progress.arrived < progress.expected) {
+        NS_LOG_DEBUG("Iteration " << seq << " finished with " << progress.arrived << " of " << progress.expected << " children");
+    }
+
+    // Get aggregation result and store them
+    aggregationResult[seq] = getMean(seq);
+
+    // Stragglers stop retransmitting, only their outstanding interests may still bring data back
+    size_t released = 0;
+    for (const auto& [childId, interest] : progress.sent) {
+        if (m_retxWheel.cancel(interest.first)) {
+            OnInterestReleased(interest.first);
+            released++;
+        }
+    }
+    if (released > 0) {
+        NS_LOG_DEBUG("Iteration " << seq << " releases " << released << " outstanding interests of its stragglers");
+    }
+
+    // Update new elements for round queues if necessary
+    if (GetQueuedInterests() < static_cast<size_t>(m_interestQueue) && globalSeq <= m_iteNum) {
+        InterestGenerator();
+    }
+
+    // Calculate aggregation time
+    Time aggregateTime;
+    auto startIt = aggregateStartTime.find(seq);
+    if (startIt != aggregateStartTime.end()) {
+        aggregateTime = ns3::Simulator::Now() - startIt->second;
+        AggregateTimeSum(aggregateTime.GetMilliSeconds());
+        NS_LOG_DEBUG("Iteration " << std::to_string(seq) << " aggregation time is: " << aggregateTime.GetMilliSeconds() << " ms");
+        aggregateStartTime.erase(startIt);
+    } else {
+        NS_LOG_DEBUG("Error when calculating aggregation time, no reference found for seq " << seq);
+    }
+
+    // Record aggregation time
+    AggregateTimeRecorder(aggregateTime);
+
+    // Progress is kept only while stragglers may still arrive, their last interests expire after one interest lifetime
+    if (progress.pending.none()) {
+        ReleaseIteration(seq);
+    } else {
+        progress.release = Simulator::Schedule(m_interestLifeTime, &Consumer::ReleaseIteration, this, seq);
+    }
+
+    /// Stop simulation once every job has finished
+    if (static_cast<uint32_t>(iterationCount) == m_iteNum) {
+        NS_LOG_DEBUG("Job " << m_jobName << " reaches " << m_iteNum << " iterations, stop!");
+        NS_LOG_INFO("Timeout is triggered " << suspiciousPacketCount << " times.");
+        NS_LOG_INFO("Total interest throughput is: " << totalInterestThroughput << " bytes.");
+        NS_LOG_INFO("Total data throughput is: " << totalDataThroughput << " bytes.");
+        NS_LOG_INFO("The average aggregation time of Consumer in " << iterationCount << " iteration is: " << GetAggregateTimeAverage() << " ms");
+
+        // Record throughput into file
+        ThroughputRecorder(totalInterestThroughput, totalDataThroughput);
+
+        // Stop simulation
+        if (s_runningJobs > 0) {
+            --s_runningJobs;
+        }
+        if (s_runningJobs == 0) {
+            ns3::Simulator::Stop();
+        } else {
+            NS_LOG_INFO(s_runningJobs << " jobs are still running.");
+        }
+    }
+}
+
+
+
+/**
+ * Drop the bookkeeping of a finished iteration, called once none of its stragglers can arrive anymore.
+ * Its result stays in aggregationResult.
+ * @param seq
+ */
+void
+Consumer::ReleaseIteration(uint32_t seq)
+{
+    auto it = m_progress.find(seq);
+    if (it != m_progress.end()) {
+        it->second.release.Cancel();
+        m_progress.erase(it);
+    }
+    sumParameters.erase(seq);
+}
+
+
+
 /**
  * Based on RTT of the first iteration, compute their RTT average as threshold, use the threshold for congestion control
  * Apply Exponentially Weighted Moving Average (EWMA) for RTT Threshold Computation
@@ -957,23 +1392,14 @@ Consumer::RTTThresholdMeasure(int64_t responseTime, int index)
 void
 Consumer::RTORecorder()
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(RTO_recorder, std::ios::app);
-
-    if (!file.is_open()) {
-        std::cerr << "Failed to open the file: " << RTO_recorder << std::endl;
-        return;
-    }
-
-    // Write the response_time to the file, followed by a newline
-    file << ns3::Simulator::Now().GetMilliSeconds();
+    LogSink& sink = LogSink::Get();
+    sink.Append(m_rtoLog, ns3::Simulator::Now().GetMilliSeconds());
     for (const auto& timer : RTO_Timer) {
-        file << " " << timer.second.GetMilliSeconds();
+        sink.Append(m_rtoLog, timer.second.GetMilliSeconds());
+        MetricsRegistry::Get().Set(GetRoundMetrics(timer.first).rto, timer.second.GetMilliSeconds());
     }
-    file << std::endl;
+    sink.EndRecord(m_rtoLog);
 
-    // Close the file
-    file.close();
     Simulator::Schedule(MilliSeconds(5), &Consumer::RTORecorder, this);
 }
 
@@ -984,22 +1410,23 @@ Consumer::RTORecorder()
  * @param responseTime
  * @param seq sequence number
  * @param ECN Whether ECN exist in current packet, type is boolean
+ * @param roundIndex Round the packet belongs to
  */
 void
-Consumer::ResponseTimeRecorder(Time responseTime, uint32_t seq, bool ECN, int64_t threshold_measure, int64_t threshold_actual) {
-    // Open the file using fstream in append mode
-    std::ofstream file(responseTime_recorder, std::ios::app);
-
-    if (!file.is_open()) {
-        std::cerr << "Failed to open the file: " << responseTime_recorder << std::endl;
-        return;
-    }
-
-    // Write the response_time to the file, followed by a newline
-    file << ns3::Simulator::Now().GetMilliSeconds() << " " << seq << " " << ECN << " " << threshold_actual << " " << responseTime.GetMilliSeconds();
-
-    // Close the file
-    file.close();
+Consumer::ResponseTimeRecorder(Time responseTime, uint32_t seq, bool ECN, int64_t threshold_measure, int64_t threshold_actual, int roundIndex) {
+    // The record is finished by subclass, e.g. ConsumerINA appends whether window decrease is suppressed
+    LogSink& sink = LogSink::Get();
+    sink.Append(m_responseTimeLog, ns3::Simulator::Now().GetMilliSeconds());
+    sink.Append(m_responseTimeLog, seq);
+    sink.Append(m_responseTimeLog, ECN);
+    sink.Append(m_responseTimeLog, threshold_actual);
+    sink.Append(m_responseTimeLog, responseTime.GetMilliSeconds());
+
+    MetricsRegistry& registry = MetricsRegistry::Get();
+    const CongestionMetrics& metrics = GetRoundMetrics(roundIndex);
+    registry.Record(metrics.rtt, responseTime.GetMilliSeconds());
+    registry.Set(metrics.rttMeasurement, threshold_measure);
+    registry.Set(metrics.rttThreshold, threshold_actual);
 }
 
 
@@ -1010,18 +1437,8 @@ Consumer::ResponseTimeRecorder(Time responseTime, uint32_t seq, bool ECN, int64_
  */
 void
 Consumer::AggregateTimeRecorder(Time aggregateTime) {
-    // Open the file using fstream in append mode
-    std::ofstream file(aggregateTime_recorder, std::ios::app);
-
-    if (!file.is_open()) {
-        std::cerr << "Failed to open the file: " << aggregateTime_recorder << std::endl;
-        return;
-    }
-
-    // Write aggregation time to file, followed by a new line
-    file << Simulator::Now().GetMilliSeconds() << " " << aggregateTime.GetMilliSeconds() << std::endl;
-
-    file.close();
+    LogSink::Get().Write(m_aggregateTimeLog, Simulator::Now().GetMilliSeconds(), aggregateTime.GetMilliSeconds());
+    MetricsRegistry::Get().Record(m_aggregateTimeMetric, aggregateTime.GetMilliSeconds());
 }
 
 
@@ -1032,23 +1449,55 @@ Consumer::AggregateTimeRecorder(Time aggregateTime) {
 void
 Consumer::InitializeLogFile()
 {
-    // Open the file and clear all contents for all log files
-    OpenFile(RTO_recorder);
-    OpenFile(responseTime_recorder);
-    OpenFile(aggregateTime_recorder);
-    OpenFile(throughput_recorder);
+    // Register all log files, their contents are cleared
+    std::string prefix = GetLogPrefix("consumer", m_jobName);
+    RTO_recorder = prefix + "_RTO.txt";
+    responseTime_recorder = prefix + "_RTT.txt";
+    aggregateTime_recorder = prefix + "_aggregationTime.txt";
+    m_rtoLog = OpenLog(RTO_recorder);
+    m_responseTimeLog = OpenLog(responseTime_recorder, {"time", "seq", "ECN", "threshold", "RTT", "isWindowDecreaseSuppressed"});
+    m_aggregateTimeLog = OpenLog(aggregateTime_recorder, {"time", "aggregateTime"});
+    throughput_recorder = folderPath + "/throughput.txt";
+    m_throughputLog = OpenLog(throughput_recorder, {"interestThroughput", "dataThroughput", "time"});
+
+    // Register metrics of the job, ignored unless the metrics registry is enabled; round metrics follow in GetRoundMetrics()
+    m_aggregateTimeMetric = MetricsRegistry::Get().Register(MetricsRegistry::Type::kHistogram, m_nodeprefix, m_jobName, "aggregationTime");
 }
 
 
 
 /**
- * Check whether cwnd has been decreased within the last RTT duration
+ * Get the metrics of a round, they're registered the first time a round is seen
+ * @param roundIndex
+ * @return Metrics of the round, updates are ignored for an unknown round
+ */
+const CongestionMetrics&
+Consumer::GetRoundMetrics(int roundIndex)
+{
+    static const CongestionMetrics unknownRound;
+    if (roundIndex < 0) {
+        return unknownRound;
+    }
+
+    while (static_cast<int>(m_roundMetrics.size()) <= roundIndex) {
+        m_roundMetrics.emplace_back();
+        m_roundMetrics.back().Register(m_nodeprefix, m_jobName, "round" + std::to_string(m_roundMetrics.size() - 1) + "/");
+    }
+    return m_roundMetrics[roundIndex];
+}
+
+
+
+/**
+ * Check whether cwnd of the round has been decreased within the last RTT duration
+ * @param threshold
+ * @param roundIndex
  * @return
  */
 bool
-Consumer::CanDecreaseWindow(int64_t threshold)
+Consumer::CanDecreaseWindow(int64_t threshold, int roundIndex)
 {
-    if (Simulator::Now().GetMilliSeconds() - lastWindowDecreaseTime.GetMilliSeconds() >= threshold) {
+    if (Simulator::Now().GetMilliSeconds() - lastWindowDecreaseTime[roundIndex].GetMilliSeconds() >= threshold) {
         NS_LOG_DEBUG("Window decrease is allowed.");
         return true;
     } else {
@@ -1067,18 +1516,7 @@ Consumer::CanDecreaseWindow(int64_t threshold)
 void
 Consumer::ThroughputRecorder(int interestThroughput, int dataThroughput)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(throughput_recorder, std::ios::app);
-
-    if (!file.is_open()) {
-        std::cerr << "Failed to open the file: " << throughput_recorder << std::endl;
-        return;
-    }
-
-    // Write aggregation time to file, followed by a new line
-    file << interestThroughput << " " << dataThroughput << " " << Simulator::Now().GetSeconds() << std::endl;
-
-    file.close();
+    LogSink::Get().Write(m_throughputLog, interestThroughput, dataThroughput, Simulator::Now().GetSeconds());
 }
 } // namespace ndn
 } // namespace ns3
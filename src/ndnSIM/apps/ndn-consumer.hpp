@@ -24,6 +24,11 @@
 
 #include "ndn-app.hpp"
 #include "ModelData.hpp"
+#include "MetricsRegistry.hpp"
+#include "TimerWheel.hpp"
+#include "RetxFilter.hpp"
+#include "TreeDescriptor.hpp"
+#include "algorithm/include/AggregationTree.hpp"
 
 #include "ns3/random-variable-stream.h"
 #include "ns3/nstime.h"
@@ -46,7 +51,9 @@
 #include <utility>
 #include <deque>
 #include <tuple>
+#include <unordered_map>
 
+#include <boost/dynamic_bitset.hpp>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/tag.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -71,6 +78,14 @@ public:
 
     void ConstructAggregationTree();
 
+    // Incrementally repair the tree on churn/link change, re-broadcast changed sub-trees only
+    // Triggered by repeated timeouts of one child (see "RepairTimeouts"), scenarios may call it when they change the topology
+    void RepairAggregationTree(const AggregationTree::TreeChange& change);
+
+    // Aggregators whose sub-tree differs between the two trees, i.e. the ones a repair sends the tree to again
+    std::vector<std::string> GetChangedSubTrees(const std::map<std::string, std::vector<std::string>>& oldTree,
+                                                const std::map<std::string, std::vector<std::string>>& newTree);
+
     virtual void
     OnData(shared_ptr<const Data> contentObject);
 
@@ -80,18 +95,28 @@ public:
     virtual void
     OnTimeout(std::string nameString);
 
+    // Send the next queued interest of the given round
     void
-    SendPacket();
+    SendPacket(int roundIndex);
 
-    // Generate new interests
+    // Register upcoming iterations, their interests are generated on demand in SendPacket()
     void
     InterestGenerator();
 
     // Data aggregation
-    void aggregate(const ModelData& data, const uint32_t& seq);
+    void aggregate(const ModelDataView& data, const uint32_t& seq);
 
     std::vector<float> getMean(const uint32_t& seq);
 
+    // Straggler-tolerant (k-of-n) aggregation
+    bool IsPartialReady(uint32_t seq) const;
+
+    void OnAggregationDeadline(uint32_t seq);
+
+    void FinishIteration(uint32_t seq);
+
+    void ReleaseIteration(uint32_t seq);
+
     // Calculate aggregate time and response time
     void ResponseTimeSum (int64_t response_time);
 
@@ -115,13 +140,15 @@ public:
     void RTORecorder();
 
     // Record RTT of each packet and some other relevant info
-    void ResponseTimeRecorder(Time responseTime, uint32_t seq, bool ECN, int64_t threshold_measure, int64_t threshold_actual);
+    void ResponseTimeRecorder(Time responseTime, uint32_t seq, bool ECN, int64_t threshold_measure, int64_t threshold_actual, int roundIndex);
 
     void AggregateTimeRecorder(Time aggregateTime);
 
     void InitializeLogFile();
 
-    bool CanDecreaseWindow(int64_t threshold);
+    const CongestionMetrics& GetRoundMetrics(int roundIndex);
+
+    bool CanDecreaseWindow(int64_t threshold, int roundIndex);
 
     void ThroughputRecorder(int interestThroughput, int dataThroughput);
 
@@ -141,11 +168,21 @@ protected:
     ScheduleNextPacket() = 0;
 
     virtual void
-    SendInterest(shared_ptr<Name> newName);
+    SendInterest(const Name& newName);
+
+    // An outstanding interest stops being retransmitted because its iteration has finished
+    virtual void
+    OnInterestReleased(const std::string& nameString);
 
     void
     CheckRetxTimeout();
 
+    void
+    OnChildTimeout(const std::string& child);
+
+    void
+    ScheduleRetxCheck(Time when);
+
     void
     SetRetxTimer(Time retxTimer);
 
@@ -160,22 +197,45 @@ public:
     // Return round index
     int findRoundIndex(const std::string& target);
 
+protected:
+    void SendTreeInfo(const std::string& parentNode, uint32_t seq);
+
+    void UpdateTreeRounds();
+
+    LeafBitmap GetLeafBitmap(const std::set<std::string>& leaves) const;
+
+    // Build name prefixes of all rounds' children once per tree
+    void BuildRoundGenerators();
+
+    // Total number of queued interests over all rounds
+    size_t GetQueuedInterests() const;
+
+    bool HasQueuedInterests(int roundIndex) const;
+
 
 
 protected:
     // Topology file name
     std::string filename = "src/ndnSIM/examples/topologies/DataCenterTopology.txt";
 
-    // Testing log file
+    // Testing log file, named after the job in InitializeLogFile(), e.g. "consumer_RTO.txt" for the default job
     // ToDo: Update logging for multiple rounds
-    std::string RTO_recorder = folderPath + "/consumer_RTO.txt"; //'Time', 'RTO'
-    std::string responseTime_recorder = folderPath + "/consumer_RTT.txt"; //'Time', 'seq', ‘ECN’， ‘RTT threshold’，'RTT', 'isWindowDecreaseSuppressed'
-    std::string aggregateTime_recorder = folderPath + "/consumer_aggregationTime.txt"; //'Time', 'aggTime'
+    std::string RTO_recorder; //'Time', 'RTO'
+    std::string responseTime_recorder; //'Time', 'seq', ‘ECN’， ‘RTT threshold’，'RTT', 'isWindowDecreaseSuppressed'
+    std::string aggregateTime_recorder; //'Time', 'aggTime'
     //std::string throughput_recorder = folderPath + "/throughput.txt";
+    LogSink::Channel m_rtoLog = LogSink::INVALID_CHANNEL;
+    LogSink::Channel m_responseTimeLog = LogSink::INVALID_CHANNEL;
+    LogSink::Channel m_aggregateTimeLog = LogSink::INVALID_CHANNEL;
+    LogSink::Channel m_throughputLog = LogSink::INVALID_CHANNEL;
     int suspiciousPacketCount; // When timeout is triggered, add one
 
+    // Metrics of each round, named "round<i>/...", and aggregation time of the job
+    std::vector<CongestionMetrics> m_roundMetrics;
+    MetricsRegistry::Id m_aggregateTimeMetric = MetricsRegistry::INVALID_ID;
+
     // Update when WindowDecrease() is called every time, used for CWA algorithm
-    Time lastWindowDecreaseTime;
+    std::map<int, Time> lastWindowDecreaseTime;
     bool isWindowDecreaseSuppressed;
 
     // Local throughput measurement
@@ -185,6 +245,7 @@ protected:
 
     // Congestion/rate control
     std::vector<std::vector<std::string>> globalTreeRound;
+    std::unordered_map<std::string, int> m_roundIndex; // Round index of each node in "globalTreeRound"
     std::map<int, std::vector<int64_t>> RTT_threshold_vec; // Each mapping represents one round (if there're more than one round)
     std::map<int, int64_t> RTT_threshold; // Actual threshold used to detect congestion
     std::map<int, int64_t> RTT_measurement; // The estimated RTT value using EWMA
@@ -194,37 +255,53 @@ protected:
     uint32_t globalSeq;
     int globalRound;
 
-    // Interest queue
-    std::queue<std::tuple<uint32_t, bool, shared_ptr<Name>>> interestQueue; // tuple: iteration, round, name
+    // Consumers (jobs) that haven't finished all iterations, the simulation stops when all of them finish
+    static uint32_t s_runningJobs;
+
+    // Interest generator of each round, rounds are scheduled independently so successive iterations overlap
+    // Interests aren't stored, the next one is built from the round's cursor when the window opens
+    struct RoundGenerator {
+        std::vector<Name> prefixes; // "/Child/Job/LeafBitmap/data" of each child, built once per tree
+        uint32_t seq = 0; // Iteration of the next interest
+        size_t next = 0; // Child of the next interest
+        std::queue<std::pair<uint32_t, Name>> leftover; // Interests of started iterations kept over a tree repair
+    };
+    std::vector<RoundGenerator> m_rounds;
 
     // Get producer list
     std::string proList;
 
     // Constructed aggregation Tree
+    std::shared_ptr<AggregationTree> m_aggTree; // Kept for incremental repair
+    std::vector<std::string> m_producers; // Producers currently in the tree
+    std::unordered_map<std::string, uint32_t> m_producerIndex; // Bit of each producer inside leaf bitmaps
+    uint32_t m_treeVersion; // Incremented on every repair, used as seq of re-broadcast interests
     std::vector<std::map<std::string, std::vector<std::string>>> aggregationTree; // Entire tree (including main tree and sub-trees)
 
     // Broadcast aggregation tree
     bool broadcastSync;
     std::vector<std::string> broadcastList; // Elements within this vector need to be broadcasted
+    std::map<std::string, Block> m_treeInfo; // Encoded TreeDescriptor of each unconfirmed "initialization" interest
 
-    // Aggregation synchronization
-    std::map<uint32_t, std::vector<std::vector<std::string>>> map_agg_oldSeq_newName; // Manage names for round
-    std::map<uint32_t, std::vector<std::string>> m_agg_newDataName; // Manage names for entire iteration
-
-    // Used inside InterestGenerator function
-    std::map<int, std::vector<std::string>> map_round_nameSec1_3;
-    std::vector<std::string> vec_iteration;
-    std::vector<std::vector<std::string>> vec_round;
+    // Aggregation synchronization, children of every iteration are bits indexed like "m_children"
+    std::vector<std::string> m_children; // Every child the consumer has had, indices stay valid across repairs
+    std::unordered_map<std::string, uint32_t> m_childIndex;
+    boost::dynamic_bitset<> m_iterationChildren; // Children of an iteration on the current tree, empty until generators are built
 
 
     // Timeout check/ RTO measurement
-    std::map<std::string, ns3::Time> m_timeoutCheck;
+    TimerWheel<std::string> m_retxWheel; // Deadline of each outstanding interest
+    RetxFilter m_retxFilter; // Recently retransmitted interests
+    uint32_t m_retxFilterCapacity;
+    Time m_retxFilterLifetime;
     std::map<int, Time> m_timeoutThreshold;
     std::map<int, Time> RTO_Timer;
     std::map<int, int64_t> SRTT;
     std::map<int, int64_t> RTTVAR;
     std::map<int, bool> initRTO;
     std::map<int, int> numTimeout; // Count the number of timeout, for testing purpose
+    uint32_t m_repairTimeouts; // Consecutive timeouts after which a child is taken out of the tree, 0 disables it
+    std::unordered_map<std::string, uint32_t> m_childTimeouts; // Consecutive timeouts of each direct child, reset by its data
 
 
     // Designed for actual aggregation operations
@@ -232,25 +309,41 @@ protected:
     std::map<uint32_t, std::vector<float>> aggregationResult;
     int producerCount;
 
+    // Progress of each iteration, the mean is weighted by the producers actually summed
+    struct IterationProgress {
+        uint32_t expected = 0; // direct children of the iteration
+        boost::dynamic_bitset<> pending; // children whose data hasn't arrived
+        uint32_t arrived = 0;
+        uint32_t contributors = 0; // producers summed in sumParameters
+        bool expired = false; // deadline has passed, finish as soon as anything is aggregated
+        bool started = false; // the first interest of the iteration has been sent
+        bool finished = false; // the result has been computed, only stragglers may still arrive
+        EventId deadline;
+        EventId release; // end of the late-arrival window of a finished iteration
+        std::map<uint32_t, std::pair<std::string, Time>> sent; // name and first send time of each pending child's interest
+    };
+    std::map<uint32_t, IterationProgress> m_progress;
+    double m_partialFraction; // Finish an iteration once this fraction of children has responded
+    Time m_partialDeadline; // Finish an iteration with whatever has arrived after this time, 0 disables it
+    bool m_foldLateArrivals; // Add responses arriving after an iteration finished into its result
+
     // Congestion signal
     bool ECNLocal;
     bool ECNRemote;
 
-    // defined for response time
-    std::map<std::string, ns3::Time> startTime;
-    std::map<std::string, ns3::Time> responseTime;
+    // defined for response time, start times are kept per child in "m_progress"
     int64_t total_response_time;
     int round;
 
     // defined for aggregation time
     std::map<uint32_t, ns3::Time> aggregateStartTime;
-    std::map<uint32_t, ns3::Time> aggregateTime;
     int64_t totalAggregateTime;
     int iterationCount;
 
     // New defined attribute variables
     std::string m_interestName; // Consumer's interest prefix
     std::string m_nodeprefix; // Consumer's node prefix
+    std::string m_jobName; // Job component of all interests, aggregators keep separate states per job
     uint32_t m_iteNum; // The number of iterations
     int m_interestQueue; // Queue size
     int m_constraint; // Constraint of each sub-tree
@@ -38,6 +38,7 @@
 #include "model/ndn-l3-protocol.hpp"
 #include "helper/ndn-fib-helper.hpp"
 #include "ModelData.hpp"
+#include "ns3/rng-seed-manager.h"
 
 #include <random>
 #include <vector>
@@ -66,6 +67,18 @@ Producer::GetTypeId(void)
          "Postfix",
          "Postfix that is added to the output data (e.g., for adding producer-uniqueness)",
          StringValue("/"), MakeNameAccessor(&Producer::m_postfix), MakeNameChecker())
+      .AddAttribute("ModelSize", "The number of model parameters carried in each Data packet", UintegerValue(300),
+                    MakeUintegerAccessor(&Producer::m_modelSize),
+                    MakeUintegerChecker<uint32_t>(1))
+      .AddAttribute("PayloadMode", "How model parameters are generated: Random, Pool, Counter or Template",
+                    StringValue("Counter"), MakeStringAccessor(&Producer::m_payloadMode), MakeStringChecker())
+      .AddAttribute("PoolSize", "The number of pre-generated payloads in Pool mode", UintegerValue(16),
+                    MakeUintegerAccessor(&Producer::m_poolSize),
+                    MakeUintegerChecker<uint32_t>(1))
+      .AddAttribute("PayloadCodec", "Encoding of model parameters: fp32, fp16, bf16, int8 or topk",
+                    StringValue("fp32"), MakeStringAccessor(&Producer::m_payloadCodec), MakeStringChecker())
+      .AddAttribute("TopKRatio", "Fraction of model parameters kept by the topk codec", DoubleValue(0.1),
+                    MakeDoubleAccessor(&Producer::m_topKRatio), MakeDoubleChecker<double>(0.0, 1.0))
       .AddAttribute("PayloadSize", "Virtual payload size for Content packets", UintegerValue(1024),
                     MakeUintegerAccessor(&Producer::m_virtualPayloadSize),
                     MakeUintegerChecker<uint32_t>())
@@ -96,6 +109,52 @@ Producer::StartApplication()
   App::StartApplication();
 
   FibHelper::AddRoute(GetNode(), m_prefix, m_face, 0);
+
+  // Payload generation, seeded per producer so runs are reproducible
+  PayloadEngine::Mode mode;
+  if (!PayloadEngine::ParseMode(m_payloadMode, mode)) {
+    NS_LOG_DEBUG("Unknown payload mode " << m_payloadMode << ", use Counter instead.");
+    mode = PayloadEngine::Mode::kCounter;
+  }
+  uint64_t seed = (static_cast<uint64_t>(RngSeedManager::GetSeed()) << 32) ^ RngSeedManager::GetRun()
+                  ^ std::hash<std::string>()(m_prefix.toUri());
+  PayloadCodec::Type codec;
+  if (!PayloadCodec::ParseType(m_payloadCodec, codec)) {
+    NS_LOG_DEBUG("Unknown payload codec " << m_payloadCodec << ", use fp32 instead.");
+    codec = PayloadCodec::Type::kFp32;
+  }
+  m_payload.SetCodec(PayloadCodec(codec, m_topKRatio));
+  m_payload.Configure(mode, m_modelSize, seed, m_poolSize);
+
+  // Signature is identical for all responses, encode it once
+  m_signatureInfo = SignatureInfo(static_cast< ::ndn::tlv::SignatureTypeValue>(255));
+  if (m_keyLocator.size() > 0) {
+    m_signatureInfo.setKeyLocator(m_keyLocator);
+  }
+  ::ndn::EncodingEstimator estimator;
+  ::ndn::EncodingBuffer encoder(estimator.appendVarNumber(m_signature), 0);
+  encoder.appendVarNumber(m_signature);
+  m_signatureValue = encoder.getBuffer();
+
+  if (mode == PayloadEngine::Mode::kTemplate) {
+    Data prototype(m_prefix);
+    FillData(prototype);
+    m_dataTemplate.Set(prototype);
+  }
+  NS_LOG_INFO("Producer " << m_prefix << " generates payloads in " << PayloadEngine::GetModeName(mode) << " mode.");
+}
+
+/**
+ * Set freshness, content and signature of a response
+ * @param data
+ */
+void
+Producer::FillData(Data& data)
+{
+  data.setFreshnessPeriod(::ndn::time::milliseconds(m_freshness.GetMilliSeconds()));
+  data.setContent(m_payload.Next());
+  data.setSignatureInfo(m_signatureInfo);
+  data.setSignatureValue(m_signatureValue);
 }
 
 void
@@ -114,46 +173,15 @@ Producer::OnInterest(shared_ptr<const Interest> interest)
     if (!m_active)
     return;
 
-    Name dataName(interest->getName());
-    // dataName.append(m_postfix);
-    // dataName.appendVersion();
-
-    auto data = make_shared<Data>();
-    data->setName(dataName);
-    data->setFreshnessPeriod(::ndn::time::milliseconds(m_freshness.GetMilliSeconds()));
-
-    // generate new data content
-    // new data format and generate random 300 model parameters
-    ModelData modelData;
-
-    std::default_random_engine generator(std::random_device{}()); // create random generator
-    std::uniform_real_distribution<float> distribution(0.0f, 10.0f); // define range (0.0, 10.0)
-    modelData.parameters.clear(); // clear the previous result
-    for (int i = 0; i < 300; ++i){
-        modelData.parameters.push_back(distribution(generator)); // generate random float range (0.0, 10.0)
+    // Template mode only encodes the name, other modes build the packet around a generated payload
+    shared_ptr<Data> data;
+    if (m_dataTemplate.IsSet()) {
+        data = m_dataTemplate.Make(interest->getName());
+    } else {
+        data = make_shared<Data>(interest->getName());
+        FillData(*data);
     }
 
-    std::vector<uint8_t> buffer;
-    serializeModelData(modelData, buffer); // serialize data packet
-    data->setContent(make_shared< ::ndn::Buffer>(buffer.begin(), buffer.end()));
-
-    // end of data content
-
-
-
-    SignatureInfo signatureInfo(static_cast< ::ndn::tlv::SignatureTypeValue>(255));
-
-    if (m_keyLocator.size() > 0) {
-        signatureInfo.setKeyLocator(m_keyLocator);
-    }
-
-    data->setSignatureInfo(signatureInfo);
-
-    ::ndn::EncodingEstimator estimator;
-    ::ndn::EncodingBuffer encoder(estimator.appendVarNumber(m_signature), 0);
-    encoder.appendVarNumber(m_signature);
-    data->setSignatureValue(encoder.getBuffer());
-
     NS_LOG_INFO(m_prefix << " -> node(" << GetNode()->GetId() << ") responding with Data: " << data->getName());
     NS_LOG_INFO("The returned data packet size is: " << data->wireEncode().size());
 
@@ -30,6 +30,7 @@
 #include "ns3/ndnSIM/model/ndn-common.hpp"
 
 #include "ndn-app.hpp"
+#include "PayloadEngine.hpp"
 #include "ns3/ndnSIM/model/ndn-common.hpp"
 
 #include "ns3/nstime.h"
@@ -66,6 +67,9 @@ protected:
   virtual void
   StopApplication(); // Called at time specified by Stop
 
+  void
+  FillData(Data& data);
+
 private:
   Name m_prefix;
   Name m_postfix;
@@ -76,6 +80,17 @@ private:
   Name m_keyLocator;
 
   uint32_t m_prefixnum; //customized
+  uint32_t m_modelSize; // The number of model parameters
+
+  // Payload generation, signature and data template are prepared in StartApplication()
+  std::string m_payloadMode;
+  uint32_t m_poolSize;
+  std::string m_payloadCodec;
+  double m_topKRatio;
+  PayloadEngine m_payload;
+  SignatureInfo m_signatureInfo;
+  ::ndn::ConstBufferPtr m_signatureValue;
+  DataTemplate m_dataTemplate;
 };
 
 } // namespace ndn
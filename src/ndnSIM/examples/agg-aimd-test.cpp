@@ -2,9 +2,14 @@
 #include "ns3/network-module.h"
 #include "ns3/ndnSIM-module.h"
 #include "ns3/error-model.h"
+#include "ns3/ndnSIM/apps/LogSink.hpp"
+#include "ns3/ndnSIM/apps/MetricsRegistry.hpp"
+#include "ns3/ndnSIM/apps/algorithm/utility/utility.hpp"
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/ini_parser.hpp>
+#include <sys/resource.h>
+#include <chrono>
 #include <iostream>
 #include <string>
 
@@ -20,17 +25,34 @@ namespace ns3 {
         double ThresholdFactor;
         bool UseCwa;
         int InterestQueue;
+        int TokenBudget;
         int QueueSize;
         int Iteration;
+        int ModelSize;
+        std::string PayloadMode;
+        std::string LogFormat;
+        bool LogAsync;
+        int LogBufferSize;
+        bool MetricsEnable;
+        std::string MetricsSamplePeriod;
+        std::string MetricsFormat;
+        std::string CostMatrixCache;
+        double PartialFraction;
+        std::string PartialDeadline;
+        bool FoldLateArrivals;
+        uint32_t RepairTimeouts;
+        std::string PayloadCodec;
+        double TopKRatio;
     };
 
     /**
      * Get all required config parameters
+     * @param configFile Path of config.ini
      * @return
      */
-    ConfigParams GetConfigParams() {
+    ConfigParams GetConfigParams(const std::string& configFile) {
         boost::property_tree::ptree pt;
-        boost::property_tree::ini_parser::read_ini("src/ndnSIM/experiments/config.ini", pt);
+        boost::property_tree::ini_parser::read_ini(configFile, pt);
 
         ConfigParams params;
         params.Constraint = pt.get<int>("General.Constraint");
@@ -42,8 +64,24 @@ namespace ns3 {
         params.ThresholdFactor = pt.get<double>("General.ThresholdFactor");
         params.UseCwa = pt.get<bool>("General.UseCwa");
         params.InterestQueue = pt.get<int>("Consumer.InterestQueue");
+        params.TokenBudget = pt.get<int>("Consumer.TokenBudget", 0);
         params.QueueSize = pt.get<int>("Aggregator.QueueSize");
         params.Iteration = pt.get<int>("Consumer.Iteration");
+        params.ModelSize = pt.get<int>("Producer.ModelSize", 300);
+        params.PayloadMode = pt.get<std::string>("Producer.PayloadMode", "Counter");
+        params.LogFormat = pt.get<std::string>("Log.Format", "text");
+        params.LogAsync = pt.get<bool>("Log.Async", false);
+        params.LogBufferSize = pt.get<int>("Log.BufferSize", 1 << 20);
+        params.MetricsEnable = pt.get<bool>("Metrics.Enable", false);
+        params.MetricsSamplePeriod = pt.get<std::string>("Metrics.SamplePeriod", "10ms");
+        params.MetricsFormat = pt.get<std::string>("Metrics.Format", "csv");
+        params.CostMatrixCache = pt.get<std::string>("General.CostMatrixCache", "/tmp/cfnagg-cost-cache");
+        params.PartialFraction = pt.get<double>("General.PartialFraction", 1.0);
+        params.PartialDeadline = pt.get<std::string>("General.PartialDeadline", "0ms");
+        params.FoldLateArrivals = pt.get<bool>("Consumer.FoldLateArrivals", false);
+        params.RepairTimeouts = pt.get<uint32_t>("Consumer.RepairTimeouts", 0);
+        params.PayloadCodec = pt.get<std::string>("General.PayloadCodec", "fp32");
+        params.TopKRatio = pt.get<double>("General.TopKRatio", 0.1);
 
         return params;
     }
@@ -51,11 +89,12 @@ namespace ns3 {
 
     /**
      * Get constraints from config.ini
+     * @param configFile Path of config.ini
      * @return
      */
-    int GetConstraint() {
+    int GetConstraint(const std::string& configFile) {
         boost::property_tree::ptree pt;
-        boost::property_tree::ini_parser::read_ini("src/ndnSIM/experiments/config.ini", pt);
+        boost::property_tree::ini_parser::read_ini(configFile, pt);
 
         int constraint = pt.get<int>("General.Constraint");
         return constraint;
@@ -74,11 +113,25 @@ namespace ns3 {
 
     int main(int argc, char* argv[])
     {
+        std::string topology = "src/ndnSIM/examples/topologies/DataCenterTopology.txt";
+        std::string configFile = "src/ndnSIM/experiments/config.ini";
+        std::string logDir = "src/ndnSIM/results/logs";
+        bool benchmark = false;
+
         CommandLine cmd;
+        cmd.AddValue("topology", "Topology file", topology);
+        cmd.AddValue("config", "Config file, see src/ndnSIM/experiments/config.ini", configFile);
+        cmd.AddValue("logDir", "Directory all log files are written into", logDir);
+        cmd.AddValue("benchmark", "Print simulator performance (events/sec, wall time per simulated second, peak RSS) at the end", benchmark);
         cmd.Parse(argc, argv);
 
+        ConfigParams params = GetConfigParams(configFile);
+
+        // Every app writes its logs into logDir, so that simulations running in parallel don't share files
+        Config::SetDefault("ns3::ndn::App::LogDirectory", StringValue(logDir));
+
         AnnotatedTopologyReader topologyReader("", 25);
-        topologyReader.SetFileName("src/ndnSIM/examples/topologies/DataCenterTopology.txt");
+        topologyReader.SetFileName(topology);
         topologyReader.Read();
 
         // Create error model to add packet loss
@@ -88,6 +141,11 @@ namespace ns3 {
 
         // Install NDN stack on all nodes
         ndn::StackHelper ndnHelper;
+        // NDNLP reassembles up to 400 fragments per packet by default, fp32 models of more than ~100k parameters need more
+        size_t maxFragments = static_cast<size_t>(params.ModelSize) * sizeof(float) / 1000 + 1;
+        if (maxFragments > 400) {
+            ndnHelper.setMaxFragments(maxFragments);
+        }
         ndnHelper.InstallAll();
 
         ndn::GlobalRoutingHelper GlobalRoutingHelper;
@@ -99,19 +157,32 @@ namespace ns3 {
         Config::Connect("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/PhyRxDrop", MakeCallback(&PacketDropCallback));
 
         // Get constraint from config.ini
-        //int constraint = GetConstraint();
-        ConfigParams params = GetConfigParams();
+        //int constraint = GetConstraint(configFile);
+
+        // Configure log sink before apps register their log files
+        LogSink::Get().SetFormat(params.LogFormat == "binary" ? LogSink::Format::kBinary : LogSink::Format::kText);
+        LogSink::Get().SetAsync(params.LogAsync);
+        LogSink::Get().SetBufferSize(params.LogBufferSize);
+        Utility::SetCostMatrixCacheDir(params.CostMatrixCache);
+
+        // Configure metrics registry, metrics are exported next to the log files
+        MetricsRegistry::Get().SetEnabled(params.MetricsEnable);
+        MetricsRegistry::Get().SetSamplePeriod(Time(params.MetricsSamplePeriod));
+        MetricsRegistry::Get().SetFormat(params.MetricsFormat == "binary" ? MetricsRegistry::Format::kBinary : MetricsRegistry::Format::kCsv);
+        MetricsRegistry::Get().SetOutputDirectory(logDir);
 
         for (NodeContainer::Iterator i = NodeList::Begin(); i != NodeList::End(); ++i) {
             Ptr<Node> node = *i;
             std::string nodeName = Names::FindName(node);
 
             if (nodeName.find("con") == 0) {
-                // Config consumer's attribute on ConsumerINA class
+                // Config consumer's attribute on ConsumerINA class, every consumer runs its own job, e.g. "con1" runs "job1"
                 ndn::AppHelper consumerHelper("ns3::ndn::ConsumerINA");
                 consumerHelper.SetAttribute("Iteration", IntegerValue(params.Iteration));
                 consumerHelper.SetAttribute("UseCwa", BooleanValue(params.UseCwa));
-                consumerHelper.SetAttribute("NodePrefix", StringValue("con0"));
+                consumerHelper.SetAttribute("NodePrefix", StringValue(nodeName));
+                consumerHelper.SetAttribute("JobName", StringValue("job" + nodeName.substr(3)));
+                consumerHelper.SetAttribute("TopologyFile", StringValue(topology));
                 consumerHelper.SetAttribute("Constraint", IntegerValue(params.Constraint));
                 consumerHelper.SetAttribute("Window", StringValue(params.Window));
                 consumerHelper.SetAttribute("Alpha", DoubleValue(params.Alpha));
@@ -120,6 +191,11 @@ namespace ns3 {
                 consumerHelper.SetAttribute("EWMAFactor", DoubleValue(params.EWMAFactor));
                 consumerHelper.SetAttribute("ThresholdFactor", DoubleValue(params.ThresholdFactor));
                 consumerHelper.SetAttribute("InterestQueue", IntegerValue(params.InterestQueue));
+                consumerHelper.SetAttribute("TokenBudget", UintegerValue(params.TokenBudget));
+                consumerHelper.SetAttribute("PartialFraction", DoubleValue(params.PartialFraction));
+                consumerHelper.SetAttribute("PartialDeadline", StringValue(params.PartialDeadline));
+                consumerHelper.SetAttribute("FoldLateArrivals", BooleanValue(params.FoldLateArrivals));
+                consumerHelper.SetAttribute("RepairTimeouts", UintegerValue(params.RepairTimeouts));
 
                 // Add consumer prefix in all nodes' routing info
                 auto app1 = consumerHelper.Install(node);
@@ -138,6 +214,10 @@ namespace ns3 {
                 aggregatorHelper.SetAttribute("EWMAFactor", DoubleValue(params.EWMAFactor));
                 aggregatorHelper.SetAttribute("ThresholdFactor", DoubleValue(params.ThresholdFactor));
                 aggregatorHelper.SetAttribute("QueueSize", IntegerValue(params.QueueSize));
+                aggregatorHelper.SetAttribute("PartialFraction", DoubleValue(params.PartialFraction));
+                aggregatorHelper.SetAttribute("PartialDeadline", StringValue(params.PartialDeadline));
+                aggregatorHelper.SetAttribute("PayloadCodec", StringValue(params.PayloadCodec));
+                aggregatorHelper.SetAttribute("TopKRatio", DoubleValue(params.TopKRatio));
 
                 // Add aggregator prefix in all nodes' routing info
                 auto app2 = aggregatorHelper.Install(node);
@@ -148,6 +228,10 @@ namespace ns3 {
                 // Install Producer on producer nodes
                 ndn::AppHelper producerHelper("ns3::ndn::Producer");
                 producerHelper.SetPrefix("/" + nodeName);
+                producerHelper.SetAttribute("ModelSize", UintegerValue(params.ModelSize));
+                producerHelper.SetAttribute("PayloadMode", StringValue(params.PayloadMode));
+                producerHelper.SetAttribute("PayloadCodec", StringValue(params.PayloadCodec));
+                producerHelper.SetAttribute("TopKRatio", DoubleValue(params.TopKRatio));
 
                 // Add producer prefix in all nodes' routing info
                 producerHelper.Install(node);
@@ -162,7 +246,21 @@ namespace ns3 {
         // Calculate and install FIBs
         ndn::GlobalRoutingHelper::CalculateRoutes();
 
+        auto wallStart = std::chrono::steady_clock::now();
         Simulator::Run();
+
+        // One line, parsed by tests/benchmarks/cfnagg-macro-bench.sh
+        if (benchmark) {
+            double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+            double simTime = Simulator::Now().GetSeconds();
+            uint64_t events = Simulator::GetEventCount();
+            struct rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            std::cout << "benchmark: events=" << events << " wall=" << wallTime << "s simulated=" << simTime << "s"
+                      << " events/s=" << (wallTime > 0 ? events / wallTime : 0)
+                      << " wall/simulated=" << (simTime > 0 ? wallTime / simTime : 0)
+                      << " peakRSS=" << usage.ru_maxrss << "KB" << std::endl;
+        }
         Simulator::Destroy();
 
         return 0;
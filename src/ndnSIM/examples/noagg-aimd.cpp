@@ -14,11 +14,18 @@ namespace ns3 {
     int
     main(int argc, char* argv[])
     {
+        std::string topology = "src/ndnSIM/examples/topologies/DataCenterTopology.txt";
+        std::string logDir = "src/ndnSIM/results/logs";
+
         CommandLine cmd;
+        cmd.AddValue("topology", "Topology file", topology);
+        cmd.AddValue("logDir", "Directory all log files are written into", logDir);
         cmd.Parse(argc, argv);
 
+        Config::SetDefault("ns3::ndn::App::LogDirectory", StringValue(logDir));
+
         AnnotatedTopologyReader topologyReader("", 25);
-        topologyReader.SetFileName("src/ndnSIM/examples/topologies/DataCenterTopology.txt");
+        topologyReader.SetFileName(topology);
         topologyReader.Read();
 
         // Create error model to add packet loss
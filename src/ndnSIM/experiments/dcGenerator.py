@@ -1,6 +1,7 @@
 import os
 import sys
 import re
+import argparse
 import configparser
 
 num_core_forwarders = 3
@@ -29,20 +30,22 @@ def is_valid_bitrate(bitrate):
     return pattern.match(bitrate) is not None
 
 
-def generate_topology(num_producers, num_aggregators, num_producers_per_edge, bit_rate):
+def generate_topology(num_producers, num_aggregators, num_producers_per_edge, bit_rate,
+                      output_path="../examples/topologies/DataCenterTopology.txt"):
     """
     Generate DC topology file in .txt format
     :param num_producers:
     :param num_aggregators:
     :param num_producers_per_edge:
     :param bit_rate:
+    :param output_path: Topology file to write
     :return:
     """
     num_edge_forwarders = (num_producers // num_producers_per_edge) + 1
 
     # open the topology txt file
     # with open("/home/dd/agg-ndnSIM/ns-3/src/ndnSIM/examples/topologies/DataCenterTopology.txt", "w") as output_file:
-    with open("../examples/topologies/DataCenterTopology.txt", "w") as output_file:
+    with open(output_path, "w") as output_file:
         # write "router" section
         output_file.write("router\n\n")
         output_file.write("con0\n")
@@ -76,10 +79,22 @@ def generate_topology(num_producers, num_aggregators, num_producers_per_edge, bi
 
 
 def main():
-    # Read information from config.ini
+    # Read information from config.ini, command line arguments override it
     config = configparser.ConfigParser()
     config.read('config.ini')
 
+    parser = argparse.ArgumentParser(description="Generate DC topology")
+    parser.add_argument("--producers", help="Number of producers")
+    parser.add_argument("--aggregators", help="Number of aggregators")
+    parser.add_argument("--perEdge", help="Number of producers per edge forwarder")
+    parser.add_argument("--bitrate", help="Bitrate of all links, e.g. 100Mbps")
+    parser.add_argument("--output", default="../examples/topologies/DataCenterTopology.txt", help="Topology file to write")
+    args = parser.parse_args()
+    for key, value in (("numProducer", args.producers), ("numAggregator", args.aggregators),
+                       ("numEdgeForwarder", args.perEdge), ("Bitrate", args.bitrate)):
+        if value is not None:
+            config['DCNTopology'][key] = value
+
     if not is_valid_parameter(config['DCNTopology']['numProducer']):
         print(f"Error! Num_producers '{config['DCNTopology']['numProducer']}' is not integer, please check.")
         sys.exit(1)
@@ -107,7 +122,7 @@ def main():
 
 
 
-    generate_topology(num_producers, num_aggregators, number_producer_per_edge, bit_rate)
+    generate_topology(num_producers, num_aggregators, number_producer_per_edge, bit_rate, args.output)
 
     print("Topology generated successfully!")
 
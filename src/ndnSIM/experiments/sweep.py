@@ -0,0 +1,263 @@
+import os
+import sys
+import glob
+import time
+import argparse
+import itertools
+import subprocess
+import configparser
+from concurrent.futures import ThreadPoolExecutor, as_completed
+
+from dcGenerator import generate_topology
+
+# Parameter sweep of CFNAgg scenarios: every combination of the given values runs as its own simulation,
+# with its own config.ini, topology and log directory, several of them in parallel. Results of all runs
+# are merged into one summary table.
+#
+# Run from src/ndnSIM/experiments, e.g.
+#   python3 sweep.py --constraint 10,20 --alpha 0.3,0.5 --producers 50,200 --jobs 8
+# Parameters not swept are taken from config.ini.
+
+EXPERIMENTS_DIR = os.path.dirname(os.path.abspath(__file__))
+NS3_ROOT = os.path.abspath(os.path.join(EXPERIMENTS_DIR, "../../.."))
+
+# Command line option, config.ini section and key of every sweepable parameter
+SWEEP_PARAMETERS = [
+    ("constraint", "General", "Constraint"),
+    ("alpha", "General", "Alpha"),
+    ("beta", "General", "Beta"),
+    ("gamma", "General", "Gamma"),
+    ("window", "General", "Window"),
+    ("queueSize", "Aggregator", "QueueSize"),
+    ("producers", "DCNTopology", "numProducer"),
+]
+
+SUMMARY_COLUMNS = ["iterations", "aggTimeMean", "aggTimeP50", "aggTimeP95", "rttMean", "throughput", "wallTime", "status"]
+
+
+def read_config(path):
+    """
+    Read config.ini, keys keep their case since the simulation reads them case-sensitively
+    :param path:
+    :return: ConfigParser
+    """
+    config = configparser.ConfigParser()
+    config.optionxform = str
+    config.read(path)
+    return config
+
+
+def build_grid(args, config):
+    """
+    All combinations of the swept values, parameters without values keep the one from config.ini
+    :param args: Parsed command line arguments
+    :param config: Base config
+    :return: List of dicts, option -> value
+    """
+    values = []
+    for option, section, key in SWEEP_PARAMETERS:
+        given = getattr(args, option)
+        if given:
+            values.append([v.strip() for v in given.split(",") if v.strip()])
+        else:
+            values.append([config[section][key]])
+
+    options = [option for option, _, _ in SWEEP_PARAMETERS]
+    return [dict(zip(options, combination)) for combination in itertools.product(*values)]
+
+
+def run_name(params):
+    """
+    Directory name of a run, e.g. "constraint20_alpha0.5_..._producers50"
+    :param params:
+    :return:
+    """
+    return "_".join(f"{option}{params[option]}" for option, _, _ in SWEEP_PARAMETERS)
+
+
+def prepare_run(params, config, output_dir, topology_dir):
+    """
+    Write config.ini of a run into its directory and generate its topology, topologies are shared by runs of the same size
+    :param params: Parameters of the run
+    :param config: Base config
+    :param output_dir: Sweep output directory
+    :param topology_dir: Directory of generated topologies
+    :return: Run directory, config path, topology path
+    """
+    run_dir = os.path.join(output_dir, run_name(params))
+    os.makedirs(os.path.join(run_dir, "logs"), exist_ok=True)
+
+    run_config = configparser.ConfigParser()
+    run_config.optionxform = str
+    run_config.read_dict(config)
+    for option, section, key in SWEEP_PARAMETERS:
+        run_config[section][key] = params[option]
+    # The summary is computed from text logs
+    run_config["Log"]["Format"] = "text"
+
+    config_path = os.path.join(run_dir, "config.ini")
+    with open(config_path, "w") as config_file:
+        run_config.write(config_file)
+
+    topology = run_config["DCNTopology"]
+    topology_path = os.path.join(topology_dir, f"DataCenterTopology-{params['producers']}.txt")
+    if not os.path.exists(topology_path):
+        generate_topology(int(topology["numProducer"]), int(topology["numAggregator"]),
+                          int(topology["numEdgeForwarder"]), topology["Bitrate"], topology_path)
+
+    return run_dir, config_path, topology_path
+
+
+def run_simulation(program, run_dir, config_path, topology_path):
+    """
+    Run one simulation without rebuilding, its output is written into <run_dir>/output.txt
+    :param program: Simulation program, e.g. agg-aimd-test
+    :param run_dir:
+    :param config_path:
+    :param topology_path:
+    :return: Exit code, wall time in seconds
+    """
+    command = f"{program} --config={config_path} --topology={topology_path} --logDir={os.path.join(run_dir, 'logs')}"
+    start = time.time()
+    with open(os.path.join(run_dir, "output.txt"), "w") as output:
+        result = subprocess.run(["./waf", "--run-no-build", command], cwd=NS3_ROOT, stdout=output, stderr=subprocess.STDOUT)
+    return result.returncode, time.time() - start
+
+
+def read_column(pattern, column):
+    """
+    Values of one column of all whitespace separated log files matching the pattern
+    :param pattern: Glob pattern
+    :param column: Column index
+    :return: List of floats
+    """
+    values = []
+    for path in sorted(glob.glob(pattern)):
+        with open(path, "r") as file:
+            for line in file:
+                columns = line.split()
+                if len(columns) > column:
+                    try:
+                        values.append(float(columns[column]))
+                    except ValueError:
+                        continue
+    return values
+
+
+def percentile(values, fraction):
+    """
+    Nearest-rank percentile
+    :param values:
+    :param fraction: e.g. 0.95
+    :return:
+    """
+    if not values:
+        return float("nan")
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, max(0, int(fraction * len(ordered) + 0.5) - 1))]
+
+
+def summarize_run(log_dir):
+    """
+    Aggregation time, RTT and throughput of a finished run, same computation as throughput_measurement.py
+    :param log_dir:
+    :return: Dict, column -> value
+    """
+    aggregation_times = read_column(os.path.join(log_dir, "consumer*_aggregationTime.txt"), 1)
+    rtts = read_column(os.path.join(log_dir, "consumer*_RTT.txt"), 4)
+
+    throughput = float("nan")
+    throughput_path = os.path.join(log_dir, "throughput.txt")
+    if os.path.exists(throughput_path):
+        interest = sum(read_column(throughput_path, 0)) * 8
+        data = sum(read_column(throughput_path, 1)) * 8
+        duration = sum(read_column(throughput_path, 2))
+        if duration > 0:
+            throughput = (interest + data) / duration
+
+    return {
+        "iterations": len(aggregation_times),
+        "aggTimeMean": sum(aggregation_times) / len(aggregation_times) if aggregation_times else float("nan"),
+        "aggTimeP50": percentile(aggregation_times, 0.5),
+        "aggTimeP95": percentile(aggregation_times, 0.95),
+        "rttMean": sum(rtts) / len(rtts) if rtts else float("nan"),
+        "throughput": throughput,
+    }
+
+
+def write_summary(path, rows):
+    """
+    Write the merged summary table, one line per run
+    :param path:
+    :param rows: List of dicts
+    :return:
+    """
+    columns = [option for option, _, _ in SWEEP_PARAMETERS] + SUMMARY_COLUMNS
+    with open(path, "w") as file:
+        file.write(",".join(columns) + "\n")
+        for row in rows:
+            file.write(",".join(format_value(row[column]) for column in columns) + "\n")
+
+
+def format_value(value):
+    if isinstance(value, float):
+        return f"{value:.3f}"
+    return str(value)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run a parameter sweep of CFNAgg simulations in parallel")
+    parser.add_argument("--config", default=os.path.join(EXPERIMENTS_DIR, "config.ini"), help="Base config file")
+    for option, section, key in SWEEP_PARAMETERS:
+        parser.add_argument(f"--{option}", help=f"Comma separated values of {section}.{key}")
+    parser.add_argument("--program", default="agg-aimd-test", help="Simulation program")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count(), help="Number of simulations running in parallel")
+    parser.add_argument("--output", default=os.path.join(EXPERIMENTS_DIR, "../results/sweeps", time.strftime("%Y%m%d-%H%M%S")),
+                        help="Output directory, every run writes into its own sub-directory")
+    parser.add_argument("--no-build", action="store_true", help="Don't build before running")
+    args = parser.parse_args()
+
+    config = read_config(args.config)
+    if not config.sections():
+        print(f"Error! Config file {args.config} doesn't exist or is empty.")
+        sys.exit(1)
+
+    output_dir = os.path.abspath(args.output)
+    topology_dir = os.path.join(output_dir, "topologies")
+    os.makedirs(topology_dir, exist_ok=True)
+
+    # Build once, all runs share the binary
+    if not args.no_build:
+        if subprocess.run(["./waf", "build"], cwd=NS3_ROOT, stdout=subprocess.DEVNULL).returncode != 0:
+            print("Error! Build failed.")
+            sys.exit(1)
+
+    grid = build_grid(args, config)
+    runs = [(params, *prepare_run(params, config, output_dir, topology_dir)) for params in grid]
+    print(f"Running {len(runs)} simulations, {args.jobs} in parallel, output in {output_dir}")
+
+    rows = []
+    with ThreadPoolExecutor(max_workers=max(1, args.jobs)) as executor:
+        futures = {executor.submit(run_simulation, args.program, run_dir, config_path, topology_path): (params, run_dir)
+                   for params, run_dir, config_path, topology_path in runs}
+        for future in as_completed(futures):
+            params, run_dir = futures[future]
+            returncode, wall_time = future.result()
+            row = dict(params)
+            row.update(summarize_run(os.path.join(run_dir, "logs")))
+            row["wallTime"] = wall_time
+            row["status"] = "ok" if returncode == 0 else f"failed({returncode})"
+            rows.append(row)
+            print(f"[{len(rows)}/{len(runs)}] {run_name(params)}: {row['status']}, {wall_time:.1f}s")
+
+    # Same order as the grid, independent of which run finished first
+    order = {run_name(params): i for i, params in enumerate(grid)}
+    rows.sort(key=lambda row: order[run_name(row)])
+
+    summary_path = os.path.join(output_dir, "summary.csv")
+    write_summary(summary_path, rows)
+    print(f"Summary written to {summary_path}")
+
+
+if __name__ == "__main__":
+    main()
@@ -116,6 +116,12 @@ StackHelper::setCsSize(size_t maxSize)
   m_maxCsSize = maxSize;
 }
 
+void
+StackHelper::setMaxFragments(size_t maxFragments)
+{
+  m_maxFragments = maxFragments;
+}
+
 void
 StackHelper::setPolicy(const std::string& policy)
 {
@@ -172,6 +178,14 @@ StackHelper::doInstall(Ptr<Node> node) const
     ndn->getConfig().put("ndnSIM.disable_strategy_choice_manager", true);
   }
 
+  if (m_isNameTreeOpenAddressing) {
+    ndn->getConfig().put("ndnSIM.name_tree_open_addressing", true);
+  }
+
+  if (m_deadNonceListFalsePositiveRate > 0.0) {
+    ndn->getConfig().put("ndnSIM.dead_nonce_list_false_positive_rate", m_deadNonceListFalsePositiveRate);
+  }
+
   ndn->getConfig().put("tables.cs_max_packets", m_maxCsSize);
 
   ndn->setCsReplacementPolicy(m_csPolicyCreationFunc);
@@ -242,6 +256,10 @@ StackHelper::DefaultNetDeviceCallback(Ptr<Node> node, Ptr<L3Protocol> ndn,
   opts.allowFragmentation = true;
   opts.allowReassembly = true;
   opts.allowCongestionMarking = true;
+  if (m_maxFragments > 0) {
+    opts.fragmenterOptions.nMaxFragments = m_maxFragments;
+    opts.reassemblerOptions.nMaxFragments = m_maxFragments;
+  }
 
   auto linkService = make_unique<::nfd::face::GenericLinkService>(opts);
 
@@ -281,6 +299,10 @@ StackHelper::PointToPointNetDeviceCallback(Ptr<Node> node, Ptr<L3Protocol> ndn,
   opts.allowFragmentation = true;
   opts.allowReassembly = true;
   opts.allowCongestionMarking = true;
+  if (m_maxFragments > 0) {
+    opts.fragmenterOptions.nMaxFragments = m_maxFragments;
+    opts.reassemblerOptions.nMaxFragments = m_maxFragments;
+  }
 
   auto linkService = make_unique<::nfd::face::GenericLinkService>(opts);
 
@@ -377,6 +399,18 @@ StackHelper::disableStrategyChoiceManager()
   m_isStrategyChoiceManagerDisabled = true;
 }
 
+void
+StackHelper::useOpenAddressingNameTree(bool enabled)
+{
+  m_isNameTreeOpenAddressing = enabled;
+}
+
+void
+StackHelper::useCompactDeadNonceList(double falsePositiveRate)
+{
+  m_deadNonceListFalsePositiveRate = falsePositiveRate;
+}
+
 void
 StackHelper::disableForwarderStatusManager()
 {
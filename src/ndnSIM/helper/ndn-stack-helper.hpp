@@ -79,6 +79,15 @@ public:
   void
   setCsSize(size_t maxSize);
 
+  /**
+   * @brief Set maximum number of fragments per network-layer packet on NetDevice faces
+   *
+   * Applies to both fragmentation and reassembly. 0 (default) keeps the NDNLP default of 400
+   * fragments, larger values allow Data such as big CFNAgg models to cross 1500-byte MTU links.
+   */
+  void
+  setMaxFragments(size_t maxFragments);
+
   /**
    * @brief Set the cache replacement policy for NFD's Content Store
    */
@@ -221,6 +230,26 @@ public:
   void
   disableForwarderStatusManager();
 
+  /**
+   * \brief Use the open-addressing layout for the NameTree hashtable of installed forwarders
+   *
+   * The default is the chained layout; open addressing keeps hashes and node pointers in flat
+   * arrays and resizes incrementally, which is preferable for large FIB/PIT populations.
+   */
+  void
+  useOpenAddressingNameTree(bool enabled = true);
+
+  /**
+   * \brief Use the compact, probabilistic Dead Nonce List of installed forwarders
+   * \param falsePositiveRate probability that a looping Interest is wrongly detected,
+   *        0 keeps the exact Dead Nonce List
+   *
+   * The compact Dead Nonce List stores fingerprints in time-bucketed cuckoo filters, which takes
+   * much less memory per node when many Interests are retransmitted.
+   */
+  void
+  useCompactDeadNonceList(double falsePositiveRate = 1e-4);
+
   /**
    * @brief Set face metric of all faces connected through PointToPoint channel to channel latency
    */
@@ -246,6 +275,9 @@ private:
 
   bool m_isForwarderStatusManagerDisabled;
   bool m_isStrategyChoiceManagerDisabled;
+  size_t m_maxFragments = 0;
+  bool m_isNameTreeOpenAddressing = false;
+  double m_deadNonceListFalsePositiveRate = 0.0;
 
 public:
   void
@@ -211,7 +211,16 @@ void
 L3Protocol::initialize()
 {
   m_impl->m_faceTable = make_unique<::nfd::FaceTable>();
-  m_impl->m_forwarder = make_shared<::nfd::Forwarder>(*m_impl->m_faceTable);
+  ::nfd::name_tree::HashtableOptions nameTreeOptions(1024);
+  if (this->getConfig().get<bool>("ndnSIM.name_tree_open_addressing", false)) {
+    nameTreeOptions.layout = ::nfd::name_tree::HashtableOptions::Layout::OPEN_ADDRESSING;
+  }
+  m_impl->m_forwarder = make_shared<::nfd::Forwarder>(*m_impl->m_faceTable, nameTreeOptions);
+  double deadNonceListFalsePositiveRate =
+    this->getConfig().get<double>("ndnSIM.dead_nonce_list_false_positive_rate", 0.0);
+  if (deadNonceListFalsePositiveRate > 0.0) {
+    m_impl->m_forwarder->getDeadNonceList().useCompactBackend(deadNonceListFalsePositiveRate);
+  }
   m_impl->m_faceSystem = make_unique<::nfd::face::FaceSystem>(*m_impl->m_faceTable, nullptr);
 
   initializeManagement();
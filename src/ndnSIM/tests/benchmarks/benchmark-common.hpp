@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDNSIM_TESTS_BENCHMARKS_BENCHMARK_COMMON_HPP
+#define NDNSIM_TESTS_BENCHMARKS_BENCHMARK_COMMON_HPP
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace benchmark {
+
+const int NUM_CORE_FORWARDERS = 3;
+
+/**
+ * Generate DCN topology file, same layout as experiments/dcGenerator.py
+ * @param path Output file
+ * @param numProducers
+ * @param numAggregators
+ * @param numProducersPerEdge
+ */
+inline void
+GenerateTopology(const std::string& path, int numProducers, int numAggregators, int numProducersPerEdge)
+{
+  int numEdgeForwarders = numProducers / numProducersPerEdge + 1;
+  std::ofstream file(path);
+
+  file << "router\n\ncon0\n";
+  for (int i = 0; i < numProducers; ++i) {
+    file << "pro" << i << "\n";
+  }
+  for (int i = 0; i < numEdgeForwarders; ++i) {
+    file << "forwarder" << i << "\n";
+  }
+  for (int i = 0; i < numAggregators; ++i) {
+    file << "agg" << i << "\n";
+  }
+  for (int i = 0; i < NUM_CORE_FORWARDERS; ++i) {
+    file << "forwarder" << numEdgeForwarders + i << "\n";
+  }
+
+  file << "\nlink\n\n";
+  for (int i = 0; i < numProducers; ++i) {
+    file << "pro" << i << "       forwarder" << i / numProducersPerEdge << "       100Mbps       1       2ms       50\n";
+  }
+  file << "con0       forwarder0       100Mbps       1       2ms       50\n";
+  for (int i = 0; i < numEdgeForwarders + NUM_CORE_FORWARDERS; ++i) {
+    for (int j = 0; j < numAggregators; ++j) {
+      file << "forwarder" << i << "       agg" << j << "       100Mbps       1       2ms       50\n";
+    }
+  }
+}
+
+/**
+ * Parse a comma separated list of integers, e.g. "50,1000,10000"
+ */
+inline std::vector<int>
+ParseList(const std::string& list)
+{
+  std::vector<int> values;
+  std::istringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      values.push_back(std::stoi(item));
+    }
+  }
+  return values;
+}
+
+inline double
+SecondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Peak resident set size of this process in KB
+ */
+inline long
+PeakRssKb()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+} // namespace benchmark
+} // namespace ns3
+
+#endif // NDNSIM_TESTS_BENCHMARKS_BENCHMARK_COMMON_HPP
@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# Macro-benchmark of CFNAgg: run agg-aimd-test on generated DCN topologies of increasing size and
+# report simulator events/sec, wall time per simulated second and peak RSS of each run.
+# Run from the ns-3 root directory, e.g.
+#   ./src/ndnSIM/tests/benchmarks/cfnagg-macro-bench.sh 50,200,1000
+# Other settings (iterations, window, ...) are taken from src/ndnSIM/experiments/config.ini.
+
+PRODUCERS=${1:-"50,200"}
+AGGREGATORS=${AGGREGATORS:-20}
+PER_EDGE=${PER_EDGE:-10}
+TOPOLOGY_DIR=${TOPOLOGY_DIR:-/tmp}
+EXPERIMENTS_DIR="./src/ndnSIM/experiments"
+
+if [ ! -x ./waf ]; then
+    echo "Please run this script from the ns-3 root directory."
+    exit 1
+fi
+
+# Build once, so compilation isn't measured
+./waf build > /dev/null || exit 1
+
+printf "%10s %14s %12s %12s %14s %16s %14s\n" "producers" "events" "wall(s)" "simulated(s)" "events/s" "wall/simulated" "peakRSS(KB)"
+
+for NUM_PRODUCERS in ${PRODUCERS//,/ }; do
+    TOPOLOGY="$TOPOLOGY_DIR/cfnagg-macro-$NUM_PRODUCERS.txt"
+    (cd $EXPERIMENTS_DIR && python3 dcGenerator.py --producers "$NUM_PRODUCERS" --aggregators "$AGGREGATORS" \
+        --perEdge "$PER_EDGE" --output "$TOPOLOGY" > /dev/null) || exit 1
+
+    RESULT=$(./waf --run "agg-aimd-test --topology=$TOPOLOGY --benchmark=1" 2> /dev/null | grep "^benchmark:")
+    if [ -z "$RESULT" ]; then
+        echo "Run with $NUM_PRODUCERS producers failed."
+        continue
+    fi
+
+    # benchmark: events=N wall=Xs simulated=Ys events/s=E wall/simulated=R peakRSS=MKB
+    read -r EVENTS WALL SIMULATED RATE RATIO RSS <<< $(echo "$RESULT" | \
+        sed -E 's/.*events=([0-9]+) wall=([0-9.e+-]+)s simulated=([0-9.e+-]+)s events\/s=([0-9.e+-]+) wall\/simulated=([0-9.e+-]+) peakRSS=([0-9]+)KB.*/\1 \2 \3 \4 \5 \6/')
+    printf "%10s %14s %12s %12s %14s %16s %14s\n" "$NUM_PRODUCERS" "$EVENTS" "$WALL" "$SIMULATED" "$RATE" "$RATIO" "$RSS"
+done
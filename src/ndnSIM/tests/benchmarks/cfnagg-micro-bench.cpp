@@ -0,0 +1,303 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// Micro-benchmarks of the CFNAgg hot paths, for topologies of increasing size
+// e.g. ./waf --run "cfnagg-micro-bench --producers=50,1000,10000"
+
+#include "benchmark-common.hpp"
+
+#include "ns3/core-module.h"
+#include "ns3/ndnSIM/apps/AggregationKernel.hpp"
+#include "ns3/ndnSIM/apps/ModelData.hpp"
+#include "ns3/ndnSIM/apps/RetxFilter.hpp"
+#include "ns3/ndnSIM/apps/TreeDescriptor.hpp"
+#include "ns3/ndnSIM/apps/algorithm/include/AggregationTree.hpp"
+#include "ns3/ndnSIM/apps/algorithm/utility/utility.hpp"
+
+#include <ndn-cxx/data.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace benchmark {
+
+// Keep results alive, so the compiler doesn't drop the measured work
+static volatile size_t g_sink = 0;
+
+void
+Report(const std::string& name, int producers, size_t ops, double elapsed)
+{
+  std::cout << std::left << std::setw(28) << name << std::right << std::setw(10) << producers
+            << std::setw(12) << ops << std::setw(18) << std::fixed << std::setprecision(1) << elapsed / ops * 1e9
+            << std::setw(12) << std::setprecision(3) << elapsed << std::endl;
+}
+
+/**
+ * Run f() until at least minTime has passed, print the time per call
+ */
+template<typename F>
+void
+Measure(const std::string& name, int producers, double minTime, F&& f)
+{
+  size_t ops = 0;
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0;
+  do {
+    f();
+    ++ops;
+    elapsed = SecondsSince(start);
+  } while (elapsed < minTime);
+
+  Report(name, producers, ops, elapsed);
+}
+
+// Silence the verbose tree construction while it is measured
+class QuietScope {
+public:
+  QuietScope()
+    : m_devNull("/dev/null")
+    , m_cout(std::cout.rdbuf(m_devNull.rdbuf()))
+    , m_cerr(std::cerr.rdbuf(m_devNull.rdbuf()))
+  {
+  }
+
+  ~QuietScope()
+  {
+    std::cout.rdbuf(m_cout);
+    std::cerr.rdbuf(m_cerr);
+  }
+
+private:
+  std::ofstream m_devNull;
+  std::streambuf* m_cout;
+  std::streambuf* m_cerr;
+};
+
+/**
+ * serializeModelData()/deserializeModelData() and the in-place ModelDataView of one payload
+ */
+void
+BenchModelData(int modelSize, double minTime)
+{
+  ModelData modelData(modelSize);
+  for (int i = 0; i < modelSize; ++i) {
+    modelData.parameters[i] = 0.001f * i;
+  }
+  std::vector<uint8_t> buffer;
+
+  Measure("serializeModelData", 0, minTime, [&] {
+    serializeModelData(modelData, buffer);
+    g_sink = g_sink + buffer.size();
+  });
+
+  ModelData decoded;
+  Measure("deserializeModelData", 0, minTime, [&] {
+    deserializeModelData(buffer, decoded);
+    g_sink = g_sink + decoded.parameters.size();
+  });
+
+  // fp32 parameters are read in place only if they are 4-byte aligned in memory, otherwise they are copied
+  ModelDataView view;
+  Measure("ModelDataView::parse", 0, minTime, [&] {
+    view.parse(buffer);
+    g_sink = g_sink + view.parameters().size();
+  });
+
+  std::vector<uint8_t> shifted(buffer.size() + 1);
+  std::copy(buffer.begin(), buffer.end(), shifted.begin() + 1);
+  ::ndn::span<const uint8_t> unaligned(shifted.data() + 1, buffer.size());
+  Measure("ModelDataView::parse copy", 0, minTime, [&] {
+    view.parse(unaligned);
+    g_sink = g_sink + view.parameters().size();
+  });
+
+  // Where the Content value lands depends on the rest of the Data packet, e.g. the length of its name
+  ::ndn::Data data(::ndn::Name("/agg0/job0/data").appendSequenceNumber(12345));
+  data.setContent(std::make_shared<::ndn::Buffer>(buffer.begin(), buffer.end()));
+  data.setSignatureInfo(::ndn::SignatureInfo(::ndn::tlv::NullSignature));
+  data.setSignatureValue(std::make_shared<::ndn::Buffer>());
+  ::ndn::Data received(::ndn::Block(::ndn::make_span(data.wireEncode().wire(), data.wireEncode().size())));
+  view.parse(received.getContent());
+  const uint8_t* parameters = received.getContent().value() + ModelDataFormat::HEADER_SIZE;
+  bool isInPlace = view.parameters().data() == reinterpret_cast<const float*>(parameters);
+  Measure(isInPlace ? "ModelDataView Data in place" : "ModelDataView Data copy", 0, minTime, [&] {
+    view.parse(received.getContent());
+    g_sink = g_sink + view.parameters().size();
+  });
+}
+
+/**
+ * Aggregation of one iteration at the root, i.e. Aggregator::aggregate() for every producer's payload
+ */
+void
+BenchAggregate(int producers, int modelSize, double minTime)
+{
+  std::vector<std::vector<uint8_t>> payloads(producers);
+  ModelData modelData(modelSize);
+  for (int p = 0; p < producers; ++p) {
+    for (int i = 0; i < modelSize; ++i) {
+      modelData.parameters[i] = 0.001f * (i + p);
+    }
+    serializeModelData(modelData, payloads[p]);
+  }
+
+  std::vector<float> sum(modelSize);
+  ModelDataView view;
+  Measure("aggregate", producers, minTime, [&] {
+    std::fill(sum.begin(), sum.end(), 0.0f);
+    for (const auto& payload : payloads) {
+      view.parse(payload);
+      AggregationKernel::Sum(sum, view.parameters());
+    }
+    g_sink = g_sink + static_cast<size_t>(sum[0]);
+  });
+}
+
+/**
+ * Interest splitting of Aggregator::OnInterest(): intersect the requested producers with the leaves of each child,
+ * check the duplicate filter and build the child's interest name
+ */
+void
+BenchSplitInterest(int producers, int children, double minTime)
+{
+  LeafBitmap requested(producers);
+  requested.set();
+  std::vector<std::pair<std::string, LeafBitmap>> leaves;
+  for (int c = 0; c < children; ++c) {
+    leaves.emplace_back("agg" + std::to_string(c), LeafBitmap(producers));
+  }
+  for (int p = 0; p < producers; ++p) {
+    leaves[p % children].second.set(p);
+  }
+
+  RetxFilter filter;
+  LeafBitmap childLeaves;
+  ndn::name::Component job("job0");
+  uint64_t seq = 0;
+  Measure("splitInterest", producers, minTime, [&] {
+    ++seq;
+    for (const auto& [child, bitmap] : leaves) {
+      childLeaves = requested;
+      childLeaves &= bitmap;
+      if (childLeaves.none()) {
+        continue;
+      }
+      ndn::Name name;
+      name.append(child).append(job).append(makeLeafComponent(childLeaves)).append("data");
+      name.appendSequenceNumber(seq);
+      g_sink = g_sink + filter.contains(name, Seconds(0)) + name.size();
+    }
+  });
+}
+
+/**
+ * Link cost computation and aggregation tree construction, see AggregationTree
+ */
+void
+BenchTree(int producers, const std::string& topology, int constraint, int mapLimit, double minTime)
+{
+  Measure("GetLinkCostMatrix", producers, minTime, [&] {
+    QuietScope quiet;
+    Utility::CostMatrix matrix = Utility::GetLinkCostMatrix(topology);
+    g_sink = g_sink + matrix.size();
+  });
+
+  // The string map holds one entry per node pair, skip it when that doesn't fit into memory
+  if (producers <= mapLimit) {
+    Measure("GetAllLinkCost", producers, minTime, [&] {
+      QuietScope quiet;
+      auto costs = Utility::GetAllLinkCost(topology);
+      g_sink = g_sink + costs.size();
+    });
+  } else {
+    std::cout << std::left << std::setw(28) << "GetAllLinkCost" << std::right << std::setw(10) << producers
+              << "    skipped, more than --mapLimit producers" << std::endl;
+  }
+
+  // Construction changes the state of the tree, every run starts from a new one and only the construction is timed
+  std::vector<std::string> producerNames = Utility::getProducers(topology);
+  size_t ops = 0;
+  double elapsed = 0;
+  do {
+    QuietScope quiet;
+    AggregationTree tree(topology);
+    auto start = std::chrono::steady_clock::now();
+    g_sink = g_sink + tree.aggregationTreeConstruction(producerNames, constraint);
+    elapsed += SecondsSince(start);
+    ++ops;
+  } while (elapsed < minTime);
+  Report("aggregationTreeConstruction", producers, ops, elapsed);
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::string producers = "50,200,1000";
+  int aggregators = 20;
+  int producersPerEdge = 10;
+  int constraint = 20;
+  int modelSize = 300;
+  int mapLimit = 1000;
+  double minTime = 0.5;
+  std::string topologyDir = "/tmp";
+
+  CommandLine cmd;
+  cmd.AddValue("producers", "Comma separated numbers of producers, e.g. 50,1000,10000", producers);
+  cmd.AddValue("aggregators", "Number of aggregators", aggregators);
+  cmd.AddValue("perEdge", "Number of producers per edge forwarder", producersPerEdge);
+  cmd.AddValue("constraint", "Maximum number of children per aggregator", constraint);
+  cmd.AddValue("modelSize", "Number of model parameters in each payload", modelSize);
+  cmd.AddValue("mapLimit", "Largest number of producers GetAllLinkCost is measured for", mapLimit);
+  cmd.AddValue("minTime", "Minimum time in seconds each benchmark runs", minTime);
+  cmd.AddValue("topologyDir", "Directory for generated topology files", topologyDir);
+  cmd.Parse(argc, argv);
+
+  // Link costs are computed every time, not read from the cache
+  Utility::SetCostMatrixCacheDir("");
+
+  std::cout << "Aggregation kernel: " << AggregationKernel::GetIsaName(AggregationKernel::GetIsa()) << std::endl;
+  std::cout << std::left << std::setw(28) << "benchmark" << std::right << std::setw(10) << "producers"
+            << std::setw(12) << "ops" << std::setw(18) << "ns/op" << std::setw(12) << "total(s)" << std::endl;
+
+  BenchModelData(modelSize, minTime);
+  for (int numProducers : ParseList(producers)) {
+    std::string topology = topologyDir + "/cfnagg-bench-" + std::to_string(numProducers) + ".txt";
+    GenerateTopology(topology, numProducers, aggregators, producersPerEdge);
+
+    BenchAggregate(numProducers, modelSize, minTime);
+    BenchSplitInterest(numProducers, constraint, minTime);
+    BenchTree(numProducers, topology, constraint, mapLimit, minTime);
+  }
+
+  std::cout << "Peak RSS: " << PeakRssKb() << " KB" << std::endl;
+  return 0;
+}
+
+} // namespace benchmark
+} // namespace ns3
+
+int
+main(int argc, char* argv[])
+{
+  return ns3::benchmark::main(argc, argv);
+}
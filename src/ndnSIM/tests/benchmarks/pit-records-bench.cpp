@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// Allocation of PIT entries shaped like those of a CFNAgg aggregator: one downstream and
+// a few upstreams per pending Interest, e.g. ./waf --run "pit-records-bench --entries=1000000"
+
+#include "benchmark-common.hpp"
+
+#include "ns3/core-module.h"
+#include "ns3/ndnSIM/NFD/daemon/face/null-face.hpp"
+#include "ns3/ndnSIM/NFD/daemon/table/pit.hpp"
+
+#include <iostream>
+#include <vector>
+
+namespace ns3 {
+namespace benchmark {
+
+int
+main(int argc, char* argv[])
+{
+  uint32_t nEntries = 1000000;
+  uint32_t nUpstreams = 2;
+
+  CommandLine cmd;
+  cmd.AddValue("entries", "Number of PIT entries", nEntries);
+  cmd.AddValue("upstreams", "Number of out-records per PIT entry", nUpstreams);
+  cmd.Parse(argc, argv);
+
+  nfd::NameTree nameTree;
+  nfd::Pit pit(nameTree);
+
+  auto downstream = nfd::face::makeNullFace();
+  std::vector<std::shared_ptr<nfd::Face>> upstreams;
+  for (uint32_t i = 0; i < nUpstreams; ++i) {
+    upstreams.push_back(nfd::face::makeNullFace());
+  }
+
+  std::vector<std::shared_ptr<::ndn::Interest>> interests;
+  interests.reserve(nEntries);
+  for (uint32_t i = 0; i < nEntries; ++i) {
+    auto interest = std::make_shared<::ndn::Interest>(::ndn::Name("/agg").appendNumber(i));
+    interest->setCanBePrefix(false);
+    interests.push_back(interest);
+  }
+
+  long rssBefore = PeakRssKb();
+  auto start = std::chrono::steady_clock::now();
+
+  for (const auto& interest : interests) {
+    auto pitEntry = pit.insert(*interest).first;
+    pitEntry->insertOrUpdateInRecord(*downstream, *interest);
+    for (const auto& upstream : upstreams) {
+      pitEntry->insertOrUpdateOutRecord(*upstream, *interest);
+    }
+  }
+  double insertTime = SecondsSince(start);
+  long rssAfter = PeakRssKb();
+
+  start = std::chrono::steady_clock::now();
+  for (const auto& interest : interests) {
+    pit.erase(pit.find(*interest).get());
+  }
+  double eraseTime = SecondsSince(start);
+
+  std::cout << "sizeof(pit::Entry): " << sizeof(nfd::pit::Entry) << " bytes" << std::endl;
+  std::cout << "insert: " << insertTime / nEntries * 1e9 << " ns/entry, "
+            << insertTime << " s total" << std::endl;
+  std::cout << "erase: " << eraseTime / nEntries * 1e9 << " ns/entry, "
+            << eraseTime << " s total" << std::endl;
+  std::cout << "Peak RSS growth: " << rssAfter - rssBefore << " KB" << std::endl;
+  return 0;
+}
+
+} // namespace benchmark
+} // namespace ns3
+
+int
+main(int argc, char* argv[])
+{
+  return ns3::benchmark::main(argc, argv);
+}
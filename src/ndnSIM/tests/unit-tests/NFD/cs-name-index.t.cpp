@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ns3/ndnSIM/NFD/daemon/table/cs.hpp"
+
+#include "../tests-common.hpp"
+
+#include <algorithm>
+
+namespace ns3 {
+namespace ndn {
+
+class CsNameIndexFixture : public CleanupFixture
+{
+protected:
+  // Data of the same name get different full names through their content
+  shared_ptr<Data>
+  makeData(const Name& name, uint32_t id)
+  {
+    auto data = make_shared<Data>(name);
+    std::string content = std::to_string(id);
+    data->setContent(make_shared<::ndn::Buffer>(content.data(), content.size()));
+    data->setSignatureInfo(::ndn::SignatureInfo(::ndn::tlv::NullSignature));
+    data->setSignatureValue(make_shared<::ndn::Buffer>());
+    data->wireEncode();
+    m_ids[data->getFullName()] = id;
+    return data;
+  }
+
+  // Data with the given name, inserted so that each one sorts before those already stored
+  std::vector<shared_ptr<Data>>
+  insertSameName(const Name& name, uint32_t firstId, size_t count)
+  {
+    std::vector<shared_ptr<Data>> all;
+    for (size_t i = 0; i < count; ++i) {
+      all.push_back(makeData(name, firstId + i));
+    }
+    std::sort(all.begin(), all.end(),
+              [] (const auto& a, const auto& b) { return a->getFullName() > b->getFullName(); });
+    for (const auto& data : all) {
+      cs.insert(*data);
+    }
+    std::reverse(all.begin(), all.end());
+    return all;
+  }
+
+  // id of the Data found for an exact-name Interest, 0 on miss
+  uint32_t
+  find(const Name& name)
+  {
+    Interest interest(name);
+    interest.setCanBePrefix(false);
+    uint32_t found = 0;
+    cs.find(interest,
+            [&] (const Interest&, const Data& data) { found = m_ids.at(data.getFullName()); },
+            [] (const Interest&) {});
+    return found;
+  }
+
+  uint32_t
+  find(const Data& data)
+  {
+    return find(data.getFullName());
+  }
+
+  uint32_t
+  idOf(const shared_ptr<Data>& data) const
+  {
+    return m_ids.at(data->getFullName());
+  }
+
+protected:
+  nfd::cs::Cs cs;
+
+private:
+  std::map<Name, uint32_t> m_ids;
+};
+
+BOOST_FIXTURE_TEST_SUITE(NfdCsNameIndex, CsNameIndexFixture)
+
+BOOST_AUTO_TEST_CASE(ExactLookup)
+{
+  cs.insert(*makeData("/A/1", 1));
+  cs.insert(*makeData("/A/2", 2));
+  cs.insert(*makeData("/A", 3));
+  cs.insert(*makeData("/A/2/x", 4));
+  BOOST_CHECK_EQUAL(cs.size(), 4);
+
+  BOOST_CHECK_EQUAL(find("/A/1"), 1);
+  BOOST_CHECK_EQUAL(find("/A/2"), 2);
+  BOOST_CHECK_EQUAL(find("/A"), 3);
+  BOOST_CHECK_EQUAL(find("/A/2/x"), 4);
+  BOOST_CHECK_EQUAL(find("/A/3"), 0);
+  BOOST_CHECK_EQUAL(find("/B"), 0);
+
+  // full names with the implicit digest
+  auto data = makeData("/A/2", 5);
+  BOOST_CHECK_EQUAL(find(*data), 0);
+  cs.insert(*data);
+  BOOST_CHECK_EQUAL(find(*data), 5);
+  BOOST_CHECK_EQUAL(cs.size(), 5);
+
+  // stored Data is refreshed, not added again
+  cs.insert(*data);
+  BOOST_CHECK_EQUAL(cs.size(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(ReplaceAndErase)
+{
+  // each insert becomes the first entry of "/A", the index is re-pointed to it
+  auto all = insertSameName("/A", 1, 4);
+  BOOST_CHECK_EQUAL(cs.size(), 4);
+  BOOST_CHECK_EQUAL(find("/A"), idOf(all.front()));
+  for (const auto& data : all) {
+    BOOST_CHECK_NE(find(*data), 0);
+  }
+
+  // erase removes the first "/A" of the Table, the index is re-pointed to the next one
+  for (size_t i = 0; i < all.size(); ++i) {
+    size_t nErased = 0;
+    cs.erase("/A", 1, [&] (size_t n) { nErased = n; });
+    BOOST_CHECK_EQUAL(nErased, 1);
+    BOOST_CHECK_EQUAL(find(*all[i]), 0);
+    if (i + 1 < all.size()) {
+      BOOST_CHECK_EQUAL(find("/A"), idOf(all[i + 1]));
+    }
+  }
+  BOOST_CHECK_EQUAL(cs.size(), 0);
+  BOOST_CHECK_EQUAL(find("/A"), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Eviction)
+{
+  // the default LRU policy evicts the least recently used entry, every hit refreshes an entry
+  cs.setLimit(3);
+  std::vector<shared_ptr<Data>> all;
+  for (uint32_t id = 1; id <= 3; ++id) {
+    all.push_back(makeData("/A", id));
+  }
+  std::sort(all.begin(), all.end(),
+            [] (const auto& a, const auto& b) { return a->getFullName() < b->getFullName(); });
+  for (const auto& data : all) {
+    cs.insert(*data);
+  }
+
+  // evicting the first entry of "/A" re-points the index to the next one
+  cs.insert(*makeData("/B", 4));
+  BOOST_CHECK_EQUAL(cs.size(), 3);
+  BOOST_CHECK_EQUAL(find(*all[0]), 0);
+  BOOST_CHECK_EQUAL(find("/A"), idOf(all[1]));
+
+  // evicting another entry of "/A" leaves the index as it is
+  cs.insert(*makeData("/C", 5));
+  BOOST_CHECK_EQUAL(find(*all[2]), 0);
+  BOOST_CHECK_EQUAL(find("/A"), idOf(all[1]));
+
+  // the last entry of "/A" leaves the index
+  cs.insert(*makeData("/D", 6));
+  cs.insert(*makeData("/E", 7));
+  cs.insert(*makeData("/F", 8));
+  BOOST_CHECK_EQUAL(cs.size(), 3);
+  BOOST_CHECK_EQUAL(find("/A"), 0);
+  BOOST_CHECK_EQUAL(find("/B"), 0);
+  BOOST_CHECK_EQUAL(find("/C"), 0);
+  BOOST_CHECK_EQUAL(find("/D"), 6);
+  BOOST_CHECK_EQUAL(find("/E"), 7);
+  BOOST_CHECK_EQUAL(find("/F"), 8);
+
+  // shrinking evicts several entries at once
+  cs.setLimit(1);
+  BOOST_CHECK_EQUAL(cs.size(), 1);
+  BOOST_CHECK_EQUAL(find("/D"), 0);
+  BOOST_CHECK_EQUAL(find("/E"), 0);
+  BOOST_CHECK_EQUAL(find("/F"), 8);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ns3/ndnSIM/NFD/daemon/table/dead-nonce-list.hpp"
+#include "ns3/ndnSIM/utils/ndn-time.hpp"
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+using nfd::DeadNonceList;
+
+class DeadNonceListFixture : public CleanupFixture
+{
+public:
+  DeadNonceListFixture()
+  {
+    // the NFD scheduler runs on simulated time
+    ::ndn::time::setCustomClocks(make_shared<ns3::ndn::time::CustomSteadyClock>(),
+                                 make_shared<ns3::ndn::time::CustomSystemClock>());
+  }
+
+  void
+  advanceClocks(time::nanoseconds duration)
+  {
+    Simulator::Stop(NanoSeconds(duration.count()));
+    Simulator::Run();
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE(NfdDeadNonceList, DeadNonceListFixture)
+
+BOOST_AUTO_TEST_CASE(CompactBackend)
+{
+  Name nameA("/A");
+  Name nameB("/B");
+  const Interest::Nonce nonce1(0x53b4eaa8);
+  const Interest::Nonce nonce2(0x1f46372b);
+
+  DeadNonceList dnl;
+  dnl.add(nameA, nonce2);
+  BOOST_CHECK_EQUAL(dnl.has(nameA, nonce2), true);
+
+  BOOST_CHECK_THROW(dnl.useCompactBackend(0.0), std::invalid_argument);
+  BOOST_CHECK_THROW(dnl.useCompactBackend(1.0), std::invalid_argument);
+  BOOST_CHECK_EQUAL(dnl.has(nameA, nonce2), true);
+
+  // entries of the default container are discarded
+  dnl.useCompactBackend(0.0001);
+  BOOST_CHECK_EQUAL(dnl.size(), 0);
+  BOOST_CHECK_EQUAL(dnl.has(nameA, nonce2), false);
+
+  dnl.add(nameA, nonce1);
+  BOOST_CHECK_EQUAL(dnl.size(), 1);
+  BOOST_CHECK_EQUAL(dnl.has(nameA, nonce1), true);
+  BOOST_CHECK_EQUAL(dnl.has(nameA, nonce2), false);
+  BOOST_CHECK_EQUAL(dnl.has(nameB, nonce1), false);
+
+  // a duplicate is not added again
+  dnl.add(nameA, nonce1);
+  BOOST_CHECK_EQUAL(dnl.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Generations)
+{
+  // 6 generations, a new one every lifetime/5
+  DeadNonceList dnl(time::seconds(1));
+  dnl.useCompactBackend(0.0001);
+
+  Name nameA("/A");
+  Name nameB("/B");
+  const Interest::Nonce nonceA(0x53b4eaa8);
+  const Interest::Nonce nonceB(0x1f46372b);
+
+  dnl.add(nameA, nonceA); // generation started at 0ms
+  advanceClocks(time::milliseconds(210));
+  dnl.add(nameB, nonceB); // generation started at 200ms
+  BOOST_CHECK_EQUAL(dnl.size(), 2);
+
+  advanceClocks(time::milliseconds(780)); // 990ms, 4 rotations
+  BOOST_CHECK_EQUAL(dnl.has(nameA, nonceA), true);
+  BOOST_CHECK_EQUAL(dnl.has(nameB, nonceB), true);
+
+  advanceClocks(time::milliseconds(200)); // 1190ms, the generation of A is the oldest one
+  BOOST_CHECK_EQUAL(dnl.has(nameA, nonceA), true);
+  BOOST_CHECK_EQUAL(dnl.has(nameB, nonceB), true);
+  BOOST_CHECK_EQUAL(dnl.size(), 2);
+
+  advanceClocks(time::milliseconds(20)); // 1210ms, the generation of A is dropped
+  BOOST_CHECK_EQUAL(dnl.has(nameA, nonceA), false);
+  BOOST_CHECK_EQUAL(dnl.has(nameB, nonceB), true);
+  BOOST_CHECK_EQUAL(dnl.size(), 1);
+
+  advanceClocks(time::milliseconds(200)); // 1410ms, the generation of B is dropped
+  BOOST_CHECK_EQUAL(dnl.has(nameB, nonceB), false);
+  BOOST_CHECK_EQUAL(dnl.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(NoFalseNegatives)
+{
+  const double FALSE_POSITIVE_RATE = 0.001;
+  DeadNonceList dnl(time::seconds(1));
+  dnl.useCompactBackend(FALSE_POSITIVE_RATE);
+
+  // a batch every 50ms, enough entries per generation for the filters to grow
+  const int N_BATCHES = 80;
+  const uint32_t BATCH_SIZE = 1000;
+  auto makeName = [] (int batch) { return Name("/N").appendNumber(batch); };
+
+  advanceClocks(time::milliseconds(10));
+  size_t nExpired = 0;
+  size_t nFalsePositives = 0;
+  for (int batch = 0; batch < N_BATCHES; ++batch) {
+    Name name = makeName(batch);
+    for (uint32_t nonce = 0; nonce < BATCH_SIZE; ++nonce) {
+      dnl.add(name, Interest::Nonce(nonce));
+    }
+
+    // every entry younger than the lifetime is found, those older than 1.2 lifetimes are dropped
+    for (int older = batch; older >= 0; --older) {
+      int age = (batch - older) * 50;
+      if (age < 1000) {
+        Name olderName = makeName(older);
+        size_t nFound = 0;
+        for (uint32_t nonce = 0; nonce < BATCH_SIZE; ++nonce) {
+          nFound += dnl.has(olderName, Interest::Nonce(nonce));
+        }
+        BOOST_CHECK_EQUAL(nFound, BATCH_SIZE);
+      }
+      else if (age > 1200 && batch == N_BATCHES - 1) {
+        Name olderName = makeName(older);
+        for (uint32_t nonce = 0; nonce < BATCH_SIZE; ++nonce) {
+          nFalsePositives += dnl.has(olderName, Interest::Nonce(nonce));
+        }
+        nExpired += BATCH_SIZE;
+      }
+    }
+
+    advanceClocks(time::milliseconds(50));
+  }
+
+  BOOST_CHECK_GT(nExpired, 0);
+  BOOST_CHECK_LE(nFalsePositives, nExpired * FALSE_POSITIVE_RATE + 10);
+  BOOST_CHECK_LE(dnl.size(), BATCH_SIZE * 25);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ns3/ndnSIM/NFD/daemon/common/memory-pool.hpp"
+#include "ns3/ndnSIM/NFD/daemon/table/pit.hpp"
+
+#include "../tests-common.hpp"
+
+#include <list>
+
+namespace ns3 {
+namespace ndn {
+
+using nfd::MemoryPool;
+using nfd::PoolAllocator;
+
+BOOST_FIXTURE_TEST_SUITE(NfdMemoryPool, CleanupFixture)
+
+BOOST_AUTO_TEST_CASE(Alignment)
+{
+  MemoryPool pool;
+  std::vector<std::pair<void*, size_t>> blocks;
+  for (size_t size = 1; size <= MemoryPool::MAX_BLOCK_SIZE + 64; size += 7) {
+    void* p = pool.allocate(size);
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(p) % MemoryPool::BLOCK_ALIGNMENT, 0);
+    std::memset(p, 0xA5, size);
+    blocks.emplace_back(p, size);
+  }
+
+  for (const auto& block : blocks) {
+    pool.deallocate(block.first, block.second);
+  }
+  BOOST_CHECK_EQUAL(pool.getNBlocksInUse(), 0);
+  BOOST_CHECK_EQUAL(pool.getBytesInUse(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Reuse)
+{
+  MemoryPool pool;
+  BOOST_CHECK_EQUAL(pool.getBytesInUse(), 0);
+  BOOST_CHECK_EQUAL(pool.getBytesReserved(), 0);
+
+  void* p1 = pool.allocate(40);
+  void* p2 = pool.allocate(40);
+  BOOST_CHECK_NE(p1, p2);
+  BOOST_CHECK_EQUAL(pool.getNBlocksInUse(), 2);
+  BOOST_CHECK_EQUAL(pool.getBytesInUse(), 96); // rounded up to 48
+  BOOST_CHECK_GE(pool.getBytesReserved(), 96);
+
+  pool.deallocate(p1, 40);
+  BOOST_CHECK_EQUAL(pool.getNBlocksInUse(), 1);
+  BOOST_CHECK_EQUAL(pool.getBytesInUse(), 48);
+
+  // a freed block is reused by a size of the same class, without reserving more memory
+  size_t nBytesReserved = pool.getBytesReserved();
+  void* p3 = pool.allocate(33);
+  BOOST_CHECK_EQUAL(p3, p1);
+  BOOST_CHECK_EQUAL(pool.getBytesReserved(), nBytesReserved);
+
+  // a large block goes to the heap and is returned to it on deallocate
+  void* p4 = pool.allocate(MemoryPool::MAX_BLOCK_SIZE + 1);
+  BOOST_CHECK_EQUAL(pool.getBytesReserved(), nBytesReserved + MemoryPool::MAX_BLOCK_SIZE + 16);
+  pool.deallocate(p4, MemoryPool::MAX_BLOCK_SIZE + 1);
+  BOOST_CHECK_EQUAL(pool.getBytesReserved(), nBytesReserved);
+
+  pool.deallocate(p2, 40);
+  pool.deallocate(p3, 33);
+  BOOST_CHECK_EQUAL(pool.getNBlocksInUse(), 0);
+  BOOST_CHECK_EQUAL(pool.getBytesInUse(), 0);
+  BOOST_CHECK_EQUAL(pool.getBytesReserved(), nBytesReserved);
+}
+
+BOOST_AUTO_TEST_CASE(Allocator)
+{
+  auto pool = make_shared<MemoryPool>();
+  std::list<int, PoolAllocator<int>> list(PoolAllocator<int>{pool});
+  for (int i = 0; i < 1000; ++i) {
+    list.push_back(i);
+  }
+  BOOST_CHECK_EQUAL(pool->getNBlocksInUse(), 1000);
+
+  auto entry = std::allocate_shared<std::string>(PoolAllocator<std::string>(pool), "entry");
+  BOOST_CHECK_EQUAL(pool->getNBlocksInUse(), 1001);
+  list.clear();
+  BOOST_CHECK_EQUAL(pool->getNBlocksInUse(), 1);
+
+  // the allocators keep the pool alive
+  std::weak_ptr<MemoryPool> weakPool = pool;
+  pool.reset();
+  BOOST_CHECK(!weakPool.expired());
+  entry.reset();
+  BOOST_CHECK(!weakPool.expired()); // still referenced by the list
+}
+
+static shared_ptr<Interest>
+makeInterest(const Name& name)
+{
+  auto interest = make_shared<Interest>(name);
+  interest->setCanBePrefix(false);
+  return interest;
+}
+
+BOOST_AUTO_TEST_CASE(PitEntries)
+{
+  nfd::NameTree nameTree(16);
+  auto pit = make_unique<nfd::Pit>(nameTree);
+  const MemoryPool& pool = pit->getMemoryPool();
+
+  std::vector<shared_ptr<nfd::pit::Entry>> entries;
+  for (int i = 0; i < 10; ++i) {
+    auto interest = makeInterest(Name("/A").appendNumber(i));
+    entries.push_back(pit->insert(*interest).first);
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(entries.back().get()) % MemoryPool::BLOCK_ALIGNMENT, 0);
+  }
+  BOOST_CHECK_EQUAL(pit->size(), 10);
+  BOOST_CHECK_EQUAL(pool.getNBlocksInUse(), 10);
+
+  // an erased entry stays valid while referenced, its block is freed on the last release
+  auto held = entries.back();
+  entries.pop_back();
+  pit->erase(held.get());
+  BOOST_CHECK_EQUAL(pit->size(), 9);
+  BOOST_CHECK(pit->find(*makeInterest(Name("/A").appendNumber(9))) == nullptr);
+  BOOST_CHECK_EQUAL(pool.getNBlocksInUse(), 10);
+  BOOST_CHECK_EQUAL(held->getName(), Name("/A").appendNumber(9));
+  held.reset();
+  BOOST_CHECK_EQUAL(pool.getNBlocksInUse(), 9);
+
+  // the freed block is reused by the next entry
+  size_t nBytesReserved = pool.getBytesReserved();
+  pit->insert(*makeInterest("/B"));
+  BOOST_CHECK_EQUAL(pool.getNBlocksInUse(), 10);
+  BOOST_CHECK_EQUAL(pool.getBytesReserved(), nBytesReserved);
+
+  // entries referenced elsewhere outlive the PIT, and keep its pool alive
+  for (auto& entry : entries) {
+    pit->erase(entry.get());
+  }
+  pit->erase(pit->find(*makeInterest("/B")).get());
+  BOOST_CHECK_EQUAL(pit->size(), 0);
+  BOOST_CHECK_EQUAL(pool.getNBlocksInUse(), 9);
+  pit.reset();
+  for (int i = 0; i < 9; ++i) {
+    BOOST_CHECK_EQUAL(entries[i]->getName(), Name("/A").appendNumber(i));
+  }
+  entries.clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
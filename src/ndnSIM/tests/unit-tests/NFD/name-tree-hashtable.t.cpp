@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ns3/ndnSIM/NFD/daemon/table/name-tree.hpp"
+
+#include "../tests-common.hpp"
+
+#include <set>
+
+namespace ns3 {
+namespace ndn {
+
+using nfd::name_tree::computeHashes;
+using nfd::name_tree::Entry;
+using nfd::name_tree::HashSequence;
+using nfd::name_tree::Hashtable;
+using nfd::name_tree::HashtableOptions;
+using nfd::name_tree::NameTree;
+using nfd::name_tree::Node;
+
+BOOST_AUTO_TEST_SUITE(NfdNameTreeHashtable)
+
+static HashtableOptions
+makeOpenAddressingOptions(size_t size)
+{
+  HashtableOptions options(size);
+  options.layout = HashtableOptions::Layout::OPEN_ADDRESSING;
+  return options;
+}
+
+static Name
+makeName(int i)
+{
+  Name name;
+  name.appendNumber(i);
+  return name;
+}
+
+// every node is in the bucket it reports, and nodes of [min, max] are found
+static void
+checkNodes(const Hashtable& ht, int min, int max, const std::set<int>& erased = {})
+{
+  size_t nFound = 0;
+  for (size_t b = 0; b < ht.getNBuckets(); ++b) {
+    if (ht.getBucket(b) != nullptr) {
+      ++nFound;
+    }
+  }
+  BOOST_CHECK_EQUAL(nFound, ht.size());
+
+  for (int i = min; i <= max; ++i) {
+    Name name = makeName(i);
+    const Node* node = ht.find(name, name.size());
+    if (erased.count(i) > 0) {
+      BOOST_CHECK(node == nullptr);
+      continue;
+    }
+    BOOST_REQUIRE(node != nullptr);
+    BOOST_CHECK_EQUAL(node->entry.getName(), name);
+    BOOST_CHECK_EQUAL(ht.getBucket(ht.getBucketIndex(node)), node);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Modifiers)
+{
+  Hashtable ht(makeOpenAddressingOptions(16));
+
+  Name name("/A/B/C/D");
+  HashSequence hashes = computeHashes(name);
+
+  BOOST_CHECK_EQUAL(ht.size(), 0);
+  BOOST_CHECK(ht.find(name, 2) == nullptr);
+
+  const Node* node = nullptr;
+  bool isNew = false;
+  std::tie(node, isNew) = ht.insert(name, 2, hashes);
+  BOOST_CHECK_EQUAL(isNew, true);
+  BOOST_REQUIRE(node != nullptr);
+  BOOST_CHECK_EQUAL(ht.size(), 1);
+  BOOST_CHECK_EQUAL(ht.find(name, 2), node);
+  BOOST_CHECK_EQUAL(ht.find(name, 2, hashes), node);
+  BOOST_CHECK_EQUAL(ht.getBucket(ht.getBucketIndex(node)), node);
+  BOOST_CHECK(ht.find(name, 1) == nullptr);
+  BOOST_CHECK(ht.find(name, 3) == nullptr);
+
+  const Node* node2 = nullptr;
+  std::tie(node2, isNew) = ht.insert(name, 2, hashes);
+  BOOST_CHECK_EQUAL(isNew, false);
+  BOOST_CHECK_EQUAL(node2, node);
+
+  std::tie(node2, isNew) = ht.insert(name, 4, hashes);
+  BOOST_CHECK_EQUAL(isNew, true);
+  BOOST_CHECK_NE(node2, node);
+  BOOST_CHECK_EQUAL(ht.size(), 2);
+
+  ht.erase(const_cast<Node*>(node2));
+  BOOST_CHECK_EQUAL(ht.size(), 1);
+  BOOST_CHECK(ht.find(name, 4) == nullptr);
+  BOOST_CHECK_EQUAL(ht.find(name, 2), node);
+
+  ht.erase(const_cast<Node*>(node));
+  BOOST_CHECK_EQUAL(ht.size(), 0);
+  BOOST_CHECK(ht.find(name, 2) == nullptr);
+}
+
+// group of 16 slots where name is placed in an empty table of nBuckets slots
+static size_t
+findHomeGroup(const Name& name, size_t nBuckets)
+{
+  Hashtable ht(makeOpenAddressingOptions(nBuckets));
+  const Node* node = ht.insert(name, name.size(), computeHashes(name)).first;
+  return ht.getBucketIndex(node) / 16;
+}
+
+BOOST_AUTO_TEST_CASE(ProbingAndTombstones)
+{
+  // 4 groups of 16 slots, 20 names of the same home group overflow it
+  std::vector<Name> names;
+  for (int i = 0; names.size() < 21; ++i) {
+    Name name = makeName(i);
+    if (findHomeGroup(name, 64) == 0) {
+      names.push_back(name);
+    }
+  }
+  Name last = names.back();
+  names.pop_back();
+
+  Hashtable ht(makeOpenAddressingOptions(64));
+  std::vector<const Node*> nodes;
+  for (const Name& name : names) {
+    nodes.push_back(ht.insert(name, name.size(), computeHashes(name)).first);
+  }
+  BOOST_CHECK_EQUAL(ht.size(), 20);
+  BOOST_CHECK(!ht.isResizing());
+  BOOST_CHECK_EQUAL(ht.getNBuckets(), 64);
+
+  std::set<size_t> groups;
+  for (size_t i = 0; i < names.size(); ++i) {
+    BOOST_CHECK_EQUAL(ht.find(names[i], names[i].size()), nodes[i]);
+    groups.insert(ht.getBucketIndex(nodes[i]) / 16);
+  }
+  BOOST_CHECK_EQUAL(groups.count(0), 1);
+  BOOST_CHECK_EQUAL(groups.size(), 2);
+
+  // the erased slot of the full group becomes a tombstone, probing still reaches the next group
+  size_t erasedSlot = ht.getBucketIndex(nodes[3]);
+  BOOST_CHECK_EQUAL(erasedSlot / 16, 0);
+  ht.erase(const_cast<Node*>(nodes[3]));
+  BOOST_CHECK_EQUAL(ht.size(), 19);
+  BOOST_CHECK(ht.find(names[3], names[3].size()) == nullptr);
+  for (size_t i = 4; i < names.size(); ++i) {
+    BOOST_CHECK_EQUAL(ht.find(names[i], names[i].size()), nodes[i]);
+  }
+
+  // the next name of the same home group reuses the tombstone
+  const Node* node = ht.insert(last, last.size(), computeHashes(last)).first;
+  BOOST_CHECK_EQUAL(ht.getBucketIndex(node), erasedSlot);
+  BOOST_CHECK_EQUAL(ht.find(last, last.size()), node);
+  BOOST_CHECK_EQUAL(ht.size(), 20);
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalResize)
+{
+  HashtableOptions options = makeOpenAddressingOptions(16);
+  options.migrationBatch = 4;
+  Hashtable ht(options);
+  BOOST_CHECK_EQUAL(ht.getNBuckets(), 16);
+
+  // lookups see the nodes of both tables while a resize is in progress, erasing works on either table
+  std::set<int> erased;
+  bool hasResized = false;
+  for (int i = 1; i <= 1000; ++i) {
+    Name name = makeName(i);
+    ht.insert(name, name.size(), computeHashes(name));
+    if (ht.isResizing()) {
+      hasResized = true;
+      if (i % 3 == 0) {
+        Name old = makeName(i - 1);
+        ht.erase(const_cast<Node*>(ht.find(old, old.size())));
+        erased.insert(i - 1);
+      }
+      checkNodes(ht, 1, i, erased);
+    }
+  }
+  BOOST_CHECK(hasResized);
+  BOOST_CHECK_EQUAL(ht.size(), 1000 - erased.size());
+  BOOST_CHECK_GE(ht.getNBuckets(), ht.size());
+  checkNodes(ht, 1, 1000, erased);
+  size_t nBucketsFull = ht.getNBuckets();
+
+  for (int i = 1; i <= 990; ++i) {
+    if (erased.count(i) > 0) {
+      continue;
+    }
+    Name name = makeName(i);
+    const Node* node = ht.find(name, name.size());
+    BOOST_REQUIRE(node != nullptr);
+    ht.erase(const_cast<Node*>(node));
+    BOOST_CHECK(ht.find(name, name.size()) == nullptr);
+    erased.insert(i);
+  }
+  checkNodes(ht, 1, 1000, erased);
+
+  for (int i = 991; i <= 1000; ++i) {
+    Name name = makeName(i);
+    const Node* node = ht.find(name, name.size());
+    if (node != nullptr) {
+      ht.erase(const_cast<Node*>(node));
+    }
+  }
+  BOOST_CHECK_EQUAL(ht.size(), 0);
+  BOOST_CHECK(!ht.isResizing());
+  BOOST_CHECK_LT(ht.getNBuckets(), nBucketsFull);
+}
+
+BOOST_AUTO_TEST_CASE(NameTreeEnumerate)
+{
+  NameTree nt(makeOpenAddressingOptions(16));
+
+  std::set<Name> names;
+  for (int i = 0; i < 200; ++i) {
+    Name name("/a");
+    name.appendNumber(i % 7).appendNumber(i);
+    nt.lookup(name);
+    for (size_t len = 0; len <= name.size(); ++len) {
+      names.insert(name.getPrefix(len));
+    }
+  }
+  BOOST_CHECK_EQUAL(nt.size(), names.size());
+
+  std::set<Name> enumerated;
+  for (const Entry& entry : nt) {
+    BOOST_CHECK(enumerated.insert(entry.getName()).second);
+  }
+  BOOST_CHECK(enumerated == names);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
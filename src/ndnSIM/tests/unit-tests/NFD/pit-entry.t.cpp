@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ns3/ndnSIM/NFD/daemon/table/pit-entry.hpp"
+#include "ns3/ndnSIM/NFD/daemon/face/null-face.hpp"
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_FIXTURE_TEST_SUITE(NfdPitEntry, CleanupFixture)
+
+static shared_ptr<Interest>
+makeInterest(uint32_t nonce)
+{
+  auto interest = make_shared<Interest>("/A/B");
+  interest->setCanBePrefix(false);
+  interest->setNonce(nonce);
+  return interest;
+}
+
+// more faces than records stored inline, so records spill out of the entry
+static std::vector<shared_ptr<nfd::Face>>
+makeFaces()
+{
+  std::vector<shared_ptr<nfd::Face>> faces;
+  for (size_t i = 0; i < nfd::pit::OUT_RECORDS_INLINE + 3; ++i) {
+    faces.push_back(nfd::face::makeNullFace());
+  }
+  return faces;
+}
+
+BOOST_AUTO_TEST_CASE(InRecords)
+{
+  auto faces = makeFaces();
+  nfd::pit::Entry entry(*makeInterest(1));
+
+  for (size_t i = 0; i < faces.size(); ++i) {
+    auto it = entry.insertOrUpdateInRecord(*faces[i], *makeInterest(100 + i));
+    BOOST_CHECK_EQUAL(&it->getFace(), faces[i].get());
+    BOOST_CHECK_EQUAL(it->getLastNonce(), 100 + i);
+  }
+  BOOST_REQUIRE_EQUAL(entry.getInRecords().size(), faces.size());
+
+  // newest first
+  size_t i = faces.size();
+  for (const nfd::pit::InRecord& inRecord : entry.getInRecords()) {
+    BOOST_CHECK_EQUAL(&inRecord.getFace(), faces[--i].get());
+  }
+
+  // update doesn't add a record
+  auto it = entry.insertOrUpdateInRecord(*faces[1], *makeInterest(200));
+  BOOST_CHECK_EQUAL(&it->getFace(), faces[1].get());
+  BOOST_CHECK_EQUAL(entry.getInRecords().size(), faces.size());
+  BOOST_CHECK_EQUAL(entry.getInRecord(*faces[1])->getLastNonce(), 200);
+
+  // remaining records keep their data after deletes
+  entry.deleteInRecord(*faces[0]);
+  entry.deleteInRecord(*faces[3]);
+  BOOST_CHECK_EQUAL(entry.getInRecords().size(), faces.size() - 2);
+  BOOST_CHECK(entry.getInRecord(*faces[0]) == entry.in_end());
+  BOOST_CHECK(entry.getInRecord(*faces[3]) == entry.in_end());
+  BOOST_CHECK_EQUAL(entry.getInRecord(*faces[1])->getLastNonce(), 200);
+  BOOST_CHECK_EQUAL(entry.getInRecord(*faces[2])->getLastNonce(), 102);
+  BOOST_CHECK_EQUAL(entry.getInRecord(*faces[4])->getLastNonce(), 104);
+
+  entry.clearInRecords();
+  BOOST_CHECK(!entry.hasInRecords());
+  BOOST_CHECK(entry.getInRecord(*faces[1]) == entry.in_end());
+}
+
+BOOST_AUTO_TEST_CASE(OutRecords)
+{
+  auto faces = makeFaces();
+  nfd::pit::Entry entry(*makeInterest(1));
+
+  for (size_t i = 0; i < faces.size(); ++i) {
+    auto it = entry.insertOrUpdateOutRecord(*faces[i], *makeInterest(100 + i));
+    BOOST_CHECK_EQUAL(&it->getFace(), faces[i].get());
+    BOOST_CHECK_EQUAL(it->getLastNonce(), 100 + i);
+  }
+  BOOST_REQUIRE_EQUAL(entry.getOutRecords().size(), faces.size());
+
+  size_t i = faces.size();
+  for (const nfd::pit::OutRecord& outRecord : entry.getOutRecords()) {
+    BOOST_CHECK_EQUAL(&outRecord.getFace(), faces[--i].get());
+  }
+
+  auto it = entry.insertOrUpdateOutRecord(*faces[4], *makeInterest(200));
+  BOOST_CHECK_EQUAL(&it->getFace(), faces[4].get());
+  BOOST_CHECK_EQUAL(entry.getOutRecords().size(), faces.size());
+  BOOST_CHECK_EQUAL(entry.getOutRecord(*faces[4])->getLastNonce(), 200);
+
+  // delete down to the inline capacity and below
+  entry.deleteOutRecord(*faces[4]);
+  entry.deleteOutRecord(*faces[0]);
+  entry.deleteOutRecord(*faces[2]);
+  BOOST_CHECK_EQUAL(entry.getOutRecords().size(), nfd::pit::OUT_RECORDS_INLINE);
+  BOOST_CHECK_EQUAL(entry.getOutRecord(*faces[1])->getLastNonce(), 101);
+  BOOST_CHECK_EQUAL(entry.getOutRecord(*faces[3])->getLastNonce(), 103);
+
+  entry.deleteOutRecord(*faces[1]);
+  BOOST_CHECK_EQUAL(entry.getOutRecords().size(), 1);
+  BOOST_CHECK(entry.getOutRecord(*faces[1]) == entry.out_end());
+  BOOST_CHECK_EQUAL(&entry.getOutRecords().front().getFace(), faces[3].get());
+
+  // deleting a face without a record does nothing
+  entry.deleteOutRecord(*faces[1]);
+  BOOST_CHECK_EQUAL(entry.getOutRecords().size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "apps/AggregationKernel.hpp"
+
+#include <vector>
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsAggregationKernel)
+
+static std::vector<AggregationKernel::Isa>
+allIsa()
+{
+  return {AggregationKernel::Isa::kScalar, AggregationKernel::Isa::kSSE,
+          AggregationKernel::Isa::kAVX2, AggregationKernel::Isa::kAVX512};
+}
+
+BOOST_AUTO_TEST_CASE(SumAndMean)
+{
+  auto detected = AggregationKernel::GetIsa();
+
+  // odd sizes exercise vector tails
+  for (size_t n : {0, 1, 7, 15, 17, 300, 1001}) {
+    for (auto isa : allIsa()) {
+      AggregationKernel::SetIsa(isa);
+
+      std::vector<float> acc(n, 1.0f);
+      std::vector<float> in(n);
+      for (size_t i = 0; i < n; ++i) {
+        in[i] = static_cast<float>(i);
+      }
+
+      AggregationKernel::Sum(acc, in);
+      AggregationKernel::Sum(acc, in);
+      for (size_t i = 0; i < n; ++i) {
+        BOOST_CHECK_EQUAL(acc[i], 1.0f + 2.0f * i);
+      }
+
+      AggregationKernel::Mean(acc, acc, 2.0f);
+      for (size_t i = 0; i < n; ++i) {
+        BOOST_CHECK_CLOSE(acc[i], 0.5f + i, 0.0001);
+      }
+    }
+  }
+
+  AggregationKernel::SetIsa(detected);
+  BOOST_CHECK(AggregationKernel::GetIsa() == detected);
+}
+
+BOOST_AUTO_TEST_CASE(WeightedMean)
+{
+  auto detected = AggregationKernel::GetIsa();
+
+  for (auto isa : allIsa()) {
+    AggregationKernel::SetIsa(isa);
+
+    std::vector<float> acc(37, 0.0f);
+    std::vector<float> a(37, 2.0f);
+    std::vector<float> b(37, 5.0f);
+
+    AggregationKernel::WeightedSum(acc, a, 3.0f);
+    AggregationKernel::WeightedSum(acc, b, 1.0f);
+    std::vector<float> mean(37);
+    AggregationKernel::WeightedMean(mean, acc, 4.0f);
+    for (float value : mean) {
+      BOOST_CHECK_CLOSE(value, 2.75f, 0.0001);
+    }
+  }
+
+  AggregationKernel::SetIsa(detected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "apps/ndn-consumer-INA.hpp"
+#include "apps/algorithm/include/AggregationTree.hpp"
+#include "apps/algorithm/utility/utility.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsAggregationTree)
+
+class AggregationTreeFixture
+{
+public:
+  AggregationTreeFixture()
+    : m_path((boost::filesystem::temp_directory_path() /
+              boost::filesystem::unique_path("agg-tree-%%%%%%.txt")).string())
+  {
+    Utility::SetCostMatrixCacheDir("");
+    writeTopology(1);
+  }
+
+  ~AggregationTreeFixture()
+  {
+    boost::filesystem::remove(m_path);
+    Utility::SetCostMatrixCacheDir("/tmp/cfnagg-cost-cache");
+  }
+
+  // 40 producers behind 4 edge forwarders, every forwarder connects to all 6 aggregators, two consumers run separate jobs
+  void
+  writeTopology(int edgeCost)
+  {
+    std::ofstream file(m_path);
+    file << "router\n\ncon0\ncon1\n";
+    for (int i = 0; i < 40; ++i) {
+      file << "pro" << i << "\n";
+    }
+    for (int i = 0; i < 5; ++i) {
+      file << "forwarder" << i << "\n";
+    }
+    for (int i = 0; i < 6; ++i) {
+      file << "agg" << i << "\n";
+    }
+    file << "\nlink\n\n";
+    for (int i = 0; i < 40; ++i) {
+      file << "pro" << i << " forwarder" << i / 10 << " 100Mbps " << (i == 5 ? edgeCost : 1) << " 2ms 50\n";
+    }
+    file << "con0 forwarder4 100Mbps 1 2ms 50\n";
+    file << "con1 forwarder4 100Mbps 1 2ms 50\n";
+    for (int i = 0; i < 5; ++i) {
+      for (int j = 0; j < 6; ++j) {
+        file << "forwarder" << i << " agg" << j << " 100Mbps 1 2ms 50\n";
+      }
+    }
+  }
+
+  // Every producer is a leaf exactly once, and no node exceeds the constraint
+  void
+  checkTree(const AggregationTree& tree, const std::set<std::string>& producers, int constraint)
+  {
+    std::multiset<std::string> leaves;
+    for (const auto& [parent, children] : tree.aggregationAllocation) {
+      BOOST_CHECK_LE(children.size(), static_cast<size_t>(constraint));
+      for (const auto& child : children) {
+        if (child.compare(0, 3, "pro") == 0) {
+          leaves.insert(child);
+        }
+      }
+    }
+    for (const auto& subTree : tree.noCHTree) {
+      for (const auto& child : subTree) {
+        if (child.compare(0, 3, "pro") == 0) {
+          leaves.insert(child);
+        }
+      }
+    }
+    BOOST_CHECK(leaves == std::multiset<std::string>(producers.begin(), producers.end()));
+  }
+
+protected:
+  std::string m_path;
+};
+
+BOOST_FIXTURE_TEST_CASE(RepairProducerChurn, AggregationTreeFixture)
+{
+  std::vector<std::string> producerList = Utility::getProducers(m_path);
+  std::set<std::string> producers(producerList.begin(), producerList.end());
+
+  AggregationTree tree(m_path);
+  BOOST_REQUIRE(tree.aggregationTreeConstruction(producerList, 5));
+  checkTree(tree, producers, 5);
+
+  AggregationTree::TreeChange leave;
+  leave.leftProducers = {"pro3", "pro12", "pro27"};
+  BOOST_REQUIRE(tree.aggregationTreeRepair(leave));
+  producers.erase("pro3");
+  producers.erase("pro12");
+  producers.erase("pro27");
+  checkTree(tree, producers, 5);
+
+  AggregationTree::TreeChange join;
+  join.joinedProducers = {"pro3", "pro27"};
+  BOOST_REQUIRE(tree.aggregationTreeRepair(join));
+  producers.insert("pro3");
+  producers.insert("pro27");
+  checkTree(tree, producers, 5);
+}
+
+BOOST_FIXTURE_TEST_CASE(RepairAggregatorLeave, AggregationTreeFixture)
+{
+  std::vector<std::string> producerList = Utility::getProducers(m_path);
+  std::set<std::string> producers(producerList.begin(), producerList.end());
+
+  AggregationTree tree(m_path);
+  BOOST_REQUIRE(tree.aggregationTreeConstruction(producerList, 10));
+
+  std::string leaving;
+  for (const auto& entry : tree.aggregationAllocation) {
+    if (entry.first != tree.globalClient) {
+      leaving = entry.first;
+      break;
+    }
+  }
+  BOOST_REQUIRE(!leaving.empty());
+
+  AggregationTree::TreeChange change;
+  change.leftAggregators = {leaving};
+  BOOST_REQUIRE(tree.aggregationTreeRepair(change));
+  BOOST_CHECK_EQUAL(tree.aggregationAllocation.count(leaving), 0);
+  for (const auto& entry : tree.aggregationAllocation) {
+    BOOST_CHECK(std::find(entry.second.begin(), entry.second.end(), leaving) == entry.second.end());
+  }
+  checkTree(tree, producers, 10);
+}
+
+BOOST_FIXTURE_TEST_CASE(RepairLinkChange, AggregationTreeFixture)
+{
+  std::vector<std::string> producerList = Utility::getProducers(m_path);
+  std::set<std::string> producers(producerList.begin(), producerList.end());
+
+  AggregationTree tree(m_path);
+  BOOST_REQUIRE(tree.aggregationTreeConstruction(producerList, 10));
+  int before = tree.costMatrix.at(tree.costMatrix.id("pro5"), tree.costMatrix.id("con0"));
+
+  writeTopology(9);
+  AggregationTree::TreeChange change;
+  change.linkChanged = true;
+  BOOST_REQUIRE(tree.aggregationTreeRepair(change));
+  BOOST_CHECK_EQUAL(tree.costMatrix.at(tree.costMatrix.id("pro5"), tree.costMatrix.id("con0")), before + 8);
+  checkTree(tree, producers, 10);
+}
+
+BOOST_FIXTURE_TEST_CASE(ConcurrentJobs, AggregationTreeFixture)
+{
+  std::vector<std::string> producerList = Utility::getProducers(m_path);
+  std::set<std::string> producers(producerList.begin(), producerList.end());
+
+  // Each consumer roots its own tree over the same aggregators, neither consumer becomes a cluster head
+  AggregationTree first(m_path);
+  AggregationTree second(m_path, "con1");
+  BOOST_REQUIRE(first.aggregationTreeConstruction(producerList, 10));
+  BOOST_REQUIRE(second.aggregationTreeConstruction(producerList, 10));
+  BOOST_CHECK_EQUAL(first.aggregationAllocation.count("con0"), 1);
+  BOOST_CHECK_EQUAL(first.aggregationAllocation.count("con1"), 0);
+  BOOST_CHECK_EQUAL(second.aggregationAllocation.count("con1"), 1);
+  BOOST_CHECK_EQUAL(second.aggregationAllocation.count("con0"), 0);
+  checkTree(first, producers, 10);
+  checkTree(second, producers, 10);
+}
+
+BOOST_FIXTURE_TEST_CASE(RepairRebroadcastsChangedSubTrees, AggregationTreeFixture)
+{
+  std::vector<std::string> producerList = Utility::getProducers(m_path);
+
+  AggregationTree tree(m_path);
+  BOOST_REQUIRE(tree.aggregationTreeConstruction(producerList, 5));
+  auto oldTree = tree.aggregationAllocation;
+
+  // a producer served by an aggregator rather than by the consumer or a sub-tree
+  std::string holder;
+  std::string leaving;
+  for (const auto& [parent, children] : oldTree) {
+    if (parent != tree.globalClient && !children.empty() && children[0].compare(0, 3, "pro") == 0) {
+      holder = parent;
+      leaving = children[0];
+      break;
+    }
+  }
+  BOOST_REQUIRE(!leaving.empty());
+
+  AggregationTree::TreeChange change;
+  change.leftProducers = {leaving};
+  BOOST_REQUIRE(tree.aggregationTreeRepair(change));
+  const auto& newTree = tree.aggregationAllocation;
+
+  // only the aggregator that served the leaving producer receives a new descriptor
+  Ptr<Consumer> consumer = CreateObject<ConsumerINA>();
+  consumer->SetAttribute("NodePrefix", StringValue(tree.globalClient));
+  std::vector<std::string> changed = consumer->GetChangedSubTrees(oldTree, newTree);
+  BOOST_REQUIRE_EQUAL(changed.size(), 1);
+  BOOST_CHECK_EQUAL(changed[0], holder);
+
+  for (const auto& [parent, children] : newTree) {
+    if (parent != holder && parent != tree.globalClient) {
+      BOOST_REQUIRE_EQUAL(oldTree.count(parent), 1);
+      BOOST_CHECK(oldTree.at(parent) == children);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "apps/LogSink.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsLogSink)
+
+static std::string
+readFile(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+class LogSinkFixture
+{
+public:
+  LogSinkFixture()
+    : dir(std::filesystem::temp_directory_path() / "ndnsim-log-sink-test")
+  {
+    std::filesystem::create_directories(dir);
+  }
+
+  ~LogSinkFixture()
+  {
+    LogSink::Get().SetAsync(false);
+    LogSink::Get().SetFormat(LogSink::Format::kText);
+    LogSink::Get().SetBufferSize(1 << 20);
+    std::filesystem::remove_all(dir);
+  }
+
+public:
+  std::filesystem::path dir;
+};
+
+BOOST_FIXTURE_TEST_CASE(Text, LogSinkFixture)
+{
+  for (bool async : {false, true}) {
+    LogSink& sink = LogSink::Get();
+    sink.SetAsync(async);
+    sink.SetBufferSize(16); // force several flushes
+
+    std::string path = (dir / "text.txt").string();
+    auto channel = sink.Register(path);
+    BOOST_CHECK_EQUAL(sink.Register(path), channel);
+
+    sink.Write(channel, int64_t(1500), 3u, true, 2.5);
+    sink.Append(channel, 7);
+    sink.Append(channel, 1.0e9);
+    sink.EndRecord(channel);
+    sink.Close();
+
+    BOOST_CHECK_EQUAL(readFile(path), "1500 3 1 2.5\n7 1e+09\n");
+
+    // writes after close are ignored
+    sink.Write(channel, 1);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(StaleHandle, LogSinkFixture)
+{
+  LogSink& sink = LogSink::Get();
+  std::string oldPath = (dir / "old.txt").string();
+  std::string newPath = (dir / "new.txt").string();
+
+  auto oldChannel = sink.Register(oldPath);
+  sink.Write(oldChannel, 1);
+  sink.Close();
+
+  // a handle kept from before Close() must not write into a channel registered afterwards
+  auto newChannel = sink.Register(newPath);
+  BOOST_CHECK_NE(newChannel, oldChannel);
+  sink.Write(oldChannel, 2);
+  sink.Write(newChannel, 3);
+  sink.Close();
+
+  BOOST_CHECK_EQUAL(readFile(oldPath), "1\n");
+  BOOST_CHECK_EQUAL(readFile(newPath), "3\n");
+}
+
+BOOST_FIXTURE_TEST_CASE(Binary, LogSinkFixture)
+{
+  LogSink& sink = LogSink::Get();
+  sink.SetFormat(LogSink::Format::kBinary);
+
+  auto channel = sink.Register((dir / "binary.txt").string(), {"time", "value"});
+  sink.Write(channel, 1, 10.5);
+  sink.Write(channel, 2);
+  sink.Close();
+
+  std::string content = readFile((dir / "binary.bin").string());
+  BOOST_REQUIRE_EQUAL(content.size(), 8 + 4 + (4 + 4) + (4 + 5) + 8 + 4 * 8);
+  BOOST_CHECK_EQUAL(content.substr(0, 4), "CFNL");
+  BOOST_CHECK_EQUAL(content[4], 1);
+
+  size_t offset = 8 + 4 + (4 + 4) + (4 + 5);
+  uint32_t rows, columns;
+  std::memcpy(&rows, content.data() + offset, 4);
+  std::memcpy(&columns, content.data() + offset + 4, 4);
+  BOOST_CHECK_EQUAL(rows, 2);
+  BOOST_CHECK_EQUAL(columns, 2);
+
+  double values[4];
+  std::memcpy(values, content.data() + offset + 8, sizeof(values));
+  BOOST_CHECK_EQUAL(values[0], 1);
+  BOOST_CHECK_EQUAL(values[1], 2);
+  BOOST_CHECK_EQUAL(values[2], 10.5);
+  BOOST_CHECK(std::isnan(values[3]));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
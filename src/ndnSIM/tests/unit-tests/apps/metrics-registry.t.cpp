@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "apps/MetricsRegistry.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsMetricsRegistry)
+
+static std::string
+readFile(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+class MetricsRegistryFixture
+{
+public:
+  MetricsRegistryFixture()
+    : dir(std::filesystem::temp_directory_path() / "ndnsim-metrics-registry-test")
+  {
+    std::filesystem::create_directories(dir);
+    MetricsRegistry& registry = MetricsRegistry::Get();
+    registry.SetEnabled(true);
+    registry.SetSamplePeriod(Time(0)); // samples are taken by the tests
+    registry.SetOutputDirectory(dir.string());
+  }
+
+  ~MetricsRegistryFixture()
+  {
+    MetricsRegistry& registry = MetricsRegistry::Get();
+    registry.Close();
+    registry.SetEnabled(false);
+    registry.SetFormat(MetricsRegistry::Format::kCsv);
+    registry.SetSamplePeriod(MilliSeconds(10));
+    std::filesystem::remove_all(dir);
+  }
+
+public:
+  std::filesystem::path dir;
+};
+
+BOOST_AUTO_TEST_CASE(HistogramBuckets)
+{
+  // exact below 2 * SUB_BUCKETS, buckets are contiguous and their width doubles above that
+  for (int64_t value : {0, 1, 127}) {
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(value), static_cast<size_t>(value));
+  }
+  for (size_t index = 1; index < 1000; ++index) {
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketLowest(index), LatencyHistogram::bucketHighest(index - 1) + 1);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(LatencyHistogram::bucketLowest(index)), index);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(LatencyHistogram::bucketHighest(index)), index);
+  }
+  BOOST_CHECK_EQUAL(LatencyHistogram::bucketLowest(LatencyHistogram::bucketIndex(1000)), 1000);
+  BOOST_CHECK_EQUAL(LatencyHistogram::bucketHighest(LatencyHistogram::bucketIndex(1000)), 1007);
+}
+
+BOOST_AUTO_TEST_CASE(HistogramPercentiles)
+{
+  LatencyHistogram histogram;
+  BOOST_CHECK_EQUAL(histogram.percentile(0.5), 0);
+
+  for (int64_t value = 1; value <= 100; ++value) {
+    histogram.record(value);
+  }
+  BOOST_CHECK_EQUAL(histogram.count(), 100);
+  BOOST_CHECK_EQUAL(histogram.min(), 1);
+  BOOST_CHECK_EQUAL(histogram.max(), 100);
+  BOOST_CHECK_CLOSE(histogram.mean(), 50.5, 1e-9);
+  BOOST_CHECK_EQUAL(histogram.percentile(0.5), 50);
+  BOOST_CHECK_EQUAL(histogram.percentile(0.99), 99);
+  BOOST_CHECK_EQUAL(histogram.percentile(1.0), 100);
+
+  // large values are within the relative error of their bucket
+  histogram.clear();
+  for (int i = 0; i < 10; ++i) {
+    histogram.record(100000);
+  }
+  BOOST_CHECK_CLOSE(histogram.percentile(0.5), 100000, 100.0 / LatencyHistogram::SUB_BUCKETS);
+}
+
+BOOST_FIXTURE_TEST_CASE(Register, MetricsRegistryFixture)
+{
+  MetricsRegistry& registry = MetricsRegistry::Get();
+  auto window = registry.Register(MetricsRegistry::Type::kGauge, "agg0", "job0", "window");
+  auto timeouts = registry.Register(MetricsRegistry::Type::kCounter, "agg0", "job0", "timeouts");
+  BOOST_CHECK_EQUAL(registry.Register(MetricsRegistry::Type::kGauge, "agg0", "job0", "window"), window);
+  BOOST_CHECK_NE(registry.Register(MetricsRegistry::Type::kGauge, "agg0", "job1", "window"), window);
+  BOOST_CHECK_EQUAL(registry.Find("agg0", "job0", "timeouts"), timeouts);
+  BOOST_CHECK_EQUAL(registry.Find("agg1", "job0", "timeouts"), MetricsRegistry::INVALID_ID);
+
+  registry.Set(window, 4.5);
+  registry.Increment(timeouts);
+  registry.Increment(timeouts, 2);
+  BOOST_CHECK_EQUAL(registry.GetValue(window), 4.5);
+  BOOST_CHECK_EQUAL(registry.GetValue(timeouts), 3);
+
+  // only metrics updated since the last sample are sampled
+  registry.Sample();
+  BOOST_CHECK_EQUAL(registry.GetSampleCount(), 2);
+  registry.Set(window, 5);
+  registry.Sample();
+  BOOST_CHECK_EQUAL(registry.GetSampleCount(), 3);
+
+  // a disabled registry ignores everything
+  registry.Close();
+  registry.SetEnabled(false);
+  auto disabled = registry.Register(MetricsRegistry::Type::kCounter, "agg0", "job0", "timeouts");
+  BOOST_CHECK_EQUAL(disabled, MetricsRegistry::INVALID_ID);
+  registry.Increment(disabled);
+  BOOST_CHECK_EQUAL(registry.GetValue(disabled), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(ExportCsv, MetricsRegistryFixture)
+{
+  MetricsRegistry& registry = MetricsRegistry::Get();
+  auto window = registry.Register(MetricsRegistry::Type::kGauge, "con0", "job0", "window");
+  auto rtt = registry.Register(MetricsRegistry::Type::kHistogram, "con0", "job0", "RTT");
+  registry.Set(window, 2);
+  registry.Sample();
+  for (int64_t value : {10, 20, 30, 40}) {
+    registry.Record(rtt, value);
+  }
+  registry.Close();
+
+  BOOST_CHECK_EQUAL(readFile((dir / "metrics_summary.csv").string()),
+                    "node,job,metric,type,count,value,min,max,p50,p90,p99\n"
+                    "con0,job0,window,gauge,1,2,,,,,\n"
+                    "con0,job0,RTT,histogram,4,25,10,40,20,40,40\n");
+  BOOST_CHECK_EQUAL(readFile((dir / "metrics_samples.csv").string()),
+                    "time,node,job,metric,value\n"
+                    "0,con0,job0,window,2\n");
+}
+
+BOOST_FIXTURE_TEST_CASE(ExportBinary, MetricsRegistryFixture)
+{
+  MetricsRegistry& registry = MetricsRegistry::Get();
+  registry.SetFormat(MetricsRegistry::Format::kBinary);
+  auto timeouts = registry.Register(MetricsRegistry::Type::kCounter, "agg0", "job0", "timeouts");
+  registry.Increment(timeouts, 3);
+  registry.Sample();
+  registry.Close();
+
+  std::string content = readFile((dir / "metrics.bin").string());
+  size_t metricSize = 1 + (4 + 4) + (4 + 4) + (4 + 8) + 8 + 6 * 8;
+  BOOST_REQUIRE_EQUAL(content.size(), 8 + 4 + metricSize + 4 + (8 + 4 + 8));
+  BOOST_CHECK_EQUAL(content.substr(0, 4), "CFNM");
+  BOOST_CHECK_EQUAL(content[4], 1);
+
+  uint32_t metrics, samples;
+  std::memcpy(&metrics, content.data() + 8, 4);
+  std::memcpy(&samples, content.data() + 8 + 4 + metricSize, 4);
+  BOOST_CHECK_EQUAL(metrics, 1);
+  BOOST_CHECK_EQUAL(samples, 1);
+
+  double value;
+  std::memcpy(&value, content.data() + content.size() - 8, 8);
+  BOOST_CHECK_EQUAL(value, 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
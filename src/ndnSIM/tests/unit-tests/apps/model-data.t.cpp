@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "apps/ModelData.hpp"
+
+#include <ndn-cxx/encoding/buffer.hpp>
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsModelData)
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+  ModelData original(1000);
+  for (size_t i = 0; i < original.parameters.size(); ++i) {
+    original.parameters[i] = 0.25f * i;
+  }
+  original.congestedNodes = {"/agg0", "/agg12"};
+
+  std::vector<uint8_t> buffer;
+  serializeModelData(original, buffer);
+  BOOST_CHECK_EQUAL(buffer.size(), ModelDataFormat::HEADER_SIZE + 1000 * sizeof(float) + 2 * 4 + 5 + 6);
+
+  ModelData decoded(0);
+  BOOST_REQUIRE(deserializeModelData(buffer, decoded));
+  BOOST_CHECK_EQUAL_COLLECTIONS(decoded.parameters.begin(), decoded.parameters.end(),
+                                original.parameters.begin(), original.parameters.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(decoded.congestedNodes.begin(), decoded.congestedNodes.end(),
+                                original.congestedNodes.begin(), original.congestedNodes.end());
+}
+
+BOOST_AUTO_TEST_CASE(ViewOverContent)
+{
+  ModelData original(300);
+  original.parameters[299] = 42.0f;
+
+  auto buffer = std::make_shared< ::ndn::Buffer>();
+  serializeModelData(original, *buffer);
+
+  Data data("/agg0/pro0.pro1/data");
+  data.setContent(buffer);
+  data.setSignatureInfo(SignatureInfo(static_cast< ::ndn::tlv::SignatureTypeValue>(255)));
+  data.setSignatureValue(std::make_shared< ::ndn::Buffer>(1));
+  Data decoded(data.wireEncode());
+
+  ModelDataView view;
+  BOOST_REQUIRE(view.parse(decoded.getContent()));
+  BOOST_CHECK_EQUAL(view.parameters().size(), 300);
+  BOOST_CHECK_EQUAL(view.parameters()[299], 42.0f);
+  BOOST_CHECK(view.congestedNodes().empty());
+}
+
+BOOST_AUTO_TEST_CASE(Contributors)
+{
+  ModelData original(4);
+  original.contributors = 7;
+
+  std::vector<uint8_t> buffer;
+  serializeModelData(original, buffer);
+  ModelData decoded(0);
+  BOOST_REQUIRE(deserializeModelData(buffer, decoded));
+  BOOST_CHECK_EQUAL(decoded.contributors, 7);
+
+  // Partial sums carry the number of producers in them
+  serializeModelData(original.parameters, {}, buffer, 3);
+  ModelDataView view;
+  BOOST_REQUIRE(view.parse(buffer));
+  BOOST_CHECK_EQUAL(view.contributors(), 3);
+
+  // Producer payloads count as one, so does the reserved 0 written by older senders
+  serializeModelDataHeader(4, buffer);
+  BOOST_REQUIRE(view.parse(buffer));
+  BOOST_CHECK_EQUAL(view.contributors(), 1);
+  std::fill(buffer.begin() + 12, buffer.begin() + 16, 0);
+  BOOST_REQUIRE(view.parse(buffer));
+  BOOST_CHECK_EQUAL(view.contributors(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Malformed)
+{
+  ModelData original(10);
+  std::vector<uint8_t> buffer;
+  serializeModelData(original, buffer);
+
+  ModelDataView view;
+  std::vector<uint8_t> truncated(buffer.begin(), buffer.end() - 1);
+  BOOST_CHECK(!view.parse(truncated));
+
+  buffer[2] = ModelDataFormat::VERSION + 1;
+  BOOST_CHECK(!view.parse(buffer));
+
+  BOOST_CHECK(!view.parse(::ndn::span<const uint8_t>()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+
+#include "apps/PayloadCodec.hpp"
+#include "apps/ModelData.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsPayloadCodec)
+
+static std::vector<float>
+makeParameters(size_t size)
+{
+  std::vector<float> parameters(size);
+  for (size_t i = 0; i < size; ++i) {
+    parameters[i] = std::sin(0.37f * i) * (1.0f + i % 7);
+  }
+  return parameters;
+}
+
+static std::vector<float>
+roundTrip(const PayloadCodec& codec, const std::vector<float>& parameters, size_t& size)
+{
+  std::vector<uint8_t> buffer;
+  serializeModelData(parameters, {"/agg0"}, buffer, 3, codec);
+  size = buffer.size();
+
+  ModelDataView view;
+  BOOST_REQUIRE(view.parse(buffer));
+  BOOST_CHECK(view.codec() == codec.GetType());
+  BOOST_CHECK_EQUAL(view.contributors(), 3);
+  BOOST_REQUIRE_EQUAL(view.congestedNodes().size(), 1);
+  BOOST_CHECK_EQUAL(view.congestedNodes()[0], "/agg0");
+  return std::vector<float>(view.parameters().begin(), view.parameters().end());
+}
+
+BOOST_AUTO_TEST_CASE(Names)
+{
+  for (const char* name : {"fp32", "fp16", "bf16", "int8", "topk"}) {
+    PayloadCodec::Type type;
+    BOOST_REQUIRE(PayloadCodec::ParseType(name, type));
+    BOOST_CHECK_EQUAL(PayloadCodec::GetTypeName(type), name);
+  }
+  PayloadCodec::Type type;
+  BOOST_CHECK(!PayloadCodec::ParseType("fp64", type));
+}
+
+BOOST_AUTO_TEST_CASE(HalfConversion)
+{
+  BOOST_CHECK_EQUAL(PayloadCodec::FloatToHalf(1.0f), 0x3C00);
+  BOOST_CHECK_EQUAL(PayloadCodec::FloatToHalf(-2.0f), 0xC000);
+  BOOST_CHECK_EQUAL(PayloadCodec::FloatToHalf(65504.0f), 0x7BFF);
+  BOOST_CHECK_EQUAL(PayloadCodec::FloatToHalf(1e6f), 0x7C00);
+  BOOST_CHECK_EQUAL(PayloadCodec::FloatToHalf(std::ldexp(1.0f, -24)), 0x0001);
+  BOOST_CHECK_EQUAL(PayloadCodec::FloatToHalf(1e-10f), 0x0000);
+  BOOST_CHECK(std::isnan(PayloadCodec::HalfToFloat(PayloadCodec::FloatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+  BOOST_CHECK_EQUAL(PayloadCodec::HalfToFloat(0x0001), std::ldexp(1.0f, -24));
+  BOOST_CHECK_EQUAL(PayloadCodec::HalfToFloat(0x3555), 0.333251953125f);
+
+  BOOST_CHECK_EQUAL(PayloadCodec::FloatToBfloat(1.0f), 0x3F80);
+  BOOST_CHECK_EQUAL(PayloadCodec::BfloatToFloat(PayloadCodec::FloatToBfloat(3.0f)), 3.0f);
+  BOOST_CHECK(std::isnan(PayloadCodec::BfloatToFloat(PayloadCodec::FloatToBfloat(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+BOOST_AUTO_TEST_CASE(DenseCodecs)
+{
+  std::vector<float> parameters = makeParameters(301);
+  size_t fp32Size;
+  BOOST_CHECK(roundTrip(PayloadCodec(), parameters, fp32Size) == parameters);
+
+  struct {
+    PayloadCodec::Type type;
+    float relativeError;
+  } codecs[] = {{PayloadCodec::Type::kFp16, 1e-3f}, {PayloadCodec::Type::kBf16, 8e-3f}};
+  for (const auto& codec : codecs) {
+    size_t size;
+    std::vector<float> decoded = roundTrip(PayloadCodec(codec.type), parameters, size);
+    BOOST_CHECK_EQUAL(size, fp32Size - 301 * 2);
+    for (size_t i = 0; i < parameters.size(); ++i) {
+      BOOST_CHECK_LE(std::fabs(decoded[i] - parameters[i]), codec.relativeError * std::fabs(parameters[i]));
+    }
+  }
+
+  // Each block is scaled by its largest magnitude
+  size_t size;
+  std::vector<float> decoded = roundTrip(PayloadCodec(PayloadCodec::Type::kInt8), parameters, size);
+  size_t numBlocks = (301 + PayloadCodec::INT8_BLOCK_SIZE - 1) / PayloadCodec::INT8_BLOCK_SIZE;
+  BOOST_CHECK_EQUAL(size, fp32Size - 301 * 4 + numBlocks * 4 + 301);
+  for (size_t block = 0; block < numBlocks; ++block) {
+    size_t end = std::min<size_t>((block + 1) * PayloadCodec::INT8_BLOCK_SIZE, 301);
+    float maxAbs = 0.0f;
+    for (size_t i = block * PayloadCodec::INT8_BLOCK_SIZE; i < end; ++i) {
+      maxAbs = std::max(maxAbs, std::fabs(parameters[i]));
+    }
+    for (size_t i = block * PayloadCodec::INT8_BLOCK_SIZE; i < end; ++i) {
+      BOOST_CHECK_LE(std::fabs(decoded[i] - parameters[i]), maxAbs / 127.0f * 0.5001f);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TopK)
+{
+  std::vector<float> parameters(100, 0.5f);
+  parameters[3] = -9.0f;
+  parameters[42] = 7.0f;
+  parameters[99] = 8.0f;
+
+  size_t size;
+  std::vector<float> decoded = roundTrip(PayloadCodec(PayloadCodec::Type::kTopK, 0.03), parameters, size);
+  BOOST_CHECK_EQUAL(size, ModelDataFormat::HEADER_SIZE + 4 + 3 * 8 + 4 + 5);
+  std::vector<float> expected(100, 0.0f);
+  expected[3] = -9.0f;
+  expected[42] = 7.0f;
+  expected[99] = 8.0f;
+  BOOST_CHECK(decoded == expected);
+
+  // At least one parameter is kept, k can't exceed the model size
+  BOOST_CHECK_EQUAL(PayloadCodec(PayloadCodec::Type::kTopK, 0.0).GetTopK(100), 1);
+  BOOST_CHECK_EQUAL(PayloadCodec(PayloadCodec::Type::kTopK, 1.0).GetTopK(100), 100);
+  BOOST_CHECK_EQUAL(PayloadCodec(PayloadCodec::Type::kTopK, 0.5).GetTopK(0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Malformed)
+{
+  std::vector<uint8_t> buffer;
+  serializeModelData(makeParameters(10), {}, buffer, 1, PayloadCodec(PayloadCodec::Type::kTopK, 0.5));
+
+  ModelDataView view;
+  std::vector<uint8_t> truncated(buffer.begin(), buffer.end() - 1);
+  BOOST_CHECK(!view.parse(truncated));
+
+  // k larger than the model size
+  std::vector<uint8_t> invalid = buffer;
+  uint32_t k = 11;
+  std::memcpy(invalid.data() + ModelDataFormat::HEADER_SIZE, &k, sizeof(k));
+  BOOST_CHECK(!view.parse(invalid));
+
+  // Unknown codec
+  invalid = buffer;
+  invalid[3] = 0x7F;
+  BOOST_CHECK(!view.parse(invalid));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "apps/PayloadEngine.hpp"
+#include "apps/ModelData.hpp"
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsPayloadEngine)
+
+static void
+checkPayload(const ::ndn::ConstBufferPtr& payload, size_t modelSize)
+{
+  ModelData modelData;
+  BOOST_REQUIRE(deserializeModelData(*payload, modelData));
+  BOOST_REQUIRE_EQUAL(modelData.parameters.size(), modelSize);
+  BOOST_CHECK(modelData.congestedNodes.empty());
+  for (float parameter : modelData.parameters) {
+    BOOST_CHECK_GE(parameter, 0.0f);
+    BOOST_CHECK_LT(parameter, 10.0f);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(AllModes)
+{
+  for (const char* name : {"Random", "Pool", "Counter", "Template"}) {
+    PayloadEngine::Mode mode;
+    BOOST_REQUIRE(PayloadEngine::ParseMode(name, mode));
+    BOOST_CHECK_EQUAL(PayloadEngine::GetModeName(mode), name);
+
+    PayloadEngine engine;
+    engine.Configure(mode, 301, 42, 4); // odd size covers the last single parameter
+    checkPayload(engine.Next(), 301);
+    checkPayload(engine.Next(), 301);
+  }
+
+  PayloadEngine::Mode mode;
+  BOOST_CHECK(!PayloadEngine::ParseMode("Unknown", mode));
+}
+
+BOOST_AUTO_TEST_CASE(Reproducible)
+{
+  PayloadEngine first;
+  PayloadEngine second;
+  PayloadEngine other;
+  first.Configure(PayloadEngine::Mode::kCounter, 100, 7, 1);
+  second.Configure(PayloadEngine::Mode::kCounter, 100, 7, 1);
+  other.Configure(PayloadEngine::Mode::kCounter, 100, 8, 1);
+
+  auto a = first.Next();
+  auto b = second.Next();
+  BOOST_CHECK(*a == *b);
+  BOOST_CHECK(!(*a == *other.Next()));
+  // Successive payloads differ
+  BOOST_CHECK(!(*first.Next() == *a));
+}
+
+BOOST_AUTO_TEST_CASE(PoolCycles)
+{
+  PayloadEngine engine;
+  engine.Configure(PayloadEngine::Mode::kPool, 10, 1, 3);
+  auto first = engine.Next();
+  BOOST_CHECK(engine.Next() != first);
+  BOOST_CHECK(engine.Next() != first);
+  BOOST_CHECK(engine.Next() == first); // shared, not copied
+}
+
+BOOST_AUTO_TEST_CASE(Encoded)
+{
+  PayloadEngine fp32;
+  PayloadEngine fp16;
+  fp32.Configure(PayloadEngine::Mode::kCounter, 100, 5, 1);
+  fp16.SetCodec(PayloadCodec(PayloadCodec::Type::kFp16));
+  fp16.Configure(PayloadEngine::Mode::kCounter, 100, 5, 1);
+
+  // Same parameters, half the bytes
+  auto raw = fp32.Next();
+  auto encoded = fp16.Next();
+  BOOST_CHECK_EQUAL(encoded->size(), ModelDataFormat::HEADER_SIZE + 100 * 2);
+  checkPayload(encoded, 100);
+
+  ModelData expected;
+  ModelData decoded;
+  BOOST_REQUIRE(deserializeModelData(*raw, expected));
+  BOOST_REQUIRE(deserializeModelData(*encoded, decoded));
+  for (size_t i = 0; i < 100; ++i) {
+    BOOST_CHECK_CLOSE(decoded.parameters[i], expected.parameters[i], 0.1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Template)
+{
+  PayloadEngine engine;
+  engine.Configure(PayloadEngine::Mode::kTemplate, 50, 3, 1);
+
+  Data prototype("/pro0");
+  prototype.setFreshnessPeriod(::ndn::time::milliseconds(100));
+  prototype.setContent(engine.Next());
+  prototype.setSignatureInfo(SignatureInfo(static_cast< ::ndn::tlv::SignatureTypeValue>(255)));
+  prototype.setSignatureValue(std::make_shared<::ndn::Buffer>(1));
+
+  DataTemplate dataTemplate;
+  BOOST_CHECK(!dataTemplate.IsSet());
+  dataTemplate.Set(prototype);
+  BOOST_REQUIRE(dataTemplate.IsSet());
+
+  Name name("/pro0/leaves/data");
+  name.appendSequenceNumber(12);
+  auto data = dataTemplate.Make(name);
+  BOOST_CHECK_EQUAL(data->getName(), name);
+  BOOST_CHECK_EQUAL(data->getFreshnessPeriod(), ::ndn::time::milliseconds(100));
+  BOOST_CHECK(data->getContent() == prototype.getContent());
+  BOOST_CHECK_EQUAL(data->getSignatureType(), 255);
+  checkPayload(std::make_shared<::ndn::Buffer>(data->getContent().value_begin(), data->getContent().value_end()), 50);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "apps/RetxFilter.hpp"
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsRetxFilter)
+
+static Name
+makeName(const std::string& prefix, uint64_t seq)
+{
+  Name name(prefix);
+  name.appendSequenceNumber(seq);
+  return name;
+}
+
+BOOST_AUTO_TEST_CASE(NameAndSeq)
+{
+  RetxFilter filter(16, MilliSeconds(100));
+  filter.insert(makeName("/agg0/job0/data", 3), MilliSeconds(0));
+
+  BOOST_CHECK(filter.contains(makeName("/agg0/job0/data", 3), MilliSeconds(10)));
+  BOOST_CHECK(!filter.contains(makeName("/agg0/job0/data", 4), MilliSeconds(10)));
+  BOOST_CHECK(!filter.contains(makeName("/agg1/job0/data", 3), MilliSeconds(10)));
+  BOOST_CHECK(!filter.contains(makeName("/agg0/job1/data", 3), MilliSeconds(10)));
+  BOOST_CHECK_EQUAL(filter.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Lifetime)
+{
+  RetxFilter filter(16, MilliSeconds(100));
+  filter.insert(makeName("/agg0/job0/data", 1), MilliSeconds(0));
+  filter.insert(makeName("/agg0/job0/data", 2), MilliSeconds(50));
+
+  BOOST_CHECK(filter.contains(makeName("/agg0/job0/data", 1), MilliSeconds(99)));
+  BOOST_CHECK(!filter.contains(makeName("/agg0/job0/data", 1), MilliSeconds(100)));
+
+  // refreshed before it expired, the older entry doesn't forget it
+  filter.insert(makeName("/agg0/job0/data", 2), MilliSeconds(120));
+  filter.expire(MilliSeconds(160));
+  BOOST_CHECK(filter.contains(makeName("/agg0/job0/data", 2), MilliSeconds(160)));
+  BOOST_CHECK_EQUAL(filter.size(), 1);
+
+  filter.expire(MilliSeconds(220));
+  BOOST_CHECK_EQUAL(filter.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Refresh)
+{
+  RetxFilter filter(3, MilliSeconds(100));
+  for (int i = 0; i < 1000; ++i) {
+    filter.insert(makeName("/agg0/job0/data", 1), MilliSeconds(i));
+  }
+  BOOST_CHECK_EQUAL(filter.size(), 1);
+  BOOST_CHECK(filter.contains(makeName("/agg0/job0/data", 1), MilliSeconds(1098)));
+
+  // the refreshed name moved behind the others, so it is evicted last
+  filter.insert(makeName("/agg0/job0/data", 2), MilliSeconds(1000));
+  filter.insert(makeName("/agg0/job0/data", 1), MilliSeconds(1001));
+  filter.insert(makeName("/agg0/job0/data", 3), MilliSeconds(1002));
+  filter.insert(makeName("/agg0/job0/data", 4), MilliSeconds(1003));
+  BOOST_CHECK_EQUAL(filter.size(), 3);
+  BOOST_CHECK(!filter.contains(makeName("/agg0/job0/data", 2), MilliSeconds(1004)));
+  BOOST_CHECK(filter.contains(makeName("/agg0/job0/data", 1), MilliSeconds(1004)));
+
+  // names expire in the order of their last insert
+  filter.expire(MilliSeconds(1101));
+  BOOST_CHECK_EQUAL(filter.size(), 2);
+  BOOST_CHECK(!filter.contains(makeName("/agg0/job0/data", 1), MilliSeconds(1101)));
+  filter.expire(MilliSeconds(1103));
+  BOOST_CHECK_EQUAL(filter.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Capacity)
+{
+  RetxFilter filter(4, Seconds(10));
+  for (uint64_t seq = 0; seq < 6; ++seq) {
+    filter.insert(makeName("/agg0/job0/data", seq), MilliSeconds(seq));
+  }
+  BOOST_CHECK_EQUAL(filter.size(), 4);
+  BOOST_CHECK(!filter.contains(makeName("/agg0/job0/data", 0), MilliSeconds(10)));
+  BOOST_CHECK(!filter.contains(makeName("/agg0/job0/data", 1), MilliSeconds(10)));
+  BOOST_CHECK(filter.contains(makeName("/agg0/job0/data", 2), MilliSeconds(10)));
+  BOOST_CHECK(filter.contains(makeName("/agg0/job0/data", 5), MilliSeconds(10)));
+
+  // capacity 0 disables the filter
+  filter.setCapacity(0);
+  BOOST_CHECK_EQUAL(filter.size(), 0);
+  filter.insert(makeName("/agg0/job0/data", 7), MilliSeconds(20));
+  BOOST_CHECK(!filter.contains(makeName("/agg0/job0/data", 7), MilliSeconds(20)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
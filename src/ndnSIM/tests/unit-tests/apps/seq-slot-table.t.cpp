@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "apps/SeqSlotTable.hpp"
+
+#include <vector>
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsSeqSlotTable)
+
+struct CountingSlot {
+  int value = 0;
+  int resets = 0;
+  std::vector<float> buffer;
+
+  void
+  reset()
+  {
+    value = 0;
+    ++resets;
+  }
+};
+
+BOOST_AUTO_TEST_CASE(InsertFindErase)
+{
+  SeqSlotTable<CountingSlot> table(5);
+  BOOST_CHECK_EQUAL(table.capacity(), 8);
+  BOOST_CHECK(table.find(1) == nullptr);
+
+  table.insert(1).value = 10;
+  table.insert(2).value = 20;
+  BOOST_CHECK_EQUAL(table.size(), 2);
+  BOOST_REQUIRE(table.find(1) != nullptr);
+  BOOST_CHECK_EQUAL(table.find(1)->value, 10);
+
+  // inserting an active seq keeps its content
+  BOOST_CHECK_EQUAL(table.insert(1).value, 10);
+  BOOST_CHECK_EQUAL(table.size(), 2);
+
+  table.erase(1);
+  BOOST_CHECK(table.find(1) == nullptr);
+  BOOST_CHECK_EQUAL(table.size(), 1);
+
+  // reused slot is reset, but keeps its buffer
+  table.find(2)->buffer.resize(100);
+  table.erase(2);
+  CountingSlot& reused = table.insert(10);
+  BOOST_CHECK_EQUAL(reused.value, 0);
+  BOOST_CHECK_EQUAL(reused.resets, 2);
+  BOOST_CHECK_GE(reused.buffer.capacity(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(GrowOnCollision)
+{
+  SeqSlotTable<CountingSlot> table(4);
+  for (uint32_t seq = 0; seq < 20; ++seq) {
+    table.insert(seq).value = static_cast<int>(seq);
+  }
+  BOOST_CHECK_EQUAL(table.size(), 20);
+  BOOST_CHECK_GE(table.capacity(), 32);
+
+  for (uint32_t seq = 0; seq < 20; ++seq) {
+    BOOST_REQUIRE(table.find(seq) != nullptr);
+    BOOST_CHECK_EQUAL(table.find(seq)->value, static_cast<int>(seq));
+  }
+
+  int visited = 0;
+  table.forEach([&] (uint32_t seq, CountingSlot& slot) {
+    BOOST_CHECK_EQUAL(slot.value, static_cast<int>(seq));
+    ++visited;
+  });
+  BOOST_CHECK_EQUAL(visited, 20);
+
+  table.clear();
+  BOOST_CHECK_EQUAL(table.size(), 0);
+  BOOST_CHECK(table.find(3) == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
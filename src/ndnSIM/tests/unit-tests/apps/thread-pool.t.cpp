@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "apps/algorithm/utility/thread_pool.hpp"
+
+#include <atomic>
+#include <vector>
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsThreadPool)
+
+BOOST_AUTO_TEST_CASE(ParallelFor)
+{
+  Utility::ThreadPool pool(4);
+  std::vector<std::atomic<int>> calls(100);
+  std::atomic<int> nBadWorkers(0);
+  pool.ParallelFor(0, 100, [&] (int i, int worker) {
+    ++calls[i];
+    if (worker < 0 || worker >= pool.size()) {
+      ++nBadWorkers;
+    }
+  });
+
+  BOOST_CHECK_EQUAL(nBadWorkers, 0);
+  for (const auto& n : calls) {
+    BOOST_CHECK_EQUAL(n, 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(NestedKeepsWorker)
+{
+  Utility::ThreadPool pool(4);
+  std::vector<std::atomic<int>> busy(pool.size());
+  std::atomic<int> nShared(0);
+  std::atomic<int> nOtherWorker(0);
+  std::atomic<int> nNestedCalls(0);
+
+  pool.ParallelFor(0, 64, [&] (int, int worker) {
+    if (busy[worker]++ > 0) {
+      ++nShared;
+    }
+    // runs inline, on the buffers of the enclosing call
+    pool.ParallelFor(0, 10, [&] (int, int nestedWorker) {
+      ++nNestedCalls;
+      if (nestedWorker != worker) {
+        ++nOtherWorker;
+      }
+    });
+    --busy[worker];
+  });
+
+  BOOST_CHECK_EQUAL(nShared, 0);
+  BOOST_CHECK_EQUAL(nOtherWorker, 0);
+  BOOST_CHECK_EQUAL(nNestedCalls, 640);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
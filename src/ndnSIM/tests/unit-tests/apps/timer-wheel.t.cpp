@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "apps/TimerWheel.hpp"
+
+#include <string>
+#include <vector>
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsTimerWheel)
+
+BOOST_AUTO_TEST_CASE(ExpireInOrder)
+{
+  TimerWheel<std::string> wheel(MilliSeconds(1), 16);
+  wheel.schedule("/a", MilliSeconds(10));
+  wheel.schedule("/b", MilliSeconds(25));
+  wheel.schedule("/c", MilliSeconds(100)); // more than one rotation away
+  BOOST_CHECK_EQUAL(wheel.size(), 3);
+
+  std::vector<std::string> expired;
+  auto collect = [&] (const std::string& key) { expired.push_back(key); };
+
+  wheel.expire(MilliSeconds(9), collect);
+  BOOST_CHECK(expired.empty());
+
+  wheel.expire(MilliSeconds(10), collect);
+  BOOST_REQUIRE_EQUAL(expired.size(), 1);
+  BOOST_CHECK_EQUAL(expired[0], "/a");
+
+  // several rotations elapse at once
+  wheel.expire(MilliSeconds(99), collect);
+  BOOST_REQUIRE_EQUAL(expired.size(), 2);
+  BOOST_CHECK_EQUAL(expired[1], "/b");
+  BOOST_CHECK(wheel.contains("/c"));
+
+  wheel.expire(MilliSeconds(150), collect);
+  BOOST_REQUIRE_EQUAL(expired.size(), 3);
+  BOOST_CHECK_EQUAL(expired[2], "/c");
+  BOOST_CHECK_EQUAL(wheel.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(CancelAndRearm)
+{
+  TimerWheel<uint64_t> wheel(MilliSeconds(1), 8);
+  wheel.schedule(1, MilliSeconds(5));
+  wheel.schedule(2, MilliSeconds(5));
+  BOOST_CHECK(wheel.cancel(1));
+  BOOST_CHECK(!wheel.cancel(1));
+
+  // re-arming replaces the old deadline
+  wheel.schedule(2, MilliSeconds(20));
+
+  std::vector<uint64_t> expired;
+  wheel.expire(MilliSeconds(10), [&] (uint64_t key) { expired.push_back(key); });
+  BOOST_CHECK(expired.empty());
+
+  // a callback may re-arm the expired key
+  wheel.expire(MilliSeconds(20), [&] (uint64_t key) {
+    expired.push_back(key);
+    wheel.schedule(key, MilliSeconds(30));
+  });
+  BOOST_CHECK_EQUAL(expired.size(), 1);
+  BOOST_CHECK(wheel.contains(2));
+
+  // deadline in the past fires on next expire
+  wheel.schedule(3, MilliSeconds(1));
+  expired.clear();
+  wheel.expire(MilliSeconds(21), [&] (uint64_t key) { expired.push_back(key); });
+  BOOST_REQUIRE_EQUAL(expired.size(), 1);
+  BOOST_CHECK_EQUAL(expired[0], 3);
+}
+
+BOOST_AUTO_TEST_CASE(NextExpiry)
+{
+  TimerWheel<uint64_t> wheel(MilliSeconds(1), 16);
+  BOOST_CHECK_EQUAL(wheel.nextExpiry(), Time::Max());
+
+  // deadlines are rounded up to the tick
+  BOOST_CHECK_EQUAL(wheel.schedule(1, MicroSeconds(7500)), MilliSeconds(8));
+  BOOST_CHECK_EQUAL(wheel.schedule(2, MilliSeconds(12)), MilliSeconds(12));
+  BOOST_CHECK_EQUAL(wheel.nextExpiry(), MilliSeconds(8));
+
+  // cancelled keys are skipped
+  wheel.cancel(1);
+  BOOST_CHECK_EQUAL(wheel.nextExpiry(), MilliSeconds(12));
+
+  // a key more than one rotation away is reported when its bucket comes up, expire() keeps it until its deadline
+  wheel.cancel(2);
+  wheel.schedule(3, MilliSeconds(40));
+  BOOST_CHECK_EQUAL(wheel.nextExpiry(), MilliSeconds(8));
+
+  std::vector<uint64_t> expired;
+  wheel.expire(MilliSeconds(8), [&] (uint64_t key) { expired.push_back(key); });
+  BOOST_CHECK(expired.empty());
+  BOOST_CHECK_EQUAL(wheel.nextExpiry(), MilliSeconds(24));
+  wheel.expire(MilliSeconds(24), [&] (uint64_t key) { expired.push_back(key); });
+  BOOST_CHECK_EQUAL(wheel.nextExpiry(), MilliSeconds(40));
+  wheel.expire(MilliSeconds(40), [&] (uint64_t key) { expired.push_back(key); });
+  BOOST_REQUIRE_EQUAL(expired.size(), 1);
+  BOOST_CHECK_EQUAL(expired[0], 3);
+  BOOST_CHECK_EQUAL(wheel.nextExpiry(), Time::Max());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2024  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "apps/TreeDescriptor.hpp"
+
+#include <ndn-cxx/interest.hpp>
+
+#include "../tests-common.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(AppsTreeDescriptor)
+
+BOOST_AUTO_TEST_CASE(BitmapTrimmed)
+{
+  LeafBitmap bitmap(1000);
+  bitmap.set(520);
+  bitmap.set(523);
+  bitmap.set(530);
+
+  ::ndn::Block block = encodeLeafBitmap(bitmap);
+  // Only bytes 65 and 66 are kept
+  BOOST_CHECK_LT(block.size(), 12);
+
+  LeafBitmap decoded;
+  BOOST_REQUIRE(decodeLeafBitmap(block, 1000, decoded));
+  BOOST_CHECK(decoded == bitmap);
+
+  // Bits beyond the number of producers are dropped
+  BOOST_REQUIRE(decodeLeafBitmap(block, 525, decoded));
+  BOOST_CHECK_EQUAL(decoded.size(), 525);
+  BOOST_CHECK_EQUAL(decoded.count(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(EmptyBitmap)
+{
+  LeafBitmap bitmap(100);
+  LeafBitmap decoded;
+  BOOST_REQUIRE(decodeLeafBitmap(encodeLeafBitmap(bitmap), 100, decoded));
+  BOOST_CHECK(decoded.none());
+  BOOST_CHECK_EQUAL(decoded.size(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(LeafComponent)
+{
+  LeafBitmap bitmap(200);
+  for (size_t i = 0; i < 200; i += 7) {
+    bitmap.set(i);
+  }
+  Name name("/agg0");
+  name.append(makeLeafComponent(bitmap)).append("data").appendSequenceNumber(3);
+
+  // Survives URI round trip, which is how names are keyed by the apps
+  Name parsed(name.toUri());
+  LeafBitmap decoded;
+  BOOST_REQUIRE(parseLeafComponent(parsed.get(1), 200, decoded));
+  BOOST_CHECK(decoded == bitmap);
+
+  BOOST_CHECK(!parseLeafComponent(Name("/pro0.pro1").get(0), 200, decoded));
+}
+
+BOOST_AUTO_TEST_CASE(DescriptorRoundTrip)
+{
+  TreeDescriptor descriptor;
+  descriptor.numProducers = 64;
+  LeafBitmap first(64);
+  first.set(0);
+  first.set(1);
+  LeafBitmap second(64);
+  second.set(63);
+  descriptor.children.emplace_back("agg3", first);
+  descriptor.children.emplace_back("pro63", second);
+
+  Interest interest(Name("/agg0/initialization").appendSequenceNumber(1));
+  interest.setApplicationParameters(descriptor.wireEncode());
+  BOOST_CHECK(interest.getName().get(-1).isParametersSha256Digest());
+  BOOST_CHECK_EQUAL(stripParametersDigest(interest.getName()), Name("/agg0/initialization").appendSequenceNumber(1));
+
+  TreeDescriptor decoded;
+  BOOST_REQUIRE(decoded.wireDecode(interest.getApplicationParameters()));
+  BOOST_CHECK_EQUAL(decoded.numProducers, 64);
+  BOOST_REQUIRE_EQUAL(decoded.children.size(), 2);
+  BOOST_CHECK_EQUAL(decoded.children[0].first, "agg3");
+  BOOST_CHECK(decoded.children[0].second == first);
+  BOOST_CHECK_EQUAL(decoded.children[1].first, "pro63");
+  BOOST_CHECK(decoded.children[1].second == second);
+
+  BOOST_CHECK(!decoded.wireDecode(::ndn::makeEmptyBlock(::ndn::tlv::ApplicationParameters)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3